@@ -560,6 +560,9 @@ RETVAL CGen8OpenCLStateProcessor::CreateKernelHeap(
 
     if (retValue.Success)
     {
+        membuf.Reserve(membuf.Size() + kernelBinarySize +
+            HWCaps().InstructionCachePrefetchSize + sizeof(DWORD));
+
         if (membuf.Write(kernelBinary, kernelBinarySize) == false)
         {
             IGC_ASSERT(0);
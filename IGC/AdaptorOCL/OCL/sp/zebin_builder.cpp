@@ -56,6 +56,9 @@ ZEBinaryBuilder::ZEBinaryBuilder(
     tf.generatorId = TargetFlags::GeneratorId::IGC;
     mBuilder.setTargetFlag(tf);
 
+    if (IGC_GET_FLAG_VALUE(ZEInfoEncoding) != 0)
+        mBuilder.setZEInfoEncoding(IGC_GET_FLAG_VALUE(ZEInfoEncoding));
+
     addProgramScopeInfo(programInfo);
 
     if (spvData != nullptr)
@@ -84,6 +87,7 @@ void ZEBinaryBuilder::createKernel(
     zeInfoKernel& zeKernel = mZEInfoBuilder.createKernel(annotations.m_kernelName);
     addKernelExecEnv(annotations, zeKernel);
     addKernelExperimentalProperties(annotations, zeKernel);
+    addKernelSpecialization(annotations, zeKernel);
     if (annotations.m_threadPayload.HasLocalIDx ||
         annotations.m_threadPayload.HasLocalIDy ||
         annotations.m_threadPayload.HasLocalIDz) {
@@ -436,6 +440,15 @@ void ZEBinaryBuilder::addKernelExperimentalProperties(const SOpenCLKernelInfo& a
     }
 }
 
+void ZEBinaryBuilder::addKernelSpecialization(const SOpenCLKernelInfo& annotations,
+    zeInfoKernel& zeinfoKernel)
+{
+    if (annotations.m_zeSpecializationOf.empty())
+        return;
+    zeinfoKernel.specialization_of = annotations.m_zeSpecializationOf;
+    zeinfoKernel.specialized_arguments = annotations.m_zeSpecializedArgs;
+}
+
 void ZEBinaryBuilder::addKernelExecEnv(const SOpenCLKernelInfo& annotations,
     zeInfoKernel& zeinfoKernel)
 {
@@ -510,10 +523,13 @@ void ZEBinaryBuilder::getBinaryObject(llvm::raw_pwrite_stream& os)
 
 void ZEBinaryBuilder::getBinaryObject(Util::BinaryStream& outputStream)
 {
-    llvm::SmallVector<char, 64> buf;
-    llvm::raw_svector_ostream llvm_os(buf);
-    getBinaryObject(llvm_os);
-    outputStream.Write(buf.data(), buf.size());
+    mBuilder.addSectionZEInfo(mZEInfoBuilder.getZEInfoContainer());
+    // the object is laid out before the buffer is requested, so it is
+    // written straight into the stream at its final size
+    mBuilder.finalize([&outputStream](uint64_t size) {
+        return reinterpret_cast<uint8_t*>(
+            outputStream.Append(static_cast<std::streamsize>(size)));
+    });
 }
 
 void ZEBinaryBuilder::printBinaryObject(const std::string& filename)
@@ -114,6 +114,10 @@ private:
     void addKernelExperimentalProperties(const IGC::SOpenCLKernelInfo& annotations,
         zebin::zeInfoKernel& zeinfoKernel);
 
+    /// add the generic kernel and argument values of a specialized variant
+    void addKernelSpecialization(const IGC::SOpenCLKernelInfo& annotations,
+        zebin::zeInfoKernel& zeinfoKernel);
+
     /// add symbols of this kernel corresponding to kernek binary
     /// added by addKernelBinary
     void addSymbols(
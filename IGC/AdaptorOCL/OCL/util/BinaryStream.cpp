@@ -26,10 +26,13 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "BinaryStream.h"
 
+#include <algorithm>
+#include <cstring>
+
 namespace Util
 {
 
-BinaryStream::BinaryStream() : m_membuf( std::ios::in | std::ios::out | std::ios::binary )
+BinaryStream::BinaryStream() : m_Size( 0 )
 {
     // Nothing!
 }
@@ -39,80 +42,168 @@ BinaryStream::~BinaryStream()
     // Nothing!
 }
 
-bool BinaryStream::Write( const char* s, std::streamsize n )
+BinaryStream::Buffer& BinaryStream::GetTail( size_t extra )
 {
-    bool retValue = false;
-
-    std::streamsize prevSize = Size();
+    // The last segment can be appended to only while nothing else shares its
+    // buffer and it covers the buffer's end.
+    if( !m_Segments.empty() )
+    {
+        Segment& tail = m_Segments.back();
+        if( tail.buf.use_count() == 1 &&
+            tail.offset + tail.size == tail.buf->size() )
+        {
+            if( tail.buf->capacity() - tail.buf->size() < extra )
+            {
+                // grow geometrically, as push_back would
+                tail.buf->reserve( std::max( tail.buf->size() + extra,
+                                             2 * tail.buf->capacity() ) );
+            }
+            return *tail.buf;
+        }
+    }
 
-    m_membuf.write( s, n );
+    Segment seg = { std::make_shared<Buffer>(), 0, 0 };
+    seg.buf->reserve( extra );
+    m_Segments.push_back( seg );
+    return *m_Segments.back().buf;
+}
 
-    if( ( Size() - prevSize ) == n )
+void BinaryStream::MakeUnique( Segment& seg )
+{
+    if( seg.buf.use_count() > 1 )
     {
-        retValue = true;
+        const char* src = seg.data();
+        seg.buf = std::make_shared<Buffer>( src, src + seg.size );
+        seg.offset = 0;
     }
+}
 
-    if( m_membuf.fail() )
+void BinaryStream::Gather( const std::vector<Segment>& segments, char* dst )
+{
+    for( const Segment& seg : segments )
     {
-        retValue = false;
+        memcpy( dst, seg.data(), seg.size );
+        dst += seg.size;
     }
+}
 
-#if defined(_DEBUG)
-    GetLinearPointer();
-#endif
-
-    return retValue;
+bool BinaryStream::Write( const char* s, std::streamsize n )
+{
+    if( n < 0 )
+    {
+        return false;
+    }
+    if( n > 0 )
+    {
+        memcpy( Append( n ), s, (size_t)n );
+    }
+    return true;
 }
 
 bool BinaryStream::Write( const BinaryStream& in )
 {
-    bool retValue = false;
+    // copy the segment list first; in may be this stream
+    std::vector<Segment> segments = in.m_Segments;
+    const size_t size = (size_t)in.m_Size;
+
+    if( size < s_MinChainSize )
+    {
+        if( size > 0 )
+        {
+            Gather( segments, Append( size ) );
+        }
+        return true;
+    }
 
-    std::streamsize prevSize = Size();
+    // Share the source's buffers.  Both streams now see them as shared, so
+    // neither appends to them, and WriteAt copies before patching.
+    m_Segments.insert( m_Segments.end(), segments.begin(), segments.end() );
+    m_Size += size;
 
-    m_membuf << in.m_membuf.str();
+    return true;
+}
 
-    if( ( Size() - prevSize ) == in.Size() )
+bool BinaryStream::WriteAt( const char* s, std::streamsize n, std::streamsize loc )
+{
+    if( n < 0 || loc < 0 || ( n + loc ) > Size() )
     {
-        retValue = true;
+        return false;
     }
 
-    if( m_membuf.fail() )
+    size_t pos = (size_t)loc;
+    size_t remaining = (size_t)n;
+    size_t segStart = 0;
+    for( Segment& seg : m_Segments )
     {
-        retValue = false;
+        if( remaining == 0 )
+        {
+            break;
+        }
+        if( pos < segStart + seg.size )
+        {
+            MakeUnique( seg );
+            size_t segOffset = pos - segStart;
+            size_t count = std::min( remaining, seg.size - segOffset );
+            memcpy( seg.data() + segOffset, s, count );
+            s += count;
+            pos += count;
+            remaining -= count;
+        }
+        segStart += seg.size;
     }
 
-#if defined(_DEBUG)
-    GetLinearPointer();
-#endif
+    return true;
+}
 
-    return retValue;
+void BinaryStream::Reserve( std::streamsize size )
+{
+    if( size > Size() )
+    {
+        GetTail( (size_t)( size - Size() ) );
+    }
 }
 
+char* BinaryStream::Append( std::streamsize n )
+{
+    Buffer& buf = GetTail( (size_t)n );
+    size_t start = buf.size();
+    buf.resize( start + (size_t)n );
+    m_Segments.back().size += (size_t)n;
+    m_Size += n;
+    return buf.data() + start;
+}
 
-bool BinaryStream::WriteAt( const char* s, std::streamsize n, std::streamsize loc )
+const char* BinaryStream::GetLinearPointer()
 {
-    bool retValue = true;
+    static const char empty = 0;
 
-    // Give this function name it seems like this function should enlarge the stream if needed. Discuss.
-    if( ( n + loc ) < Size() )
+    if( m_Segments.empty() )
     {
-        m_membuf.seekp( loc, std::ios_base::beg );
-        Write( s, n );
-        m_membuf.seekp( 0, std::ios_base::end );
+        return &empty;
     }
-    else
+
+    if( m_Segments.size() > 1 )
     {
-        retValue = false;
+        // flatten once; later calls reuse the result until the stream is
+        // chained again
+        Segment seg = { std::make_shared<Buffer>( (size_t)m_Size ), 0, (size_t)m_Size };
+        Gather( m_Segments, seg.data() );
+        m_Segments.clear();
+        m_Segments.push_back( seg );
     }
 
-    return retValue;
+    return m_Segments.front().data();
 }
 
-const char* BinaryStream::GetLinearPointer()
+bool BinaryStream::CopyTo( char* dst, std::streamsize dstSize ) const
 {
-    m_LinearPointer = m_membuf.str();
-    return m_LinearPointer.c_str();
+    if( dstSize < Size() )
+    {
+        return false;
+    }
+
+    Gather( m_Segments, dst );
+    return true;
 }
 
 bool BinaryStream::Align( std::streamsize alignment )
@@ -137,28 +228,19 @@ bool BinaryStream::Align( std::streamsize alignment )
 
 bool BinaryStream::AddPadding( std::streamsize padding )
 {
-    bool retValue = true;
-
-    while( padding-- )
+    if( padding < 0 )
     {
-        // Always pad with 0x0 to make external tools that parse
-        // OpenCL program binaries easier to maintain
-        retValue &= Write( (char)0x0 );
+        return false;
     }
 
-    return retValue;
-}
-
-std::streamsize BinaryStream::Size() const
-{
-    // tellp is a non const function
-    // TODO: Is there a better way to do this?
-    return const_cast<BinaryStream*>(this)->Size();
-}
+    // Always pad with 0x0 to make external tools that parse
+    // OpenCL program binaries easier to maintain
+    if( padding > 0 )
+    {
+        memset( Append( padding ), 0, (size_t)padding );
+    }
 
-std::streamsize BinaryStream::Size()
-{
-    return m_membuf.tellp();
+    return true;
 }
 
 }
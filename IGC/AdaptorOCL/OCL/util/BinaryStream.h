@@ -26,17 +26,32 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #pragma once
 
-#include <sstream>
+#include <ios>
+#include <memory>
+#include <vector>
 
 namespace Util
 {
 
+// A growable byte stream used to assemble patch token binaries.
+//
+// The contents are kept as a list of segments over shared buffers.  Bytes
+// written directly go into a contiguous, owned tail buffer which can be
+// sized up front with Reserve.  Writing one stream into another chains the
+// source's buffers instead of copying them, so nesting kernel streams into a
+// program stream costs no copies; the data is gathered only once, either by
+// GetLinearPointer (which flattens and caches) or by CopyTo (which writes
+// straight into the caller's buffer).  A shared buffer is copied before it
+// is patched by WriteAt, so chained streams keep value semantics.
 class BinaryStream
 {
 public:
     BinaryStream();
     ~BinaryStream();
 
+    BinaryStream( const BinaryStream& ) = delete;
+    BinaryStream& operator=( const BinaryStream& ) = delete;
+
     bool Write( const char* s, std::streamsize n );
 
     bool Write( const BinaryStream& in );
@@ -44,6 +59,7 @@ public:
     template< class T >
     bool Write( const T& in );
 
+    // Patches n bytes at loc in place; the patched range must already exist.
     bool WriteAt( const char* s, std::streamsize n, std::streamsize loc );
 
     template< class T >
@@ -52,15 +68,44 @@ public:
     bool Align( std::streamsize alignment );
     bool AddPadding( std::streamsize padding );
 
+    // Makes room so that the stream can grow to size bytes without
+    // reallocating.
+    void Reserve( std::streamsize size );
+
+    // Grows the stream by n uninitialized bytes and returns a pointer to
+    // them; the pointer is valid until the stream is next modified.
+    char* Append( std::streamsize n );
+
+    // Returns the contents as one contiguous buffer, valid until the stream
+    // is next modified.
     const char* GetLinearPointer();
 
-    std::streamsize Size() const;
-    std::streamsize Size();
+    // Gathers the contents into dst, which must hold at least Size() bytes.
+    bool CopyTo( char* dst, std::streamsize dstSize ) const;
+
+    std::streamsize Size() const { return m_Size; }
 
 private:
-    std::stringstream m_membuf;
+    typedef std::vector<char> Buffer;
+
+    struct Segment
+    {
+        std::shared_ptr<Buffer> buf;
+        size_t offset;
+        size_t size;
+
+        char* data() const { return buf->data() + offset; }
+    };
+
+    // streams smaller than this are copied rather than chained
+    static const size_t s_MinChainSize = 1024;
+
+    Buffer& GetTail( size_t extra );
+    void MakeUnique( Segment& seg );
+    static void Gather( const std::vector<Segment>& segments, char* dst );
 
-    std::string m_LinearPointer;
+    std::vector<Segment> m_Segments;
+    std::streamsize m_Size;
 };
 
 template< class T >
@@ -0,0 +1,303 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+
+#include "AdaptorOCL/StagedCompile.hpp"
+#include "common/MDFrameWork.h"
+#include "common/LLVMWarningsPush.hpp"
+#include "llvmWrapper/Bitcode/BitcodeWriter.h"
+#include <llvm/ADT/Hashing.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/raw_ostream.h>
+#include "common/LLVMWarningsPop.hpp"
+#include "Probe/Assertion.h"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+using namespace TC;
+
+void StagedCompileOutput::assign(const STB_TranslateOutputArgs& output, bool succeeded)
+{
+    success = succeeded;
+    binary.assign(output.pOutput, output.pOutput + output.OutputSize);
+    debugData.assign(output.pDebugData, output.pDebugData + output.DebugDataSize);
+    errorString.clear();
+    if (output.pErrorString && output.ErrorStringSize > 0)
+    {
+        // ErrorStringSize includes the terminator
+        errorString.assign(output.pErrorString, output.ErrorStringSize - 1);
+    }
+}
+
+void StagedCompileOutput::copyTo(STB_TranslateOutputArgs& output) const
+{
+    auto clone = [](const char* data, size_t size) {
+        char* copy = new char[size];
+        memcpy(copy, data, size);
+        return copy;
+    };
+
+    if (!binary.empty())
+    {
+        output.pOutput = clone(binary.data(), binary.size());
+        output.OutputSize = (uint32_t)binary.size();
+    }
+    if (!debugData.empty())
+    {
+        output.pDebugData = clone(debugData.data(), debugData.size());
+        output.DebugDataSize = (uint32_t)debugData.size();
+    }
+    if (!errorString.empty())
+    {
+        output.pErrorString = clone(errorString.c_str(), errorString.size() + 1);
+        output.ErrorStringSize = (uint32_t)errorString.size() + 1;
+    }
+}
+
+void StagedCompileState::saveIR(IGC::OpenCLProgramContext& ctx)
+{
+    // the metadata lives in the context until it is written back
+    ctx.getMetaDataUtils()->save(*ctx.getLLVMContext());
+    IGC::serialize(*ctx.getModuleMetaData(), ctx.getModule());
+
+    optimizedIR.clear();
+    llvm::raw_string_ostream OS(optimizedIR);
+    IGCLLVM::WriteBitcodeToFile(ctx.getModule(), OS);
+    OS.flush();
+
+    stagingCtx.m_savedBitcodeCharArray = &optimizedIR[0];
+    stagingCtx.m_savedBitcodeCharArraySize = (unsigned int)optimizedIR.size();
+
+    instrTypes = ctx.m_instrTypes;
+    floatDenormMode16 = ctx.m_floatDenormMode16;
+    floatDenormMode32 = ctx.m_floatDenormMode32;
+    floatDenormMode64 = ctx.m_floatDenormMode64;
+    enableFunctionPointer = ctx.m_enableFunctionPointer;
+    enableSubroutine = ctx.m_enableSubroutine;
+}
+
+void StagedCompileState::restoreContext(IGC::OpenCLProgramContext& ctx) const
+{
+    ctx.m_instrTypes = instrTypes;
+    ctx.m_floatDenormMode16 = floatDenormMode16;
+    ctx.m_floatDenormMode32 = floatDenormMode32;
+    ctx.m_floatDenormMode64 = floatDenormMode64;
+    ctx.m_enableFunctionPointer = enableFunctionPointer;
+    ctx.m_enableSubroutine = enableSubroutine;
+}
+
+void StagedCompileState::recordStage1(const IGC::OpenCLProgramContext& ctx, CG_FLAG_t requestedFlag)
+{
+    if (ctx.m_doSimd16Stage2)
+    {
+        SetSimd16(stagingCtx.m_stats);
+    }
+    if (ctx.m_doSimd32Stage2)
+    {
+        SetSimd32(stagingCtx.m_stats);
+    }
+
+    if (ctx.m_CgFlag == FLAG_CG_ALL_SIMDS)
+    {
+        // code generation cancelled staging, stage 1 already is the full compile
+        needsStage2 = false;
+    }
+    else if (requestedFlag == FLAG_CG_STAGE1_FASTEST_COMPILE)
+    {
+        // optimizations were off
+        needsStage2 = true;
+    }
+    else
+    {
+        needsStage2 = DoSimd16(stagingCtx.m_stats) || DoSimd32(stagingCtx.m_stats);
+    }
+}
+
+StagedCompileCache& StagedCompileCache::get()
+{
+    // Never destroyed: destroying a state waits for its background stage 2,
+    // which must not hold up process exit. Results still pending at exit
+    // are abandoned.
+    static StagedCompileCache* cache = new StagedCompileCache();
+    return *cache;
+}
+
+StagedCompileKey::StagedCompileKey(
+    const STB_TranslateInputArgs& inputArgs,
+    TB_DATA_FORMAT inputDataFormat,
+    const IGC::CPlatform& platform) :
+    format(inputDataFormat),
+    productFamily((unsigned)platform.GetProductFamily()),
+    deviceId((unsigned)platform.GetDeviceId()),
+    revId((unsigned)platform.GetRevId()),
+    internalOptions(stripStagingOptions(inputArgs.pInternalOptions, inputArgs.InternalOptionsSize))
+{
+    if (inputArgs.pInput)
+    {
+        input.assign(inputArgs.pInput, inputArgs.InputSize);
+    }
+    if (inputArgs.pOptions)
+    {
+        options.assign(inputArgs.pOptions, inputArgs.OptionsSize);
+    }
+    if (inputArgs.SpecConstantsSize > 0)
+    {
+        specConstantsIds.assign(inputArgs.pSpecConstantsIds,
+            inputArgs.pSpecConstantsIds + inputArgs.SpecConstantsSize);
+        specConstantsValues.assign(inputArgs.pSpecConstantsValues,
+            inputArgs.pSpecConstantsValues + inputArgs.SpecConstantsSize);
+    }
+
+    llvm::hash_code code = llvm::hash_combine(
+        (unsigned)format, productFamily, deviceId, revId,
+        llvm::StringRef(input), llvm::StringRef(options), llvm::StringRef(internalOptions));
+    code = llvm::hash_combine(code,
+        llvm::hash_combine_range(specConstantsIds.begin(), specConstantsIds.end()),
+        llvm::hash_combine_range(specConstantsValues.begin(), specConstantsValues.end()));
+    hash = (size_t)code;
+}
+
+bool StagedCompileKey::operator==(const StagedCompileKey& other) const
+{
+    return hash == other.hash &&
+        format == other.format &&
+        productFamily == other.productFamily &&
+        deviceId == other.deviceId &&
+        revId == other.revId &&
+        input == other.input &&
+        options == other.options &&
+        internalOptions == other.internalOptions &&
+        specConstantsIds == other.specConstantsIds &&
+        specConstantsValues == other.specConstantsValues;
+}
+
+void StagedCompileCache::put(StagedCompileKey key, std::shared_ptr<StagedCompileState> state)
+{
+    std::vector<std::shared_ptr<StagedCompileState>> evicted;
+    {
+        std::lock_guard<std::mutex> lock(m_Lock);
+        auto it = m_States.find(key);
+        if (it != m_States.end())
+        {
+            // a repeated stage 1 replaces the older state
+            evicted.push_back(std::move(it->second));
+            it->second = std::move(state);
+            m_Order.erase(std::find(m_Order.begin(), m_Order.end(), &it->first));
+        }
+        else
+        {
+            it = m_States.emplace(std::move(key), std::move(state)).first;
+        }
+        m_Order.push_back(&it->first);
+
+        while (m_States.size() > s_MaxStates)
+        {
+            auto old = m_States.find(*m_Order.front());
+            IGC_ASSERT(old != m_States.end());
+            m_Order.pop_front();
+            evicted.push_back(std::move(old->second));
+            m_States.erase(old);
+        }
+    }
+    // Released outside the lock: dropping a state waits for its background
+    // stage 2, if any.
+    evicted.clear();
+}
+
+std::shared_ptr<StagedCompileState> StagedCompileCache::take(const StagedCompileKey& key)
+{
+    std::lock_guard<std::mutex> lock(m_Lock);
+    auto it = m_States.find(key);
+    if (it == m_States.end())
+    {
+        return nullptr;
+    }
+    std::shared_ptr<StagedCompileState> state = std::move(it->second);
+    m_Order.erase(std::find(m_Order.begin(), m_Order.end(), &it->first));
+    m_States.erase(it);
+    return state;
+}
+
+StagedCompileInput::StagedCompileInput(const STB_TranslateInputArgs& inputArgs) :
+    m_Args(inputArgs)
+{
+    if (inputArgs.pInput)
+    {
+        m_Input.assign(inputArgs.pInput, inputArgs.pInput + inputArgs.InputSize);
+        m_Args.pInput = m_Input.data();
+    }
+    if (inputArgs.pOptions)
+    {
+        m_Options.assign(inputArgs.pOptions, inputArgs.OptionsSize);
+        m_Args.pOptions = m_Options.c_str();
+    }
+    // stage 2 runs with the stage 1 options minus the staging ones
+    m_InternalOptions =
+        stripStagingOptions(inputArgs.pInternalOptions, inputArgs.InternalOptionsSize);
+    m_Args.pInternalOptions = m_InternalOptions.c_str();
+    m_Args.InternalOptionsSize = (uint32_t)m_InternalOptions.size();
+    if (inputArgs.SpecConstantsSize > 0)
+    {
+        m_SpecConstantsIds.assign(inputArgs.pSpecConstantsIds,
+            inputArgs.pSpecConstantsIds + inputArgs.SpecConstantsSize);
+        m_SpecConstantsValues.assign(inputArgs.pSpecConstantsValues,
+            inputArgs.pSpecConstantsValues + inputArgs.SpecConstantsSize);
+        m_Args.pSpecConstantsIds = m_SpecConstantsIds.data();
+        m_Args.pSpecConstantsValues = m_SpecConstantsValues.data();
+    }
+    // neither is used past the first translation
+    m_Args.pTracingOptions = nullptr;
+    m_Args.TracingOptionsCount = 0;
+    m_Args.GTPinInput = nullptr;
+}
+
+std::string TC::stripStagingOptions(const char* internalOptions, uint32_t size)
+{
+    if (internalOptions == nullptr)
+    {
+        return std::string();
+    }
+
+    // options may or may not be null terminated within size
+    std::istringstream IS(std::string(internalOptions, strnlen(internalOptions, size)));
+    std::string result;
+    std::string option;
+    while (IS >> option)
+    {
+        if (option.find("-intel-stage1-") != std::string::npos ||
+            option.find("-intel-stage2-") != std::string::npos)
+        {
+            continue;
+        }
+        if (!result.empty())
+        {
+            result += ' ';
+        }
+        result += option;
+    }
+    return result;
+}
@@ -0,0 +1,158 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+#pragma once
+
+#include "AdaptorOCL/TranslationBlock.h"
+#include "Compiler/CodeGenPublic.h"
+
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace TC
+{
+    // A translation result that owns its buffers; STB_TranslateOutputArgs
+    // only carries raw allocations handed over to the caller.
+    struct StagedCompileOutput
+    {
+        bool success = false;
+        std::vector<char> binary;
+        std::vector<char> debugData;
+        std::string errorString;
+
+        void assign(const STB_TranslateOutputArgs& output, bool succeeded);
+        // hands out fresh allocations, as TranslateBuild does
+        void copyTo(STB_TranslateOutputArgs& output) const;
+    };
+
+    // What stage 1 of a staged OpenCL compile leaves behind for stage 2.
+    //
+    // Stage 1 saves the module right after OptimizeIR, along with the bits
+    // of context state that the front end computes, so stage 2 restarts at
+    // code generation. When stage 1 found that no kernel would pick a wider
+    // SIMD, stage 2 can't do better and returns the stage 1 binary instead.
+    struct StagedCompileState
+    {
+        // stats recorded by stage 1; BIT_CG_DO_SIMD16/32 mark SIMD modes
+        // that were skipped but would have been compiled
+        CG_CTX_t stagingCtx = {};
+        // bitcode after OptimizeIR; empty if it wasn't saved
+        std::string optimizedIR;
+        IGC::SInstrTypes instrTypes = {};
+        IGC::Float_DenormMode floatDenormMode16 = IGC::FLOAT_DENORM_FLUSH_TO_ZERO;
+        IGC::Float_DenormMode floatDenormMode32 = IGC::FLOAT_DENORM_FLUSH_TO_ZERO;
+        IGC::Float_DenormMode floatDenormMode64 = IGC::FLOAT_DENORM_FLUSH_TO_ZERO;
+        bool enableFunctionPointer = false;
+        bool enableSubroutine = false;
+
+        bool needsStage2 = true;
+        StagedCompileOutput stage1Output;
+        // set when stage 2 was started in the background
+        std::shared_future<StagedCompileOutput> stage2;
+
+        void saveIR(IGC::OpenCLProgramContext& ctx);
+        void restoreContext(IGC::OpenCLProgramContext& ctx) const;
+        void recordStage1(const IGC::OpenCLProgramContext& ctx, CG_FLAG_t requestedFlag);
+    };
+
+    // The translation inputs (minus the staging options) that a stage 2
+    // call must repeat to find the state of its stage 1 call. Keeps the
+    // bytes rather than just a hash, so that two programs whose hashes
+    // collide never share a state.
+    struct StagedCompileKey
+    {
+        StagedCompileKey(
+            const STB_TranslateInputArgs& inputArgs,
+            TB_DATA_FORMAT inputDataFormat,
+            const IGC::CPlatform& platform);
+
+        bool operator==(const StagedCompileKey& other) const;
+
+        struct Hash
+        {
+            size_t operator()(const StagedCompileKey& key) const { return key.hash; }
+        };
+
+        TB_DATA_FORMAT format;
+        unsigned productFamily;
+        unsigned deviceId;
+        unsigned revId;
+        std::string input;
+        std::string options;
+        std::string internalOptions;
+        std::vector<uint32_t> specConstantsIds;
+        std::vector<uint64_t> specConstantsValues;
+        size_t hash;
+    };
+
+    // Process-wide store of stage 1 states, so that the stage 2 call finds
+    // the state of the matching stage 1 call.
+    class StagedCompileCache
+    {
+    public:
+        static StagedCompileCache& get();
+
+        void put(StagedCompileKey key, std::shared_ptr<StagedCompileState> state);
+        std::shared_ptr<StagedCompileState> take(const StagedCompileKey& key);
+
+    private:
+        // stage 2 is optional, so states that are never picked up are
+        // dropped oldest first
+        static const size_t s_MaxStates = 64;
+
+        std::mutex m_Lock;
+        std::unordered_map<StagedCompileKey, std::shared_ptr<StagedCompileState>,
+            StagedCompileKey::Hash> m_States;
+        // keys of m_States, oldest first; map nodes don't move on rehash
+        std::deque<const StagedCompileKey*> m_Order;
+    };
+
+    // Owning copy of translation inputs, for running stage 2 after the
+    // caller's buffers are gone.
+    class StagedCompileInput
+    {
+    public:
+        explicit StagedCompileInput(const STB_TranslateInputArgs& inputArgs);
+
+        const STB_TranslateInputArgs* get() const { return &m_Args; }
+
+    private:
+        STB_TranslateInputArgs m_Args;
+        std::vector<char> m_Input;
+        std::string m_Options;
+        std::string m_InternalOptions;
+        std::vector<uint32_t> m_SpecConstantsIds;
+        std::vector<uint64_t> m_SpecConstantsValues;
+    };
+
+    // Returns internal options with the staging options removed.
+    std::string stripStagingOptions(const char* internalOptions, uint32_t size);
+}
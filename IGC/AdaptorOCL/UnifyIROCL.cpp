@@ -100,6 +100,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Compiler/Optimizer/OpenCLPasses/TransformUnmaskedFunctionsPass.h"
 #include "Compiler/Optimizer/OpenCLPasses/StatelessToStatefull/StatelessToStatefull.hpp"
 #include "Compiler/Optimizer/OpenCLPasses/KernelFunctionCloning.h"
+#include "Compiler/Optimizer/OpenCLPasses/KernelArgSpecialization.h"
 #include "Compiler/Legalizer/TypeLegalizerPass.h"
 #include "Compiler/Optimizer/OpenCLPasses/ClampLoopUnroll/ClampLoopUnroll.hpp"
 #include "Compiler/Optimizer/OpenCLPasses/Image3dToImage2darray/Image3dToImage2darray.hpp"
@@ -310,6 +311,12 @@ static void CommonOCLBasedPasses(
     // Clone kernel function being used as user function.
     mpm.add(createKernelFunctionCloningPass());
 
+    // Add kernel variants for the constant argument hints, if any.
+    if (!pContext->m_InternalOptions.KernelArgHints.empty())
+    {
+        mpm.add(createKernelArgSpecializationPass());
+    }
+
     mpm.add(new CorrectlyRoundedDivSqrt(shouldForceCR, false));
     if(IGC_IS_FLAG_ENABLED(EnableIntelFast))
     {
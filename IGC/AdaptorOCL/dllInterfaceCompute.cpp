@@ -35,6 +35,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <string>
 #include <stdexcept>
 #include <fstream>
+#include <mutex>
 
 #include "AdaptorCommon/customApi.hpp"
 #include "AdaptorOCL/OCL/LoadBuffer.h"
@@ -42,11 +43,13 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "AdaptorOCL/OCL/TB/igc_tb.h"
 
 #include "AdaptorOCL/UnifyIROCL.hpp"
+#include "AdaptorOCL/StagedCompile.hpp"
 #include "AdaptorOCL/DriverInfoOCL.hpp"
 
 #include "Compiler/MetaDataApi/IGCMetaDataHelper.h"
 #include "common/debug/Dump.hpp"
 #include "common/debug/Debug.hpp"
+#include "common/debug/DumpSink.hpp"
 #include "common/igc_regkeys.hpp"
 #include "common/secure_mem.h"
 #include "common/shaderOverride.hpp"
@@ -340,6 +343,8 @@ void GenerateCompilerOptionsMD(llvm::LLVMContext &C, llvm::Module &M, llvm::Stri
 // Create directory if it doesn't exist.
 // Works for all OSes.
 // ext - file name suffix (optional) and extension.
+// fileName receives the path written, or stays empty when nothing was
+// written (empty buffer, or the dump was dropped by DumpRateLimitMB).
 void DumpShaderFile(
     const std::string& dstDir,
     const char* pBuffer,
@@ -360,17 +365,12 @@ void DumpShaderFile(
             << std::setfill(' ')
             << ext;
 
-        FILE* pFile = NULL;
-        fopen_s(&pFile, fullPath.str().c_str(), "wb");
-        if (pFile)
-        {
-            fwrite(pBuffer, 1, bufferSize, pFile);
-            fclose(pFile);
-        }
+        std::string path = IGC::Debug::DumpSink::get().write(
+            fullPath.str(), std::string(pBuffer, bufferSize), true);
 
         if (fileName != nullptr)
         {
-            *fileName = fullPath.str();
+            *fileName = path;
         }
     }
 }
@@ -846,46 +846,190 @@ static std::unique_ptr<llvm::MemoryBuffer> GetGenericModuleBuffer() {
     return std::unique_ptr<llvm::MemoryBuffer>{llvm::LoadBufferFromResource(Resource, "BC")};
 }
 
-bool TranslateBuild(
-    const STB_TranslateInputArgs* pInputArgs,
-    STB_TranslateOutputArgs* pOutputArgs,
-    TB_DATA_FORMAT inputDataFormatTemp,
-    const IGC::CPlatform& IGCPlatform,
-    float profilingTimerResolution)
+// Links in the builtins, unifies the IR and runs the IR optimizations;
+// all of this happens once per program, before per-kernel code generation.
+static bool UnifyAndOptimizeIR(
+    OpenCLProgramContext& oclContext,
+    unsigned PtrSzInBits,
+    STB_TranslateOutputArgs* pOutputArgs)
 {
-#if !defined(WDDM_LINUX) && (!defined(IGC_VC_DISABLED) || !IGC_VC_DISABLED)
-    if (pInputArgs->pOptions) {
-        std::error_code Status =
-            vc::translateBuild(pInputArgs, pOutputArgs, inputDataFormatTemp,
-                               IGCPlatform, profilingTimerResolution);
-        if (!Status)
-            return true;
-        // If vc codegen option was not specified, then vc was not called.
-        if (static_cast<vc::errc>(Status.value()) != vc::errc::not_vc_codegen)
-            return false;
+    std::unique_ptr<llvm::Module> BuiltinGenericModule = nullptr;
+    std::unique_ptr<llvm::Module> BuiltinSizeModule = nullptr;
+    std::unique_ptr<llvm::MemoryBuffer> pGenericBuffer = nullptr;
+    std::unique_ptr<llvm::MemoryBuffer> pSizeTBuffer = nullptr;
+    {
+        // IGC has two BIF Modules:
+        //            1. kernel Module (pKernelModule)
+        //            2. BIF Modules:
+        //                 a) generic Module (BuiltinGenericModule)
+        //                 b) size Module (BuiltinSizeModule)
+        //
+        // OCL builtin types, such as clk_event_t/queue_t, etc., are struct (opaque) types. For
+        // those types, its original names are themselves; the derived names are ones with
+        // '.<digit>' appended to the original names. For example,  clk_event_t is the original
+        // name, its derived names are clk_event_t.0, clk_event_t.1, etc.
+        //
+        // When llvm reads in multiple modules, say, M0, M1, under the same llvmcontext, if both
+        // M0 and M1 has the same struct type,  M0 will have the original name and M1 the derived
+        // name for that type.  For example, clk_event_t,  M0 will have clk_event_t, while M1 will
+        // have clk_event_t.2 (number is arbitary). After linking, those two named types should be
+        // mapped to the same type, otherwise, we could have type-mismatch (for example, OCL GAS
+        // builtin_functions tests will assertion fail during inlining due to type-mismatch).  Furthermore,
+        // when linking M1 into M0 (M0 : dstModule, M1 : srcModule), the final type is the type
+        // used in M0.
+
+        // Load the builtin module -  Generic BC
+        // Load the builtin module -  Generic BC
+        {
+            COMPILER_TIME_START(&oclContext, TIME_OCL_LazyBiFLoading);
+
+            pGenericBuffer = GetGenericModuleBuffer();
+
+            if (pGenericBuffer == NULL)
+            {
+                SetErrorMessage("Error loading the Generic builtin resource", *pOutputArgs);
+                return false;
+            }
+
+            llvm::Expected<std::unique_ptr<llvm::Module>> ModuleOrErr =
+                getLazyBitcodeModule(pGenericBuffer->getMemBufferRef(), *oclContext.getLLVMContext());
+
+            if (llvm::Error EC = ModuleOrErr.takeError())
+            {
+                std::string error_str = "Error lazily loading bitcode for generic builtins,"
+                                        "is bitcode the right version and correctly formed?";
+                SetErrorMessage(error_str, *pOutputArgs);
+                return false;
+            }
+            else
+            {
+                BuiltinGenericModule = std::move(*ModuleOrErr);
+            }
+
+            if (BuiltinGenericModule == NULL)
+            {
+                SetErrorMessage("Error loading the Generic builtin module from buffer", *pOutputArgs);
+                return false;
+            }
+            COMPILER_TIME_END(&oclContext, TIME_OCL_LazyBiFLoading);
+        }
+
+        // Load the builtin module -  pointer depended
+        {
+            char ResNumber[5] = { '-' };
+            switch (PtrSzInBits)
+            {
+            case 32:
+                _snprintf(ResNumber, sizeof(ResNumber), "#%d", OCL_BC_32);
+                break;
+            case 64:
+                _snprintf(ResNumber, sizeof(ResNumber), "#%d", OCL_BC_64);
+                break;
+            default:
+                IGC_ASSERT_MESSAGE(0, "Unknown bitness of compiled module");
+            }
+
+            // the MemoryBuffer becomes owned by the module and does not need to be managed
+            pSizeTBuffer.reset(llvm::LoadBufferFromResource(ResNumber, "BC"));
+            IGC_ASSERT_MESSAGE(pSizeTBuffer, "Error loading builtin resource");
+
+            llvm::Expected<std::unique_ptr<llvm::Module>> ModuleOrErr =
+                getLazyBitcodeModule(pSizeTBuffer->getMemBufferRef(), *oclContext.getLLVMContext());
+            if (llvm::Error EC = ModuleOrErr.takeError())
+                IGC_ASSERT_MESSAGE(0, "Error lazily loading bitcode for size_t builtins");
+            else
+                BuiltinSizeModule = std::move(*ModuleOrErr);
+
+            IGC_ASSERT_MESSAGE(BuiltinSizeModule, "Error loading builtin module from buffer");
+        }
+
+        BuiltinGenericModule->setDataLayout(BuiltinSizeModule->getDataLayout());
+        BuiltinGenericModule->setTargetTriple(BuiltinSizeModule->getTargetTriple());
     }
-#endif // !defined(WDDM_LINUX) && (!defined(IGC_VC_DISABLED) || !IGC_VC_DISABLED)
 
-    // Disable code sinking in instruction combining.
-    // This is a workaround for a performance issue caused by code sinking
-    // that is being done in LLVM's instcombine pass.
-    // This code will be removed once sinking is removed from instcombine.
-    auto optionsMap = llvm::cl::getRegisteredOptions();
-    llvm::StringRef instCombineFlag = "-instcombine-code-sinking=0";
-    auto instCombineSinkingSwitch = optionsMap.find(instCombineFlag.trim("-=0"));
-    if (instCombineSinkingSwitch != optionsMap.end()) {
-      if ((*instCombineSinkingSwitch).getValue()->getNumOccurrences() == 0) {
-        const char* args[] = { "igc", instCombineFlag.data() };
-        llvm::cl::ParseCommandLineOptions(sizeof(args) / sizeof(args[0]), args);
-      }
+    oclContext.getModuleMetaData()->csInfo.forcedSIMDSize |= IGC_GET_FLAG_VALUE(ForceOCLSIMDWidth);
+
+    if (llvm::StringRef(oclContext.getModule()->getTargetTriple()).startswith("spir"))
+    {
+        IGC::UnifyIRSPIR(&oclContext, std::move(BuiltinGenericModule), std::move(BuiltinSizeModule));
+    }
+    else // not SPIR
+    {
+        IGC::UnifyIROCL(&oclContext, std::move(BuiltinGenericModule), std::move(BuiltinSizeModule));
+    }
+
+    if (!(oclContext.oclErrorMessage.empty()))
+    {
+         //The error buffer returned will be deleted when the module is unloaded so
+         //a copy is necessary
+        if (const char *pErrorMsg = oclContext.oclErrorMessage.c_str())
+        {
+            SetErrorMessage(oclContext.oclErrorMessage, *pOutputArgs);
+        }
+        return false;
     }
 
-    if (IGC_IS_FLAG_ENABLED(QualityMetricsEnable))
+    // Compiler Options information available after unification.
+    ModuleMetaData *modMD = oclContext.getModuleMetaData();
+    if (modMD->compOpt.DenormsAreZero)
     {
-        IGC::Debug::SetDebugFlag(IGC::Debug::DebugFlag::SHADER_QUALITY_METRICS, true);
+        oclContext.m_floatDenormMode16 = FLOAT_DENORM_FLUSH_TO_ZERO;
+        oclContext.m_floatDenormMode32 = FLOAT_DENORM_FLUSH_TO_ZERO;
     }
 
-    MEM_USAGERESET;
+    // Optimize the IR. This happens once for each program, not per-kernel.
+    IGC::OptimizeIR(&oclContext);
+
+    return true;
+}
+
+// Guards the process-wide state a translation sets up front (LLVM
+// command-line options, debug flags, the memory report), which a background
+// stage 2 may be setting at the same time. Never destroyed, as a background
+// stage 2 may still be running at exit.
+static std::mutex& GetProcessStateLock()
+{
+    static std::mutex* lock = new std::mutex();
+    return *lock;
+}
+
+// Compiles a program. cgFlag selects stage 1 of a staged compile; pStage1,
+// if given, is what stage 1 left behind and makes this a stage 2 compile;
+// pSaveStage1, if given, receives what a later stage 2 needs.
+static bool TranslateBuildImpl(
+    const STB_TranslateInputArgs* pInputArgs,
+    STB_TranslateOutputArgs* pOutputArgs,
+    TB_DATA_FORMAT inputDataFormatTemp,
+    const IGC::CPlatform& IGCPlatform,
+    float profilingTimerResolution,
+    CG_FLAG_t cgFlag,
+    StagedCompileState* pStage1,
+    StagedCompileState* pSaveStage1)
+{
+    {
+        std::lock_guard<std::mutex> processStateLock(GetProcessStateLock());
+
+        // Disable code sinking in instruction combining.
+        // This is a workaround for a performance issue caused by code sinking
+        // that is being done in LLVM's instcombine pass.
+        // This code will be removed once sinking is removed from instcombine.
+        auto optionsMap = llvm::cl::getRegisteredOptions();
+        llvm::StringRef instCombineFlag = "-instcombine-code-sinking=0";
+        auto instCombineSinkingSwitch = optionsMap.find(instCombineFlag.trim("-=0"));
+        if (instCombineSinkingSwitch != optionsMap.end()) {
+          if ((*instCombineSinkingSwitch).getValue()->getNumOccurrences() == 0) {
+            const char* args[] = { "igc", instCombineFlag.data() };
+            llvm::cl::ParseCommandLineOptions(sizeof(args) / sizeof(args[0]), args);
+          }
+        }
+
+        if (IGC_IS_FLAG_ENABLED(QualityMetricsEnable))
+        {
+            IGC::Debug::SetDebugFlag(IGC::Debug::DebugFlag::SHADER_QUALITY_METRICS, true);
+        }
+
+        MEM_USAGERESET;
+    }
 
     // Parse the module we want to compile
     llvm::Module* pKernelModule = nullptr;
@@ -960,10 +1104,36 @@ bool TranslateBuild(
             outputstr << "\n\nOr using the following with IGC keys set via -option\n\n";
             outputstr << cmdline.str() << " -option " << optionstr << "\n";
         }
-        DumpShaderFile(pOutputFolder, outputstr.str().c_str(), outputstr.str().size(), hash, "_cmd.txt");
+        // Skip the command file if any of the files it names was dropped.
+        bool allDumped = !inputf.empty() &&
+            (pInputArgs->InternalOptionsSize == 0 || !iof.empty()) &&
+            (pInputArgs->OptionsSize == 0 || !of.empty());
+        if (allDumped)
+        {
+            DumpShaderFile(pOutputFolder, outputstr.str().c_str(), outputstr.str().size(), hash, "_cmd.txt");
+        }
+    }
+
+    // Stage 2 restarts from the module stage 1 saved after OptimizeIR and
+    // skips the front end; it falls back to a full compile if that fails.
+    bool restartFromIR = false;
+    if (pStage1 && !pStage1->optimizedIR.empty())
+    {
+        llvm::Expected<std::unique_ptr<llvm::Module>> MOE = llvm::parseBitcodeFile(
+            llvm::MemoryBufferRef(pStage1->optimizedIR, "<stage1>"), *llvmContext);
+        if (MOE)
+        {
+            pKernelModule = MOE->release();
+            restartFromIR = true;
+        }
+        else
+        {
+            llvm::consumeError(MOE.takeError());
+        }
     }
 
-    if (!ParseInput(pKernelModule, pInputArgs, pOutputArgs, *llvmContext, inputDataFormatTemp))
+    if (!restartFromIR &&
+        !ParseInput(pKernelModule, pInputArgs, pOutputArgs, *llvmContext, inputDataFormatTemp))
     {
         return false;
     }
@@ -999,11 +1169,17 @@ bool TranslateBuild(
     }
 
     oclContext.setModule(pKernelModule);
-    if (oclContext.isSPIRV())
+    if (oclContext.isSPIRV() || restartFromIR)
     {
         deserialize(*oclContext.getModuleMetaData(), pKernelModule);
     }
 
+    oclContext.m_CgFlag = cgFlag;
+    if (pStage1)
+    {
+        oclContext.m_StagingCtx = &pStage1->stagingCtx;
+    }
+
     oclContext.hash = inputShHash;
     oclContext.annotater = nullptr;
 
@@ -1016,6 +1192,11 @@ bool TranslateBuild(
         oclContext.m_floatDenormMode64 = FLOAT_DENORM_RETAIN;
     }
 
+    if (restartFromIR)
+    {
+        pStage1->restoreContext(oclContext);
+    }
+
     unsigned PtrSzInBits = pKernelModule->getDataLayout().getPointerSizeInBits();
     //TODO: Again, this should not happen on each compilation
 
@@ -1024,133 +1205,20 @@ bool TranslateBuild(
     oclContext.m_retryManager.Enable();
     do
     {
-        std::unique_ptr<llvm::Module> BuiltinGenericModule = nullptr;
-        std::unique_ptr<llvm::Module> BuiltinSizeModule = nullptr;
-        std::unique_ptr<llvm::MemoryBuffer> pGenericBuffer = nullptr;
-        std::unique_ptr<llvm::MemoryBuffer> pSizeTBuffer = nullptr;
+        if (!restartFromIR)
         {
-            // IGC has two BIF Modules:
-            //            1. kernel Module (pKernelModule)
-            //            2. BIF Modules:
-            //                 a) generic Module (BuiltinGenericModule)
-            //                 b) size Module (BuiltinSizeModule)
-            //
-            // OCL builtin types, such as clk_event_t/queue_t, etc., are struct (opaque) types. For
-            // those types, its original names are themselves; the derived names are ones with
-            // '.<digit>' appended to the original names. For example,  clk_event_t is the original
-            // name, its derived names are clk_event_t.0, clk_event_t.1, etc.
-            //
-            // When llvm reads in multiple modules, say, M0, M1, under the same llvmcontext, if both
-            // M0 and M1 has the same struct type,  M0 will have the original name and M1 the derived
-            // name for that type.  For example, clk_event_t,  M0 will have clk_event_t, while M1 will
-            // have clk_event_t.2 (number is arbitary). After linking, those two named types should be
-            // mapped to the same type, otherwise, we could have type-mismatch (for example, OCL GAS
-            // builtin_functions tests will assertion fail during inlining due to type-mismatch).  Furthermore,
-            // when linking M1 into M0 (M0 : dstModule, M1 : srcModule), the final type is the type
-            // used in M0.
-
-            // Load the builtin module -  Generic BC
-            // Load the builtin module -  Generic BC
-            {
-                COMPILER_TIME_START(&oclContext, TIME_OCL_LazyBiFLoading);
-
-                pGenericBuffer = GetGenericModuleBuffer();
-
-                if (pGenericBuffer == NULL)
-                {
-                    SetErrorMessage("Error loading the Generic builtin resource", *pOutputArgs);
-                    return false;
-                }
-
-                llvm::Expected<std::unique_ptr<llvm::Module>> ModuleOrErr =
-                    getLazyBitcodeModule(pGenericBuffer->getMemBufferRef(), *oclContext.getLLVMContext());
-
-                if (llvm::Error EC = ModuleOrErr.takeError())
-                {
-                    std::string error_str = "Error lazily loading bitcode for generic builtins,"
-                                            "is bitcode the right version and correctly formed?";
-                    SetErrorMessage(error_str, *pOutputArgs);
-                    return false;
-                }
-                else
-                {
-                    BuiltinGenericModule = std::move(*ModuleOrErr);
-                }
-
-                if (BuiltinGenericModule == NULL)
-                {
-                    SetErrorMessage("Error loading the Generic builtin module from buffer", *pOutputArgs);
-                    return false;
-                }
-                COMPILER_TIME_END(&oclContext, TIME_OCL_LazyBiFLoading);
-            }
-
-            // Load the builtin module -  pointer depended
+            if (!UnifyAndOptimizeIR(oclContext, PtrSzInBits, pOutputArgs))
             {
-                char ResNumber[5] = { '-' };
-                switch (PtrSzInBits)
-                {
-                case 32:
-                    _snprintf(ResNumber, sizeof(ResNumber), "#%d", OCL_BC_32);
-                    break;
-                case 64:
-                    _snprintf(ResNumber, sizeof(ResNumber), "#%d", OCL_BC_64);
-                    break;
-                default:
-                    IGC_ASSERT_MESSAGE(0, "Unknown bitness of compiled module");
-                }
-
-                // the MemoryBuffer becomes owned by the module and does not need to be managed
-                pSizeTBuffer.reset(llvm::LoadBufferFromResource(ResNumber, "BC"));
-                IGC_ASSERT_MESSAGE(pSizeTBuffer, "Error loading builtin resource");
-
-                llvm::Expected<std::unique_ptr<llvm::Module>> ModuleOrErr =
-                    getLazyBitcodeModule(pSizeTBuffer->getMemBufferRef(), *oclContext.getLLVMContext());
-                if (llvm::Error EC = ModuleOrErr.takeError())
-                    IGC_ASSERT_MESSAGE(0, "Error lazily loading bitcode for size_t builtins");
-                else
-                    BuiltinSizeModule = std::move(*ModuleOrErr);
-
-                IGC_ASSERT_MESSAGE(BuiltinSizeModule, "Error loading builtin module from buffer");
+                return false;
             }
 
-            BuiltinGenericModule->setDataLayout(BuiltinSizeModule->getDataLayout());
-            BuiltinGenericModule->setTargetTriple(BuiltinSizeModule->getTargetTriple());
-        }
-
-        oclContext.getModuleMetaData()->csInfo.forcedSIMDSize |= IGC_GET_FLAG_VALUE(ForceOCLSIMDWidth);
-
-        if (llvm::StringRef(oclContext.getModule()->getTargetTriple()).startswith("spir"))
-        {
-            IGC::UnifyIRSPIR(&oclContext, std::move(BuiltinGenericModule), std::move(BuiltinSizeModule));
-        }
-        else // not SPIR
-        {
-            IGC::UnifyIROCL(&oclContext, std::move(BuiltinGenericModule), std::move(BuiltinSizeModule));
-        }
-
-        if (!(oclContext.oclErrorMessage.empty()))
-        {
-             //The error buffer returned will be deleted when the module is unloaded so
-             //a copy is necessary
-            if (const char *pErrorMsg = oclContext.oclErrorMessage.c_str())
+            if (pSaveStage1 && IGC_IS_FLAG_ENABLED(SaveRestoreIR) &&
+                oclContext.m_retryManager.IsFirstTry())
             {
-                SetErrorMessage(oclContext.oclErrorMessage, *pOutputArgs);
+                pSaveStage1->saveIR(oclContext);
             }
-            return false;
-        }
-
-        // Compiler Options information available after unification.
-        ModuleMetaData *modMD = oclContext.getModuleMetaData();
-        if (modMD->compOpt.DenormsAreZero)
-        {
-            oclContext.m_floatDenormMode16 = FLOAT_DENORM_FLUSH_TO_ZERO;
-            oclContext.m_floatDenormMode32 = FLOAT_DENORM_FLUSH_TO_ZERO;
         }
 
-        // Optimize the IR. This happens once for each program, not per-kernel.
-        IGC::OptimizeIR(&oclContext);
-
         // Now, perform code generation
         IGC::CodeGen(&oclContext);
 
@@ -1166,6 +1234,9 @@ bool TranslateBuild(
 
             IGC::Debug::RegisterComputeErrHandlers(*oclContext.getLLVMContext());
 
+            // the retry changes the IR optimizations too, so it always
+            // starts from the input
+            restartFromIR = false;
             if (!ParseInput(pKernelModule, pInputArgs, pOutputArgs, *oclContext.getLLVMContext(), inputDataFormatTemp))
             {
                 return false;
@@ -1185,6 +1256,11 @@ bool TranslateBuild(
         return false;
     }
 
+    if (pSaveStage1)
+    {
+        pSaveStage1->recordStage1(oclContext, cgFlag);
+    }
+
     // Prepare and set program binary
     unsigned int pointerSizeInBytes = (PtrSzInBits == 64) ? 8 : 4;
 
@@ -1201,7 +1277,7 @@ bool TranslateBuild(
         oclContext.m_programOutput.GetProgramBinary(programBinary, pointerSizeInBytes);
         binarySize = static_cast<int>(programBinary.Size());
         binaryOutput = new char[binarySize];
-        memcpy_s(binaryOutput, binarySize, (char*)programBinary.GetLinearPointer(), binarySize);
+        programBinary.CopyTo(binaryOutput, binarySize);
     } else {
         // ze binary foramt
         llvm::SmallVector<char, 64> buf;
@@ -1238,7 +1314,7 @@ bool TranslateBuild(
     if (debugDataSize > 0)
     {
         char* debugDataOutput = new char[debugDataSize];
-        memcpy_s(debugDataOutput, debugDataSize, (char*)programDebugData.GetLinearPointer(), debugDataSize);
+        programDebugData.CopyTo(debugDataOutput, debugDataSize);
 
         pOutputArgs->DebugDataSize = debugDataSize;
         pOutputArgs->pDebugData = debugDataOutput;
@@ -1277,6 +1353,113 @@ bool TranslateBuild(
     return true;
 }
 
+static StagedCompileOutput TranslateBuildStage2(
+    const StagedCompileInput& input,
+    TB_DATA_FORMAT inputDataFormatTemp,
+    const IGC::CPlatform& IGCPlatform,
+    float profilingTimerResolution,
+    StagedCompileState* pStage1)
+{
+    STB_TranslateOutputArgs output;
+    bool success = TranslateBuildImpl(input.get(), &output, inputDataFormatTemp,
+        IGCPlatform, profilingTimerResolution, FLAG_CG_ALL_SIMDS, pStage1, nullptr);
+
+    StagedCompileOutput result;
+    result.assign(output, success);
+    delete[] output.pOutput;
+    delete[] output.pErrorString;
+    delete[] output.pDebugData;
+    return result;
+}
+
+// Staged compilation, selected through internal options:
+//  -intel-stage1-fast-compile     stage 1, SIMD8 only
+//  -intel-stage1-fastest-compile  stage 1, SIMD8 with the vISA optimizations off
+//  -intel-stage1-best-perf        stage 1, SIMD16 or SIMD8
+//  -intel-stage2-compile          stage 2, the fully optimized program
+//  -intel-stage2-background       with a stage 1 option, starts stage 2 on a
+//                                 background thread right away
+// The stage 2 call must pass the same input and otherwise the same options
+// as the stage 1 call; it then picks up the background result or restarts
+// code generation from the IR stage 1 saved. Without a matching stage 1 it
+// is a regular compile.
+bool TranslateBuild(
+    const STB_TranslateInputArgs* pInputArgs,
+    STB_TranslateOutputArgs* pOutputArgs,
+    TB_DATA_FORMAT inputDataFormatTemp,
+    const IGC::CPlatform& IGCPlatform,
+    float profilingTimerResolution)
+{
+#if !defined(WDDM_LINUX) && (!defined(IGC_VC_DISABLED) || !IGC_VC_DISABLED)
+    if (pInputArgs->pOptions) {
+        std::error_code Status =
+            vc::translateBuild(pInputArgs, pOutputArgs, inputDataFormatTemp,
+                               IGCPlatform, profilingTimerResolution);
+        if (!Status)
+            return true;
+        // If vc codegen option was not specified, then vc was not called.
+        if (static_cast<vc::errc>(Status.value()) != vc::errc::not_vc_codegen)
+            return false;
+    }
+#endif // !defined(WDDM_LINUX) && (!defined(IGC_VC_DISABLED) || !IGC_VC_DISABLED)
+
+    OpenCLProgramContext::InternalOptions internalOptions(pInputArgs);
+    if (internalOptions.StagedCompileFlag == FLAG_CG_ALL_SIMDS &&
+        !internalOptions.StagedCompileStage2)
+    {
+        return TranslateBuildImpl(pInputArgs, pOutputArgs, inputDataFormatTemp,
+            IGCPlatform, profilingTimerResolution, FLAG_CG_ALL_SIMDS, nullptr, nullptr);
+    }
+
+    StagedCompileCache& cache = StagedCompileCache::get();
+    StagedCompileKey key(*pInputArgs, inputDataFormatTemp, IGCPlatform);
+
+    if (internalOptions.StagedCompileStage2)
+    {
+        std::shared_ptr<StagedCompileState> stage1 = cache.take(key);
+        if (stage1 && stage1->stage2.valid())
+        {
+            const StagedCompileOutput& output = stage1->stage2.get();
+            output.copyTo(*pOutputArgs);
+            return output.success;
+        }
+        if (stage1 && !stage1->needsStage2)
+        {
+            stage1->stage1Output.copyTo(*pOutputArgs);
+            return true;
+        }
+        return TranslateBuildImpl(pInputArgs, pOutputArgs, inputDataFormatTemp,
+            IGCPlatform, profilingTimerResolution, FLAG_CG_ALL_SIMDS, stage1.get(), nullptr);
+    }
+
+    auto stage1 = std::make_shared<StagedCompileState>();
+    if (!TranslateBuildImpl(pInputArgs, pOutputArgs, inputDataFormatTemp, IGCPlatform,
+            profilingTimerResolution, internalOptions.StagedCompileFlag, nullptr, stage1.get()))
+    {
+        return false;
+    }
+
+    if (!stage1->needsStage2)
+    {
+        stage1->stage1Output.assign(*pOutputArgs, true);
+    }
+    else if (internalOptions.StagedCompileBackground && pInputArgs->GTPinInput == nullptr)
+    {
+        // The state owns the task's future and dropping it waits for the
+        // task, so the task can refer to the state by a plain pointer.
+        auto input = std::make_shared<StagedCompileInput>(*pInputArgs);
+        StagedCompileState* pStage1 = stage1.get();
+        IGC::CPlatform platform = IGCPlatform;
+        stage1->stage2 = std::async(std::launch::async, [=]() {
+            return TranslateBuildStage2(*input, inputDataFormatTemp, platform,
+                profilingTimerResolution, pStage1);
+        }).share();
+    }
+
+    cache.put(std::move(key), std::move(stage1));
+    return true;
+}
+
 bool CIGCTranslationBlock::FreeAllocations(
     STB_TranslateOutputArgs* pOutputArgs)
 {
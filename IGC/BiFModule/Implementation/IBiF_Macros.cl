@@ -49,6 +49,45 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
         }                                                                   \
     }
 
+// Contiguous async copy through sub-group block messages. Taken at runtime
+// when both pointers are OWord aligned and every sub-group is full (block
+// messages need all lanes); each sub-group moves 4 dwords per work item per
+// message and the bytes past the last whole block are copied one per work
+// item. Anything else goes through ASYNC_WORK_GROUP_COPY.
+// dst_as/src_as name the address spaces (global or local).
+#define ASYNC_WORK_GROUP_COPY_BLOCK(dst, src, num_elements, evt, __num_elements_type, dst_as, src_as) \
+    {                                                                       \
+        uint sgSize = __builtin_spirv_BuiltInSubgroupMaxSize();             \
+        uint wgSize = __spirv_WorkgroupSize();                              \
+        if (((((size_t)(dst)) | ((size_t)(src))) & 15) == 0 &&              \
+            (wgSize % sgSize) == 0)                                         \
+        {                                                                   \
+            __num_elements_type uiNumBytes = (num_elements) * sizeof(*(dst)); \
+            __num_elements_type blockDwords = sgSize * 4;                   \
+            __num_elements_type numBlocks = (uiNumBytes / 4) / blockDwords; \
+            __num_elements_type block = __builtin_spirv_BuiltInSubgroupId(); \
+            __num_elements_type blockStep = wgSize / sgSize;                \
+            __##dst_as uint* dstDw = (__##dst_as uint*)(dst);               \
+            const __##src_as uint* srcDw = (const __##src_as uint*)(src);   \
+            for( ; block < numBlocks; block += blockStep ) {                \
+                __num_elements_type offset = block * blockDwords;           \
+                uint4 data = __builtin_IB_simd_block_read_4_##src_as(srcDw + offset); \
+                __builtin_IB_simd_block_write_4_##dst_as(dstDw + offset, data);      \
+            }                                                               \
+            __##dst_as uchar* dstB = (__##dst_as uchar*)(dst);              \
+            const __##src_as uchar* srcB = (const __##src_as uchar*)(src);  \
+            __num_elements_type index = numBlocks * blockDwords * 4 +       \
+                __spirv_BuiltInLocalInvocationIndex();                      \
+            for( ; index < uiNumBytes; index += wgSize ) {                  \
+                dstB[index] = srcB[index];                                  \
+            }                                                               \
+        }                                                                   \
+        else                                                                \
+        {                                                                   \
+            ASYNC_WORK_GROUP_COPY(dst, src, num_elements, evt, __num_elements_type) \
+        }                                                                   \
+    }
+
 #define ASYNC_WORK_GROUP_STRIDED_COPY_G2L(dst, src, num_elements, src_stride, evt, __num_elements_type)  \
     {                                                                       \
         __num_elements_type uiNumElements = num_elements;                                  \
@@ -57,7 +57,7 @@ double OVERLOADABLE intel_sub_group_shuffle_up( double identity, double X, uint
 {                                                                                                    \
     if ( Stride == 0 )                                                                                \
     {                                                                                                \
-        ASYNC_WORK_GROUP_COPY(Destination, Source, NumElements, Event, type)                        \
+        ASYNC_WORK_GROUP_COPY_BLOCK(Destination, Source, NumElements, Event, type, global, local)    \
         return Event;                                                                                \
     }                                                                                                \
     else                                                                                            \
@@ -71,7 +71,7 @@ double OVERLOADABLE intel_sub_group_shuffle_up( double identity, double X, uint
 {                                                                                                    \
     if ( Stride == 0 )                                                                                \
     {                                                                                                \
-        ASYNC_WORK_GROUP_COPY(Destination, Source, NumElements, Event, type)                        \
+        ASYNC_WORK_GROUP_COPY_BLOCK(Destination, Source, NumElements, Event, type, local, global)    \
         return Event;                                                                                \
     }                                                                                                \
     else                                                                                            \
@@ -1869,6 +1869,69 @@ DEFN_ARITH_OPERATIONS(half)
     return X;                                                                            \
 }
 
+// Hierarchical work group reduce/scan: each sub-group reduces (or scans) in
+// registers, one partial per sub-group is exchanged through SLM behind a
+// single barrier, and every work item then folds in the partials it needs.
+// Only valid where the native sub-group builtins are (partial sub-groups are
+// handled by the hardware execution mask rather than by shuffles).
+// When the work group size is known at compile time the single sub-group
+// check and the trip count of the partials loop fold away.
+
+// 1024 work items at SIMD8
+#define WORK_GROUP_MAX_NUM_SUBGROUPS 128
+
+#define DEFN_WORK_GROUP_REDUCE_HIER(func, type, type_abbr, op, identity, X)                    \
+{                                                                                           \
+    uint lsize = __spirv_WorkgroupSize();                                                    \
+    type sgX = __builtin_IB_sub_group_reduce_##func##_##type_abbr(X);                        \
+    if (lsize <= __builtin_spirv_BuiltInSubgroupMaxSize())                                   \
+    {                                                                                       \
+        return sgX;                                                                         \
+    }                                                                                       \
+    GET_MEMPOOL_PTR(data, type, false, WORK_GROUP_MAX_NUM_SUBGROUPS)                         \
+    uint sgid = __builtin_spirv_BuiltInSubgroupId();                                         \
+    uint numsg = __builtin_spirv_BuiltInNumSubgroups();                                      \
+    if (__builtin_spirv_BuiltInSubgroupLocalInvocationId() == 0)                             \
+    {                                                                                       \
+        data[sgid] = sgX;                                                                   \
+    }                                                                                       \
+    __builtin_spirv_OpControlBarrier_i32_i32_i32(Workgroup, 0, AcquireRelease | WorkgroupMemory);  \
+    type ret = identity;                                                                    \
+    for (uint i = 0; i < numsg; ++i)                                                        \
+    {                                                                                       \
+        ret = op(ret, data[i]);                                                             \
+    }                                                                                       \
+    __builtin_spirv_OpControlBarrier_i32_i32_i32(Workgroup, 0, AcquireRelease | WorkgroupMemory);  \
+    return ret;                                                                             \
+}
+
+#define DEFN_WORK_GROUP_SCAN_HIER(func, type, type_abbr, op, identity, X, inclusive)           \
+{                                                                                           \
+    uint lsize = __spirv_WorkgroupSize();                                                    \
+    type sgExcl = __builtin_IB_sub_group_scan_##func##_##type_abbr(X);                       \
+    type sgIncl = op(X, sgExcl);                                                            \
+    type sgX = (inclusive) ? sgIncl : sgExcl;                                               \
+    if (lsize <= __builtin_spirv_BuiltInSubgroupMaxSize())                                   \
+    {                                                                                       \
+        return sgX;                                                                         \
+    }                                                                                       \
+    GET_MEMPOOL_PTR(data, type, false, WORK_GROUP_MAX_NUM_SUBGROUPS)                         \
+    uint sgid = __builtin_spirv_BuiltInSubgroupId();                                         \
+    uint sglid = __builtin_spirv_BuiltInSubgroupLocalInvocationId();                         \
+    if (sglid == __builtin_spirv_BuiltInSubgroupSize() - 1)                                  \
+    {                                                                                       \
+        data[sgid] = sgIncl;                                                                \
+    }                                                                                       \
+    __builtin_spirv_OpControlBarrier_i32_i32_i32(Workgroup, 0, AcquireRelease | WorkgroupMemory);  \
+    type prefix = identity;                                                                 \
+    for (uint i = 0; i < sgid; ++i)                                                         \
+    {                                                                                       \
+        prefix = op(prefix, data[i]);                                                       \
+    }                                                                                       \
+    __builtin_spirv_OpControlBarrier_i32_i32_i32(Workgroup, 0, AcquireRelease | WorkgroupMemory);  \
+    return op(sgX, prefix);                                                                 \
+}
+
 #define DEFN_SUB_GROUP_REDUCE(type, type_abbr, op, identity, X)                             \
 {                                                                                         \
     uint sgsize = __builtin_spirv_BuiltInSubgroupSize();                                 \
@@ -2002,6 +2065,24 @@ DEFN_ARITH_OPERATIONS(half)
     }                                                                                     \
 }
 
+#define WORK_GROUP_SWITCH_HIER(func, type, type_abbr, op, identity, X, Operation)          \
+{                                                                                         \
+    switch(Operation){                                                                     \
+        case GroupOperationReduce:                                                         \
+            DEFN_WORK_GROUP_REDUCE_HIER(func, type, type_abbr, op, identity, X)             \
+            break;                                                                         \
+        case GroupOperationInclusiveScan:                                                 \
+            DEFN_WORK_GROUP_SCAN_HIER(func, type, type_abbr, op, identity, X, true)         \
+            break;                                                                         \
+        case GroupOperationExclusiveScan:                                                 \
+            DEFN_WORK_GROUP_SCAN_HIER(func, type, type_abbr, op, identity, X, false)        \
+            break;                                                                         \
+        default:                                                                         \
+            return 0;                                                                    \
+            break;                                                                         \
+    }                                                                                     \
+}
+
 #define SUB_GROUP_SWITCH(type, type_abbr, op, identity, X, Operation)                     \
 {                                                                                         \
     switch(Operation){                                                                     \
@@ -2025,7 +2106,14 @@ type  __builtin_spirv_OpGroup##func##_i32_i32_##type_abbr(uint Execution, uint O
 {                                                                                                \
     if (Execution == Workgroup)                                                                  \
     {                                                                                            \
-        WORK_GROUP_SWITCH(type, op, identity, X, Operation)                                      \
+        if (sizeof(X) < 8 || __UseNative64BitSubgroupBuiltin)                                    \
+        {                                                                                        \
+            WORK_GROUP_SWITCH_HIER(func, type, type_abbr, op, identity, X, Operation)            \
+        }                                                                                        \
+        else                                                                                     \
+        {                                                                                        \
+            WORK_GROUP_SWITCH(type, op, identity, X, Operation)                                  \
+        }                                                                                        \
     }                                                                                            \
     else if (Execution == Subgroup)                                                              \
     {                                                                                             \
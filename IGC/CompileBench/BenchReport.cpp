@@ -0,0 +1,321 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+#include "BenchReport.hpp"
+
+#include "common/LLVMWarningsPush.hpp"
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Support/FormatVariadic.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include "common/LLVMWarningsPop.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+using namespace llvm;
+using namespace IGC::CompileBench;
+
+namespace
+{
+    json::Array toArray(const std::vector<double>& samples)
+    {
+        json::Array arr;
+        for (double s : samples)
+            arr.push_back(s);
+        return arr;
+    }
+
+    std::vector<double> fromArray(const json::Array* arr)
+    {
+        std::vector<double> samples;
+        if (!arr)
+            return samples;
+        for (const json::Value& v : *arr)
+        {
+            if (auto d = v.getAsNumber())
+                samples.push_back(*d);
+        }
+        return samples;
+    }
+
+    double deltaPct(double base, double cur)
+    {
+        return base == 0 ? 0 : (cur - base) / base * 100.0;
+    }
+
+    json::Object compareValues(double base, double cur)
+    {
+        return json::Object{
+            {"base", base},
+            {"new", cur},
+            {"delta_pct", deltaPct(base, cur)},
+        };
+    }
+} // anonymous namespace
+
+double IGC::CompileBench::median(std::vector<double> samples)
+{
+    if (samples.empty())
+        return 0;
+    size_t mid = samples.size() / 2;
+    std::nth_element(samples.begin(), samples.begin() + mid, samples.end());
+    double m = samples[mid];
+    if (samples.size() % 2 == 0)
+        m = (m + *std::max_element(samples.begin(), samples.begin() + mid)) / 2;
+    return m;
+}
+
+double IGC::CompileBench::mannWhitneyP(
+    const std::vector<double>& a,
+    const std::vector<double>& b)
+{
+    const size_t n1 = a.size(), n2 = b.size();
+    if (n1 == 0 || n2 == 0)
+        return 1.0;
+
+    // rank the pooled samples, ties get the average rank
+    std::vector<std::pair<double, bool>> pooled;
+    pooled.reserve(n1 + n2);
+    for (double v : a) pooled.emplace_back(v, true);
+    for (double v : b) pooled.emplace_back(v, false);
+    std::sort(pooled.begin(), pooled.end(),
+        [](const std::pair<double, bool>& l, const std::pair<double, bool>& r) {
+            return l.first < r.first;
+        });
+
+    double rankSumA = 0;
+    double tieTerm = 0;
+    for (size_t i = 0; i < pooled.size();)
+    {
+        size_t j = i;
+        while (j < pooled.size() && pooled[j].first == pooled[i].first)
+            ++j;
+        double rank = (i + 1 + j) / 2.0;
+        for (size_t k = i; k < j; ++k)
+        {
+            if (pooled[k].second)
+                rankSumA += rank;
+        }
+        double t = double(j - i);
+        tieTerm += t * t * t - t;
+        i = j;
+    }
+
+    const double N = double(n1 + n2);
+    const double U = rankSumA - n1 * (n1 + 1) / 2.0;
+    const double mu = n1 * n2 / 2.0;
+    const double var = n1 * n2 / 12.0 * ((N + 1) - tieTerm / (N * (N - 1)));
+    if (var <= 0)
+        return 1.0;
+    // continuity correction
+    const double z = std::max(0.0, std::fabs(U - mu) - 0.5) / std::sqrt(var);
+    return std::erfc(z / std::sqrt(2.0));
+}
+
+json::Value IGC::CompileBench::toJSON(const Report& report)
+{
+    json::Array inputs;
+    for (const InputResult& in : report.inputs)
+    {
+        json::Object timers;
+        for (const auto& T : in.timersMS)
+            timers[T.first] = toArray(T.second);
+
+        inputs.push_back(json::Object{
+            {"name", in.name},
+            {"succeeded", in.succeeded},
+            {"code_size", int64_t(in.codeSize)},
+            {"peak_rss_kb", int64_t(in.peakRSSKB)},
+            {"wall_ms", toArray(in.wallMS)},
+            {"timers_ms", std::move(timers)},
+        });
+    }
+
+    return json::Object{
+        {"version", 2},
+        {"igc", report.igcLibrary},
+        {"iterations", int64_t(report.iterations)},
+        {"inputs", std::move(inputs)},
+    };
+}
+
+Expected<Report> IGC::CompileBench::readReport(StringRef path)
+{
+    auto bufOrErr = MemoryBuffer::getFile(path);
+    if (!bufOrErr)
+        return errorCodeToError(bufOrErr.getError());
+
+    Expected<json::Value> parsed = json::parse((*bufOrErr)->getBuffer());
+    if (!parsed)
+        return parsed.takeError();
+
+    const json::Object* root = parsed->getAsObject();
+    if (!root || !root->getArray("inputs"))
+        return createStringError(inconvertibleErrorCode(),
+            "%s: not a compile bench report", path.str().c_str());
+
+    Report report;
+    if (auto lib = root->getString("igc"))
+        report.igcLibrary = lib->str();
+    if (auto iters = root->getInteger("iterations"))
+        report.iterations = unsigned(*iters);
+
+    for (const json::Value& v : *root->getArray("inputs"))
+    {
+        const json::Object* obj = v.getAsObject();
+        if (!obj)
+            continue;
+        InputResult in;
+        if (auto name = obj->getString("name"))
+            in.name = name->str();
+        in.succeeded = obj->getBoolean("succeeded").getValueOr(false);
+        in.codeSize = uint64_t(obj->getInteger("code_size").getValueOr(0));
+        in.peakRSSKB = uint64_t(obj->getInteger("peak_rss_kb").getValueOr(0));
+        in.wallMS = fromArray(obj->getArray("wall_ms"));
+        if (const json::Object* timers = obj->getObject("timers_ms"))
+        {
+            for (const auto& T : *timers)
+                in.timersMS[T.first.str()] = fromArray(T.second.getAsArray());
+        }
+        report.inputs.push_back(std::move(in));
+    }
+    return std::move(report);
+}
+
+unsigned IGC::CompileBench::compareReports(
+    const Report& base,
+    const Report& cur,
+    const CompareOptions& opts,
+    raw_ostream& OS)
+{
+    StringMap<const InputResult*> baseByName;
+    for (const InputResult& in : base.inputs)
+        baseByName[in.name] = &in;
+
+    json::Array inputs, regressions, improvements, missing;
+    double logRatioSum = 0;
+    unsigned numRatios = 0;
+    uint64_t baseCodeSize = 0, curCodeSize = 0;
+
+    for (const InputResult& in : cur.inputs)
+    {
+        auto it = baseByName.find(in.name);
+        if (it == baseByName.end())
+        {
+            missing.push_back(in.name);
+            continue;
+        }
+        const InputResult& b = *it->second;
+        baseByName.erase(it);
+
+        json::Object entry{{"name", in.name}};
+        bool regressed = false, improved = false;
+
+        if (b.succeeded != in.succeeded)
+        {
+            entry["succeeded"] = json::Object{{"base", b.succeeded}, {"new", in.succeeded}};
+            regressed |= b.succeeded;
+            improved |= in.succeeded;
+        }
+
+        if (b.succeeded && in.succeeded)
+        {
+            double baseMed = median(b.wallMS), curMed = median(in.wallMS);
+            double p = mannWhitneyP(b.wallMS, in.wallMS);
+            double delta = deltaPct(baseMed, curMed);
+            bool significant = p < opts.alpha && std::fabs(delta) >= opts.thresholdPct;
+            json::Object wall = compareValues(baseMed, curMed);
+            wall["p"] = p;
+            wall["significant"] = significant;
+            entry["wall_ms"] = std::move(wall);
+            regressed |= significant && delta > 0;
+            improved |= significant && delta < 0;
+            if (baseMed > 0 && curMed > 0)
+            {
+                logRatioSum += std::log(curMed / baseMed);
+                ++numRatios;
+            }
+
+            // code size is deterministic, so no test is needed
+            double sizeDelta = deltaPct(double(b.codeSize), double(in.codeSize));
+            entry["code_size"] = compareValues(double(b.codeSize), double(in.codeSize));
+            regressed |= sizeDelta >= opts.thresholdPct;
+            improved |= sizeDelta <= -opts.thresholdPct;
+            baseCodeSize += b.codeSize;
+            curCodeSize += in.codeSize;
+
+            if (b.peakRSSKB && in.peakRSSKB)
+                entry["peak_rss_kb"] = compareValues(double(b.peakRSSKB), double(in.peakRSSKB));
+
+            // per-interval breakdown to point at the phase that moved
+            json::Object timers;
+            for (const auto& T : in.timersMS)
+            {
+                auto bt = b.timersMS.find(T.first);
+                if (bt == b.timersMS.end())
+                    continue;
+                double tBase = median(bt->second), tCur = median(T.second);
+                if (std::fabs(deltaPct(tBase, tCur)) < opts.thresholdPct)
+                    continue;
+                json::Object t = compareValues(tBase, tCur);
+                t["p"] = mannWhitneyP(bt->second, T.second);
+                timers[T.first] = std::move(t);
+            }
+            if (!timers.empty())
+                entry["timers_ms"] = std::move(timers);
+        }
+
+        entry["regression"] = regressed;
+        if (regressed)
+            regressions.push_back(in.name);
+        else if (improved)
+            improvements.push_back(in.name);
+        inputs.push_back(std::move(entry));
+    }
+    for (const auto& leftover : baseByName)
+        missing.push_back(leftover.second->name);
+
+    const unsigned numRegressions = unsigned(regressions.size());
+    json::Object summary{
+        {"inputs_compared", int64_t(inputs.size())},
+        {"geomean_wall_ratio", numRatios ? std::exp(logRatioSum / numRatios) : 1.0},
+        {"code_size_total", compareValues(double(baseCodeSize), double(curCodeSize))},
+        {"regressions", std::move(regressions)},
+        {"improvements", std::move(improvements)},
+        {"missing", std::move(missing)},
+    };
+
+    json::Value result = json::Object{
+        {"base", base.igcLibrary},
+        {"new", cur.igcLibrary},
+        {"alpha", opts.alpha},
+        {"threshold_pct", opts.thresholdPct},
+        {"summary", std::move(summary)},
+        {"inputs", std::move(inputs)},
+    };
+    OS << formatv("{0:2}", result) << "\n";
+    return numRegressions;
+}
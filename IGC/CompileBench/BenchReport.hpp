@@ -0,0 +1,92 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+#pragma once
+
+#include "common/LLVMWarningsPush.hpp"
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/Error.h>
+#include <llvm/Support/JSON.h>
+#include <llvm/Support/raw_ostream.h>
+#include "common/LLVMWarningsPop.hpp"
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace IGC
+{
+namespace CompileBench
+{
+    // Everything measured for one corpus input.  An input is compiled by
+    // a single Translate call, so all its kernels are measured together.
+    // Time series hold one sample per measured (non warm-up) iteration.
+    struct InputResult
+    {
+        std::string name;           // input path relative to the corpus root
+        bool        succeeded = false;
+        uint64_t    codeSize = 0;   // size of the oclGenBin output in bytes
+        uint64_t    peakRSSKB = 0;  // 0 when not available
+        std::vector<double> wallMS;
+        // COMPILE_TIME_INTERVALS name (e.g. "TIME_CodeGen") to samples
+        std::map<std::string, std::vector<double>> timersMS;
+    };
+
+    struct Report
+    {
+        std::string igcLibrary;
+        unsigned    iterations = 0;
+        std::vector<InputResult> inputs;
+    };
+
+    llvm::json::Value toJSON(const Report& report);
+    llvm::Expected<Report> readReport(llvm::StringRef path);
+
+    struct CompareOptions
+    {
+        double alpha = 0.05;        // significance level for timing changes
+        double thresholdPct = 2.0;  // smallest change reported as a regression
+    };
+
+    // Writes a JSON comparison of cur against base to OS and returns the
+    // number of inputs that regressed.
+    unsigned compareReports(
+        const Report& base,
+        const Report& cur,
+        const CompareOptions& opts,
+        llvm::raw_ostream& OS);
+
+    double median(std::vector<double> samples);
+
+    // Two-sided p-value of the Mann-Whitney U test (normal approximation,
+    // tie corrected).  Timing samples are rarely normal, so a rank test is
+    // a safer default than Student's t.
+    double mannWhitneyP(
+        const std::vector<double>& a,
+        const std::vector<double>& b);
+
+} // namespace CompileBench
+} // namespace IGC
@@ -0,0 +1,452 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+
+//===----------------------------------------------------------------------===//
+//
+// igc_compile_bench: offline compile-time and code-size benchmark.
+//
+// Drives libigc through the OCL translation interface (the same entry point
+// the driver uses) over a corpus of SPIR-V (.spv) or LLVM bitcode (.bc)
+// inputs.  Options for an input are taken from <base>_options.txt and
+// <base>_internal_options.txt next to it, which is how ShaderDumpEnable
+// dumps them, so a dump directory can be used as a corpus as is.
+//
+// Per input it records the wall time of every measured compile, the IGC
+// COMPILE_TIME_INTERVALS (including the vISA Timer.def timers) when the
+// library honors IGC_DumpTimeStatsJSON, the peak RSS and the binary size.
+// These cover all the kernels of the input, as the translation interface
+// compiles a module at a time; a corpus of one kernel per input (e.g. a
+// ShaderDumpEnable dump of single-kernel programs) gives per kernel data.
+//
+//   igc_compile_bench -product-family=N -render-core-family=N corpus/ -o new.json
+//   igc_compile_bench -compare base.json new.json
+//
+//===----------------------------------------------------------------------===//
+
+#include "BenchReport.hpp"
+
+#include "cif/common/library_handle.h"
+#include "cif/import/library_api.h"
+#include "cif/import/cif_main.h"
+#include "cif/builtins/memory/buffer/buffer.h"
+#include "ocl_igc_interface/code_type.h"
+#include "ocl_igc_interface/igc_ocl_device_ctx.h"
+#include "ocl_igc_interface/igc_ocl_translation_ctx.h"
+#include "ocl_igc_interface/ocl_translation_output.h"
+#include "ocl_igc_interface/platform.h"
+#include "ocl_igc_interface/gt_system_info.h"
+
+#include "common/LLVMWarningsPush.hpp"
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/CommandLine.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/FormatVariadic.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/Program.h>
+#include <llvm/Support/raw_ostream.h>
+#include "llvmWrapper/Support/FileSystem.h"
+#include "common/LLVMWarningsPop.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#endif
+
+using namespace llvm;
+using namespace IGC::CompileBench;
+
+#ifndef IGC_COMPILE_BENCH_LIBRARY
+#define IGC_COMPILE_BENCH_LIBRARY ""
+#endif
+
+static cl::list<std::string>
+    Inputs(cl::Positional, cl::OneOrMore,
+        cl::desc("<corpus directory>... | <base report> <new report> with -compare"));
+static cl::opt<std::string>
+    OutputFile("o", cl::desc("Output JSON file (default: stdout)"), cl::init("-"));
+static cl::opt<bool>
+    Compare("compare", cl::desc("Compare two reports instead of running the corpus"));
+
+static cl::opt<std::string>
+    IGCLibrary("igc", cl::desc("Path of the IGC library to benchmark"),
+        cl::init(IGC_COMPILE_BENCH_LIBRARY));
+static cl::opt<unsigned>
+    Iterations("iterations", cl::desc("Measured compiles per input"), cl::init(5));
+static cl::opt<unsigned>
+    Warmup("warmup", cl::desc("Unmeasured compiles per input"), cl::init(1));
+
+static cl::opt<uint64_t>
+    ProductFamily("product-family", cl::desc("PRODUCT_FAMILY value of the target"));
+static cl::opt<uint64_t>
+    RenderCoreFamily("render-core-family", cl::desc("GFXCORE_FAMILY value of the target"));
+static cl::opt<unsigned>
+    DeviceID("device-id", cl::desc("PCI device id of the target"), cl::init(0));
+static cl::opt<unsigned>
+    RevID("rev-id", cl::desc("Stepping of the target"), cl::init(0));
+static cl::opt<unsigned>
+    EUCount("eu-count", cl::desc("EUs of the target"), cl::init(96));
+static cl::opt<unsigned>
+    ThreadsPerEU("threads-per-eu", cl::desc("Hardware threads per EU"), cl::init(7));
+static cl::opt<unsigned>
+    SliceCount("slice-count", cl::desc("Slices of the target"), cl::init(1));
+static cl::opt<unsigned>
+    SubSliceCount("subslice-count", cl::desc("Subslices of the target"), cl::init(6));
+
+static cl::opt<double>
+    Alpha("alpha", cl::desc("Significance level for timing changes (-compare)"), cl::init(0.05));
+static cl::opt<double>
+    ThresholdPct("threshold", cl::desc("Smallest change in percent reported as a regression (-compare)"),
+        cl::init(2.0));
+static cl::opt<bool>
+    FailOnRegression("fail-on-regression", cl::desc("Exit with 1 if -compare finds a regression"));
+
+namespace
+{
+    struct CorpusEntry
+    {
+        std::string name;
+        std::string input;
+        IGC::CodeType::CodeType_t type;
+        std::string options;
+        std::string internalOptions;
+    };
+
+    std::string readFileOrEmpty(const Twine& path)
+    {
+        auto buf = MemoryBuffer::getFile(path);
+        return buf ? (*buf)->getBuffer().str() : std::string();
+    }
+
+    void collectCorpus(StringRef root, std::vector<CorpusEntry>& corpus)
+    {
+        std::error_code EC;
+        std::vector<CorpusEntry> found;
+        for (sys::fs::recursive_directory_iterator I(root, EC), E; I != E && !EC; I.increment(EC))
+        {
+            StringRef path = I->path();
+            StringRef ext = sys::path::extension(path);
+            IGC::CodeType::CodeType_t type;
+            if (ext == ".spv")
+                type = IGC::CodeType::spirV;
+            else if (ext == ".bc")
+                type = IGC::CodeType::llvmBc;
+            else
+                continue;
+
+            SmallString<256> base(path);
+            sys::path::replace_extension(base, "");
+            SmallString<256> name(path);
+            sys::path::replace_path_prefix(name, root, "");
+            found.push_back({
+                sys::path::relative_path(name).str(),
+                path.str(),
+                type,
+                readFileOrEmpty(base + "_options.txt"),
+                readFileOrEmpty(base + "_internal_options.txt"),
+            });
+        }
+        if (EC)
+            errs() << root << ": " << EC.message() << "\n";
+
+        // directory order is unspecified; reports are compared by name but
+        // a stable order keeps them diffable
+        std::sort(found.begin(), found.end(),
+            [](const CorpusEntry& a, const CorpusEntry& b) { return a.name < b.name; });
+        corpus.insert(corpus.end(), found.begin(), found.end());
+    }
+
+    // Peak RSS of the process in KB since the last resetPeakRSS().
+    void resetPeakRSS()
+    {
+#if defined(__linux__)
+        // "5" resets VmHWM to the current RSS (Linux 4.0+); harmless if not
+        std::ofstream("/proc/self/clear_refs") << "5";
+#endif
+    }
+
+    uint64_t getPeakRSSKB()
+    {
+#if defined(__linux__)
+        std::ifstream status("/proc/self/status");
+        std::string line;
+        while (std::getline(status, line))
+        {
+            if (line.compare(0, 6, "VmHWM:") == 0)
+                return std::strtoull(line.c_str() + 6, nullptr, 10);
+        }
+        return 0;
+#elif defined(_WIN32)
+        // cannot be reset, so this is the peak of the whole run so far
+        PROCESS_MEMORY_COUNTERS pmc;
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+            return pmc.PeakWorkingSetSize / 1024;
+        return 0;
+#else
+        return 0;
+#endif
+    }
+
+    // Reads the time stat records IGC appended to the DumpTimeStatsJSON
+    // file since the previous call and adds them to timers.
+    class TimeStatsReader
+    {
+    public:
+        explicit TimeStatsReader(std::string path) : m_path(std::move(path)) { }
+
+        void consume(std::map<std::string, double>& timers)
+        {
+            std::ifstream file(m_path, std::ios::binary);
+            if (!file)
+                return;
+            file.seekg(m_offset);
+            std::string line;
+            while (std::getline(file, line))
+            {
+                m_offset += line.size() + 1;
+                Expected<json::Value> record = json::parse(line);
+                if (!record)
+                {
+                    consumeError(record.takeError());
+                    continue;
+                }
+                const json::Object* obj = record->getAsObject();
+                const json::Object* recTimers = obj ? obj->getObject("timers") : nullptr;
+                if (!recTimers)
+                    continue;
+                for (const auto& T : *recTimers)
+                {
+                    if (const json::Object* t = T.second.getAsObject())
+                        timers[T.first.str()] += t->getNumber("ms").getValueOr(0);
+                }
+            }
+        }
+
+    private:
+        std::string m_path;
+        std::streamoff m_offset = 0;
+    };
+
+    bool setEnv(const char* name, const std::string& value)
+    {
+#if defined(_WIN32)
+        return _putenv_s(name, value.c_str()) == 0;
+#else
+        return setenv(name, value.c_str(), 1) == 0;
+#endif
+    }
+
+    int runCompare()
+    {
+        if (Inputs.size() != 2)
+        {
+            errs() << "-compare expects exactly two reports\n";
+            return 2;
+        }
+        Expected<Report> base = readReport(Inputs[0]);
+        Expected<Report> cur = readReport(Inputs[1]);
+        if (!base || !cur)
+        {
+            logAllUnhandledErrors(base ? Error::success() : base.takeError(), errs(), "error: ");
+            logAllUnhandledErrors(cur ? Error::success() : cur.takeError(), errs(), "error: ");
+            return 2;
+        }
+
+        std::error_code EC;
+        raw_fd_ostream OS(OutputFile, EC, IGCLLVM::sys::fs::OF_Text);
+        if (EC)
+        {
+            errs() << OutputFile << ": " << EC.message() << "\n";
+            return 2;
+        }
+        CompareOptions opts;
+        opts.alpha = Alpha;
+        opts.thresholdPct = ThresholdPct;
+        unsigned regressions = compareReports(*base, *cur, opts, OS);
+        errs() << regressions << " regression(s)\n";
+        return (FailOnRegression && regressions) ? 1 : 0;
+    }
+
+    int runCorpus()
+    {
+        if (ProductFamily.getNumOccurrences() == 0 || RenderCoreFamily.getNumOccurrences() == 0)
+        {
+            errs() << "-product-family and -render-core-family are required\n";
+            return 2;
+        }
+        if (IGCLibrary.empty())
+        {
+            errs() << "no IGC library given (-igc)\n";
+            return 2;
+        }
+
+        std::vector<CorpusEntry> corpus;
+        for (const std::string& dir : Inputs)
+            collectCorpus(dir, corpus);
+        if (corpus.empty())
+        {
+            errs() << "no .spv or .bc inputs found\n";
+            return 2;
+        }
+
+        // Must be in place before the library reads its registry keys.
+        // Builds without IGC_DEBUG_VARIABLES ignore it; only the wall time,
+        // memory and code size are reported then.
+        SmallString<128> timeStatsPath;
+        if (std::error_code EC = sys::fs::createTemporaryFile("igc_time_stats", "jsonl", timeStatsPath))
+        {
+            errs() << "cannot create time stats file: " << EC.message() << "\n";
+            return 2;
+        }
+        sys::fs::remove(timeStatsPath);
+        setEnv("IGC_DumpTimeStatsJSON", timeStatsPath.str().str());
+        TimeStatsReader timeStats(timeStatsPath.str().str());
+
+        auto igc = CIF::OpenLibraryInterface(CIF::OpenLibrary(IGCLibrary, false));
+        if (!igc || !igc->IsValid())
+        {
+            errs() << IGCLibrary << ": cannot open the CIF interface\n";
+            return 2;
+        }
+        auto deviceCtx = igc->GetCIFMain()->CreateInterface<IGC::IgcOclDeviceCtxTagOCL>();
+        if (!deviceCtx)
+        {
+            errs() << IGCLibrary << ": incompatible OCL device interface\n";
+            return 2;
+        }
+
+        auto platform = deviceCtx->GetPlatformHandle();
+        platform->SetProductFamily(ProductFamily);
+        platform->SetRenderCoreFamily(RenderCoreFamily);
+        platform->SetDeviceID((unsigned short)DeviceID);
+        platform->SetRevId((unsigned short)RevID);
+        auto sysInfo = deviceCtx->GetGTSystemInfoHandle();
+        sysInfo->SetEUCount(EUCount);
+        sysInfo->SetThreadCount(EUCount * ThreadsPerEU);
+        sysInfo->SetSliceCount(SliceCount);
+        sysInfo->SetSubSliceCount(SubSliceCount);
+        sysInfo->SetMaxSlicesSupported(SliceCount);
+        sysInfo->SetMaxSubSlicesSupported(SubSliceCount);
+        sysInfo->SetMaxEuPerSubSlice(SubSliceCount ? EUCount / SubSliceCount : EUCount);
+
+        Report report;
+        report.igcLibrary = IGCLibrary;
+        report.iterations = Iterations;
+
+        for (const CorpusEntry& entry : corpus)
+        {
+            auto srcBuf = MemoryBuffer::getFile(entry.input);
+            if (!srcBuf)
+            {
+                errs() << entry.input << ": " << srcBuf.getError().message() << "\n";
+                continue;
+            }
+            StringRef src = (*srcBuf)->getBuffer();
+            auto main = igc->GetCIFMain();
+            auto srcCIF = CIF::Builtins::CreateConstBuffer(main, src.data(), src.size());
+            auto optsCIF = CIF::Builtins::CreateConstBuffer(
+                main, entry.options.data(), entry.options.size());
+            auto intOptsCIF = CIF::Builtins::CreateConstBuffer(
+                main, entry.internalOptions.data(), entry.internalOptions.size());
+
+            InputResult result;
+            result.name = entry.name;
+            result.succeeded = true;
+
+            std::map<std::string, std::vector<double>> timers;
+            for (unsigned i = 0; i < Warmup + Iterations && result.succeeded; ++i)
+            {
+                const bool measured = i >= Warmup;
+                if (measured)
+                    resetPeakRSS();
+
+                auto start = std::chrono::steady_clock::now();
+                auto transCtx = deviceCtx->CreateTranslationCtx(entry.type, IGC::CodeType::oclGenBin);
+                if (!transCtx)
+                {
+                    errs() << entry.name << ": input type not supported by the library\n";
+                    result.succeeded = false;
+                    break;
+                }
+                auto output = transCtx->Translate(srcCIF.get(), optsCIF.get(), intOptsCIF.get(), nullptr, 0);
+                auto end = std::chrono::steady_clock::now();
+
+                std::map<std::string, double> compileTimers;
+                timeStats.consume(compileTimers);
+
+                if (!output || !output->Successful())
+                {
+                    errs() << entry.name << ": compilation failed\n";
+                    if (output && output->GetBuildLog() && output->GetBuildLog()->GetSizeRaw())
+                    {
+                        auto log = output->GetBuildLog();
+                        errs().write(log->GetMemory<char>(), log->GetSizeRaw()) << "\n";
+                    }
+                    result.succeeded = false;
+                    break;
+                }
+                if (!measured)
+                    continue;
+
+                result.wallMS.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+                result.peakRSSKB = std::max(result.peakRSSKB, getPeakRSSKB());
+                result.codeSize = output->GetOutput() ? output->GetOutput()->GetSizeRaw() : 0;
+                for (const auto& T : compileTimers)
+                    timers[T.first].push_back(T.second);
+            }
+            result.timersMS = std::move(timers);
+
+            errs() << formatv("{0,-60} {1,10:f2} ms {2,10} bytes\n",
+                entry.name, median(result.wallMS), result.codeSize);
+            report.inputs.push_back(std::move(result));
+        }
+        sys::fs::remove(timeStatsPath);
+
+        std::error_code EC;
+        raw_fd_ostream OS(OutputFile, EC, IGCLLVM::sys::fs::OF_Text);
+        if (EC)
+        {
+            errs() << OutputFile << ": " << EC.message() << "\n";
+            return 2;
+        }
+        OS << formatv("{0:2}", toJSON(report)) << "\n";
+        return 0;
+    }
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+    cl::ParseCommandLineOptions(argc, argv,
+        "IGC compile-time and code-size benchmark\n");
+    return Compare ? runCompare() : runCorpus();
+}
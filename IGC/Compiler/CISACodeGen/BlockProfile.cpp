@@ -0,0 +1,337 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+
+#include "Compiler/CISACodeGen/BlockProfile.hpp"
+#include "common/debug/Debug.hpp"
+#include "common/debug/Dump.hpp"
+#include "common/igc_regkeys.hpp"
+#include "common/LLVMWarningsPush.hpp"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Metadata.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "common/LLVMWarningsPop.hpp"
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include "Probe/Assertion.h"
+
+using namespace llvm;
+using namespace IGC;
+
+static const char* const ProfileBlockIdMD = "igc.profile.block";
+
+// for lit tests; same as BlockProfilePath
+static cl::opt<std::string> BlockProfileFile(
+    "igc-block-profile", cl::init(""), cl::Hidden,
+    cl::desc("Block execution-count profile (BlockProfilePath)"));
+
+static const char* getProfilePath()
+{
+    const char* path = IGC_GET_REGKEYSTRING(BlockProfilePath);
+    if (path && *path)
+    {
+        return path;
+    }
+    return BlockProfileFile.c_str();
+}
+
+static bool parseHex(StringRef str, uint64_t& value)
+{
+    if (str.startswith("0x") || str.startswith("0X"))
+    {
+        str = str.drop_front(2);
+    }
+    return !str.empty() && !str.getAsInteger(16, value);
+}
+
+bool BlockProfile::isEnabled()
+{
+    return *getProfilePath() || IGC_IS_FLAG_ENABLED(DumpBlockProfileMap);
+}
+
+const BlockProfile* BlockProfile::get()
+{
+    const char* path = getProfilePath();
+    if (!*path)
+    {
+        return nullptr;
+    }
+
+    static std::mutex loadMutex;
+    static std::map<std::string, std::unique_ptr<BlockProfile>> loaded;
+    std::lock_guard<std::mutex> lock(loadMutex);
+    auto it = loaded.find(path);
+    if (it != loaded.end())
+    {
+        return it->second.get();
+    }
+
+    // failures are reported once and remembered as a null profile
+    std::unique_ptr<BlockProfile> profile;
+    auto buffer = MemoryBuffer::getFile(path);
+    if (!buffer)
+    {
+        IGC::Debug::ods() << "BlockProfile: cannot read " << path << ": "
+            << buffer.getError().message() << "\n";
+    }
+    else
+    {
+        std::string error;
+        profile.reset(new BlockProfile());
+        if (!profile->parse((*buffer)->getBuffer(), error))
+        {
+            IGC::Debug::ods() << "BlockProfile: " << path << ": " << error << "\n";
+            profile.reset();
+        }
+    }
+    return (loaded[path] = std::move(profile)).get();
+}
+
+bool BlockProfile::parse(StringRef text, std::string& error)
+{
+    m_shaders.clear();
+
+    uint64_t hash = 0;
+    bool inKernel = false;
+    FunctionCounts* func = nullptr;
+    bool skipFunc = false;
+    unsigned lineNo = 0;
+
+    auto fail = [&](const char* msg)
+    {
+        error = "line " + std::to_string(lineNo) + ": " + msg;
+        m_shaders.clear();
+        return false;
+    };
+
+    SmallVector<StringRef, 16> lines;
+    text.split(lines, '\n');
+    for (StringRef line : lines)
+    {
+        ++lineNo;
+        line = line.split('#').first.trim();
+        if (line.empty())
+        {
+            continue;
+        }
+
+        SmallVector<StringRef, 4> tokens;
+        line.split(tokens, ' ', -1, false);
+        if (tokens[0] == "kernel")
+        {
+            if (tokens.size() != 3 || !parseHex(tokens[1], hash))
+            {
+                return fail("expected 'kernel <hash> <name>'");
+            }
+            inKernel = true;
+            func = nullptr;
+            skipFunc = false;
+        }
+        else if (tokens[0] == "func")
+        {
+            uint64_t checksum = 0;
+            if (tokens.size() != 3 || !parseHex(tokens[2], checksum))
+            {
+                return fail("expected 'func <name> <checksum>'");
+            }
+            if (!inKernel)
+            {
+                return fail("'func' outside of a kernel");
+            }
+            // A function compiled into several kernels has the same CFG in
+            // each of them; its counts are merged.
+            auto& funcs = m_shaders[hash];
+            auto it = funcs.find(tokens[1].str());
+            if (it == funcs.end())
+            {
+                func = &funcs[tokens[1].str()];
+                func->checksum = checksum;
+                skipFunc = false;
+            }
+            else
+            {
+                func = &it->second;
+                skipFunc = func->checksum != checksum;
+            }
+        }
+        else
+        {
+            unsigned id = 0;
+            uint64_t count = 0;
+            if (tokens.size() != 2 ||
+                tokens[0].getAsInteger(10, id) ||
+                tokens[1].getAsInteger(10, count))
+            {
+                return fail("expected '<block id> <count>'");
+            }
+            if (!func)
+            {
+                return fail("block count outside of a function");
+            }
+            if (!skipFunc)
+            {
+                func->counts[id] += count;
+            }
+        }
+    }
+    return true;
+}
+
+const BlockProfile::FunctionCounts* BlockProfile::lookup(
+    uint64_t hash, const Function& F) const
+{
+    auto shader = m_shaders.find(hash);
+    if (shader == m_shaders.end())
+    {
+        return nullptr;
+    }
+    auto func = shader->second.find(F.getName().str());
+    if (func == shader->second.end())
+    {
+        return nullptr;
+    }
+    if (func->second.checksum != getProfileChecksum(F))
+    {
+        // e.g. profile-guided trimming inlined differently than the
+        // instrumented build (see EstimateFunctionSize::reduceKernelSize)
+        IGC::Debug::ods() << "BlockProfile: CFG of " << F.getName().str()
+            << " changed since the profile was taken, ignoring its counts\n";
+        return nullptr;
+    }
+    return &func->second;
+}
+
+bool BlockProfile::getEntryCount(uint64_t hash, StringRef name, uint64_t& count) const
+{
+    auto shader = m_shaders.find(hash);
+    if (shader == m_shaders.end())
+    {
+        return false;
+    }
+    auto func = shader->second.find(name.str());
+    if (func == shader->second.end())
+    {
+        return false;
+    }
+    // the entry block always has id 0
+    auto entry = func->second.counts.find(0);
+    if (entry == func->second.counts.end())
+    {
+        return false;
+    }
+    count = entry->second;
+    return true;
+}
+
+void IGC::assignProfileBlockIds(Function& F)
+{
+    LLVMContext& C = F.getContext();
+    Type* int32Ty = Type::getInt32Ty(C);
+    unsigned id = 0;
+    for (BasicBlock& BB : F)
+    {
+        if (Instruction* term = BB.getTerminator())
+        {
+            Metadata* idMD = ConstantAsMetadata::get(ConstantInt::get(int32Ty, id));
+            term->setMetadata(ProfileBlockIdMD, MDNode::get(C, idMD));
+        }
+        ++id;
+    }
+}
+
+bool IGC::getProfileBlockId(const BasicBlock* BB, unsigned& id)
+{
+    const Instruction* term = BB->getTerminator();
+    MDNode* node = term ? term->getMetadata(ProfileBlockIdMD) : nullptr;
+    if (!node)
+    {
+        return false;
+    }
+    id = (unsigned)mdconst::extract<ConstantInt>(node->getOperand(0))->getZExtValue();
+    return true;
+}
+
+uint64_t IGC::getProfileChecksum(const Function& F)
+{
+    // FNV-1a over (id, successor ids) of every block, in id order
+    std::map<unsigned, const BasicBlock*> blocks;
+    for (const BasicBlock& BB : F)
+    {
+        unsigned id = 0;
+        if (getProfileBlockId(&BB, id))
+        {
+            blocks[id] = &BB;
+        }
+    }
+
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    auto mix = [&hash](unsigned v)
+    {
+        for (unsigned i = 0; i < 4; ++i)
+        {
+            hash ^= (v >> (8 * i)) & 0xff;
+            hash *= 0x100000001b3ULL;
+        }
+    };
+    for (auto& it : blocks)
+    {
+        const Instruction* term = it.second->getTerminator();
+        mix(it.first);
+        mix(term->getNumSuccessors());
+        for (unsigned i = 0, e = term->getNumSuccessors(); i < e; ++i)
+        {
+            unsigned succId = ~0U;
+            getProfileBlockId(term->getSuccessor(i), succId);
+            mix(succId);
+        }
+    }
+    return hash;
+}
+
+void IGC::dumpProfileBlockMap(uint64_t hash, StringRef kernel,
+    const Function& F, const std::map<unsigned, std::string>& labels)
+{
+    std::stringstream map;
+    map << std::hex << "kernel " << hash << " " << kernel.str() << "\n"
+        << "func " << F.getName().str() << " " << getProfileChecksum(F) << "\n"
+        << std::dec;
+    for (auto& it : labels)
+    {
+        map << it.first << " " << (it.second.empty() ? "entry" : it.second) << "\n";
+    }
+
+    static std::mutex dumpMutex;
+    std::lock_guard<std::mutex> lock(dumpMutex);
+    std::stringstream mapFile;
+    mapFile << IGC::Debug::GetShaderOutputFolder() << "BlockProfile.map";
+    std::ofstream mapStream;
+    mapStream.open(mapFile.str(), std::ios::app);
+    mapStream << map.str();
+}
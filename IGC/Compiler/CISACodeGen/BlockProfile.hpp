@@ -0,0 +1,115 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+#pragma once
+#include "common/LLVMWarningsPush.hpp"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/Function.h"
+#include "common/LLVMWarningsPop.hpp"
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace IGC
+{
+    /// \brief Basic-block execution counts fed back from an instrumented run.
+    ///
+    /// The profile is a text file named by the BlockProfilePath regkey
+    /// (-igc-block-profile in igc_opt):
+    ///
+    ///     # comment
+    ///     kernel <shader asm hash, hex> <kernel name>
+    ///     func <function name> <CFG checksum, hex>
+    ///     <block id> <execution count>
+    ///     ...
+    ///
+    /// A 'kernel' line starts the records of one compiled kernel, a 'func'
+    /// line those of one function compiled into it (the kernel itself, its
+    /// subroutines and stack-call functions). Block ids are the positions of
+    /// the blocks in their function when Layout runs, i.e. before anything
+    /// is reordered, so they are the same in the instrumented and in the
+    /// profile-guided build. The checksum covers the CFG over those ids;
+    /// functions whose CFG changed since the profile was taken are ignored.
+    ///
+    /// An instrumented build run with DumpBlockProfileMap writes
+    /// BlockProfile.map in the same format, with the vISA label of each block
+    /// (or "entry") in place of its count. make_block_profile.py turns the
+    /// map and per-label execution counts (e.g. GTPin counts of the blocks at
+    /// the label offsets in the .asm dump) into a profile.
+    class BlockProfile
+    {
+    public:
+        /// Counts of one function, by block id.
+        struct FunctionCounts
+        {
+            uint64_t checksum = 0;
+            llvm::DenseMap<unsigned, uint64_t> counts;
+        };
+
+        /// Whether a profile is being read or a block map written; block ids
+        /// are only assigned then.
+        static bool isEnabled();
+
+        /// The profile named by BlockProfilePath, or nullptr if none is set or
+        /// it cannot be read. Each file is parsed once per process.
+        static const BlockProfile* get();
+
+        /// Parses \p text; on malformed input returns false and describes the
+        /// first bad line in \p error.
+        bool parse(llvm::StringRef text, std::string& error);
+
+        /// Counts recorded for \p F (which must have block ids) in the shader
+        /// with asm hash \p hash; nullptr if there are none or they are stale.
+        const FunctionCounts* lookup(uint64_t hash, const llvm::Function& F) const;
+
+        /// How often function \p name was entered, summed over the kernels of
+        /// the shader with asm hash \p hash. Only functions that were not
+        /// inlined in the instrumented build have an entry count.
+        bool getEntryCount(uint64_t hash, llvm::StringRef name, uint64_t& count) const;
+
+    private:
+        // shader hash -> function name -> counts, merged over kernels
+        std::map<uint64_t, std::map<std::string, FunctionCounts>> m_shaders;
+    };
+
+    /// Numbers the blocks of \p F in their current order and records the ids
+    /// on the terminators.
+    void assignProfileBlockIds(llvm::Function& F);
+
+    /// Profile block id of \p BB; false if it has none (e.g. it was created
+    /// after Layout).
+    bool getProfileBlockId(const llvm::BasicBlock* BB, unsigned& id);
+
+    /// Checksum of the CFG of \p F over its profile block ids.
+    uint64_t getProfileChecksum(const llvm::Function& F);
+
+    /// Appends the block map of \p F, whose blocks start at the vISA labels
+    /// \p labels (by block id, empty for the entry), to BlockProfile.map.
+    void dumpProfileBlockMap(uint64_t hash, llvm::StringRef kernel,
+        const llvm::Function& F, const std::map<unsigned, std::string>& labels);
+
+} // namespace IGC
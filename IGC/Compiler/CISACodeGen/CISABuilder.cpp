@@ -487,6 +487,24 @@ namespace IGC
         return (id);
     }
 
+    std::string CEncoder::GetLabelName(uint label) const
+    {
+        auto it = labelNameMap.find(label);
+        return it != labelNameMap.end() ? it->second : std::string();
+    }
+
+    void CEncoder::BlockCount(uint label, uint64_t count)
+    {
+        V(vKernel->SetBlockProfile(GetLabel(label), count));
+    }
+
+    void CEncoder::EntryBlockCount(uint64_t count, llvm::Function* F)
+    {
+        // subroutines share the vISA kernel of their caller and start at
+        // their function label
+        V(vKernel->SetBlockProfile(F ? GetFuncLabel(F) : nullptr, count));
+    }
+
     void CEncoder::DwordAtomicRaw(
         AtomicOp atomic_op,
         const ResourceDescriptor& resource,
@@ -2872,6 +2890,7 @@ namespace IGC
             sprintf_s(labelname, sizeof(labelname), "label%d", labelCounter++);
             V(vKernel->CreateVISALabelVar(visaLabel, labelname, kind));
             labelMap[label] = visaLabel;
+            labelNameMap[label] = labelname;
         }
         return visaLabel;
     }
@@ -159,6 +159,14 @@ namespace IGC
         void Jump(CVariable* flag, uint label);
         void Label(uint label);
         uint GetNewLabelID();
+        /// vISA name of the label of IGC label <label>; empty if not created
+        std::string GetLabelName(uint label) const;
+        /// Measured execution count of the block starting at <label>, for
+        /// vISA's spill heuristics
+        void BlockCount(uint label, uint64_t count);
+        /// Measured execution count of the entry block of the current
+        /// kernel/stack function, or of subroutine <F> if given
+        void EntryBlockCount(uint64_t count, llvm::Function* F = nullptr);
         void DwordAtomicRaw(AtomicOp atomic_op,
             const ResourceDescriptor& bindingTableIndex,
             CVariable* dst, CVariable* elem_offset, CVariable* src0,
@@ -615,6 +623,7 @@ namespace IGC
         bool m_enableVISAdump;
         bool m_hasInlineAsm;
         std::vector<VISA_LabelOpnd*> labelMap;
+        llvm::DenseMap<uint, std::string> labelNameMap;
 
         /// Per kernel label counter
         unsigned labelCounter;
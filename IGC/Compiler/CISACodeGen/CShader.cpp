@@ -34,6 +34,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Compiler/CISACodeGen/GenCodeGenModule.h"
 #include "Compiler/CISACodeGen/messageEncoding.hpp"
 #include "Compiler/CISACodeGen/VariableReuseAnalysis.hpp"
+#include "Compiler/CISACodeGen/UniformArgsPropagation.hpp"
 #include "Compiler/CISACodeGen/PixelShaderCodeGen.hpp"
 #include "Compiler/CISACodeGen/VertexShaderCodeGen.hpp"
 #include "Compiler/CISACodeGen/GeometryShaderCodeGen.hpp"
@@ -2060,8 +2061,8 @@ CVariable* CShader::LazyCreateCCTupleBackingVariable(
 /// In some sense, all formal arguments are pre-allocated. Those symbols must be
 /// non-alias cvariable (ie root cvariable) as required by visa.
 ///
-/// Currently, all explicit arguments are non-uniform and most implicit
-/// arguments are uniform. Some implicit arguments may share the same symbol
+/// Explicit arguments are non-uniform unless UniformArgsPropagation proved
+/// them uniform at every call site, and most implicit arguments are uniform. Some implicit arguments may share the same symbol
 /// with their caller's implicit argument of the same kind. This is a subroutine
 /// optimization implemented in 'getOrCreateArgumentSymbol'.
 ///
@@ -2166,7 +2167,7 @@ CVariable* CShader::getOrCreateArgumentSymbol(
     // Stack call does not use implicit args
     if (!useStackCall)
     {
-        // An explicit argument is not uniform, and for an implicit argument, it
+        // An explicit argument is handled below, and for an implicit argument, it
         // is predefined. Note that it is not necessarily uniform.
         Function* F = Arg->getParent();
         ImplicitArgs implicitArgs(*F, m_pMdUtils);
@@ -2246,6 +2247,11 @@ CVariable* CShader::getOrCreateArgumentSymbol(
             // Arg is for the current function and m_WI is available
             isUniform = (m_WI->whichDepend(&*Arg) == WIAnalysis::UNIFORM);
         }
+        else {
+            // Callee's WI is not available; use what WIAnalysis will seed
+            // the argument with.
+            isUniform = isUniformArg(&*Arg);
+        }
 
         VISA_Type type = GetType(Arg->getType());
         uint16_t nElts = (uint16_t)GetNumElts(Arg->getType(), isUniform);
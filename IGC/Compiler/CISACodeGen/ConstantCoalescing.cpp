@@ -34,8 +34,11 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "common/LLVMWarningsPush.hpp"
 #include "llvmWrapper/IR/DerivedTypes.h"
 #include "llvmWrapper/Support/Alignment.h"
+#include <llvm/Support/CommandLine.h>
 #include "common/LLVMWarningsPop.hpp"
 #include <list>
+#include <fstream>
+#include <sstream>
 #include "Probe/Assertion.h"
 
 /// @brief ConstantCoalescing merges multiple constant loads into one load
@@ -47,6 +50,11 @@ using namespace llvm;
 using namespace IGC;
 using IGCLLVM::getAlign;
 
+// for lit tests; same as EnableConstantCoalescingLoopHoist
+static cl::opt<bool> ConstantCoalescingLoopHoist(
+    "igc-constant-coalescing-loop-hoist", cl::init(false), cl::Hidden,
+    cl::desc("Hoist loop-invariant constant loads in ConstantCoalescing (EnableConstantCoalescingLoopHoist)"));
+
 // Register pass to igc-opt
 #define PASS_FLAG "igc-constant-coalescing"
 #define PASS_DESCRIPTION "Constant Coalescing"
@@ -57,8 +65,15 @@ IGC_INITIALIZE_PASS_DEPENDENCY(DominatorTreeWrapperPass)
 IGC_INITIALIZE_PASS_DEPENDENCY(WIAnalysis)
 IGC_INITIALIZE_PASS_DEPENDENCY(MetaDataUtilsWrapper)
 IGC_INITIALIZE_PASS_DEPENDENCY(CodeGenContextWrapper)
+IGC_INITIALIZE_PASS_DEPENDENCY(LoopInfoWrapperPass)
+IGC_INITIALIZE_PASS_DEPENDENCY(RegisterEstimator)
 IGC_INITIALIZE_PASS_END(ConstantCoalescing, PASS_FLAG, PASS_DESCRIPTION, PASS_CFG_ONLY, PASS_ANALYSIS)
 
+bool ConstantCoalescing::IsLoopHoistEnabled()
+{
+    return IGC_IS_FLAG_ENABLED(EnableConstantCoalescingLoopHoist) || ConstantCoalescingLoopHoist;
+}
+
 ConstantCoalescing::ConstantCoalescing() : FunctionPass(ID)
 {
     curFunc = NULL;
@@ -75,11 +90,194 @@ bool ConstantCoalescing::runOnFunction(Function& func)
     IGCMD::MetaDataUtils* pMdUtils = getAnalysis<MetaDataUtilsWrapper>().getMetaDataUtils();
     if (pMdUtils->findFunctionsInfoItem(&func) != pMdUtils->end_FunctionsInfo())
     {
+        bool optReport = IGC_IS_FLAG_ENABLED(EnableOptReportConstantCoalescing);
+        m_numHoistedLoads = 0;
+        m_numLoadsBefore = optReport ? countConstantLoads(&func) : 0;
         ProcessFunction(&func);
+        if (optReport)
+        {
+            emitOptReport(func);
+        }
+    }
+    return true;
+}
+
+// loads ProcessBlock may coalesce
+bool ConstantCoalescing::isConstantLoad(Instruction* I) const
+{
+    if (auto* ldRaw = dyn_cast<LdRawIntrinsic>(I))
+    {
+        bool directIdx = false;
+        unsigned int bufId = 0;
+        BufferType bufType = DecodeAS4GFXResource(
+            ldRaw->getResourceValue()->getType()->getPointerAddressSpace(), directIdx, bufId);
+        return bufType == BINDLESS_CONSTANT_BUFFER || bufType == BINDLESS_TEXTURE;
+    }
+    auto* LI = dyn_cast<LoadInst>(I);
+    if (!LI || LI->getType()->isAggregateType())
+    {
+        return false;
+    }
+    if (LI->getPointerAddressSpace() == ADDRESS_SPACE_CONSTANT)
+    {
+        return true;
+    }
+    uint bufId = 0;
+    Value* elt_ptrv = nullptr;
+    BufferType bufType = BUFFER_TYPE_UNKNOWN;
+    return IsReadOnlyLoadDirectCB(LI, bufId, elt_ptrv, bufType);
+}
+
+uint ConstantCoalescing::countConstantLoads(Function* function) const
+{
+    uint numLoads = 0;
+    for (auto& BB : *function)
+    {
+        for (auto& I : BB)
+        {
+            if (!I.use_empty() && isConstantLoad(&I))
+            {
+                numLoads++;
+            }
+        }
+    }
+    return numLoads;
+}
+
+void ConstantCoalescing::emitOptReport(Function& F) const
+{
+    uint numLoadsAfter = countConstantLoads(&F);
+
+    std::stringstream report;
+    report << "Function " << F.getName().str() << std::endl
+        << "Constant loads: " << m_numLoadsBefore << " before, " << numLoadsAfter << " after"
+        << ", messages removed: " << (m_numLoadsBefore > numLoadsAfter ? m_numLoadsBefore - numLoadsAfter : 0) << std::endl
+        << "Loads hoisted out of loops: " << m_numHoistedLoads << std::endl;
+
+    IGC::Debug::ods() << report.str();
+
+    std::stringstream optReportFile;
+    optReportFile << IGC::Debug::GetShaderOutputFolder() << "ConstantCoalescing.opt";
+    std::ofstream optReportStream;
+    optReportStream.open(optReportFile.str(), std::ios::app);
+    optReportStream << report.str();
+}
+
+// Moves a uniform constant load, and the address computation it needs, to
+// the preheader of L. Constant memory is never written, so only the
+// operands matter; the load must run whenever the loop is left so that it
+// is not executed speculatively.
+bool ConstantCoalescing::hoistLoadFromLoop(Instruction* load, Loop* L)
+{
+    BasicBlock* preheader = L->getLoopPreheader();
+    if (!preheader)
+    {
+        return false;
+    }
+    if (auto* LI = dyn_cast<LoadInst>(load))
+    {
+        if (!LI->isSimple())
+            return false;
+    }
+
+    DominatorTree& DT = getAnalysis<DominatorTreeWrapperPass>().getDomTree();
+    SmallVector<BasicBlock*, 4> exitingBlocks;
+    L->getExitingBlocks(exitingBlocks);
+    if (exitingBlocks.empty())
+    {
+        return false;
     }
+    for (auto* exiting : exitingBlocks)
+    {
+        if (!DT.dominates(load->getParent(), exiting))
+            return false;
+    }
+
+    Instruction* insertPt = preheader->getTerminator();
+    for (Value* op : load->operands())
+    {
+        if (isa<Function>(op))
+            continue;
+        bool changed = false;
+        if (!L->makeLoopInvariant(op, changed, insertPt))
+            return false;
+    }
+    load->moveBefore(insertPt);
     return true;
 }
 
+void ConstantCoalescing::HoistLoopInvariantLoads(Function* function)
+{
+    LoopInfo& LI = getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
+    if (LI.empty())
+    {
+        return;
+    }
+
+    RegisterEstimator* RPE = &getAnalysis<RegisterEstimator>();
+    RPE->calculate();
+    uint32_t threshold = IGC_GET_FLAG_VALUE(ConstantCoalescingLoopHoistGRFThreshold) *
+        m_ctx->getNumGRFPerThread() / 128;
+    uint32_t grfSize = m_ctx->platform.getGRFSize();
+    // GRFs taken by loads already hoisted over a block
+    DenseMap<BasicBlock*, uint32_t> extraGRFs;
+
+    // innermost loops first, so that a load may be hoisted step by step
+    // out of a loop nest
+    SmallVector<Loop*, 8> worklist;
+    for (Loop* L : LI)
+    {
+        for (Loop* inner : depth_first(L))
+        {
+            worklist.push_back(inner);
+        }
+    }
+    while (!worklist.empty())
+    {
+        Loop* L = worklist.pop_back_val();
+
+        uint32_t maxPressure = 0;
+        for (BasicBlock* BB : L->blocks())
+        {
+            maxPressure = std::max(maxPressure, RPE->getMaxLiveGRFAtBB(BB) + extraGRFs[BB]);
+        }
+
+        SmallVector<Instruction*, 8> candidates;
+        for (BasicBlock* BB : L->blocks())
+        {
+            for (auto& I : *BB)
+            {
+                if (!I.use_empty() && isConstantLoad(&I) &&
+                    wiAns->whichDepend(&I) == WIAnalysis::UNIFORM)
+                {
+                    candidates.push_back(&I);
+                }
+            }
+        }
+
+        for (Instruction* load : candidates)
+        {
+            // uniform, so a single copy per thread
+            uint32_t loadGRFs =
+                ((uint32_t)dataLayout->getTypeAllocSize(load->getType()) + grfSize - 1) / grfSize;
+            if (maxPressure + loadGRFs > threshold)
+            {
+                // a smaller load may still fit
+                continue;
+            }
+            if (hoistLoadFromLoop(load, L))
+            {
+                maxPressure += loadGRFs;
+                for (BasicBlock* BB : L->blocks())
+                {
+                    extraGRFs[BB] += loadGRFs;
+                }
+                m_numHoistedLoads++;
+            }
+        }
+    }
+}
+
 void ConstantCoalescing::ProcessFunction(Function* function)
 {
     curFunc = function;
@@ -111,6 +309,11 @@ void ConstantCoalescing::ProcessFunction(Function* function)
         }
     }
 
+    if (IsLoopHoistEnabled())
+    {
+        HoistLoopInvariantLoads(function);
+    }
+
     // get the dominator-tree to traverse
     DominatorTree& dom_tree = getAnalysis<DominatorTreeWrapperPass>().getDomTree();
 
@@ -28,6 +28,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Compiler/CISACodeGen/TranslationTable.hpp"
 #include "Compiler/CISACodeGen/ShaderCodeGen.hpp"
 #include "Compiler/CISACodeGen/WIAnalysis.hpp"
+#include "Compiler/CISACodeGen/RegisterEstimator.hpp"
 #include "Compiler/MetaDataUtilsWrapper.h"
 #include "Compiler/MetaDataApi/MetaDataApi.h"
 
@@ -35,6 +36,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <llvm/IR/PassManager.h>
 #include <llvm/IR/IRBuilder.h>
 #include <llvm/ADT/SmallBitVector.h>
+#include <llvm/Analysis/LoopInfo.h>
 #include "common/LLVMWarningsPop.hpp"
 #include "common/IGCIRBuilder.h"
 
@@ -44,6 +46,8 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 /// of larger quantity
 /// - change to oword loads if the address is uniform
 /// - change to gather4 or sampler loads if the address is not uniform
+/// - optionally hoist loop-invariant uniform loads to the loop preheader
+///   first, so that they are merged with the loads dominating the loop
 
 using namespace llvm;
 
@@ -78,6 +82,11 @@ namespace IGC
             AU.addRequired<CodeGenContextWrapper>();
             AU.addRequired<TranslationTable>();
             AU.addPreservedID(TranslationTable::ID);
+            if (IsLoopHoistEnabled())
+            {
+                AU.addRequired<LoopInfoWrapperPass>();
+                AU.addRequired<RegisterEstimator>();
+            }
 
         }
 
@@ -90,6 +99,12 @@ namespace IGC
         void FindAllDirectCB(llvm::BasicBlock* blk,
             std::vector<BufChunk*>& dircb_owloads);
 
+        /// hoist loop-invariant uniform constant loads out of loops,
+        /// bounded by the estimated GRF pressure in each loop
+        void HoistLoopInvariantLoads(llvm::Function* function);
+        /// whether HoistLoopInvariantLoads runs, by regkey or cl::opt
+        static bool IsLoopHoistEnabled();
+
         virtual bool runOnFunction(llvm::Function& func) override;
     private:
 
@@ -245,6 +260,15 @@ namespace IGC
         const llvm::DataLayout* dataLayout;
         TranslationTable* m_TT;
 
+        /// opt report (EnableOptReportConstantCoalescing)
+        uint m_numLoadsBefore = 0;
+        uint m_numHoistedLoads = 0;
+
+        bool isConstantLoad(llvm::Instruction* I) const;
+        uint countConstantLoads(llvm::Function* function) const;
+        bool hoistLoadFromLoop(llvm::Instruction* load, llvm::Loop* L);
+        void emitOptReport(llvm::Function& F) const;
+
 
         /// Examines the uniformity of the load and the number of used elements
         /// to determine whether we should try to merge it.
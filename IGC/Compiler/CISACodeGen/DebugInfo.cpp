@@ -28,6 +28,11 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "common/Types.hpp"
 #include "Probe/Assertion.h"
 
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
 using namespace llvm;
 using namespace IGC;
 using namespace IGC::IGCMD;
@@ -61,7 +66,6 @@ bool DebugInfoPass::runOnModule(llvm::Module& M)
 {
     std::vector<CShader*> units;
     auto moduleMD = getAnalysis<MetaDataUtilsWrapper>().getModuleMetaData();
-    bool isOneStepElf = false;
 
     auto isCandidate = [](CShaderProgram* shaderProgram, SIMDMode m, ShaderDispatchMode mode = ShaderDispatchMode::NOT_APPLICABLE)
     {
@@ -87,189 +91,217 @@ bool DebugInfoPass::runOnModule(llvm::Module& M)
         if (simd32) units.push_back(simd32);
     }
 
-    for (auto& currShader : units)
+    // Skip units that are not entry points.
+    units.erase(std::remove_if(units.begin(), units.end(), [](CShader* currShader) {
+        return !isEntryFunc(currShader->GetMetaDataUtils(), currShader->entry);
+    }), units.end());
+
+    // Every unit has its own debug emitter, vISA debug info and program
+    // output, and the emitters only read the (shared) IR, so units can be
+    // emitted concurrently. Each result goes straight to its unit's program
+    // output, so the order in which workers pick units up does not matter.
+    unsigned numThreads = IGC_GET_FLAG_VALUE(DebugInfoEmitThreads);
+    if (numThreads == 0)
+        numThreads = std::thread::hardware_concurrency();
+    numThreads = std::max(1u, std::min<unsigned>(numThreads, units.size()));
+
+    std::atomic<unsigned> nextUnit{ 0 };
+    std::mutex visaMutex;
+    auto worker = [&]()
     {
-        // Look for the right CShaderProgram instance
-        m_currShader = currShader;
-
-        MetaDataUtils* pMdUtils = m_currShader->GetMetaDataUtils();
-        if (!isEntryFunc(pMdUtils, m_currShader->entry))
-            continue;
-
-        bool isCloned = false;
-        if (DebugInfoData::hasDebugInfo(m_currShader))
+        for (unsigned i = nextUnit++; i < units.size(); i = nextUnit++)
         {
-            auto fIT = moduleMD->FuncMD.find(m_currShader->entry);
-            if (fIT != moduleMD->FuncMD.end() &&
-                (*fIT).second.isCloned)
-            {
-                isCloned = true;
-            }
+            if (!EmitUnit(units[i], moduleMD))
+                continue;
+            // Tear the unit down as soon as it is done, so only the units
+            // in flight hold on to their emitter and vISA builder.
+            IDebugEmitter::Release(units[i]->GetDebugInfoData()->m_pDebugEmitter);
+
+            // destroy VISA builder; vISA is not known to be thread safe
+            std::lock_guard<std::mutex> lock(visaMutex);
+            auto encoder = &(units[i]->GetEncoder());
+            encoder->DestroyVISABuilder();
         }
+    };
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < numThreads; i++)
+        threads.emplace_back(worker);
+    worker();
+    for (auto& t : threads)
+        t.join();
 
-        bool finalize = false;
-        unsigned int size = m_currShader->GetDebugInfoData()->m_VISAModules.size();
-        m_pDebugEmitter = m_currShader->GetDebugInfoData()->m_pDebugEmitter;
-        std::vector<std::pair<unsigned int, std::pair<llvm::Function*, IGC::VISAModule*>>> sortedVISAModules;
+    return false;
+}
 
-        // Sort modules in order of their placement in binary
-        DbgDecoder decodedDbg(m_currShader->ProgramOutput()->m_debugDataGenISA);
-        auto getGenOff = [&decodedDbg](std::vector<std::pair<unsigned int, unsigned int>>& data, unsigned int VISAIndex)
+// Emits DWARF for all functions of a unit; returns true when the unit's
+// emitter was finalized (and is to be released).
+bool DebugInfoPass::EmitUnit(CShader* currShader, ModuleMetaData* moduleMD)
+{
+    bool isCloned = false;
+    if (DebugInfoData::hasDebugInfo(currShader))
+    {
+        auto fIT = moduleMD->FuncMD.find(currShader->entry);
+        if (fIT != moduleMD->FuncMD.end() &&
+            (*fIT).second.isCloned)
         {
-            unsigned retval = 0;
-            for (auto& item : data)
-            {
-                if (item.first == VISAIndex)
-                {
-                    retval = item.second;
-                }
-            }
-            return retval;
-        };
+            isCloned = true;
+        }
+    }
 
-        auto getLastGenOff = [this, &decodedDbg, &getGenOff](IGC::VISAModule* v)
+    bool isOneStepElf = false;
+    bool finalize = false;
+    unsigned int size = currShader->GetDebugInfoData()->m_VISAModules.size();
+    IDebugEmitter* pDebugEmitter = currShader->GetDebugInfoData()->m_pDebugEmitter;
+    std::vector<std::pair<unsigned int, std::pair<llvm::Function*, IGC::VISAModule*>>> sortedVISAModules;
+
+    // Sort modules in order of their placement in binary
+    DbgDecoder decodedDbg(currShader->ProgramOutput()->m_debugDataGenISA);
+    auto getGenOff = [&decodedDbg](std::vector<std::pair<unsigned int, unsigned int>>& data, unsigned int VISAIndex)
+    {
+        unsigned retval = 0;
+        for (auto& item : data)
         {
-            unsigned int genOff = 0;
-            // Detect last instructions of kernel. This information is absent in
-            // dbg info. So detect is as first instruction of first subroutine - 1.
-            // reloc_index, first sub inst's VISA id
-            std::unordered_map<uint32_t, unsigned int> firstSubVISAIndex;
-
-            for (auto& item : decodedDbg.compiledObjs)
+            if (item.first == VISAIndex)
             {
-                firstSubVISAIndex[item.relocOffset] = item.CISAIndexMap.back().first;
-                for (auto& sub : item.subs)
-                {
-                    auto subStartVISAIndex = sub.startVISAIndex;
-                    if (firstSubVISAIndex[item.relocOffset] > subStartVISAIndex)
-                        firstSubVISAIndex[item.relocOffset] = subStartVISAIndex - 1;
-                }
+                retval = item.second;
             }
+        }
+        return retval;
+    };
 
-            for (auto& item : decodedDbg.compiledObjs)
-            {
-                auto& name = item.kernelName;
-                auto firstInst = (v->GetInstInfoMap()->begin())->first;
-                auto funcName = firstInst->getParent()->getParent()->getName();
-                if (item.subs.size() == 0 && funcName.compare(name) == 0)
-                {
-                    genOff = item.CISAIndexMap.back().second;
-                }
-                else
-                {
-                    if (funcName.compare(name) == 0)
-                    {
-                        genOff = getGenOff(item.CISAIndexMap, firstSubVISAIndex[item.relocOffset]);
-                        break;
-                    }
-                    for (auto& sub : item.subs)
-                    {
-                        auto& subName = sub.name;
-                        if (funcName.compare(subName) == 0)
-                        {
-                            genOff = getGenOff(item.CISAIndexMap, sub.endVISAIndex);
-                            break;
-                        }
-                    }
-                }
+    auto getLastGenOff = [&decodedDbg, &getGenOff](IGC::VISAModule* v)
+    {
+        unsigned int genOff = 0;
+        // Detect last instructions of kernel. This information is absent in
+        // dbg info. So detect is as first instruction of first subroutine - 1.
+        // reloc_index, first sub inst's VISA id
+        std::unordered_map<uint32_t, unsigned int> firstSubVISAIndex;
 
-                if (genOff)
-                    break;
+        for (auto& item : decodedDbg.compiledObjs)
+        {
+            firstSubVISAIndex[item.relocOffset] = item.CISAIndexMap.back().first;
+            for (auto& sub : item.subs)
+            {
+                auto subStartVISAIndex = sub.startVISAIndex;
+                if (firstSubVISAIndex[item.relocOffset] > subStartVISAIndex)
+                    firstSubVISAIndex[item.relocOffset] = subStartVISAIndex - 1;
             }
+        }
 
-            return genOff;
-        };
-
-        auto setType = [&decodedDbg](VISAModule* v)
+        for (auto& item : decodedDbg.compiledObjs)
         {
+            auto& name = item.kernelName;
             auto firstInst = (v->GetInstInfoMap()->begin())->first;
             auto funcName = firstInst->getParent()->getParent()->getName();
-
-            for (auto& item : decodedDbg.compiledObjs)
+            if (item.subs.size() == 0 && funcName.compare(name) == 0)
+            {
+                genOff = item.CISAIndexMap.back().second;
+            }
+            else
             {
-                auto& name = item.kernelName;
                 if (funcName.compare(name) == 0)
                 {
-                    if (item.relocOffset == 0)
-                        v->SetType(VISAModule::ObjectType::KERNEL);
-                    else
-                        v->SetType(VISAModule::ObjectType::STACKCALL_FUNC);
-                    return;
+                    genOff = getGenOff(item.CISAIndexMap, firstSubVISAIndex[item.relocOffset]);
+                    break;
                 }
                 for (auto& sub : item.subs)
                 {
                     auto& subName = sub.name;
                     if (funcName.compare(subName) == 0)
                     {
-                        v->SetType(VISAModule::ObjectType::SUBROUTINE);
-                        return;
+                        genOff = getGenOff(item.CISAIndexMap, sub.endVISAIndex);
+                        break;
                     }
                 }
             }
-        };
 
-        for (auto& m : m_currShader->GetDebugInfoData()->m_VISAModules)
-        {
-            setType(m.second);
-            auto lastVISAId = getLastGenOff(m.second);
-            sortedVISAModules.push_back(std::make_pair(lastVISAId, std::make_pair(m.first, m.second)));
+            if (genOff)
+                break;
         }
 
-        std::sort(sortedVISAModules.begin(), sortedVISAModules.end(),
-            [](std::pair<unsigned int, std::pair<llvm::Function*, IGC::VISAModule*>>& p1,
-                std::pair<unsigned int, std::pair<llvm::Function*, IGC::VISAModule*>>& p2)
-        {
-            return p1.first < p2.first;
-        });
+        return genOff;
+    };
 
-        for (auto& m : sortedVISAModules)
+    auto setType = [&decodedDbg](VISAModule* v)
+    {
+        auto firstInst = (v->GetInstInfoMap()->begin())->first;
+        auto funcName = firstInst->getParent()->getParent()->getName();
+
+        for (auto& item : decodedDbg.compiledObjs)
         {
-            m_pDebugEmitter->AddVISAModFunc(m.second.second, m.second.first);
+            auto& name = item.kernelName;
+            if (funcName.compare(name) == 0)
+            {
+                if (item.relocOffset == 0)
+                    v->SetType(VISAModule::ObjectType::KERNEL);
+                else
+                    v->SetType(VISAModule::ObjectType::STACKCALL_FUNC);
+                return;
+            }
+            for (auto& sub : item.subs)
+            {
+                auto& subName = sub.name;
+                if (funcName.compare(subName) == 0)
+                {
+                    v->SetType(VISAModule::ObjectType::SUBROUTINE);
+                    return;
+                }
+            }
         }
+    };
 
-        for (auto& m : sortedVISAModules)
-        {
-            isOneStepElf |= m.second.second->isDirectElfInput;
-            m_pDebugEmitter->SetVISAModule(m.second.second);
-            m_pDebugEmitter->setFunction(m.second.first, isCloned);
+    for (auto& m : currShader->GetDebugInfoData()->m_VISAModules)
+    {
+        setType(m.second);
+        auto lastVISAId = getLastGenOff(m.second);
+        sortedVISAModules.push_back(std::make_pair(lastVISAId, std::make_pair(m.first, m.second)));
+    }
 
-            if (--size == 0)
-                finalize = true;
+    std::sort(sortedVISAModules.begin(), sortedVISAModules.end(),
+        [](std::pair<unsigned int, std::pair<llvm::Function*, IGC::VISAModule*>>& p1,
+            std::pair<unsigned int, std::pair<llvm::Function*, IGC::VISAModule*>>& p2)
+    {
+        return p1.first < p2.first;
+    });
 
-            EmitDebugInfo(finalize, &decodedDbg);
-        }
+    for (auto& m : sortedVISAModules)
+    {
+        pDebugEmitter->AddVISAModFunc(m.second.second, m.second.first);
+    }
 
-        // set VISA dbg info to nullptr to indicate 1-step debug is enabled
-        if (isOneStepElf)
-        {
-            currShader->ProgramOutput()->m_debugDataGenISASize = 0;
-            currShader->ProgramOutput()->m_debugDataGenISA = nullptr;
-        }
+    for (auto& m : sortedVISAModules)
+    {
+        isOneStepElf |= m.second.second->isDirectElfInput;
+        pDebugEmitter->SetVISAModule(m.second.second);
+        pDebugEmitter->setFunction(m.second.first, isCloned);
 
-        if (finalize)
-        {
-            IDebugEmitter::Release(m_pDebugEmitter);
+        if (--size == 0)
+            finalize = true;
 
-            // destroy VISA builder
-            auto encoder = &(m_currShader->GetEncoder());
-            encoder->DestroyVISABuilder();
-        }
+        EmitDebugInfo(currShader, pDebugEmitter, finalize, &decodedDbg);
     }
 
-    return false;
+    // set VISA dbg info to nullptr to indicate 1-step debug is enabled
+    if (isOneStepElf)
+    {
+        currShader->ProgramOutput()->m_debugDataGenISASize = 0;
+        currShader->ProgramOutput()->m_debugDataGenISA = nullptr;
+    }
+
+    return finalize;
 }
 
-void DebugInfoPass::EmitDebugInfo(bool finalize, DbgDecoder* decodedDbg)
+void DebugInfoPass::EmitDebugInfo(CShader* currShader, IDebugEmitter* pDebugEmitter, bool finalize, DbgDecoder* decodedDbg)
 {
     std::vector<char> buffer;
 
-    IF_DEBUG_INFO_IF(m_pDebugEmitter, buffer = m_pDebugEmitter->Finalize(finalize, decodedDbg);)
+    IF_DEBUG_INFO_IF(pDebugEmitter, buffer = pDebugEmitter->Finalize(finalize, decodedDbg);)
 
     if (!buffer.empty())
     {
         if (IGC_IS_FLAG_ENABLED(ShaderDumpEnable))
         {
-            std::string debugFileNameStr = IGC::Debug::GetDumpName(m_currShader, "elf");
+            std::string debugFileNameStr = IGC::Debug::GetDumpName(currShader, "elf");
 
             // Try to create the directory for the file (it might not already exist).
             if (iSTD::ParentDirectoryCreate(debugFileNameStr.c_str()) == 0)
@@ -288,7 +320,7 @@ void DebugInfoPass::EmitDebugInfo(bool finalize, DbgDecoder* decodedDbg)
     if (dbgInfo)
         memcpy_s(dbgInfo, buffer.size(), buffer.data(), buffer.size());
 
-    SProgramOutput* pOutput = m_currShader->ProgramOutput();
+    SProgramOutput* pOutput = currShader->ProgramOutput();
     pOutput->m_debugDataVISA = dbgInfo;
     pOutput->m_debugDataVISASize = dbgInfo ? buffer.size() : 0;
 }
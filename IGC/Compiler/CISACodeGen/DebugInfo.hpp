@@ -101,8 +101,6 @@ namespace IGC
     private:
         static char ID;
         CShaderProgram::KernelShaderMap& kernels;
-        CShader* m_currShader = nullptr;
-        IDebugEmitter* m_pDebugEmitter = nullptr;
 
         virtual bool runOnModule(llvm::Module& M) override;
         virtual bool doInitialization(llvm::Module& M) override;
@@ -114,7 +112,8 @@ namespace IGC
             AU.setPreservesAll();
         }
 
-        void EmitDebugInfo(bool, DbgDecoder*);
+        bool EmitUnit(CShader*, ModuleMetaData*);
+        void EmitDebugInfo(CShader*, IDebugEmitter*, bool, DbgDecoder*);
     };
 
     class CatchAllLineNumber : public llvm::FunctionPass
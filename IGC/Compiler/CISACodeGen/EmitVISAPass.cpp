@@ -35,6 +35,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "HullShaderCodeGen.hpp"
 #include "DomainShaderCodeGen.hpp"
 #include "DeSSA.hpp"
+#include "BlockProfile.hpp"
 #include "messageEncoding.hpp"
 #include "PayloadMapping.hpp"
 #include "VectorProcess.hpp"
@@ -736,6 +737,18 @@ bool EmitPass::runOnFunction(llvm::Function& F)
 
     DenseMap<Instruction*, uint32_t> rootToVISAId;
 
+    // Block profile: measured counts go to vISA's RA; an instrumented build
+    // records which vISA label each profile block id starts at.
+    const uint64_t shaderHash = m_currShader->GetContext()->hash.getAsmHash();
+    const BlockProfile::FunctionCounts* profileCounts = nullptr;
+    if (const BlockProfile* profile = BlockProfile::get())
+    {
+        profileCounts = profile->lookup(shaderHash, F);
+    }
+    const bool dumpBlockMap = IGC_IS_FLAG_ENABLED(DumpBlockProfileMap);
+    const bool isSubroutine = m_FGA && !m_FGA->isGroupHead(&F) && !m_FGA->useStackCall(&F);
+    std::map<unsigned, std::string> profileBlockLabels;
+
     StringRef curSrcFile, curSrcDir;
 
     for (uint i = 0; i < m_pattern->m_numBlocks; i++)
@@ -757,6 +770,28 @@ bool EmitPass::runOnFunction(llvm::Function& F)
             IF_DEBUG_INFO_IF(m_pDebugEmitter, m_pDebugEmitter->EndEncodingMark();)
         }
 
+        unsigned profileId = 0;
+        if ((profileCounts || dumpBlockMap) && getProfileBlockId(block.bb, profileId))
+        {
+            if (profileCounts)
+            {
+                uint64_t count = profileCounts->counts.lookup(profileId);
+                if (i != 0)
+                {
+                    m_encoder->BlockCount(block.id, count);
+                }
+                else
+                {
+                    m_encoder->EntryBlockCount(count, isSubroutine ? &F : nullptr);
+                }
+            }
+            if (dumpBlockMap)
+            {
+                profileBlockLabels[profileId] =
+                    i != 0 ? m_encoder->GetLabelName(block.id) : std::string();
+            }
+        }
+
         // remove cached per lane offset variables if any.
         PerLaneOffsetVars.clear();
 
@@ -888,6 +923,11 @@ bool EmitPass::runOnFunction(llvm::Function& F)
         delete llvmtoVISADump;
     }
 
+    if (dumpBlockMap && !profileBlockLabels.empty())
+    {
+        dumpProfileBlockMap(shaderHash, m_currShader->entry->getName(), F, profileBlockLabels);
+    }
+
     if (!m_FGA || m_FGA->isGroupHead(&F))
     {
         // Cache the arguments list into a vector for faster access
@@ -1022,14 +1062,18 @@ bool EmitPass::runOnFunction(llvm::Function& F)
         return false;
     }
 
+    // OpenCL kernels record these while skipping the SIMD modes, see
+    // COpenCLKernel::checkSIMDCompileConds
     if (m_SimdMode == SIMDMode::SIMD16 &&
         this->m_ShaderDispatchMode == ShaderDispatchMode::NOT_APPLICABLE &&
+        m_pCtx->type != ShaderType::OPENCL_SHADER &&
         IsStage1BestPerf(m_pCtx->m_CgFlag, m_pCtx->m_StagingCtx))
     {
         m_pCtx->m_doSimd32Stage2 = m_currShader->CompileSIMDSize(SIMDMode::SIMD32, *this, F);
     }
 
     if (m_SimdMode == SIMDMode::SIMD8 &&
+        m_pCtx->type != ShaderType::OPENCL_SHADER &&
         IsStage1FastCompile(m_pCtx->m_CgFlag, m_pCtx->m_StagingCtx))
     {
         m_pCtx->m_doSimd16Stage2 = m_currShader->CompileSIMDSize(SIMDMode::SIMD16, *this, F);
@@ -2269,27 +2313,43 @@ void EmitPass::EmitMulPair(GenIntrinsicInst* GII, const SSource Sources[4], cons
         return;
     }
 
-    CVariable* THi = m_currShader->GetNewVariable(
-        Hi->GetNumberElement(), Hi->GetType(), Hi->GetAlign(), Hi->IsUniform(), Hi->getName());
+    // A cross term vanishes when its Hi source is a zero immediate, as for
+    // `x * (i64)c` with a 32-bit unsigned `c`.
+    bool HasL0H1 = !(H1->IsImmediate() && H1->GetImmediateValue() == 0);
+    bool HasL1H0 = !(H0->IsImmediate() && H0->GetImmediateValue() == 0);
+
+    CVariable* THi = Hi;
+    if (HasL0H1 || HasL1H0) {
+        THi = m_currShader->GetNewVariable(
+            Hi->GetNumberElement(), Hi->GetType(), Hi->GetAlign(), Hi->IsUniform(), Hi->getName());
+    }
 
     m_encoder->MulH(THi, L0, L1);
     m_encoder->Push();
 
+    if (!HasL0H1 && !HasL1H0) {
+        return;
+    }
+
     CVariable* T0 = m_currShader->GetNewVariable(
         Hi->GetNumberElement(), Hi->GetType(), Hi->GetAlign(), Hi->IsUniform(),
         CName(Hi->getName(), "tmp"));
 
-    m_encoder->Mul(T0, L0, H1);
-    m_encoder->Push();
+    if (HasL0H1) {
+        m_encoder->Mul(T0, L0, H1);
+        m_encoder->Push();
 
-    m_encoder->Add(THi, THi, T0);
-    m_encoder->Push();
+        m_encoder->Add(HasL1H0 ? THi : Hi, THi, T0);
+        m_encoder->Push();
+    }
 
-    m_encoder->Mul(T0, L1, H0);
-    m_encoder->Push();
+    if (HasL1H0) {
+        m_encoder->Mul(T0, L1, H0);
+        m_encoder->Push();
 
-    m_encoder->Add(Hi, THi, T0);
-    m_encoder->Push();
+        m_encoder->Add(Hi, THi, T0);
+        m_encoder->Push();
+    }
 }
 
 void EmitPass::EmitPtrToPair(GenIntrinsicInst* GII, const SSource Sources[1], const DstModifier& DstMod) {
@@ -9793,6 +9853,11 @@ void EmitPass::emitCall(llvm::CallInst* inst)
         // lifted to use a global vISA variable, just skip the copy.
         if (Dst != Src)
         {
+            // A uniform argument may still be computed per lane by the caller.
+            if (Dst->IsUniform() && !Src->IsUniform())
+            {
+                Src = UniformCopy(Src);
+            }
             emitCopyAll(Dst, Src, Arg.getType());
         }
     }
@@ -10304,6 +10369,8 @@ void EmitPass::emitStackFuncEntry(Function* F)
     uint32_t offsetA = 0;  // visa argument offset
     uint32_t offsetS = 0;  // visa stack offset
     std::vector<CVariable*> argsOnStack;
+    // (uniform argument, per-lane copy it is received in)
+    std::vector<std::pair<CVariable*, CVariable*>> uniformArgs;
     for (auto& Arg : F->args())
     {
         if (!F->hasFnAttribute("IndirectlyCalled"))
@@ -10313,6 +10380,16 @@ void EmitPass::emitStackFuncEntry(Function* F)
         }
 
         CVariable* Dst = m_currShader->getOrCreateArgumentSymbol(&Arg, false, true);
+        CVariable* UniformDst = nullptr;
+        if (Dst->IsUniform())
+        {
+            // The caller still lays the argument out per lane; receive it
+            // that way and read it back from an active lane below.
+            UniformDst = Dst;
+            Dst = m_currShader->GetNewVariable(
+                numLanes(m_currShader->m_dispatchSize), Dst->GetType(),
+                m_currShader->getGRFAlignment(), false, CName(Arg.getName()));
+        }
         // adjust offset for alignment
         uint align = getGRFSize();
         offsetA = int_cast<unsigned>(llvm::alignTo(offsetA, align));
@@ -10337,7 +10414,10 @@ void EmitPass::emitStackFuncEntry(Function* F)
                 {
                     // Directly map the dst register to an alias of ArgBlkVar, and update symbol mapping for future uses
                     Dst = m_currShader->GetNewAlias(ArgBlkVar, Dst->GetType(), (uint16_t)offsetA, Dst->GetNumberElement(), Dst->IsUniform());
-                    m_currShader->UpdateSymbolMap(&Arg, Dst);
+                    if (!UniformDst)
+                    {
+                        m_currShader->UpdateSymbolMap(&Arg, Dst);
+                    }
                 }
                 else
                 {
@@ -10355,12 +10435,23 @@ void EmitPass::emitStackFuncEntry(Function* F)
         {
             argsOnStack.push_back(Dst);
         }
+        if (UniformDst)
+        {
+            uniformArgs.push_back(std::make_pair(UniformDst, Dst));
+        }
     }
     m_encoder->SetStackFunctionArgSize((offsetA + getGRFSize() - 1) / getGRFSize());
 
     // Read all stack-pushed args back into registers
     offsetS = emitStackArgumentLoadOrStore(argsOnStack, false);
 
+    // All active lanes hold the same value for a uniform argument.
+    for (auto& UA : uniformArgs)
+    {
+        m_encoder->Copy(UA.first, UniformCopy(UA.second));
+        m_encoder->Push();
+    }
+
     unsigned totalAllocaSize = 0;
 
     // reserve space for all the alloca in the function subgroup
@@ -30,6 +30,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/PostOrderIterator.h"
 #include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/TinyPtrVector.h"
 #include "llvm/IR/Argument.h"
 #include "llvm/IR/DataLayout.h"
@@ -42,6 +43,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "llvm/IR/Type.h"
 #include "llvm/IR/Value.h"
 #include "llvm/Pass.h"
+#include "llvm/Support/Debug.h"
 #include "llvm/Analysis/TargetFolder.h"
 #include "llvmWrapper/IR/DerivedTypes.h"
 #include "llvmWrapper/IR/Instructions.h"
@@ -64,6 +66,10 @@ using namespace IGC::IGCMD;
 
 using std::ldexp;
 
+#define DEBUG_TYPE "emu64-ops"
+
+STATISTIC(Stat_Emu64InstsSaved, "Number of emulation instructions saved by narrow 64-bit forms");
+
 
 namespace {
 
@@ -96,13 +102,17 @@ namespace {
 
         SmallPtrSet<Instruction*, 32> DeadInsts;
 
+        // Instructions saved in the current function by expanding with
+        // narrower sequences, counted against the full `*_pair` sequences.
+        unsigned NumInstsSaved;
+
     public:
 
         static char ID;
 
         Emu64Ops() : FunctionPass(ID), DL(nullptr), CGC(nullptr), IRB(nullptr),
             Expander(nullptr), TheContext(nullptr), TheModule(nullptr),
-            TheFunction(nullptr) {
+            TheFunction(nullptr), NumInstsSaved(0) {
             initializeEmu64OpsPass(*PassRegistry::getPassRegistry());
         }
 
@@ -132,6 +142,24 @@ namespace {
 
         bool isArg64Cast(BitCastInst* BC) const { return Arg64Casts.count(BC) != 0; }
 
+        // Whether Hi makes Lo/Hi a 32-bit value zero-extended to 64 bits.
+        static bool isZExt32(Value* Hi) {
+            ConstantInt* CHi = dyn_cast<ConstantInt>(Hi);
+            return CHi && CHi->isZero();
+        }
+        // Whether Lo/Hi is a 32-bit value sign-extended to 64 bits.
+        static bool isSExt32(Value* Lo, Value* Hi) {
+            if (ConstantInt* CHi = dyn_cast<ConstantInt>(Hi)) {
+                ConstantInt* CLo = dyn_cast<ConstantInt>(Lo);
+                return CLo && CHi->getSExtValue() == (CLo->isNegative() ? -1 : 0);
+            }
+            BinaryOperator* BO = dyn_cast<BinaryOperator>(Hi);
+            if (!BO || BO->getOpcode() != Instruction::AShr || BO->getOperand(0) != Lo)
+                return false;
+            ConstantInt* ShAmt = dyn_cast<ConstantInt>(BO->getOperand(1));
+            return ShAmt && ShAmt->getZExtValue() == 31;
+        }
+
         Type* getV2Int32Ty(unsigned NumElts = 1) const {
             return IGCLLVM::FixedVectorType::get(IRB->getInt32Ty(), NumElts * 2);
         }
@@ -496,6 +524,7 @@ bool Emu64Ops::runOnFunction(Function& F) {
     ValueMap.clear();
     Arg64Casts.clear();
     DeadInsts.clear();
+    NumInstsSaved = 0;
 
     bool Changed = false;
     Changed |= ThePreprocessor.preprocess(F);
@@ -505,6 +534,10 @@ bool Emu64Ops::runOnFunction(Function& F) {
     Changed |= populatePHIs(F);
     Changed |= removeDeadInsts();
 
+    Stat_Emu64InstsSaved += NumInstsSaved;
+    LLVM_DEBUG(dbgs() << "Emu64Ops: " << F.getName() << ": "
+        << NumInstsSaved << " instruction(s) saved\n");
+
     return Changed;
 }
 
@@ -697,6 +730,18 @@ bool InstExpander::visitAdd(BinaryOperator& BinOp) {
     Value* L1 = nullptr, * H1 = nullptr;
     std::tie(L1, H1) = Emu->getExpandedValues(BinOp.getOperand(1));
 
+    // With a zero Lo on either side (e.g. `x + (y << 32)`) there is no carry
+    // and only Hi needs adding, 1 instruction instead of 3.
+    ConstantInt* CL0 = dyn_cast<ConstantInt>(L0);
+    ConstantInt* CL1 = dyn_cast<ConstantInt>(L1);
+    if ((CL0 && CL0->isZero()) || (CL1 && CL1->isZero())) {
+        Value* Lo = (CL1 && CL1->isZero()) ? L0 : L1;
+        Value* Hi = IRB->CreateAdd(H0, H1);
+        Emu->NumInstsSaved += 2;
+        Emu->setExpandedValues(&BinOp, Lo, Hi);
+        return true;
+    }
+
     GenISAIntrinsic::ID GIID = GenISAIntrinsic::GenISA_add_pair;
     Function* IFunc = GenISAIntrinsic::getDeclaration(Emu->getModule(), GIID);
     IGC_ASSERT(nullptr != IRB);
@@ -718,6 +763,15 @@ bool InstExpander::visitSub(BinaryOperator& BinOp) {
     Value* L1 = nullptr, * H1 = nullptr;
     std::tie(L1, H1) = Emu->getExpandedValues(BinOp.getOperand(1));
 
+    // Subtracting a zero Lo never borrows.
+    ConstantInt* CL1 = dyn_cast<ConstantInt>(L1);
+    if (CL1 && CL1->isZero()) {
+        Value* Hi = IRB->CreateSub(H0, H1);
+        Emu->NumInstsSaved += 2;
+        Emu->setExpandedValues(&BinOp, L0, Hi);
+        return true;
+    }
+
     GenISAIntrinsic::ID GIID = GenISAIntrinsic::GenISA_sub_pair;
     Function* IFunc = GenISAIntrinsic::getDeclaration(Emu->getModule(), GIID);
     IGC_ASSERT(nullptr != IRB);
@@ -739,6 +793,24 @@ bool InstExpander::visitMul(BinaryOperator& BinOp) {
     Value* L1 = nullptr, * H1 = nullptr;
     std::tie(L1, H1) = Emu->getExpandedValues(BinOp.getOperand(1));
 
+    // The product of two zero- (or sign-) extended 32-bit values is the full
+    // 32x32 product: `mul` and `mulh`, instead of the 6 instructions of
+    // `mul_pair`. This is the common `(i64)a * (i64)b` index computation.
+    GenISAIntrinsic::ID MulHID = GenISAIntrinsic::no_intrinsic;
+    if (Emu->isZExt32(H0) && Emu->isZExt32(H1))
+        MulHID = GenISAIntrinsic::GenISA_umulH;
+    else if (Emu->isSExt32(L0, H0) && Emu->isSExt32(L1, H1))
+        MulHID = GenISAIntrinsic::GenISA_imulH;
+    if (MulHID != GenISAIntrinsic::no_intrinsic) {
+        Function* MulH = GenISAIntrinsic::getDeclaration(
+            Emu->getModule(), MulHID, IRB->getInt32Ty());
+        Value* Lo = IRB->CreateMul(L0, L1);
+        Value* Hi = IRB->CreateCall2(MulH, L0, L1);
+        Emu->NumInstsSaved += 4;
+        Emu->setExpandedValues(&BinOp, Lo, Hi);
+        return true;
+    }
+
     GenISAIntrinsic::ID GIID = GenISAIntrinsic::GenISA_mul_pair;
     Function* IFunc = GenISAIntrinsic::getDeclaration(Emu->getModule(), GIID);
     IGC_ASSERT(nullptr != IRB);
@@ -25,6 +25,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 ======================= end_copyright_notice ==================================*/
 
 #include "Compiler/CISACodeGen/EstimateFunctionSize.h"
+#include "Compiler/CISACodeGen/BlockProfile.hpp"
 #include "Compiler/CodeGenContextWrapper.hpp"
 #include "Compiler/MetaDataUtilsWrapper.h"
 #include "Compiler/CodeGenPublic.h"
@@ -651,6 +652,32 @@ void EstimateFunctionSize::reduceKernelSize() {
         };
         std::sort(SortedKernelFunctions.begin(), SortedKernelFunctions.end(), Cmp);
 
+        // With a block profile, functions that never ran are trimmed first,
+        // then those that ran, the least called first. Functions without an
+        // entry count were inlined in the instrumented build and go last, so
+        // the trimmed set can only shrink relative to that build.
+        //
+        // When the trimmed set does change, the kernel's CFG changes with it.
+        // Its checksum then no longer matches, so Layout and vISA RA ignore
+        // the kernel's block counts until it is profiled again from this
+        // build. Because the set only shrinks from one round to the next, it
+        // settles after a few rounds; from then on both the inlining and the
+        // block counts apply.
+        auto CGW = getAnalysisIfAvailable<CodeGenContextWrapper>();
+        if (const BlockProfile* Profile = CGW ? BlockProfile::get() : nullptr) {
+            uint64_t Hash = CGW->getCodeGenContext()->hash.getAsmHash();
+            auto Rank = [&](const FunctionNode* Node) {
+                uint64_t Count = 0;
+                if (!Profile->getEntryCount(Hash, Node->F->getName(), Count))
+                    return std::make_pair(2, (uint64_t)0);
+                return Count == 0 ? std::make_pair(0, (uint64_t)0) : std::make_pair(1, Count);
+            };
+            std::stable_sort(SortedKernelFunctions.begin(), SortedKernelFunctions.end(),
+                [&](const FunctionNode* LHS, const FunctionNode* RHS) {
+                    return Rank(LHS) < Rank(RHS);
+                });
+        }
+
         if( ( IGC_GET_FLAG_VALUE( PrintControlKernelTotalSize ) & 0x4 ) != 0 )
         {
             std::cout << "Kernel " << Kernel->F->getName().str() << " has " << SortedKernelFunctions.size() << " funcs to consider for trimming" << std::endl;
@@ -36,19 +36,38 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "llvmWrapper/IR/DerivedTypes.h"
 #include "llvmWrapper/IR/IRBuilder.h"
 #include <llvm/IR/Function.h>
+#include <llvm/IR/DebugInfo.h>
 #include <llvm/IR/Instructions.h>
 #include <llvm/ADT/SmallVector.h>
+#include <llvm/Analysis/LoopInfo.h>
+#include <llvm/Support/CommandLine.h>
+#include <llvm/Transforms/Utils/BasicBlockUtils.h>
 #include <llvm/Transforms/Utils/Local.h>
 #include "common/LLVMWarningsPop.hpp"
+#include "common/debug/Debug.hpp"
 #include "Probe/Assertion.h"
+#include <fstream>
+#include <sstream>
 
 #define MAX_ALLOCA_PROMOTE_GRF_NUM      48
 #define MAX_PRESSURE_GRF_NUM            90
+// smallest hot window worth splitting an array for
+#define MIN_HYBRID_HOT_ELEMENTS         8
 
 using namespace llvm;
 using namespace IGC;
 using namespace IGC::IGCMD;
 
+// for lit tests; same as EnableHybridPrivMemPromotion
+static cl::opt<bool> HybridPrivMemPromotion(
+    "igc-hybrid-priv-mem", cl::init(false), cl::Hidden,
+    cl::desc("Enable hybrid promotion in LowerGEPForPrivMem (EnableHybridPrivMemPromotion)"));
+
+static bool IsHybridPromotionEnabled()
+{
+    return IGC_IS_FLAG_ENABLED(EnableHybridPrivMemPromotion) || HybridPrivMemPromotion;
+}
+
 namespace IGC {
     /// @brief  LowerGEPForPrivMem pass is used for lowering the allocas identified while visiting the alloca instructions
     ///         and then inserting insert/extract elements instead of load stores. This allows us
@@ -71,7 +90,12 @@ namespace IGC {
             AU.addRequired<MetaDataUtilsWrapper>();
             AU.addRequired<CodeGenContextWrapper>();
             AU.addRequired<DominatorTreeWrapperPass>();
-            AU.setPreservesCFG();
+            AU.addRequired<LoopInfoWrapperPass>();
+            // hybrid promotion branches on the index of dynamic accesses
+            if (!IsHybridPromotionEnabled())
+            {
+                AU.setPreservesCFG();
+            }
         }
 
         virtual bool runOnFunction(llvm::Function& F) override;
@@ -89,7 +113,17 @@ namespace IGC {
         void handleAllocaInst(llvm::AllocaInst* pAlloca);
 
         bool CheckIfAllocaPromotable(llvm::AllocaInst* pAlloca);
+        unsigned int GetAllowedAllocaSizeInBytes() const;
+        unsigned int GetPressureOverLiverange(llvm::AllocaInst* pAlloca, unsigned int& lowId, unsigned int& highId) const;
         bool IsNativeType(Type* type);
+
+        /// Hybrid promotion for arrays too large for GRF: a window of numHot
+        /// elements is promoted, the rest stays in a smaller private array
+        bool CheckIfAllocaHybridPromotable(llvm::AllocaInst* pAlloca, unsigned int& numHot);
+        void handleHybridAllocaInst(llvm::AllocaInst* pAlloca, unsigned int numHot);
+        /// Loop-depth based estimate of how often an instruction runs
+        uint64_t GetAccessWeight(llvm::Instruction* I) const;
+        void emitOptReport(llvm::Function& F) const;
         /// Conservatively check if a store allow an Alloca to be uniform
         bool IsUniformStore(llvm::StoreInst* pStore);
 
@@ -100,7 +134,21 @@ namespace IGC {
         const llvm::DataLayout* m_pDL = nullptr;
         CodeGenContext* m_ctx = nullptr;
         DominatorTree* m_DT = nullptr;
+        LoopInfo* m_LI = nullptr;
         std::vector<llvm::AllocaInst*> m_allocasToPrivMem;
+
+        struct HybridAlloca
+        {
+            llvm::AllocaInst* pAlloca;
+            unsigned int numHot;
+        };
+        std::vector<HybridAlloca> m_hybridAllocas;
+        /// access weights taken before any block is split (LoopInfo is not updated)
+        llvm::DenseMap<llvm::Instruction*, uint64_t> m_hybridAccessWeights;
+
+        /// opt report (EnableOptReportLowerGEPForPrivMem)
+        std::vector<std::string> m_optReport;
+        uint64_t m_trafficEliminated = 0;
         RegisterPressureEstimate* m_pRegisterPressureEstimate = nullptr;
         llvm::Function* m_pFunc = nullptr;
 
@@ -132,6 +180,7 @@ IGC_INITIALIZE_PASS_BEGIN(LowerGEPForPrivMem, PASS_FLAG, PASS_DESCRIPTION, PASS_
 IGC_INITIALIZE_PASS_DEPENDENCY(RegisterPressureEstimate)
 IGC_INITIALIZE_PASS_DEPENDENCY(MetaDataUtilsWrapper)
 IGC_INITIALIZE_PASS_DEPENDENCY(CodeGenContextWrapper)
+IGC_INITIALIZE_PASS_DEPENDENCY(LoopInfoWrapperPass)
 IGC_INITIALIZE_PASS_END(LowerGEPForPrivMem, PASS_FLAG, PASS_DESCRIPTION, PASS_CFG_ONLY, PASS_ANALYSIS)
 
 char LowerGEPForPrivMem::ID = 0;
@@ -169,6 +218,7 @@ bool LowerGEPForPrivMem::runOnFunction(llvm::Function& F)
     IGC_ASSERT(nullptr != pCtxWrapper);
     m_ctx = pCtxWrapper->getCodeGenContext();
     m_DT = &getAnalysis<DominatorTreeWrapperPass>().getDomTree();
+    m_LI = &getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
 
     MetaDataUtils* pMdUtils = getAnalysis<MetaDataUtilsWrapper>().getMetaDataUtils();
     IGC_ASSERT(nullptr != pMdUtils);
@@ -188,6 +238,12 @@ bool LowerGEPForPrivMem::runOnFunction(llvm::Function& F)
     m_pRegisterPressureEstimate->buildRPMapPerInstruction();
 
     m_allocasToPrivMem.clear();
+    // instruction numbers are per function, so are the promoted live ranges
+    m_promotedLiveranges.clear();
+    m_hybridAllocas.clear();
+    m_hybridAccessWeights.clear();
+    m_optReport.clear();
+    m_trafficEliminated = 0;
     visit(F);
 
     std::vector<llvm::AllocaInst*>& allocaToHande = m_allocasToPrivMem;
@@ -195,6 +251,12 @@ bool LowerGEPForPrivMem::runOnFunction(llvm::Function& F)
     {
         handleAllocaInst(pAlloca);
     }
+    // Hybrid ones split blocks, so go after anything that needs m_DT
+    for (auto& hybrid : m_hybridAllocas)
+    {
+        handleHybridAllocaInst(hybrid.pAlloca, hybrid.numHot);
+        allocaToHande.push_back(hybrid.pAlloca);
+    }
 
     // Last remove alloca instructions
     for (auto pInst : allocaToHande)
@@ -205,6 +267,11 @@ bool LowerGEPForPrivMem::runOnFunction(llvm::Function& F)
         }
     }
 
+    if (IGC_IS_FLAG_ENABLED(EnableOptReportLowerGEPForPrivMem) && !m_optReport.empty())
+    {
+        emitOptReport(F);
+    }
+
     if (!allocaToHande.empty())
         DumpLLVMIR(m_ctx, "AfterLowerGEP");
     // IR changed only if we had alloca instruction to optimize
@@ -269,15 +336,51 @@ bool LowerGEPForPrivMem::IsNativeType(Type* type)
     return true;
 }
 
-bool LowerGEPForPrivMem::CheckIfAllocaPromotable(llvm::AllocaInst* pAlloca)
+// Collects the loads and stores reaching the alloca through GEPs and
+// bitcasts. Returns false if some other user is found.
+static bool CollectAllocaAccesses(Instruction* I, SmallVectorImpl<Instruction*>& accesses)
 {
-    // vla is not promotable
-    IGC_ASSERT(pAlloca != nullptr);
-    if (IsVariableSizeAlloca(*pAlloca))
-        return false;
+    for (auto* U : I->users())
+    {
+        Instruction* inst = cast<Instruction>(U);
+        if (isa<GetElementPtrInst>(inst) || isa<BitCastInst>(inst))
+        {
+            if (!CollectAllocaAccesses(inst, accesses))
+                return false;
+        }
+        else if (isa<LoadInst>(inst) || isa<StoreInst>(inst))
+        {
+            accesses.push_back(inst);
+        }
+        else if (!isa<IntrinsicInst>(inst))
+        {
+            return false;
+        }
+    }
+    return true;
+}
 
-    bool isUniformAlloca = pAlloca->getMetadata("uniform") != nullptr;
-    unsigned int allocaSize = extractConstAllocaSize(pAlloca);
+static Type* GetAccessType(Instruction* I)
+{
+    if (auto* pStore = dyn_cast<StoreInst>(I))
+        return pStore->getValueOperand()->getType();
+    return I->getType();
+}
+
+static uint64_t GetAccessSize(Instruction* I, const DataLayout& DL)
+{
+    return DL.getTypeStoreSize(GetAccessType(I));
+}
+
+uint64_t LowerGEPForPrivMem::GetAccessWeight(Instruction* I) const
+{
+    // assume every loop runs 8 iterations
+    unsigned int depth = m_LI->getLoopDepth(I->getParent());
+    return 1ULL << std::min(3 * depth, 30U);
+}
+
+unsigned int LowerGEPForPrivMem::GetAllowedAllocaSizeInBytes() const
+{
     unsigned int allowedAllocaSizeInBytes = MAX_ALLOCA_PROMOTE_GRF_NUM * 4;
 
     // scale alloc size based on the number of GRFs we have
@@ -292,6 +395,47 @@ bool LowerGEPForPrivMem::CheckIfAllocaPromotable(llvm::AllocaInst* pAlloca)
 
         allowedAllocaSizeInBytes = allowedAllocaSizeInBytes / d;
     }
+    return allowedAllocaSizeInBytes;
+}
+
+// Max estimated pressure over the live range of the alloca, including the
+// allocas already promoted over an intersecting range.
+unsigned int LowerGEPForPrivMem::GetPressureOverLiverange(
+    llvm::AllocaInst* pAlloca, unsigned int& lowestAssignedNumber, unsigned int& highestAssignedNumber) const
+{
+    GetAllocaLiverange(pAlloca, lowestAssignedNumber, highestAssignedNumber, m_pRegisterPressureEstimate);
+
+    unsigned int pressure = 0;
+    for (unsigned int i = lowestAssignedNumber; i <= highestAssignedNumber; i++)
+    {
+        pressure = std::max(
+            pressure, m_pRegisterPressureEstimate->getRegisterPressureForInstructionFromRPMap(i));
+    }
+
+    for (auto it : m_promotedLiveranges)
+    {
+        // check interval intersection
+        if ((it.lowId < lowestAssignedNumber && it.highId > lowestAssignedNumber) ||
+            (it.lowId > lowestAssignedNumber && it.lowId < highestAssignedNumber))
+        {
+            pressure += it.varSize;
+        }
+    }
+    return pressure;
+}
+
+bool LowerGEPForPrivMem::CheckIfAllocaPromotable(llvm::AllocaInst* pAlloca)
+{
+    // vla is not promotable
+    IGC_ASSERT(pAlloca != nullptr);
+    if (IsVariableSizeAlloca(*pAlloca))
+        return false;
+
+    bool isUniformAlloca = pAlloca->getMetadata("uniform") != nullptr;
+    unsigned int allocaSize = extractConstAllocaSize(pAlloca);
+    unsigned int allowedAllocaSizeInBytes = GetAllowedAllocaSizeInBytes();
+    float grfRatio = m_ctx->getNumGRFPerThread() / 128.0f;
+
     Type* baseType = nullptr;
     if (!CanUseSOALayout(pAlloca, baseType))
     {
@@ -323,37 +467,75 @@ bool LowerGEPForPrivMem::CheckIfAllocaPromotable(llvm::AllocaInst* pAlloca)
     // then estimate how much changing this alloca to register adds to the pressure at that block.
     unsigned int lowestAssignedNumber = 0xFFFFFFFF;
     unsigned int highestAssignedNumber = 0;
-
-    GetAllocaLiverange(pAlloca, lowestAssignedNumber, highestAssignedNumber, m_pRegisterPressureEstimate);
+    unsigned int pressure = GetPressureOverLiverange(pAlloca, lowestAssignedNumber, highestAssignedNumber);
 
     uint32_t maxGRFPressure = (uint32_t)(grfRatio * MAX_PRESSURE_GRF_NUM * 4);
 
-    unsigned int pressure = 0;
-    for (unsigned int i = lowestAssignedNumber; i <= highestAssignedNumber; i++)
+    if (allocaSize + pressure > maxGRFPressure)
     {
-        pressure = std::max(
-            pressure, m_pRegisterPressureEstimate->getRegisterPressureForInstructionFromRPMap(i));
+        return false;
     }
+    PromotedLiverange liverange;
+    liverange.lowId = lowestAssignedNumber;
+    liverange.highId = highestAssignedNumber;
+    liverange.varSize = allocaSize;
+    m_promotedLiveranges.push_back(liverange);
+    return true;
+}
 
-    for (auto it : m_promotedLiveranges)
+static Type* GetBaseType(Type* pType);
+
+bool LowerGEPForPrivMem::CheckIfAllocaHybridPromotable(llvm::AllocaInst* pAlloca, unsigned int& numHot)
+{
+    if (IsVariableSizeAlloca(*pAlloca) || pAlloca->getMetadata("uniform") != nullptr)
+        return false;
+
+    Type* baseType = nullptr;
+    if (!CanUseSOALayout(pAlloca, baseType) || !IsNativeType(baseType) || baseType->isVectorTy())
     {
-        // check interval intersection
-        if ((it.lowId < lowestAssignedNumber && it.highId > lowestAssignedNumber) ||
-            (it.lowId > lowestAssignedNumber && it.lowId < highestAssignedNumber))
+        return false;
+    }
+
+    // only scalar accesses of exactly one element, so that each access goes
+    // either to the promoted window or to the remaining array
+    unsigned int eltSize = int_cast<unsigned int>(m_pDL->getTypeAllocSize(baseType));
+    SmallVector<Instruction*, 16> accesses;
+    if (!CollectAllocaAccesses(pAlloca, accesses))
+        return false;
+    for (auto* access : accesses)
+    {
+        Type* accessType = GetAccessType(access);
+        if (!(accessType->isIntegerTy() || accessType->isFloatingPointTy()) ||
+            m_pDL->getTypeAllocSize(accessType) != eltSize)
         {
-            pressure += it.varSize;
+            return false;
         }
     }
 
-    if (allocaSize + pressure > maxGRFPressure)
-    {
+    unsigned int lowestAssignedNumber = 0xFFFFFFFF;
+    unsigned int highestAssignedNumber = 0;
+    unsigned int pressure = GetPressureOverLiverange(pAlloca, lowestAssignedNumber, highestAssignedNumber);
+
+    float grfRatio = m_ctx->getNumGRFPerThread() / 128.0f;
+    uint32_t maxGRFPressure = (uint32_t)(grfRatio * MAX_PRESSURE_GRF_NUM * 4);
+    if (pressure >= maxGRFPressure)
         return false;
-    }
+
+    unsigned int budget = std::min(GetAllowedAllocaSizeInBytes(), maxGRFPressure - pressure);
+    unsigned int numElts = extractConstAllocaSize(pAlloca) / eltSize;
+    numHot = budget / eltSize;
+    if (numHot < MIN_HYBRID_HOT_ELEMENTS || numHot >= numElts)
+        return false;
+
     PromotedLiverange liverange;
     liverange.lowId = lowestAssignedNumber;
     liverange.highId = highestAssignedNumber;
-    liverange.varSize = allocaSize;
+    liverange.varSize = numHot * eltSize;
     m_promotedLiveranges.push_back(liverange);
+    for (auto* access : accesses)
+    {
+        m_hybridAccessWeights[access] = GetAccessWeight(access);
+    }
     return true;
 }
 
@@ -492,11 +674,41 @@ void LowerGEPForPrivMem::visitAllocaInst(AllocaInst& I)
     // Alloca should always be private memory
     IGC_ASSERT(nullptr != I.getType());
     IGC_ASSERT(I.getType()->getAddressSpace() == ADDRESS_SPACE_PRIVATE);
+    bool optReport = IGC_IS_FLAG_ENABLED(EnableOptReportLowerGEPForPrivMem);
     if (!CheckIfAllocaPromotable(&I))
     {
+        unsigned int numHot = 0;
+        if (IsHybridPromotionEnabled() &&
+            CheckIfAllocaHybridPromotable(&I, numHot))
+        {
+            m_hybridAllocas.push_back({ &I, numHot });
+            return;
+        }
         // alloca size extends remain per-lane-reg space
+        if (optReport)
+        {
+            std::stringstream line;
+            line << "  " << I.getName().str() << ": left in scratch";
+            m_optReport.push_back(line.str());
+        }
         return;
     }
+    if (optReport)
+    {
+        uint64_t traffic = 0;
+        SmallVector<Instruction*, 16> accesses;
+        CollectAllocaAccesses(&I, accesses);
+        for (auto* access : accesses)
+        {
+            traffic += GetAccessWeight(access) * GetAccessSize(access, *m_pDL);
+        }
+        m_trafficEliminated += traffic;
+        std::stringstream line;
+        line << "  " << I.getName().str() << ": promoted to GRF ("
+            << (IsVariableSizeAlloca(I) ? 0 : extractConstAllocaSize(&I))
+            << " bytes), est. private traffic eliminated: " << traffic << " bytes";
+        m_optReport.push_back(line.str());
+    }
     m_allocasToPrivMem.push_back(&I);
 }
 
@@ -733,3 +945,201 @@ void TransposeHelperPromote::handleStoreInst(
     IRB.CreateStore(pIns, pVecAlloca);
     pStore->eraseFromParent();
 }
+
+// Only records the scalarized index of each access; the hybrid promotion
+// needs all of them before picking which elements to promote.
+class TransposeHelperCollect : public TransposeHelper
+{
+public:
+    void handleLoadInst(
+        LoadInst* pLoad,
+        Value* pScalarizedIdx)
+    {
+        accesses.push_back(std::make_pair(pLoad, pScalarizedIdx));
+    }
+    void handleStoreInst(
+        StoreInst* pStore,
+        Value* pScalarizedIdx)
+    {
+        accesses.push_back(std::make_pair(pStore, pScalarizedIdx));
+    }
+    std::vector<std::pair<Instruction*, Value*>> accesses;
+    TransposeHelperCollect() : TransposeHelper(false) {}
+};
+
+// Hybrid promotion of an array of N elements where only H fit in GRF:
+//
+//   %a = alloca [N x float]
+//
+// becomes
+//
+//   %hot  = alloca <H x float>           ; elements [S, S+H), promoted
+//   %cold = alloca [N-H x float]         ; the others, left in scratch
+//
+// Accesses with a constant index go to one of the two directly. A dynamic
+// index branches on (idx - S) <u H. The window start S is the one covering
+// the most (loop weighted) constant index accesses.
+void LowerGEPForPrivMem::handleHybridAllocaInst(llvm::AllocaInst* pAlloca, unsigned int numHot)
+{
+    Type* pType = pAlloca->getType()->getPointerElementType();
+    Type* pBaseType = GetBaseType(pType)->getScalarType();
+    IGC_ASSERT(pBaseType);
+    unsigned int eltSize = int_cast<unsigned int>(m_pDL->getTypeAllocSize(pBaseType));
+    unsigned int numElts = extractConstAllocaSize(pAlloca) / eltSize;
+    IGC_ASSERT(numHot < numElts);
+
+    TransposeHelperCollect helper;
+    {
+        IRBuilder<> IRB(pAlloca);
+        helper.HandleAllocaSources(pAlloca, IRB.getInt32(0));
+    }
+
+    // pick the window start
+    unsigned int windowStart = 0;
+    uint64_t bestWeight = 0;
+    for (auto& candidate : helper.accesses)
+    {
+        auto* C = dyn_cast<ConstantInt>(candidate.second);
+        if (!C)
+            continue;
+        unsigned int start = (unsigned int)std::min<uint64_t>(C->getZExtValue(), numElts - numHot);
+        uint64_t weight = 0;
+        for (auto& access : helper.accesses)
+        {
+            auto* idx = dyn_cast<ConstantInt>(access.second);
+            if (idx && idx->getZExtValue() >= start && idx->getZExtValue() < start + numHot)
+                weight += m_hybridAccessWeights.lookup(access.first);
+        }
+        if (weight > bestWeight || (weight == bestWeight && start < windowStart))
+        {
+            bestWeight = weight;
+            windowStart = start;
+        }
+    }
+
+    IGCLLVM::IRBuilder<> AllocaBuilder(pAlloca);
+    AllocaInst* pHot = AllocaBuilder.CreateAlloca(
+        IGCLLVM::FixedVectorType::get(pBaseType, numHot), nullptr, pAlloca->getName() + ".hot");
+    // the remaining elements keep the regular private memory lowering
+    AllocaInst* pCold = AllocaBuilder.CreateAlloca(
+        ArrayType::get(pBaseType, numElts - numHot), nullptr, pAlloca->getName() + ".cold");
+
+    auto hotLoad = [&](IRBuilder<>& IRB, Value* idx, Type* Ty) {
+        return loadEltsFromVecAlloca(1, pHot, IRB.CreateSub(idx, IRB.getInt32(windowStart)), IRB, Ty);
+    };
+    auto hotStore = [&](IRBuilder<>& IRB, Value* idx, Value* val) {
+        Value* pVec = IRB.CreateLoad(pHot);
+        val = IRB.CreateBitCast(val, pBaseType);
+        pVec = IRB.CreateInsertElement(pVec, val, IRB.CreateSub(idx, IRB.getInt32(windowStart)));
+        IRB.CreateStore(pVec, pHot);
+    };
+    auto coldPtr = [&](IRBuilder<>& IRB, Value* idx, Type* Ty) {
+        // elements past the window move down by numHot
+        Value* coldIdx = IRB.CreateSub(idx, IRB.getInt32(numHot));
+        if (windowStart > 0)
+        {
+            coldIdx = IRB.CreateSelect(IRB.CreateICmpULT(idx, IRB.getInt32(windowStart)), idx, coldIdx);
+        }
+        Value* gepIdx[] = { IRB.getInt32(0), coldIdx };
+        Value* ptr = IRB.CreateInBoundsGEP(pCold, gepIdx);
+        return IRB.CreateBitCast(ptr, PointerType::get(Ty, ADDRESS_SPACE_PRIVATE));
+    };
+
+    uint64_t traffic = 0;
+    unsigned int numSplitAccesses = 0;
+    for (auto& access : helper.accesses)
+    {
+        Instruction* I = access.first;
+        Value* idx = access.second;
+        uint64_t weight = m_hybridAccessWeights.lookup(I) * eltSize;
+        auto* StoreI = dyn_cast<StoreInst>(I);
+        Type* Ty = GetAccessType(I);
+
+        if (auto* C = dyn_cast<ConstantInt>(idx))
+        {
+            bool isHot = C->getZExtValue() >= windowStart && C->getZExtValue() < windowStart + numHot;
+            IRBuilder<> IRB(I);
+            if (StoreI)
+            {
+                if (isHot)
+                    hotStore(IRB, idx, StoreI->getValueOperand());
+                else
+                    IRB.CreateStore(StoreI->getValueOperand(), coldPtr(IRB, idx, Ty));
+            }
+            else
+            {
+                Value* val = isHot ? hotLoad(IRB, idx, Ty) : IRB.CreateLoad(coldPtr(IRB, idx, Ty));
+                I->replaceAllUsesWith(val);
+            }
+            traffic += isHot ? weight : 0;
+            I->eraseFromParent();
+            continue;
+        }
+
+        IRBuilder<> IRB(I);
+        Value* inWindow = IRB.CreateICmpULT(
+            IRB.CreateSub(idx, IRB.getInt32(windowStart)), IRB.getInt32(numHot));
+        Instruction* ThenTerm = nullptr;
+        Instruction* ElseTerm = nullptr;
+        SplitBlockAndInsertIfThenElse(inWindow, I, &ThenTerm, &ElseTerm);
+        IRBuilder<> HotIRB(ThenTerm);
+        IRBuilder<> ColdIRB(ElseTerm);
+        if (StoreI)
+        {
+            hotStore(HotIRB, idx, StoreI->getValueOperand());
+            ColdIRB.CreateStore(StoreI->getValueOperand(), coldPtr(ColdIRB, idx, Ty));
+        }
+        else
+        {
+            Value* hotVal = hotLoad(HotIRB, idx, Ty);
+            Value* coldVal = ColdIRB.CreateLoad(coldPtr(ColdIRB, idx, Ty));
+            PHINode* phi = PHINode::Create(Ty, 2, "", I);
+            phi->addIncoming(hotVal, ThenTerm->getParent());
+            phi->addIncoming(coldVal, ElseTerm->getParent());
+            I->replaceAllUsesWith(phi);
+        }
+        // assume dynamic indices are spread over the whole array
+        traffic += weight * numHot / numElts;
+        ++numSplitAccesses;
+        I->eraseFromParent();
+    }
+    helper.EraseDeadCode();
+
+    // The variable now lives in two allocas, one of them with a different
+    // element order, which a single dbg.declare cannot describe. Drop the
+    // location rather than leave it on the alloca that is about to go.
+    for (auto* DbgUse : FindDbgAddrUses(pAlloca))
+    {
+        DbgUse->eraseFromParent();
+    }
+
+    if (IGC_IS_FLAG_ENABLED(EnableOptReportLowerGEPForPrivMem))
+    {
+        m_trafficEliminated += traffic;
+        std::stringstream line;
+        line << "  " << pAlloca->getName().str() << ": split, elements ["
+            << windowStart << ", " << windowStart + numHot << ") of " << numElts
+            << " promoted to GRF, " << numSplitAccesses << " dynamic accesses branch"
+            << ", est. private traffic eliminated: " << traffic << " bytes";
+        m_optReport.push_back(line.str());
+    }
+}
+
+void LowerGEPForPrivMem::emitOptReport(llvm::Function& F) const
+{
+    std::stringstream report;
+    report << "Function " << F.getName().str() << std::endl;
+    for (auto& line : m_optReport)
+    {
+        report << line << std::endl;
+    }
+    report << "Est. private traffic eliminated: " << m_trafficEliminated << " bytes" << std::endl;
+
+    IGC::Debug::ods() << report.str();
+
+    std::stringstream optReportFile;
+    optReportFile << IGC::Debug::GetShaderOutputFolder() << "LowerGEPForPrivMem.opt";
+    std::ofstream optReportStream;
+    optReportStream.open(optReportFile.str(), std::ios::app);
+    optReportStream << report.str();
+}
@@ -31,10 +31,14 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <llvmWrapper/Analysis/TargetLibraryInfo.h>
 #include <llvm/Analysis/AliasAnalysis.h>
 #include <llvm/Analysis/InstructionSimplify.h>
+#include <llvm/Analysis/LoopInfo.h>
+#include <llvm/Analysis/PostDominators.h>
 #include <llvm/Analysis/ScalarEvolution.h>
 #include <llvm/Analysis/ScalarEvolutionExpressions.h>
 #include <llvm/Analysis/ValueTracking.h>
+#include <llvm/IR/CFG.h>
 #include <llvm/IR/DataLayout.h>
+#include <llvm/IR/Dominators.h>
 #include <llvm/IR/Function.h>
 #include <llvm/IR/GlobalAlias.h>
 #include <llvm/IR/IRBuilder.h>
@@ -51,11 +55,16 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Compiler/MetaDataUtilsWrapper.h"
 #include "Compiler/CISACodeGen/WIAnalysis.hpp"
 #include "Compiler/CISACodeGen/MemOpt.h"
+#include "common/debug/Debug.hpp"
 #include "Probe/Assertion.h"
 
+#include <fstream>
+#include <sstream>
+
 using namespace llvm;
 using namespace IGC;
 using namespace IGC::IGCMD;
+using namespace IGC::Debug;
 
 DEBUG_COUNTER(MergeLoadCounter, "memopt-merge-load",
     "Controls count of merged loads");
@@ -75,11 +84,21 @@ namespace {
     //   the non-tailing store is merged into the tailing one, iff there's no
     //   memory dependency between them which may results in different result.
     //
+    // When EnableMemOptCrossBB is set, the same scan is also applied over a
+    // chain of control-equivalent BBs, i.e. BB A and B where A dominates B, B
+    // post-dominates A and both are in the same loop. Memory references in the
+    // BBs between A and B (e.g. small if-converted regions) are never merged
+    // but are put into the check list so that the alias check covers every
+    // path from A to B.
+    //
     class MemOpt : public FunctionPass {
         const DataLayout* DL;
         AliasAnalysis* AA;
         ScalarEvolution* SE;
         WIAnalysis* WI;
+        DominatorTree* DT;
+        PostDominatorTree* PDT;
+        LoopInfo* LI;
 
         CodeGenContext* CGC;
         TargetLibraryInfo* TLI;
@@ -97,11 +116,29 @@ namespace {
         typedef std::vector<std::pair<Instruction*, unsigned> > MemRefListTy;
         typedef std::vector<Instruction*> TrivialMemRefListTy;
 
+        // A chain of control-equivalent BBs in the dominance order. Each entry
+        // is a BB and whether its memory references may be merged (i.e. it's
+        // a chain member) or are only checked for dependency (i.e. it's a BB
+        // in between two chain members.)
+        typedef SmallVector<std::pair<BasicBlock*, bool>, 8> BBChainTy;
+
+        // Memory references from BBs in between chain members. They are kept
+        // in the memory reference list for the dependency check only.
+        SmallPtrSet<Instruction*, 32> CheckOnlyMemRefs;
+
+        // Statistics for the opt report.
+        unsigned NumMergedLoads = 0;
+        unsigned NumMergedStores = 0;
+        unsigned NumNewLoads = 0;
+        unsigned NumNewStores = 0;
+        unsigned NumCrossBBMerges = 0;
+
     public:
         static char ID;
 
         MemOpt(bool AllowNegativeSymPtrsForLoad = false) :
             FunctionPass(ID), DL(nullptr), AA(nullptr), SE(nullptr), WI(nullptr),
+            DT(nullptr), PDT(nullptr), LI(nullptr),
             CGC(nullptr), AllowNegativeSymPtrsForLoad(AllowNegativeSymPtrsForLoad) {
             initializeMemOptPass(*PassRegistry::getPassRegistry());
         }
@@ -117,10 +154,28 @@ namespace {
             AU.addRequired<TargetLibraryInfoWrapperPass>();
             AU.addRequired<ScalarEvolutionWrapperPass>();
             AU.addRequired<WIAnalysis>();
+            AU.addRequired<DominatorTreeWrapperPass>();
+            AU.addRequired<PostDominatorTreeWrapperPass>();
+            AU.addRequired<LoopInfoWrapperPass>();
         }
 
         void buildProfitVectorLengths(Function& F);
 
+        void buildBBChains(Function& F, SmallVectorImpl<BBChainTy>& Chains) const;
+        bool collectBBsInBetween(BasicBlock* From, BasicBlock* To,
+            SmallVectorImpl<BasicBlock*>& InBetween) const;
+        bool optimizeChain(const BBChainTy& Chain);
+
+        bool isCheckOnly(const Instruction* I) const {
+            return CheckOnlyMemRefs.count(I) != 0;
+        }
+
+        bool isCrossBB(const Instruction* A, const Instruction* B) const {
+            return A->getParent() != B->getParent();
+        }
+
+        void emitOptReport(Function& F) const;
+
         bool mergeLoad(LoadInst* LeadingLoad, MemRefListTy::iterator MI,
             MemRefListTy& MemRefs, TrivialMemRefListTy& ToOpt);
         bool mergeStore(StoreInst* LeadingStore, MemRefListTy::iterator MI,
@@ -399,6 +454,9 @@ IGC_INITIALIZE_PASS_DEPENDENCY(MetaDataUtilsWrapper)
 IGC_INITIALIZE_PASS_DEPENDENCY(AAResultsWrapperPass)
 IGC_INITIALIZE_PASS_DEPENDENCY(TargetLibraryInfoWrapperPass)
 IGC_INITIALIZE_PASS_DEPENDENCY(WIAnalysis)
+IGC_INITIALIZE_PASS_DEPENDENCY(DominatorTreeWrapperPass)
+IGC_INITIALIZE_PASS_DEPENDENCY(PostDominatorTreeWrapperPass)
+IGC_INITIALIZE_PASS_DEPENDENCY(LoopInfoWrapperPass)
 IGC_INITIALIZE_PASS_END(MemOpt, PASS_FLAG, PASS_DESC, PASS_CFG_ONLY, PASS_ANALYSIS)
 
 char MemOpt::ID = 0;
@@ -439,6 +497,9 @@ bool MemOpt::runOnFunction(Function& F) {
     AA = &getAnalysis<AAResultsWrapperPass>().getAAResults();
     SE = &getAnalysis<ScalarEvolutionWrapperPass>().getSE();
     WI = &getAnalysis<WIAnalysis>();
+    DT = &getAnalysis<DominatorTreeWrapperPass>().getDomTree();
+    PDT = &getAnalysis<PostDominatorTreeWrapperPass>().getPostDomTree();
+    LI = &getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
 
     CGC = getAnalysis<CodeGenContextWrapper>().getCodeGenContext();
     TLI = &getAnalysis<TargetLibraryInfoWrapperPass>().getTLI();
@@ -448,13 +509,111 @@ bool MemOpt::runOnFunction(Function& F) {
 
     bool Changed = false;
 
-    for (Function::iterator BB = F.begin(), BBE = F.end(); BB != BBE; ++BB) {
-        // Find all instructions with memory reference. Remember the distance one
-        // by one.
-        MemRefListTy MemRefs;
-        TrivialMemRefListTy MemRefsToOptimize;
-        unsigned Distance = 0;
-        bool FirstMemRef = true;
+    NumMergedLoads = 0;
+    NumMergedStores = 0;
+    NumNewLoads = 0;
+    NumNewStores = 0;
+    NumCrossBBMerges = 0;
+
+    SmallVector<BBChainTy, 32> Chains;
+    buildBBChains(F, Chains);
+
+    for (auto& Chain : Chains)
+        Changed |= optimizeChain(Chain);
+
+    if (IGC_IS_FLAG_ENABLED(EnableOptReportMemOpt))
+        emitOptReport(F);
+
+    DL = nullptr;
+    AA = nullptr;
+    SE = nullptr;
+    DT = nullptr;
+    PDT = nullptr;
+    LI = nullptr;
+
+    return Changed;
+}
+
+/// collectBBsInBetween() - collects BBs reachable from `From` without passing
+/// through `To`. Returns false if that region is not a single-entry
+/// single-exit one or is too large to be scanned.
+bool MemOpt::collectBBsInBetween(BasicBlock* From, BasicBlock* To,
+    SmallVectorImpl<BasicBlock*>& InBetween) const {
+    unsigned Limit = IGC_GET_FLAG_VALUE(MemOptWindowSize);
+    unsigned NumInsts = 0;
+
+    SmallPtrSet<BasicBlock*, 16> Visited;
+    SmallVector<BasicBlock*, 16> WorkList(succ_begin(From), succ_end(From));
+    while (!WorkList.empty()) {
+        BasicBlock* BB = WorkList.pop_back_val();
+        if (BB == To || !Visited.insert(BB).second)
+            continue;
+        // Going back to `From` without passing through `To` means `To` is not
+        // executed once per `From`.
+        if (BB == From || !DT->dominates(From, BB))
+            return false;
+        NumInsts += BB->size();
+        if (NumInsts > Limit)
+            return false;
+        InBetween.push_back(BB);
+        WorkList.append(succ_begin(BB), succ_end(BB));
+    }
+
+    return true;
+}
+
+/// buildBBChains() - partitions BBs into chains of control-equivalent BBs.
+/// Without cross-BB merging, each BB forms its own chain.
+void MemOpt::buildBBChains(Function& F,
+    SmallVectorImpl<BBChainTy>& Chains) const {
+    bool CrossBB = IGC_IS_FLAG_ENABLED(EnableMemOptCrossBB);
+
+    SmallPtrSet<BasicBlock*, 32> Assigned;
+    for (auto& BB : F) {
+        if (!Assigned.insert(&BB).second)
+            continue;
+
+        Chains.emplace_back();
+        BBChainTy& Chain = Chains.back();
+        Chain.push_back(std::make_pair(&BB, true));
+
+        BasicBlock* Cur = &BB;
+        while (CrossBB) {
+            DomTreeNode* Node = PDT->getNode(Cur);
+            if (!Node || !Node->getIDom())
+                break;
+            BasicBlock* Next = Node->getIDom()->getBlock();
+            // The virtual exit node has no BB.
+            if (!Next || Assigned.count(Next))
+                break;
+            if (!DT->dominates(Cur, Next) ||
+                LI->getLoopFor(Cur) != LI->getLoopFor(Next))
+                break;
+            SmallVector<BasicBlock*, 8> InBetween;
+            if (!collectBBsInBetween(Cur, Next, InBetween))
+                break;
+            for (auto* IB : InBetween)
+                Chain.push_back(std::make_pair(IB, false));
+            Chain.push_back(std::make_pair(Next, true));
+            Assigned.insert(Next);
+            Cur = Next;
+        }
+    }
+}
+
+bool MemOpt::optimizeChain(const BBChainTy& Chain) {
+    bool Changed = false;
+
+    // Find all instructions with memory reference. Remember the distance one
+    // by one.
+    MemRefListTy MemRefs;
+    TrivialMemRefListTy MemRefsToOptimize;
+    unsigned Distance = 0;
+    bool FirstMemRef = true;
+    CheckOnlyMemRefs.clear();
+    for (auto& Entry : Chain) {
+        BasicBlock* BB = Entry.first;
+        bool Mergeable = Entry.second;
         for (auto BI = BB->begin(), BE = BB->end(); BI != BE; ++BI) {
             Instruction* I = &(*BI);
             Distance += FirstMemRef ? 0 : 1;
@@ -462,45 +621,67 @@ bool MemOpt::runOnFunction(Function& F) {
             if (shouldSkip(I))
                 continue;
             MemRefs.push_back(std::make_pair(I, Distance));
+            if (!Mergeable)
+                CheckOnlyMemRefs.insert(I);
             Distance = 0;
             FirstMemRef = false;
         }
+    }
 
-        // Skip BB with no more than 2 loads/stores.
-        if (MemRefs.size() < 2)
-            continue;
+    // Skip chain with no more than 2 loads/stores.
+    if (MemRefs.size() < 2)
+        return false;
 
-        // Canonicalize 64-bit GEP to help SCEV find constant offset by
-        // distributing `zext`/`sext` over safe expressions.
-        for (auto& M : MemRefs)
+    // Canonicalize 64-bit GEP to help SCEV find constant offset by
+    // distributing `zext`/`sext` over safe expressions.
+    for (auto& M : MemRefs)
+        if (!isCheckOnly(M.first))
             Changed |= canonicalizeGEP64(M.first);
 
-        for (auto MI = MemRefs.begin(), ME = MemRefs.end(); MI != ME; ++MI) {
-            Instruction* I = MI->first;
-
-            // Skip already merged one.
-            if (!I)
-                continue;
+    for (auto MI = MemRefs.begin(), ME = MemRefs.end(); MI != ME; ++MI) {
+        Instruction* I = MI->first;
 
-            if (LoadInst * LI = dyn_cast<LoadInst>(I))
-                Changed |= mergeLoad(LI, MI, MemRefs, MemRefsToOptimize);
-            else if (StoreInst * SI = dyn_cast<StoreInst>(I))
-                Changed |= mergeStore(SI, MI, MemRefs, MemRefsToOptimize);
-        }
+        // Skip already merged one.
+        if (!I || isCheckOnly(I))
+            continue;
 
-        // Optimize 64-bit GEP to reduce strength by factoring out `zext`/`sext`
-        // over safe expressions.
-        for (auto I : MemRefsToOptimize)
-            Changed |= optimizeGEP64(I);
+        if (LoadInst * LD = dyn_cast<LoadInst>(I))
+            Changed |= mergeLoad(LD, MI, MemRefs, MemRefsToOptimize);
+        else if (StoreInst * SI = dyn_cast<StoreInst>(I))
+            Changed |= mergeStore(SI, MI, MemRefs, MemRefsToOptimize);
     }
 
-    DL = nullptr;
-    AA = nullptr;
-    SE = nullptr;
+    // Optimize 64-bit GEP to reduce strength by factoring out `zext`/`sext`
+    // over safe expressions.
+    for (auto I : MemRefsToOptimize)
+        Changed |= optimizeGEP64(I);
+
+    CheckOnlyMemRefs.clear();
 
     return Changed;
 }
 
+void MemOpt::emitOptReport(Function& F) const {
+    unsigned MergedLoads = NumMergedLoads - NumNewLoads;
+    unsigned MergedStores = NumMergedStores - NumNewStores;
+
+    std::stringstream report;
+    report << "Function " << F.getName().str() << std::endl
+        << "Loads merged: " << NumMergedLoads << " into " << NumNewLoads
+        << ", messages saved: " << MergedLoads << std::endl
+        << "Stores merged: " << NumMergedStores << " into " << NumNewStores
+        << ", messages saved: " << MergedStores << std::endl
+        << "Cross-BB merges: " << NumCrossBBMerges << std::endl;
+
+    ods() << report.str();
+
+    std::stringstream optReportFile;
+    optReportFile << GetShaderOutputFolder() << "MemOpt.opt";
+    std::ofstream optReportStream;
+    optReportStream.open(optReportFile.str(), std::ios::app);
+    optReportStream << report.str();
+}
+
 bool MemOpt::mergeLoad(LoadInst* LeadingLoad,
     MemRefListTy::iterator MI, MemRefListTy& MemRefs,
     TrivialMemRefListTy& ToOpt) {
@@ -602,8 +783,8 @@ bool MemOpt::mergeLoad(LoadInst* LeadingLoad,
 
         LoadInst* NextLoad = dyn_cast<LoadInst>(NextMemRef);
 
-        // Skip non-load instruction.
-        if (!NextLoad)
+        // Skip non-load instruction or one from BBs in between chain members.
+        if (!NextLoad || isCheckOnly(NextLoad))
             continue;
 
         // Bail out if that load is not a simple one.
@@ -835,9 +1016,13 @@ bool MemOpt::mergeLoad(LoadInst* LeadingLoad,
     Instruction* NewOne = NewLoad;
     std::swap(ToOpt.back(), NewOne);
 
+    ++NumNewLoads;
     for (auto& I : LoadsToMerge) {
         LoadInst* LD = cast<LoadInst>(std::get<0>(I));
         Value* Ptr = LD->getPointerOperand();
+        ++NumMergedLoads;
+        if (isCrossBB(LD, LeadingLoad))
+            ++NumCrossBBMerges;
         // make sure the load was merged before actually removing it
         if (LD->use_empty()) {
             LD->eraseFromParent();
@@ -937,8 +1122,8 @@ bool MemOpt::mergeStore(StoreInst* LeadingStore,
         CheckList.push_back(NextMemRef);
 
         StoreInst* NextStore = dyn_cast<StoreInst>(NextMemRef);
-        // Skip non-store instruction.
-        if (!NextStore)
+        // Skip non-store instruction or one from BBs in between chain members.
+        if (!NextStore || isCheckOnly(NextStore))
             continue;
 
         // Bail out if that store is not a simple one.
@@ -1139,9 +1324,13 @@ bool MemOpt::mergeStore(StoreInst* LeadingStore,
     Instruction* NewOne = NewStore;
     std::swap(ToOpt.back(), NewOne);
 
+    ++NumNewStores;
     for (auto& I : StoresToMerge) {
         StoreInst* ST = cast<StoreInst>(std::get<0>(I));
         Value* Ptr = ST->getPointerOperand();
+        ++NumMergedStores;
+        if (isCrossBB(ST, TailingStore))
+            ++NumCrossBBMerges;
         // Stores merged in the previous iterations can get merged again, so we need
         // to update ToOpt vector to avoid null instruction in there
         ToOpt.erase(std::remove(ToOpt.begin(), ToOpt.end(), ST), ToOpt.end());
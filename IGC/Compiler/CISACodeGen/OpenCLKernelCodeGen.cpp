@@ -1829,6 +1829,14 @@ namespace IGC
 
             m_kernelInfo.m_executionEnivronment.CompiledSubGroupsNumber = funcMD.CompiledSubGroupsNumber;
 
+            m_kernelInfo.m_zeSpecializationOf = funcMD.specializationOf;
+            for (const SpecializedArgMD& arg : funcMD.specializedArgs)
+            {
+                zebin::zeInfoSpecializedArgument zeArg;
+                zeArg.arg_index = arg.argIndex;
+                zeArg.value = (zebin::zeinfo_int64_t)arg.value;
+                m_kernelInfo.m_zeSpecializedArgs.push_back(zeArg);
+            }
         }
 
         m_kernelInfo.m_executionEnivronment.HasGlobalAtomics = GetHasGlobalAtomics();
@@ -2442,6 +2450,27 @@ namespace IGC
                     return SIMDStatus::SIMD_PERF_FAIL;
                 }
             }
+
+            // Stage 1 of a staged compile leaves the wider SIMD modes to
+            // stage 2; remember that this one would have been compiled so
+            // stage 2 knows it can improve on stage 1.
+            bool skipInStage1 =
+                (simdMode == SIMDMode::SIMD32 &&
+                 (IsStage1BestPerf(pCtx->m_CgFlag, pCtx->m_StagingCtx) ||
+                  IsStage1FastCompile(pCtx->m_CgFlag, pCtx->m_StagingCtx) ||
+                  IsStage1FastestCompile(pCtx->m_CgFlag, pCtx->m_StagingCtx))) ||
+                (simdMode == SIMDMode::SIMD16 &&
+                 (IsStage1FastCompile(pCtx->m_CgFlag, pCtx->m_StagingCtx) ||
+                  IsStage1FastestCompile(pCtx->m_CgFlag, pCtx->m_StagingCtx)));
+            if (skipInStage1)
+            {
+                if (simdMode == SIMDMode::SIMD32)
+                    pCtx->m_doSimd32Stage2 = true;
+                else
+                    pCtx->m_doSimd16Stage2 = true;
+                pCtx->SetSIMDInfo(SIMD_SKIP_PERF, simdMode, ShaderDispatchMode::NOT_APPLICABLE);
+                return SIMDStatus::SIMD_FUNC_FAIL;
+            }
         }
 
         return SIMDStatus::SIMD_PASS;
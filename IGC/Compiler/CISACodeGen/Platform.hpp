@@ -208,6 +208,7 @@ unsigned int getMaxNumberThreadPerSubslice() const
         return m_caps.KernelHwCaps.ThreadCount / m_caps.KernelHwCaps.SubSliceCount;
     return 0;
 }
+unsigned int getMaxNumberThreadPerEU() const { return m_caps.KernelHwCaps.EUThreadsPerEU; }
 unsigned int getMaxNumberThreadPerWorkgroupPooledMax() const
 {
     return m_caps.KernelHwCaps.EUCountPerPoolMax * m_caps.KernelHwCaps.EUThreadsPerEU;
@@ -47,6 +47,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Compiler/CISACodeGen/ConstantCoalescing.hpp"
 #include "Compiler/CISACodeGen/CheckInstrTypes.hpp"
 #include "Compiler/CISACodeGen/EstimateFunctionSize.h"
+#include "Compiler/CISACodeGen/UniformArgsPropagation.hpp"
 #include "Compiler/CISACodeGen/PassTimer.hpp"
 #include "Compiler/CISACodeGen/FixAddrSpaceCast.h"
 #include "Compiler/CISACodeGen/FixupExtractValuePair.h"
@@ -458,6 +459,12 @@ static void AddLegalizationPasses(CodeGenContext& ctx, IGCPassManager& mpm, PSSi
         mpm.add(createGenRotatePass());
     }
 
+    // Turn llvm.expect into branch_weights before the intrinsic is dropped,
+    // so that Layout can still see the hint.
+    if (IGC_IS_FLAG_ENABLED(EnableProbabilityLayout))
+    {
+        mpm.add(llvm::createLowerExpectIntrinsicPass());
+    }
     mpm.add(createReplaceUnsupportedIntrinsicsPass());
 
     if (IGC_IS_FLAG_DISABLED(DisablePromoteToDirectAS) &&
@@ -517,14 +524,19 @@ static void AddLegalizationPasses(CodeGenContext& ctx, IGCPassManager& mpm, PSSi
             mpm.add(new PrivateMemoryToSLM(
                 IGC_IS_FLAG_ENABLED(EnableOptReportPrivateMemoryToSLM)));
         }
-        else if (IGC_IS_FLAG_ENABLED(ForcePrivateMemoryToSLMOnBuffers))
+        else if (IGC_IS_FLAG_ENABLED(ForcePrivateMemoryToSLMOnBuffers) ||
+                 (IGC_IS_FLAG_ENABLED(EnableAutoPrivateMemoryToSLM) && !isOptDisabled))
         {
-            std::string forcedBuffers(
-                IGC_GET_REGKEYSTRING(ForcePrivateMemoryToSLMOnBuffers));
+            std::string forcedBuffers;
+            if (IGC_IS_FLAG_ENABLED(ForcePrivateMemoryToSLMOnBuffers))
+            {
+                forcedBuffers = IGC_GET_REGKEYSTRING(ForcePrivateMemoryToSLMOnBuffers);
+            }
 
             mpm.add(new PrivateMemoryToSLM(
                 forcedBuffers,
-                IGC_IS_FLAG_ENABLED(EnableOptReportPrivateMemoryToSLM)));
+                IGC_IS_FLAG_ENABLED(EnableOptReportPrivateMemoryToSLM),
+                IGC_IS_FLAG_ENABLED(EnableAutoPrivateMemoryToSLM) && !isOptDisabled));
         }
         mpm.add(createInferAddressSpacesPass());
     }
@@ -542,6 +554,10 @@ static void AddLegalizationPasses(CodeGenContext& ctx, IGCPassManager& mpm, PSSi
         // Sort functions if subroutine/indirect fcall is enabled.
         mpm.add(llvm::createGlobalDCEPass());
         mpm.add(new PurgeMetaDataUtils());
+        if (IGC_IS_FLAG_ENABLED(EnableUniformArgsPropagation))
+        {
+            mpm.add(createUniformArgsPropagationPass());
+        }
         mpm.add(createGenXCodeGenModulePass());
     }
 
@@ -1168,6 +1184,27 @@ void CodeGen(OpenCLProgramContext* ctx, CShaderProgram::KernelShaderMap& kernels
 
     AddAnalysisPasses(*ctx, Passes);
 
+    // Stage 1 of a staged compile emits SIMD8 (and SIMD16 for best perf)
+    // only, see COpenCLKernel::checkSIMDCompileConds. Cancel staging when
+    // the SIMD mode is dictated anyway or SIMD8 isn't allowed.
+    if (ctx->m_CgFlag != FLAG_CG_ALL_SIMDS &&
+        !IsStage2RestSIMDs(ctx->m_StagingCtx))
+    {
+        bool simd8Allowed = true;
+        if (ctx->getModuleMetaData()->csInfo.maxWorkGroupSize)
+        {
+            simd8Allowed = getLeastSIMDAllowed(
+                ctx->getModuleMetaData()->csInfo.maxWorkGroupSize,
+                GetHwThreadsPerWG(ctx->platform)) == SIMDMode::SIMD8;
+        }
+        if (ctx->m_enableFunctionPointer ||
+            ctx->getModuleMetaData()->csInfo.forcedSIMDSize != 0 ||
+            !simd8Allowed)
+        {
+            ctx->m_CgFlag = FLAG_CG_ALL_SIMDS;
+        }
+    }
+
     if (ctx->m_enableFunctionPointer
         && ctx->m_DriverInfo.sendMultipleSIMDModes()
         && ctx->getModuleMetaData()->csInfo.forcedSIMDSize == 0)
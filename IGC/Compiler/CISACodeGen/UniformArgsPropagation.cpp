@@ -0,0 +1,430 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+
+#include "Compiler/CISACodeGen/UniformArgsPropagation.hpp"
+#include "Compiler/CISACodeGen/helper.h"
+#include "Compiler/CISACodeGen/WIAnalysis.hpp"
+#include "Compiler/CodeGenContextWrapper.hpp"
+#include "Compiler/IGCPassSupport.h"
+#include "Compiler/MetaDataUtilsWrapper.h"
+#include "Compiler/MetaDataApi/IGCMetaDataHelper.h"
+#include "AdaptorCommon/ImplicitArgs.hpp"
+#include "common/igc_regkeys.hpp"
+#include "common/LLVMWarningsPush.hpp"
+#include "llvm/IR/Attributes.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvmWrapper/Transforms/Utils/Cloning.h"
+#include "common/LLVMWarningsPop.hpp"
+#include <algorithm>
+#include "Probe/Assertion.h"
+
+using namespace llvm;
+using namespace IGC;
+using namespace IGC::IGCMD;
+
+static const char* const UNIFORM_ARG_ATTR = "igc.uniform";
+
+// for lit tests; same as UniformArgsMaxClonesPerFunc
+static cl::opt<unsigned> UniformArgsMaxClones(
+    "igc-uniform-args-max-clones", cl::init(0), cl::Hidden,
+    cl::desc("Max number of uniform-argument specializations per callee (UniformArgsMaxClonesPerFunc)"));
+
+char UniformArgsPropagation::ID = 0;
+
+IGC_INITIALIZE_PASS_BEGIN(UniformArgsPropagation, "UniformArgsPropagation", "UniformArgsPropagation", false, false)
+IGC_INITIALIZE_PASS_DEPENDENCY(MetaDataUtilsWrapper)
+IGC_INITIALIZE_PASS_DEPENDENCY(CodeGenContextWrapper)
+IGC_INITIALIZE_PASS_END(UniformArgsPropagation, "UniformArgsPropagation", "UniformArgsPropagation", false, false)
+
+llvm::ModulePass* IGC::createUniformArgsPropagationPass()
+{
+    return new UniformArgsPropagation;
+}
+
+bool IGC::isUniformArg(const llvm::Argument* Arg)
+{
+    const Function* F = Arg->getParent();
+    return F->getAttributes().getParamAttributes(Arg->getArgNo()).hasAttribute(UNIFORM_ARG_ATTR);
+}
+
+UniformArgsPropagation::UniformArgsPropagation() : ModulePass(ID)
+{
+    initializeUniformArgsPropagationPass(*PassRegistry::getPassRegistry());
+}
+
+void UniformArgsPropagation::getAnalysisUsage(AnalysisUsage& AU) const
+{
+    AU.addRequired<MetaDataUtilsWrapper>();
+    AU.addRequired<CodeGenContextWrapper>();
+}
+
+bool UniformArgsPropagation::runOnModule(Module& M)
+{
+    m_ctx = getAnalysis<CodeGenContextWrapper>().getCodeGenContext();
+    m_pMdUtils = getAnalysis<MetaDataUtilsWrapper>().getMetaDataUtils();
+
+    initFacts(M);
+    solve();
+
+    bool changed = false;
+    if (specialize(M))
+    {
+        // Redirected call sites may have made the original callees uniform
+        // as well, so start over from the optimistic assumption.
+        changed = true;
+        initFacts(M);
+        solve();
+    }
+    changed |= commit();
+    return changed;
+}
+
+// Functions whose every caller is visible: not a kernel, not reachable
+// through a function pointer and only ever used as the callee of a call.
+bool UniformArgsPropagation::isCandidate(Function* F) const
+{
+    if (F->isDeclaration() || F->isVarArg() ||
+        isEntryFunc(m_pMdUtils, F) ||
+        F->hasFnAttribute("IndirectlyCalled") ||
+        F->hasFnAttribute("referenced-indirectly"))
+    {
+        return false;
+    }
+    for (auto& U : F->uses())
+    {
+        CallInst* CI = dyn_cast<CallInst>(U.getUser());
+        if (!CI || !CI->isCallee(&U))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+unsigned UniformArgsPropagation::getNumExplicitArgs(Function* F) const
+{
+    ImplicitArgs implicitArgs(*F, m_pMdUtils);
+    unsigned numImplicit = implicitArgs.size();
+    if (isEntryFunc(m_pMdUtils, F))
+    {
+        numImplicit += m_ctx->getModuleMetaData()->pushInfo.pushAnalysisWIInfos.size();
+    }
+    IGC_ASSERT(F->arg_size() >= numImplicit);
+    return F->arg_size() - numImplicit;
+}
+
+// Only scalars that the emitter can read back from a single lane.
+bool UniformArgsPropagation::isEligibleArg(const Argument* Arg) const
+{
+    Type* Ty = Arg->getType();
+    if (Arg->hasByValAttr() || Ty->isIntegerTy(1) ||
+        !(Ty->isIntegerTy() || Ty->isFloatingPointTy() || Ty->isPointerTy()))
+    {
+        return false;
+    }
+    unsigned bits = (unsigned)m_ctx->getModule()->getDataLayout().getTypeSizeInBits(Ty);
+    switch (bits)
+    {
+    case 8:
+    case 16:
+    case 32:
+        return true;
+    case 64:
+        return !m_ctx->platform.hasNoInt64Inst();
+    default:
+        return false;
+    }
+}
+
+// A value is uniform at a call site if it is built, without phis or memory
+// accesses, from constants and uniform arguments of the caller. Pure
+// operations on such leaves give the same result on every lane and in every
+// iteration of an enclosing loop, so no control-flow reasoning is needed.
+bool UniformArgsPropagation::isUniformValue(Value* V, unsigned depth) const
+{
+    if (isa<Constant>(V))
+    {
+        return true;
+    }
+
+    if (Argument* Arg = dyn_cast<Argument>(V))
+    {
+        Function* F = Arg->getParent();
+        unsigned numExplicit = getNumExplicitArgs(F);
+        unsigned argNo = Arg->getArgNo();
+        if (argNo >= numExplicit)
+        {
+            ImplicitArgs implicitArgs(*F, m_pMdUtils);
+            unsigned idx = argNo - numExplicit;
+            return idx < implicitArgs.size() &&
+                implicitArgs[idx].getDependency() == WIAnalysis::UNIFORM;
+        }
+        if (isEntryFunc(m_pMdUtils, F))
+        {
+            return true;
+        }
+        auto it = m_facts.find(F);
+        return it != m_facts.end() && it->second.test(argNo);
+    }
+
+    if (depth >= s_cMaxDepth)
+    {
+        return false;
+    }
+
+    Instruction* I = dyn_cast<Instruction>(V);
+    if (!I)
+    {
+        return false;
+    }
+    if (isa<BinaryOperator>(I) || isa<CastInst>(I) || isa<CmpInst>(I) ||
+        isa<SelectInst>(I) || isa<GetElementPtrInst>(I) ||
+        isa<ExtractElementInst>(I) || isa<InsertElementInst>(I))
+    {
+        for (Value* Op : I->operands())
+        {
+            if (!isUniformValue(Op, depth + 1))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+SmallBitVector UniformArgsPropagation::getUniformPattern(CallInst* CI) const
+{
+    Function* F = CI->getCalledFunction();
+    unsigned numExplicit = getNumExplicitArgs(F);
+    SmallBitVector pattern(numExplicit);
+    for (unsigned i = 0; i < numExplicit; ++i)
+    {
+        if (isEligibleArg(F->arg_begin() + i) &&
+            isUniformValue(CI->getArgOperand(i)))
+        {
+            pattern.set(i);
+        }
+    }
+    return pattern;
+}
+
+void UniformArgsPropagation::initFacts(Module& M)
+{
+    m_facts.clear();
+    for (Function& F : M)
+    {
+        if (!isCandidate(&F))
+        {
+            continue;
+        }
+        unsigned numExplicit = getNumExplicitArgs(&F);
+        SmallBitVector facts(numExplicit);
+        for (unsigned i = 0; i < numExplicit; ++i)
+        {
+            if (isEligibleArg(F.arg_begin() + i))
+            {
+                facts.set(i);
+            }
+        }
+        if (facts.any())
+        {
+            m_facts[&F] = facts;
+        }
+    }
+}
+
+// Optimistic fixed point: every eligible argument starts out uniform and is
+// dropped as soon as one call site passes a value that is not provably
+// uniform under the current facts.
+void UniformArgsPropagation::solve()
+{
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (auto& it : m_facts)
+        {
+            Function* F = it.first;
+            for (User* U : F->users())
+            {
+                if (it.second.none())
+                {
+                    break;
+                }
+                SmallBitVector facts = it.second;
+                facts &= getUniformPattern(cast<CallInst>(U));
+                if (facts != it.second)
+                {
+                    it.second = facts;
+                    changed = true;
+                }
+            }
+        }
+    }
+}
+
+// Clone small callees for the all-uniform argument patterns that the solver
+// could not prove for the function as a whole, either because some call
+// sites disagree or because the function is also reachable through a
+// function pointer.
+bool UniformArgsPropagation::specialize(Module& M)
+{
+    unsigned threshold = IGC_GET_FLAG_VALUE(UniformArgsCloneThreshold);
+    unsigned maxClones = UniformArgsMaxClones.getNumOccurrences() ?
+        (unsigned)UniformArgsMaxClones : IGC_GET_FLAG_VALUE(UniformArgsMaxClonesPerFunc);
+    if (threshold == 0 || maxClones == 0)
+    {
+        return false;
+    }
+
+    SmallVector<Function*, 16> funcs;
+    for (Function& F : M)
+    {
+        if (!F.isDeclaration() && !F.isVarArg() &&
+            !isEntryFunc(m_pMdUtils, &F) &&
+            F.getInstructionCount() <= threshold)
+        {
+            funcs.push_back(&F);
+        }
+    }
+
+    typedef std::pair<SmallBitVector, SmallVector<CallInst*, 4>> CallGroup;
+    bool changed = false;
+    for (Function* F : funcs)
+    {
+        unsigned numExplicit = getNumExplicitArgs(F);
+        auto FI = m_facts.find(F);
+        SmallBitVector facts = FI != m_facts.end() ? FI->second : SmallBitVector(numExplicit);
+
+        // Group the direct call sites by their uniform pattern, keeping only
+        // those that would make a used argument uniform.
+        SmallVector<CallGroup, 4> groups;
+        for (auto& U : F->uses())
+        {
+            CallInst* CI = dyn_cast<CallInst>(U.getUser());
+            if (!CI || !CI->isCallee(&U))
+            {
+                continue;
+            }
+            SmallBitVector pattern = getUniformPattern(CI);
+            for (int i = pattern.find_first(); i >= 0; i = pattern.find_next(i))
+            {
+                if ((F->arg_begin() + i)->use_empty())
+                {
+                    pattern.reset(i);
+                }
+            }
+            SmallBitVector gain = pattern;
+            gain.reset(facts);
+            if (gain.none())
+            {
+                continue;
+            }
+            auto G = std::find_if(groups.begin(), groups.end(),
+                [&](const CallGroup& g) { return g.first == pattern; });
+            if (G == groups.end())
+            {
+                groups.push_back(CallGroup(pattern, { CI }));
+            }
+            else
+            {
+                G->second.push_back(CI);
+            }
+        }
+
+        std::stable_sort(groups.begin(), groups.end(),
+            [](const CallGroup& a, const CallGroup& b) {
+                return a.second.size() > b.second.size();
+            });
+        for (unsigned g = 0, e = std::min<unsigned>(groups.size(), maxClones); g < e; ++g)
+        {
+            Function* clone = cloneForPattern(F, groups[g].first);
+            for (CallInst* CI : groups[g].second)
+            {
+                CI->setCalledFunction(clone);
+            }
+            changed = true;
+        }
+
+        // All call sites went to clones.
+        if (F->use_empty() && F->hasLocalLinkage())
+        {
+            m_facts.erase(F);
+            IGCMetaDataHelper::removeFunction(*m_pMdUtils, *m_ctx->getModuleMetaData(), F);
+            m_pMdUtils->save(F->getContext());
+            F->eraseFromParent();
+        }
+    }
+    return changed;
+}
+
+Function* UniformArgsPropagation::cloneForPattern(Function* F, const SmallBitVector& Pattern)
+{
+    ValueToValueMapTy VMap;
+    Function* clone = CloneFunction(F, VMap);
+    if (!F->getParent()->getFunction(clone->getName()))
+    {
+        F->getParent()->getFunctionList().push_back(clone);
+    }
+    clone->setName(F->getName() + ".uniform");
+    clone->setLinkage(GlobalValue::InternalLinkage);
+    // The clone is only reached from the redirected direct call sites.
+    clone->removeFnAttr("IndirectlyCalled");
+    clone->removeFnAttr("referenced-indirectly");
+
+    m_pMdUtils->setFunctionsInfoItem(clone, m_pMdUtils->getFunctionsInfoItem(F));
+    m_pMdUtils->save(F->getContext());
+    ModuleMetaData* modMD = m_ctx->getModuleMetaData();
+    auto FuncMD = modMD->FuncMD.find(F);
+    if (FuncMD != modMD->FuncMD.end())
+    {
+        FunctionMetaData funcMD = FuncMD->second;
+        modMD->FuncMD[clone] = funcMD;
+    }
+    return clone;
+}
+
+bool UniformArgsPropagation::commit()
+{
+    bool changed = false;
+    for (auto& it : m_facts)
+    {
+        Function* F = it.first;
+        const SmallBitVector& facts = it.second;
+        for (int i = facts.find_first(); i >= 0; i = facts.find_next(i))
+        {
+            if (!isUniformArg(F->arg_begin() + i))
+            {
+                F->addParamAttr(i, llvm::Attribute::get(F->getContext(), UNIFORM_ARG_ATTR));
+                changed = true;
+            }
+        }
+    }
+    return changed;
+}
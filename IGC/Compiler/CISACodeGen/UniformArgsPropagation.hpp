@@ -0,0 +1,97 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+#pragma once
+#include "Compiler/MetaDataApi/MetaDataApi.h"
+#include "common/LLVMWarningsPush.hpp"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallBitVector.h"
+#include "llvm/IR/Argument.h"
+#include "llvm/IR/Function.h"
+#include "llvm/Pass.h"
+#include "common/LLVMWarningsPop.hpp"
+
+namespace IGC
+{
+    class CodeGenContext;
+
+    /// \brief Interprocedural uniformity of subroutine / stack call arguments.
+    ///
+    /// WIAnalysis has to assume that every explicit argument of a non-kernel
+    /// function is random, so a value that is uniform in every caller still
+    /// occupies a full SIMD register in the callee and everything computed
+    /// from it is vectorized. This pass proves, over all direct call sites,
+    /// which scalar arguments are the same for every active lane and tags them
+    /// with the "igc.uniform" parameter attribute. WIAnalysis seeds those
+    /// arguments as uniform and the emitter passes them as scalars.
+    ///
+    /// Callees that are only uniform for some of their call sites are cloned
+    /// for the dominant all-uniform argument patterns (bounded in size and
+    /// number of clones), so that hot call sites still get the scalar version.
+    class UniformArgsPropagation : public llvm::ModulePass
+    {
+    public:
+        static char ID;
+
+        UniformArgsPropagation();
+
+        virtual llvm::StringRef getPassName() const override
+        {
+            return "UniformArgsPropagation";
+        }
+
+        virtual void getAnalysisUsage(llvm::AnalysisUsage& AU) const override;
+
+        virtual bool runOnModule(llvm::Module& M) override;
+
+    private:
+        bool isCandidate(llvm::Function* F) const;
+        unsigned getNumExplicitArgs(llvm::Function* F) const;
+        bool isEligibleArg(const llvm::Argument* Arg) const;
+        bool isUniformValue(llvm::Value* V, unsigned depth = 0) const;
+        llvm::SmallBitVector getUniformPattern(llvm::CallInst* CI) const;
+        void initFacts(llvm::Module& M);
+        void solve();
+        bool specialize(llvm::Module& M);
+        llvm::Function* cloneForPattern(llvm::Function* F,
+            const llvm::SmallBitVector& Pattern);
+        bool commit();
+
+        static const unsigned s_cMaxDepth = 8;
+
+        CodeGenContext* m_ctx = nullptr;
+        IGCMD::MetaDataUtils* m_pMdUtils = nullptr;
+
+        /// Explicit arguments assumed (and, once solved, proven) uniform for
+        /// every candidate function.
+        llvm::DenseMap<llvm::Function*, llvm::SmallBitVector> m_facts;
+    };
+
+    llvm::ModulePass* createUniformArgsPropagationPass();
+
+    /// Whether \p Arg was proven uniform by UniformArgsPropagation.
+    bool isUniformArg(const llvm::Argument* Arg);
+
+} // namespace IGC
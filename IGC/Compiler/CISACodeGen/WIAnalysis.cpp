@@ -26,6 +26,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "AdaptorCommon/ImplicitArgs.hpp"
 #include "Compiler/CISACodeGen/WIAnalysis.hpp"
+#include "Compiler/CISACodeGen/UniformArgsPropagation.hpp"
 #include "Compiler/CISACodeGen/helper.h"
 #include "Compiler/CodeGenContextWrapper.hpp"
 #include "Compiler/CodeGenPublic.h"
@@ -441,7 +442,8 @@ void WIAnalysisRunner::updateArgsDependency(llvm::Function* pF)
     */
 
     // For a subroutine, conservatively assume that all user provided arguments
-    // are random. Note that all other functions are treated as kernels.
+    // are random unless UniformArgsPropagation proved them uniform at every
+    // call site. Note that all other functions are treated as kernels.
     // To enable subroutine for other FEs, we need to update this check.
     bool IsSubroutine = !isEntryFunc(m_pMdUtils, pF) || isNonEntryMultirateShader(pF);
 
@@ -456,11 +458,12 @@ void WIAnalysisRunner::updateArgsDependency(llvm::Function* pF)
     ae = pF->arg_end();
 
     // 1. add all kernel function args as uniform, or
-    //    add all subroutine function args as random
+    //    add all subroutine function args as random (except proven uniform ones)
     for (int i = 0; i < implicitArgStart; ++i, ++ai)
     {
         IGC_ASSERT(ai != ae);
-        incUpdateDepend(&(*ai), IsSubroutine ? WIAnalysis::RANDOM : WIAnalysis::UNIFORM);
+        bool isUniform = !IsSubroutine || isUniformArg(&(*ai));
+        incUpdateDepend(&(*ai), isUniform ? WIAnalysis::UNIFORM : WIAnalysis::RANDOM);
     }
 
     // 2. add implicit args
@@ -25,12 +25,16 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 ======================= end_copyright_notice ==================================*/
 
 #include "Compiler/CISACodeGen/layout.hpp"
+#include "Compiler/CISACodeGen/BlockProfile.hpp"
 #include "Compiler/CISACodeGen/ShaderCodeGen.hpp"
+#include "Compiler/CodeGenContextWrapper.hpp"
 #include "Compiler/IGCPassSupport.h"
 #include "common/debug/Debug.hpp"
 #include "common/debug/Dump.hpp"
 #include "common/MemStats.h"
 #include "common/LLVMUtils.h"
+#include <fstream>
+#include <sstream>
 #include <vector>
 #include <set>
 #include "Probe/Assertion.h"
@@ -38,6 +42,14 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 using namespace llvm;
 using namespace IGC;
 
+// for lit tests; same as the regkeys of the same meaning
+static cl::opt<bool> ProbabilityLayout(
+    "igc-layout-probability", cl::init(false), cl::Hidden,
+    cl::desc("Use branch probabilities in Layout (EnableProbabilityLayout)"));
+static cl::opt<unsigned> LayoutColdRatio(
+    "igc-layout-cold-ratio", cl::init(0), cl::Hidden,
+    cl::desc("Cold block frequency ratio for Layout (ColdBlockFreqRatio)"));
+
 #define SUCCSZANY     (true)
 #define SUCCHASINST   (succ->size() > 1)
 #define SUCCNOINST    (succ->size() <= 1)
@@ -62,6 +74,7 @@ using namespace IGC;
 IGC_INITIALIZE_PASS_BEGIN(Layout, PASS_FLAG, PASS_DESCRIPTION, PASS_CFG_ONLY, PASS_ANALYSIS)
 IGC_INITIALIZE_PASS_DEPENDENCY(LoopInfoWrapperPass)
 IGC_INITIALIZE_PASS_DEPENDENCY(PostDominatorTreeWrapperPass)
+IGC_INITIALIZE_PASS_DEPENDENCY(CodeGenContextWrapper)
 IGC_INITIALIZE_PASS_END(Layout, PASS_FLAG, PASS_DESCRIPTION, PASS_CFG_ONLY, PASS_ANALYSIS)
 
 char IGC::Layout::ID = 0;
@@ -78,6 +91,7 @@ void Layout::getAnalysisUsage(llvm::AnalysisUsage& AU) const
     AU.addRequired<llvm::LoopInfoWrapperPass>();
     AU.addRequired<llvm::PostDominatorTreeWrapperPass>();
     AU.addRequired<llvm::DominatorTreeWrapperPass>();
+    AU.addRequired<CodeGenContextWrapper>();
 }
 
 bool Layout::runOnFunction(Function& func)
@@ -85,6 +99,8 @@ bool Layout::runOnFunction(Function& func)
     m_PDT = &getAnalysis<PostDominatorTreeWrapperPass>().getPostDomTree();
     m_DT = &getAnalysis<DominatorTreeWrapperPass>().getDomTree();
     LoopInfo& LI = getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
+    loadBlockProfile(func);
+    computeBranchProbabilities(func, LI);
     if (LI.empty())
     {
         LayoutBlocks(func);
@@ -93,10 +109,114 @@ bool Layout::runOnFunction(Function& func)
     {
         LayoutBlocks(func, LI);
     }
+    unsigned numSunk = sinkColdBlocks(func, LI);
+    if (IGC_IS_FLAG_ENABLED(EnableOptReportLayout))
+    {
+        emitOptReport(func, numSunk);
+    }
+    m_BFI.reset();
+    m_BPI.reset();
     MEM_SNAPSHOT(IGC::SMS_AFTER_LAYOUTPASS);
     return true;
 }
 
+void Layout::loadBlockProfile(Function& func)
+{
+    m_blockCounts.clear();
+    if (!BlockProfile::isEnabled())
+    {
+        return;
+    }
+    // Blocks are numbered before anything is moved, so that the ids are the
+    // same in the instrumented and in the profile-guided build.
+    assignProfileBlockIds(func);
+
+    const BlockProfile* profile = BlockProfile::get();
+    CodeGenContext* ctx = getAnalysis<CodeGenContextWrapper>().getCodeGenContext();
+    const BlockProfile::FunctionCounts* counts =
+        profile ? profile->lookup(ctx->hash.getAsmHash(), func) : nullptr;
+    if (!counts)
+    {
+        return;
+    }
+    // blocks missing from the profile never ran
+    for (BasicBlock& BB : func)
+    {
+        unsigned id = 0;
+        getProfileBlockId(&BB, id);
+        auto it = counts->counts.find(id);
+        m_blockCounts[&BB] = it != counts->counts.end() ? it->second : 0;
+    }
+}
+
+void Layout::computeBranchProbabilities(Function& func, LoopInfo& LI)
+{
+    // measured counts beat any static estimate
+    if (!m_blockCounts.empty() ||
+        (IGC_IS_FLAG_DISABLED(EnableProbabilityLayout) && !ProbabilityLayout))
+    {
+        return;
+    }
+    m_BPI.reset(new BranchProbabilityInfo(func, LI));
+    m_BFI.reset(new BlockFrequencyInfo(func, *m_BPI, LI));
+}
+
+bool Layout::hasBlockWeights() const
+{
+    return !m_blockCounts.empty() || m_BFI;
+}
+
+// How often BB runs, relative to the other blocks of the function.
+uint64_t Layout::getBlockWeight(BasicBlock* BB) const
+{
+    if (!m_blockCounts.empty())
+    {
+        return m_blockCounts.lookup(BB);
+    }
+    return m_BFI->getBlockFreq(BB).getFrequency();
+}
+
+// How likely the edge From->To is, relative to the other edges out of From.
+// The profile has no edge counts; the count of To stands in for them.
+uint64_t Layout::getEdgeWeight(BasicBlock* From, BasicBlock* To) const
+{
+    if (!m_blockCounts.empty())
+    {
+        return m_blockCounts.lookup(To);
+    }
+    return m_BPI->getEdgeProbability(From, To).getNumerator();
+}
+
+// The successor BB branches to most of the time, or nullptr if no
+// successor is preferred.
+BasicBlock* Layout::getLikelySucc(BasicBlock* BB) const
+{
+    BasicBlock* Likely = nullptr;
+    uint64_t LikelyWeight = 0;
+    bool Tie = false;
+    SmallPtrSet<BasicBlock*, 4> Seen;
+    for (succ_iterator SI = succ_begin(BB), SE = succ_end(BB); SI != SE; ++SI)
+    {
+        BasicBlock* succ = *SI;
+        if (!Seen.insert(succ).second)
+        {
+            continue;
+        }
+        uint64_t Weight = getEdgeWeight(BB, succ);
+        if (!Likely || Weight > LikelyWeight)
+        {
+            Likely = succ;
+            LikelyWeight = Weight;
+            Tie = false;
+        }
+        else if (Weight == LikelyWeight)
+        {
+            Tie = true;
+        }
+    }
+    return Tie ? nullptr : Likely;
+}
+
 // check if the instruction is atomic write (xchg or cmpxchng)
 bool Layout::isAtomicWrite(llvm::Instruction* inst, bool onlyLocalMem)
 {
@@ -457,6 +577,38 @@ BasicBlock* Layout::selectSucc(
     return S0;
 }
 
+//
+// selectColdestSucc: of the unvisited successors of CurrBlk (only those
+// with instructions if HasInstOnly), return the one least likely to be
+// branched to. The layout is built backward, so visiting the coldest
+// successor first places it last and lets the hottest one fall through.
+// Ties go to the first successor, as with PUSHSUCC.
+//
+BasicBlock* Layout::selectColdestSucc(
+    BasicBlock* CurrBlk,
+    bool HasInstOnly,
+    const std::set<BasicBlock*>& VisitSet)
+{
+    BasicBlock* Coldest = nullptr;
+    uint64_t ColdestCount = 0;
+    for (succ_iterator SI = succ_begin(CurrBlk), SE = succ_end(CurrBlk);
+        SI != SE; ++SI)
+    {
+        BasicBlock* succ = *SI;
+        if (VisitSet.count(succ) || (HasInstOnly && succ->size() <= 1))
+        {
+            continue;
+        }
+        uint64_t Count = getEdgeWeight(CurrBlk, succ);
+        if (!Coldest || Count < ColdestCount)
+        {
+            Coldest = succ;
+            ColdestCount = Count;
+        }
+    }
+    return Coldest;
+}
+
 void Layout::LayoutBlocks(Function& func, LoopInfo& LI)
 {
     std::vector<llvm::BasicBlock*> visitVec;
@@ -504,7 +656,15 @@ void Layout::LayoutBlocks(Function& func, LoopInfo& LI)
         else
         {
             // push: time for DFS visit
-            PUSHSUCC(blk, SUCCANYLOOP, SUCCHASINST);
+            if (!hasBlockWeights())
+            {
+                PUSHSUCC(blk, SUCCANYLOOP, SUCCHASINST);
+            }
+            else if (BasicBlock * aBlk = selectColdestSucc(blk, true, visitSet))
+            {
+                visitVec.push_back(aBlk);
+                visitSet.insert(aBlk);
+            }
             if (blk != visitVec.back())
                 continue;
             // push: time for DFS visit
@@ -663,7 +823,15 @@ void Layout::LayoutBlocks(Function& func)
         if (blk != visitVec.back())
             continue;
         // push in all the same-loop successors
-        PUSHSUCC(blk, SUCCANYLOOP, SUCCSZANY);
+        if (!hasBlockWeights())
+        {
+            PUSHSUCC(blk, SUCCANYLOOP, SUCCSZANY);
+        }
+        else if (BasicBlock * aBlk = selectColdestSucc(blk, false, visitSet))
+        {
+            visitVec.push_back(aBlk);
+            visitSet.insert(aBlk);
+        }
         // pop
         if (blk == visitVec.back())
         {
@@ -676,3 +844,221 @@ void Layout::LayoutBlocks(Function& func)
         }
     }
 }
+
+
+//
+// sinkColdBlocks: move the blocks that hardly ever run (error and
+// bounds-check paths) to the end of the function, just before the final
+// return block, so that they stop splitting the hot code.
+//
+// The move must not introduce control flow vISA's CFGStructurizer cannot
+// recognize: it treats backward branches as loops, and expects loops to be
+// contiguous with their exits laid out as Layout left them. So a block is
+// only sunk if
+//   - neither it nor any of its predecessors is in a loop, and
+//   - all of its successors are sunk as well, or are the final return block;
+// the sunk blocks keep their relative order, so no branch changes direction.
+// A cold block that rejoins the hot code stays where it is; selectColdestSucc
+// has already taken it off the fall-through path.
+//
+unsigned Layout::sinkColdBlocks(Function& func, LoopInfo& LI)
+{
+    unsigned Ratio = LayoutColdRatio ? (unsigned)LayoutColdRatio :
+        (unsigned)IGC_GET_FLAG_VALUE(ColdBlockFreqRatio);
+    if (!hasBlockWeights() || Ratio == 0)
+    {
+        return 0;
+    }
+    BasicBlock* entry = &func.getEntryBlock();
+    uint64_t EntryWeight = getBlockWeight(entry);
+    if (EntryWeight == 0)
+    {
+        return 0;
+    }
+
+    // Static estimates are only trusted where they come from a hint: stacked
+    // BPI heuristics (nested 50/50 branches, float or zero compares) make
+    // plenty of ordinary blocks look rare. Without a profile, a block must
+    // also be dominated by the unlikely successor of a branch whose
+    // branch_weights (e.g. from __builtin_expect) say so.
+    SmallVector<BasicBlock*, 8> HintedCold;
+    if (m_blockCounts.empty())
+    {
+        for (BasicBlock& BB : func)
+        {
+            auto* TI = BB.getTerminator();
+            MDNode* MD = TI->getMetadata(LLVMContext::MD_prof);
+            MDString* Kind = MD ? dyn_cast<MDString>(MD->getOperand(0)) : nullptr;
+            if (!Kind || Kind->getString() != "branch_weights" ||
+                MD->getNumOperands() != TI->getNumSuccessors() + 1)
+            {
+                continue;
+            }
+            double Total = 0.0;
+            SmallVector<double, 4> Weights;
+            for (unsigned i = 1, e = MD->getNumOperands(); i != e; ++i)
+            {
+                ConstantInt* W = mdconst::dyn_extract<ConstantInt>(MD->getOperand(i));
+                Weights.push_back(W ? (double)W->getZExtValue() : 0.0);
+                Total += Weights.back();
+            }
+            for (unsigned i = 0, e = TI->getNumSuccessors(); i != e; ++i)
+            {
+                BasicBlock* succ = TI->getSuccessor(i);
+                if (succ->getSinglePredecessor() == &BB && Weights[i] * Ratio < Total)
+                {
+                    HintedCold.push_back(succ);
+                }
+            }
+        }
+        if (HintedCold.empty())
+        {
+            return 0;
+        }
+    }
+    auto isHintedCold = [&](BasicBlock* BB) {
+        for (BasicBlock* Hinted : HintedCold)
+        {
+            if (m_DT->dominates(Hinted, BB))
+            {
+                return true;
+            }
+        }
+        return false;
+    };
+    BasicBlock* Tail = &func.back();
+    if (succ_begin(Tail) != succ_end(Tail))
+    {
+        Tail = nullptr;
+    }
+
+    SmallPtrSet<BasicBlock*, 16> Cold;
+    for (BasicBlock& BB : func)
+    {
+        if (&BB == entry || &BB == Tail || LI.getLoopFor(&BB) ||
+            (double)getBlockWeight(&BB) * Ratio >= (double)EntryWeight ||
+            (m_blockCounts.empty() && !isHintedCold(&BB)) ||
+            HasThreadGroupBarrierInBlock(&BB))
+        {
+            continue;
+        }
+        bool PredInLoop = false;
+        for (BasicBlock* pred : predecessors(&BB))
+        {
+            if (LI.getLoopFor(pred))
+            {
+                PredInLoop = true;
+                break;
+            }
+        }
+        if (!PredInLoop)
+        {
+            Cold.insert(&BB);
+        }
+    }
+
+    // drop the blocks that branch back into the hot code, until none is left
+    bool Changed = true;
+    while (Changed)
+    {
+        Changed = false;
+        for (BasicBlock& BB : func)
+        {
+            if (!Cold.count(&BB))
+            {
+                continue;
+            }
+            for (BasicBlock* succ : successors(&BB))
+            {
+                if (succ != Tail && !Cold.count(succ))
+                {
+                    Cold.erase(&BB);
+                    Changed = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    SmallVector<BasicBlock*, 16> ToSink;
+    for (BasicBlock& BB : func)
+    {
+        if (Cold.count(&BB))
+        {
+            ToSink.push_back(&BB);
+        }
+    }
+    // place them back to front, leaving those already in place alone
+    unsigned NumMoved = 0;
+    BasicBlock* Next = Tail;
+    for (auto I = ToSink.rbegin(), E = ToSink.rend(); I != E; ++I)
+    {
+        BasicBlock* BB = *I;
+        if (BB->getNextNode() != Next)
+        {
+            if (Next)
+            {
+                BB->moveBefore(Next);
+            }
+            else
+            {
+                BB->moveAfter(&func.back());
+            }
+            NumMoved++;
+        }
+        Next = BB;
+    }
+    return NumMoved;
+}
+
+// Reports how often the hot path falls through: of the blocks with a
+// preferred successor, how many have it as the next block, weighted by how
+// often they run.
+void Layout::emitOptReport(Function& func, unsigned numSunk) const
+{
+    std::stringstream report;
+    report << "Function " << func.getName().str() << std::endl;
+    if (!hasBlockWeights())
+    {
+        report << "  no branch probabilities" << std::endl;
+    }
+    else
+    {
+        unsigned NumBranches = 0, NumFallThrough = 0;
+        double Weight = 0.0, FallThroughWeight = 0.0;
+        for (BasicBlock& BB : func)
+        {
+            BasicBlock* Likely = getLikelySucc(&BB);
+            if (!Likely || BB.getSingleSuccessor())
+            {
+                continue;
+            }
+            double W = (double)getBlockWeight(&BB);
+            NumBranches++;
+            Weight += W;
+            if (Likely == BB.getNextNode())
+            {
+                NumFallThrough++;
+                FallThroughWeight += W;
+            }
+        }
+        report << "  " << (m_blockCounts.empty() ? "estimated" : "profiled")
+            << " branches: " << NumBranches
+            << ", likely successor falls through: " << NumFallThrough;
+        if (Weight > 0.0)
+        {
+            report << " (" << (int)(100.0 * FallThroughWeight / Weight + 0.5)
+                << "% of executions)";
+        }
+        report << std::endl;
+        report << "  cold blocks moved to the end: " << numSunk << std::endl;
+    }
+
+    IGC::Debug::ods() << report.str();
+
+    std::stringstream optReportFile;
+    optReportFile << IGC::Debug::GetShaderOutputFolder() << "Layout.opt";
+    std::ofstream optReportStream;
+    optReportStream.open(optReportFile.str(), std::ios::app);
+    optReportStream << report.str();
+}
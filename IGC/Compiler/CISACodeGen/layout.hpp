@@ -29,9 +29,14 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <llvm/Pass.h>
 #include <llvm/Analysis/LoopInfo.h>
 #include <llvm/Analysis/PostDominators.h>
+#include <llvm/Analysis/BlockFrequencyInfo.h>
+#include <llvm/Analysis/BranchProbabilityInfo.h>
 #include <llvm/IR/Dominators.h>
 #include <llvm/IR/Instructions.h>
+#include <llvm/ADT/DenseMap.h>
 #include "common/LLVMWarningsPop.hpp"
+#include <memory>
+#include <set>
 
 namespace IGC
 {
@@ -65,6 +70,18 @@ namespace IGC
             bool SelectNoInstBlk,
             const llvm::LoopInfo& LI,
             const std::set<llvm::BasicBlock*>& VisitSet);
+        llvm::BasicBlock* selectColdestSucc(
+            llvm::BasicBlock* CurrBlk,
+            bool HasInstOnly,
+            const std::set<llvm::BasicBlock*>& VisitSet);
+        void loadBlockProfile(llvm::Function& func);
+        void computeBranchProbabilities(llvm::Function& func, llvm::LoopInfo& LI);
+        bool hasBlockWeights() const;
+        uint64_t getBlockWeight(llvm::BasicBlock* BB) const;
+        uint64_t getEdgeWeight(llvm::BasicBlock* From, llvm::BasicBlock* To) const;
+        llvm::BasicBlock* getLikelySucc(llvm::BasicBlock* BB) const;
+        unsigned sinkColdBlocks(llvm::Function& func, llvm::LoopInfo& LI);
+        void emitOptReport(llvm::Function& func, unsigned numSunk) const;
 
         bool isAtomicWrite(llvm::Instruction* inst, bool onlyLocalMem);
         bool isAtomicRead(llvm::Instruction* inst, bool onlyLocalMem);
@@ -75,6 +92,14 @@ namespace IGC
 
         llvm::PostDominatorTree* m_PDT;
         llvm::DominatorTree* m_DT;
+        /// Execution counts from the block profile; empty if there is none
+        /// for the function.
+        llvm::DenseMap<llvm::BasicBlock*, uint64_t> m_blockCounts;
+        /// Static estimates (branch_weights metadata, e.g. from
+        /// __builtin_expect, and BPI heuristics) used when there is no
+        /// profile; null if EnableProbabilityLayout is off.
+        std::unique_ptr<llvm::BranchProbabilityInfo> m_BPI;
+        std::unique_ptr<llvm::BlockFrequencyInfo> m_BFI;
     };
 
 }
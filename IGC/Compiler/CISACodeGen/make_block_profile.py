@@ -0,0 +1,85 @@
+#!/usr/bin/env python
+
+#===================== begin_copyright_notice ==================================
+
+#Copyright (c) 2017 Intel Corporation
+
+#Permission is hereby granted, free of charge, to any person obtaining a
+#copy of this software and associated documentation files (the
+#"Software"), to deal in the Software without restriction, including
+#without limitation the rights to use, copy, modify, merge, publish,
+#distribute, sublicense, and/or sell copies of the Software, and to
+#permit persons to whom the Software is furnished to do so, subject to
+#the following conditions:
+
+#The above copyright notice and this permission notice shall be included
+#in all copies or substantial portions of the Software.
+
+#THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+#OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+#MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+#IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+#CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+#TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+#SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+# Turns the BlockProfile.map written by an instrumented build (regkey
+# DumpBlockProfileMap) into a block profile for BlockProfilePath; see
+# BlockProfile.hpp for both formats.
+#
+# usage: make_block_profile.py <BlockProfile.map> <label counts> <profile>
+#
+# The label counts file has one line per executed vISA label:
+#
+#     <kernel name> <label> <execution count>
+#
+# The entry block of a function has no label of its own in the map; its
+# count is looked up under the name of the function. Producing the label
+# counts (e.g. from GTPin per-block counts and the offsets of the labels in
+# the .asm dump) is up to the profiling tool. Blocks without a count are left
+# out of the profile, which treats them as never executed.
+
+import sys
+
+def read_counts(path):
+    counts = {}
+    with open(path, 'r') as file:
+        for lineNo, line in enumerate(file, 1):
+            tokens = line.split('#')[0].split()
+            if not tokens:
+                continue
+            if len(tokens) != 3 or not tokens[2].isdigit():
+                sys.exit("%s:%d: expected '<kernel> <label> <count>'" % (path, lineNo))
+            key = (tokens[0], tokens[1])
+            counts[key] = counts.get(key, 0) + int(tokens[2])
+    return counts
+
+def convert(mapPath, counts, output):
+    kernel = None
+    func = None
+    with open(mapPath, 'r') as file:
+        for lineNo, line in enumerate(file, 1):
+            tokens = line.split('#')[0].split()
+            if not tokens:
+                continue
+            if tokens[0] == 'kernel' and len(tokens) == 3:
+                kernel = tokens[2]
+                output.write(line)
+            elif tokens[0] == 'func' and len(tokens) == 3:
+                func = tokens[1]
+                output.write(line)
+            elif len(tokens) == 2 and tokens[0].isdigit() and kernel and func:
+                label = func if tokens[1] == 'entry' else tokens[1]
+                count = counts.get((kernel, label))
+                if count is not None:
+                    output.write('%s %d\n' % (tokens[0], count))
+            else:
+                sys.exit("%s:%d: not a block map line" % (mapPath, lineNo))
+
+if len(sys.argv) != 4:
+    sys.exit("usage: make_block_profile.py <BlockProfile.map> <label counts> <profile>")
+
+counts = read_counts(sys.argv[2])
+with open(sys.argv[3], 'w') as output:
+    convert(sys.argv[1], counts, output)
@@ -648,6 +648,9 @@ namespace IGC
         zebin::PayloadArgumentsTy m_zePayloadArgs;
         // BTI information for payload arguments
         zebin::BindingTableIndicesTy m_zeBTIArgs;
+        // Generic kernel and argument values of a specialized variant
+        std::string m_zeSpecializationOf;
+        zebin::SpecializedArgumentsTy m_zeSpecializedArgs;
 
         // Analysis result of if there are non-kernel-argument ld/st in the kernel
         // If all false, we can avoid expensive memory setting of each kernel during runtime
@@ -1319,6 +1322,46 @@ namespace IGC
                     // some some optimizations disabled to avoid spill/fill instructions.
                     NoSpill = true;
                 }
+
+                // Staged compilation: stage 1 returns a quickly compiled
+                // kernel (SIMD8, or SIMD16/SIMD8 for best-perf), stage 2 the
+                // fully optimized one. See TC::TranslateBuild.
+                if (strstr(options, "-intel-stage1-fastest-compile"))
+                {
+                    StagedCompileFlag = FLAG_CG_STAGE1_FASTEST_COMPILE;
+                }
+                else if (strstr(options, "-intel-stage1-fast-compile"))
+                {
+                    StagedCompileFlag = FLAG_CG_STAGE1_FAST_COMPILE;
+                }
+                else if (strstr(options, "-intel-stage1-best-perf"))
+                {
+                    StagedCompileFlag = FLAG_CG_STAGE1_BEST_PERF;
+                }
+                else if (strstr(options, "-intel-stage2-compile"))
+                {
+                    StagedCompileStage2 = true;
+                }
+                if (strstr(options, "-intel-stage2-background"))
+                {
+                    // start stage 2 on a background thread as soon as
+                    // stage 1 is done
+                    StagedCompileBackground = true;
+                }
+
+                // -intel-kernel-arg-hints=<kernel>:<arg>=<value>[,<arg>=<value>...]
+                // Each occurrence asks for one variant of <kernel>, compiled
+                // for these argument values. See KernelArgSpecialization.
+                const char* hintOpt = "-intel-kernel-arg-hints=";
+                for (const char* O = strstr(options, hintOpt); O != nullptr;
+                    O = strstr(O + 1, hintOpt))
+                {
+                    KernelArgHint H;
+                    if (parseKernelArgHint(O + strlen(hintOpt), H))
+                    {
+                        KernelArgHints.push_back(H);
+                    }
+                }
             }
 
 
@@ -1342,11 +1385,62 @@ namespace IGC
             bool hasNoLocalToGeneric = false;
             bool EnableZEBinary = false;
             bool NoSpill = false;
+            CG_FLAG_t StagedCompileFlag = FLAG_CG_ALL_SIMDS;
+            bool StagedCompileStage2 = false;
+            bool StagedCompileBackground = false;
 
             // -1 : initial value that means it is not set from cmdline
             // 0-5: valid values set from the cmdline
             int16_t VectorCoalescingControl = -1;
 
+            struct KernelArgHint
+            {
+                std::string kernelName;
+                // (explicit argument index, value)
+                std::vector<std::pair<unsigned, uint64_t>> args;
+            };
+            std::vector<KernelArgHint> KernelArgHints;
+
+            // Parses "<kernel>:<arg>=<value>[,<arg>=<value>...]" up to the next
+            // space; returns false for a malformed hint.
+            static bool parseKernelArgHint(const char* hint, KernelArgHint& H)
+            {
+                const char* end = hint + strcspn(hint, " ");
+                const char* colon = strchr(hint, ':');
+                if (colon == nullptr || colon == hint || colon >= end)
+                {
+                    return false;
+                }
+                H.kernelName.assign(hint, colon);
+                H.args.clear();
+                const char* p = colon + 1;
+                while (p < end)
+                {
+                    char* next = nullptr;
+                    unsigned long idx = strtoul(p, &next, 10);
+                    if (next == p || *next != '=')
+                    {
+                        return false;
+                    }
+                    p = next + 1;
+                    unsigned long long val = strtoull(p, &next, 0);
+                    if (next == p)
+                    {
+                        return false;
+                    }
+                    H.args.push_back(std::make_pair((unsigned)idx, (uint64_t)val));
+                    p = next;
+                    if (*p == ',')
+                    {
+                        ++p;
+                    }
+                    else if (p != end)
+                    {
+                        return false;
+                    }
+                }
+                return !H.args.empty();
+            }
         };
 
         class Options
@@ -74,6 +74,7 @@ void initializeSplitIndirectEEtoSelPass(llvm::PassRegistry&);
 void initializeGenXFunctionGroupAnalysisPass(llvm::PassRegistry&);
 void initializeGenXCodeGenModulePass(llvm::PassRegistry&);
 void initializeEstimateFunctionSizePass(llvm::PassRegistry&);
+void initializeUniformArgsPropagationPass(llvm::PassRegistry&);
 void initializeSubroutineInlinerPass(llvm::PassRegistry&);
 void initializeHandleLoadStoreInstructionsPass(llvm::PassRegistry&);
 void initializeIGCConstPropPass(llvm::PassRegistry&);
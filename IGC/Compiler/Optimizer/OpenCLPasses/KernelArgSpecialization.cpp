@@ -0,0 +1,202 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+
+#include "common/LLVMWarningsPush.hpp"
+#include <llvm/Pass.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/CommandLine.h>
+#include <llvm/Transforms/Utils/Cloning.h>
+#include "common/LLVMWarningsPop.hpp"
+
+#include "Compiler/Optimizer/OpenCLPasses/KernelArgSpecialization.h"
+#include "Compiler/CISACodeGen/helper.h"
+#include "Compiler/CodeGenPublic.h"
+#include "Compiler/IGCPassSupport.h"
+#include "Compiler/MetaDataUtilsWrapper.h"
+#include "common/igc_regkeys.hpp"
+
+using namespace llvm;
+using namespace IGC;
+using namespace IGC::IGCMD;
+
+// The runtime often launches a kernel with scalar arguments (tile sizes,
+// strides, flags) whose values are already known when the program is built.
+// The caller can pass them as hints through the internal options:
+//
+//   -intel-kernel-arg-hints=<kernel>:<arg index>=<value>[,<arg index>=<value>...]
+//
+// Each occurrence of the option asks for one specialized variant of <kernel>.
+// This pass clones the kernel for every hint and replaces the uses of the
+// hinted arguments by constants, so that the regular pipeline folds them and
+// unrolls the loops they bound. The arguments themselves are kept, so a variant
+// has exactly the payload layout of the generic kernel and the runtime can
+// dispatch it instead whenever the actual argument values match.
+//
+// The generic kernel is always compiled as well. The variant records the
+// generic kernel's name and its argument values in FunctionMetaData, which
+// ends up as specialization_of / specialized_arguments in zeInfo. As the
+// patch-token format has no way to describe the selection, variants are only
+// created for zebin output.
+//
+
+// for lit tests; same syntax as -intel-kernel-arg-hints
+static cl::list<std::string> KernelArgHintsOpt("igc-kernel-arg-hints", cl::Hidden,
+    cl::desc("<kernel>:<arg>=<value>[,<arg>=<value>...] (-intel-kernel-arg-hints)"));
+
+namespace {
+    class KernelArgSpecialization : public ModulePass {
+    public:
+        static char ID;
+
+        KernelArgSpecialization() : ModulePass(ID) {}
+
+        bool runOnModule(Module&) override;
+
+    private:
+        void getAnalysisUsage(AnalysisUsage& AU) const override {
+            AU.addRequired<CodeGenContextWrapper>();
+            AU.addRequired<MetaDataUtilsWrapper>();
+        }
+
+        Constant* getArgConstant(Argument* Arg, uint64_t& Value) const;
+    };
+
+} // End anonymous namespace
+
+namespace IGC {
+
+    ModulePass* createKernelArgSpecializationPass() {
+        return new KernelArgSpecialization();
+    }
+
+#define PASS_FLAG "igc-kernel-arg-specialization"
+#define PASS_DESC "Clone kernels for constant argument hints."
+#define PASS_CFG_ONLY false
+#define PASS_ANALYSIS false
+    IGC_INITIALIZE_PASS_BEGIN(KernelArgSpecialization, PASS_FLAG, PASS_DESC, PASS_CFG_ONLY, PASS_ANALYSIS)
+        IGC_INITIALIZE_PASS_DEPENDENCY(CodeGenContextWrapper)
+        IGC_INITIALIZE_PASS_DEPENDENCY(MetaDataUtilsWrapper)
+        IGC_INITIALIZE_PASS_END(KernelArgSpecialization, PASS_FLAG, PASS_DESC, PASS_CFG_ONLY, PASS_ANALYSIS)
+
+} // End IGC namespace
+
+char KernelArgSpecialization::ID = 0;
+
+// Only by-value scalars can be specialized; the hint value is the argument's
+// bit pattern, truncated to its size. Value is updated to the truncated bits,
+// which is what the variant assumes.
+Constant* KernelArgSpecialization::getArgConstant(Argument* Arg, uint64_t& Value) const {
+    Type* Ty = Arg->getType();
+    if (Arg->hasByValAttr() || !(Ty->isIntegerTy() || Ty->isFloatingPointTy()))
+        return nullptr;
+    unsigned Bits = (unsigned)Ty->getPrimitiveSizeInBits();
+    if (Bits == 0 || Bits > 64)
+        return nullptr;
+    APInt Truncated(Bits, Value);
+    Value = Truncated.getZExtValue();
+    Constant* C = ConstantInt::get(Arg->getContext(), Truncated);
+    return Ty->isIntegerTy() ? C : ConstantExpr::getBitCast(C, Ty);
+}
+
+bool KernelArgSpecialization::runOnModule(Module& M) {
+    CodeGenContext* Ctx = getAnalysis<CodeGenContextWrapper>().getCodeGenContext();
+    MetaDataUtils* MDU = getAnalysis<MetaDataUtilsWrapper>().getMetaDataUtils();
+    ModuleMetaData* ModMD = Ctx->getModuleMetaData();
+
+    typedef OpenCLProgramContext::InternalOptions::KernelArgHint KernelArgHint;
+    std::vector<KernelArgHint> Hints;
+    if (Ctx->type == ShaderType::OPENCL_SHADER)
+        Hints = static_cast<OpenCLProgramContext*>(Ctx)->m_InternalOptions.KernelArgHints;
+    for (auto& Opt : KernelArgHintsOpt) {
+        KernelArgHint H;
+        if (OpenCLProgramContext::InternalOptions::parseKernelArgHint(Opt.c_str(), H))
+            Hints.push_back(H);
+    }
+
+    if (Hints.empty() || !ModMD->compOpt.EnableZEBinary)
+        return false;
+
+    const unsigned MaxVariants = IGC_GET_FLAG_VALUE(KernelArgSpecializationMaxVariants);
+    DenseMap<Function*, unsigned> NumVariants;
+    bool Changed = false;
+    for (auto& Hint : Hints) {
+        Function* F = M.getFunction(Hint.kernelName);
+        if (!F || F->isDeclaration() || !isEntryFunc(MDU, F))
+            continue;
+        unsigned& N = NumVariants[F];
+        if (N >= MaxVariants)
+            continue;
+
+        // Validate the whole hint before cloning.
+        SmallVector<std::pair<unsigned, uint64_t>, 4> Values;
+        SmallVector<Constant*, 4> Consts;
+        for (auto& A : Hint.args) {
+            uint64_t Value = A.second;
+            Constant* C = A.first < F->arg_size() ?
+                getArgConstant(F->arg_begin() + A.first, Value) : nullptr;
+            if (!C) {
+                Consts.clear();
+                break;
+            }
+            Values.push_back(std::make_pair(A.first, Value));
+            Consts.push_back(C);
+        }
+        if (Consts.empty())
+            continue;
+
+        ValueToValueMapTy VMap;
+        Function* NewF = CloneFunction(F, VMap);
+        NewF->setName(F->getName() + "__spec" + Twine(N++));
+        NewF->setLinkage(F->getLinkage());
+        if (!M.getFunction(NewF->getName()))
+            M.getFunctionList().push_back(NewF);
+        for (unsigned i = 0; i < Consts.size(); ++i)
+            (NewF->arg_begin() + Values[i].first)->replaceAllUsesWith(Consts[i]);
+
+        // A variant is a kernel of its own. Deep copy the function info, as
+        // later passes (e.g. AddImplicitArgs) update it per kernel.
+        FunctionInfoMetaDataHandle Info = MDU->getFunctionsInfoItem(F);
+        MDNode* InfoNode = cast<MDNode>(Info->generateNode(M.getContext()));
+        MDU->setFunctionsInfoItem(NewF, FunctionInfoMetaDataHandle(FunctionInfoMetaData::get(InfoNode)));
+
+        FunctionMetaData FuncMD = ModMD->FuncMD[F];
+        FuncMD.specializationOf = F->getName().str();
+        for (auto& A : Values) {
+            SpecializedArgMD Arg;
+            Arg.argIndex = (int)A.first;
+            Arg.value = A.second;
+            FuncMD.specializedArgs.push_back(Arg);
+        }
+        ModMD->FuncMD[NewF] = FuncMD;
+        Changed = true;
+    }
+
+    if (Changed)
+        MDU->save(M.getContext());
+    return Changed;
+}
@@ -4,11 +4,13 @@
 #include "Compiler/IGCPassSupport.h"
 #include "Compiler/CodeGenPublic.h"
 #include "Compiler/CISACodeGen/GenCodeGenModule.h"
+#include "Compiler/CISACodeGen/helper.h"
 #include "Compiler/Optimizer/OpenCLPasses/PrivateMemory/PrivateMemoryResolution.hpp"
 
 #include "common/debug/Debug.hpp"
 #include "llvmWrapper/IR/DataLayout.h"
 #include "llvmWrapper/Support/Alignment.h"
+#include <llvm/Support/CommandLine.h>
 
 #include <fstream>
 #include <sstream>
@@ -17,6 +19,19 @@ using namespace IGC;
 using namespace IGC::IGCMD;
 using namespace IGC::Debug;
 
+// for lit tests; same as the regkeys of the same meaning
+static cl::opt<bool> AutoPrivMemToSLM(
+    "igc-auto-private-memory-to-slm", cl::init(false), cl::Hidden,
+    cl::desc("Use the automatic policy instead of moving all allocations (EnableAutoPrivateMemoryToSLM)"));
+static cl::opt<unsigned> AutoPrivMemToSLMMaxSize(
+    "igc-auto-private-memory-to-slm-max-size", cl::init(0), cl::Hidden,
+    cl::desc("Largest allocation moved by the automatic policy (AutoPrivateMemoryToSLMMaxSize)"));
+// for lit tests; pins the hardware threads per subslice of the occupancy
+// model instead of taking them from the platform
+static cl::opt<unsigned> PrivMemToSLMHwThreads(
+    "igc-private-memory-to-slm-hw-threads", cl::init(0), cl::Hidden,
+    cl::desc("Hardware threads per subslice in the occupancy model of PrivateMemoryToSLM"));
+
 #define PASS_FLAG "igc-move-private-memory-to-slm"
 #define PASS_DESCRIPTION "Move private memory allocations to SLM"
 #define PASS_CFG_ONLY true
@@ -31,20 +46,24 @@ namespace IGC
     const unsigned int PrivateMemoryToSLM::SLM_LOCAL_VARIABLE_ALIGNMENT = 4;
     const unsigned int PrivateMemoryToSLM::SLM_LOCAL_SIZE_ALIGNMENT = 32;
 
-    // Empty constructor to force moving of all eligible allocations.
+    // Empty constructor to force moving of all eligible allocations, or
+    // to apply the automatic policy under -igc-auto-private-memory-to-slm.
     PrivateMemoryToSLM::PrivateMemoryToSLM(bool enableOptReport /* = false */) :
                                            ModulePass(ID),
-                                           m_ForceAll(true),
-                                           m_EnableOptReport(enableOptReport)
+                                           m_ForceAll(!AutoPrivMemToSLM),
+                                           m_EnableOptReport(enableOptReport),
+                                           m_AutoPolicy(AutoPrivMemToSLM)
     {
         initializePrivateMemoryToSLMPass(*PassRegistry::getPassRegistry());
     }
 
     PrivateMemoryToSLM::PrivateMemoryToSLM(std::string forcedBuffers,
-                                           bool enableOptReport) :
+                                           bool enableOptReport,
+                                           bool enableAutoPolicy /* = false */) :
                                            ModulePass(ID),
                                            m_ForceAll(false),
-                                           m_EnableOptReport(enableOptReport)
+                                           m_EnableOptReport(enableOptReport),
+                                           m_AutoPolicy(enableAutoPolicy)
     {
         // Parse semocolon-separated list of forced buffers.
         const char* SEPARATORS = ";";
@@ -72,6 +91,41 @@ namespace IGC
         optReportStream << report;
     }
 
+    // Fraction of the subslice's hardware threads kept busy when every work
+    // group uses slmSize bytes of SLM. The SIMD width is not known yet, so
+    // take the lowest over the widths the kernel may be compiled to.
+    float PrivateMemoryToSLM::getModeledOccupancy(
+        CodeGenContext* ctx,
+        FunctionInfoMetaDataHandle funcMD,
+        uint64_t threadsNum,
+        unsigned int slmSize,
+        unsigned int slmSizePerSubslice) const
+    {
+        SmallVector<SIMDMode, 3> simdModes;
+        SubGroupSizeMetaDataHandle subGroupSize = funcMD->getSubGroupSize();
+        if (subGroupSize->hasValue())
+        {
+            simdModes.push_back(lanesToSIMDMode(subGroupSize->getSIMD_size()));
+        }
+        else
+        {
+            simdModes.append({ SIMDMode::SIMD8, SIMDMode::SIMD16, SIMDMode::SIMD32 });
+        }
+
+        float occupancy = 1.0f;
+        for (SIMDMode simdMode : simdModes)
+        {
+            occupancy = std::min(occupancy,
+                GetThreadOccupancyPerSubslice(
+                    simdMode,
+                    (unsigned int)threadsNum,
+                    PrivMemToSLMHwThreads ? (unsigned int)PrivMemToSLMHwThreads : GetHwThreadsPerWG(ctx->platform),
+                    slmSize,
+                    slmSizePerSubslice));
+        }
+        return occupancy;
+    }
+
     // TODO: Unify with the original predicate from InlineLocalsResolution.cpp
     static bool useAsPointerOnly(Value* V) {
         assert(V->getType()->isPointerTy() && "Expect the input value is a pointer!");
@@ -196,12 +250,36 @@ namespace IGC
                 offset += (unsigned int) DL.getTypeAllocSize(varType);
             }
 
+            // The automatic policy only moves an allocation if the occupancy
+            // stays at or above min(original occupancy, target occupancy).
+            bool autoPolicy = m_AutoPolicy && isEntryFunc(MD, F);
+            float occupancy = 0.0f;
+            float minOccupancy = 0.0f;
+            unsigned int numAutoMoved = 0;
+            unsigned int maxAutoSize = AutoPrivMemToSLMMaxSize ? (unsigned int)AutoPrivMemToSLMMaxSize :
+                IGC_GET_FLAG_VALUE(AutoPrivateMemoryToSLMMaxSize);
+            if (autoPolicy)
+            {
+                occupancy = getModeledOccupancy(CodeGenCtx, funcMD, threadsNum, offset, (unsigned int)slmSizePerSubslice);
+                minOccupancy = occupancy;
+                unsigned int threadsPerEU = CodeGenCtx->platform.getMaxNumberThreadPerEU();
+                unsigned int targetThreadsPerEU = IGC_GET_FLAG_VALUE(AutoPrivateMemoryToSLMTargetThreadsPerEU);
+                if (targetThreadsPerEU != 0 && threadsPerEU != 0)
+                {
+                    minOccupancy = std::min(minOccupancy, float(targetThreadsPerEU) / float(threadsPerEU));
+                }
+            }
+
             if (m_EnableOptReport)
             {
                 std::stringstream report;
                 report << "Function" << F->getName().str() << std::endl
                     << "Workgroup size: " << threadsNum << ", X: " << xDim << ", Y:" << yDim << ", Z:" << zDim << std::endl
                     << "SLM size per subslice: " << slmSizePerSubslice << ", used " << offset << " bytes" << std::endl;
+                if (autoPolicy)
+                {
+                    report << "Modeled occupancy: " << occupancy << ", lowest allowed: " << minOccupancy << std::endl;
+                }
 
                 ods() << report.str();
                 emitOptReport(report.str());
@@ -216,8 +294,6 @@ namespace IGC
 
             ImplicitArgs implicitArgs(*F, MD);
 
-            Instruction* pEntryPoint = &(*F->getEntryBlock().getFirstInsertionPt());
-
             for (auto pAI : allocaInsts)
             {
                 bool isForcedBuffer =
@@ -225,7 +301,14 @@ namespace IGC
                               m_ForcedBuffers.end(),
                               pAI->getName()) != m_ForcedBuffers.end();
 
-                if (m_ForceAll || isForcedBuffer)
+                // Allocations of a dynamic size are left alone; whatever is
+                // still in private memory at this point would go to scratch.
+                bool isAutoCandidate =
+                    autoPolicy &&
+                    !pAI->isArrayAllocation() &&
+                    DL.getTypeAllocSize(pAI->getAllocatedType()) <= maxAutoSize;
+
+                if (m_ForceAll || isForcedBuffer || isAutoCandidate)
                 {
                     Type* origType = pAI->getType()->getPointerElementType();
                     bool isArray = origType->isArrayTy();
@@ -256,6 +339,28 @@ namespace IGC
                         continue;
                     }
 
+                    if (!m_ForceAll && !isForcedBuffer)
+                    {
+                        float newOccupancy = getModeledOccupancy(CodeGenCtx, funcMD, threadsNum, newOffset, (unsigned int)slmSizePerSubslice);
+                        if (newOccupancy < minOccupancy)
+                        {
+                            if (m_EnableOptReport)
+                            {
+                                std::stringstream report;
+                                report << "Skip moving a memory allocation " << pAI->getName().str()
+                                    << " of " << allocSize << " bytes"
+                                    << " to SLM, occupancy would drop to " << newOccupancy << std::endl;
+
+                                ods() << report.str();
+                                emitOptReport(report.str());
+                            }
+
+                            continue;
+                        }
+                        occupancy = newOccupancy;
+                        ++numAutoMoved;
+                    }
+
                     if (m_EnableOptReport)
                     {
                         std::stringstream report;
@@ -299,6 +404,9 @@ namespace IGC
 
                     if (CodeGenCtx->type == ShaderType::OPENCL_SHADER)
                     {
+                        // Looked up for every allocation, as the previous
+                        // entry point may be an alloca erased below.
+                        Instruction* pEntryPoint = &(*F->getEntryBlock().getFirstInsertionPt());
                         localIdX =
                             ZExtInst::CreateIntegerCast(
                                 implicitArgs.getArgInFunc(*F, ImplicitArg::LOCAL_ID_X),
@@ -385,6 +493,15 @@ namespace IGC
                     modified = true;
                 }
             }
+
+            if (autoPolicy)
+            {
+                std::string prefix = "PrivateMemoryToSLM." + F->getName().str() + ".";
+                CompilerStats& stats = CodeGenCtx->Stats();
+                stats.SetI64(prefix + "NumMoved", numAutoMoved);
+                stats.SetI64(prefix + "SLMSize", offset);
+                stats.SetF64(prefix + "ModeledOccupancy", occupancy);
+            }
         }
 
         return modified;
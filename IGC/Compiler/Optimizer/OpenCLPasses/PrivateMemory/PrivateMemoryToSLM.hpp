@@ -11,6 +11,9 @@ namespace IGC
 {
     // Experimental pass to move private memory allocations to SLM where it's
     // profitable. The pass is able to handle Compute and OpenCL shader types.
+    // Besides the forced allocations, with enableAutoPolicy it moves small
+    // allocations left in private memory as long as the modeled thread
+    // occupancy of the kernel does not drop.
     class PrivateMemoryToSLM : public ModulePass
     {
 
@@ -20,7 +23,8 @@ namespace IGC
         PrivateMemoryToSLM(bool enableOptReport = false);
         PrivateMemoryToSLM(
             std::string forcedBuffers,
-            bool enableOptReport);
+            bool enableOptReport,
+            bool enableAutoPolicy = false);
         ~PrivateMemoryToSLM() {}
 
         virtual StringRef getPassName() const override
@@ -42,8 +46,16 @@ namespace IGC
         static const unsigned int SLM_LOCAL_SIZE_ALIGNMENT;
 
     private:
+        float getModeledOccupancy(
+            CodeGenContext* ctx,
+            IGCMD::FunctionInfoMetaDataHandle funcMD,
+            uint64_t threadsNum,
+            unsigned int slmSize,
+            unsigned int slmSizePerSubslice) const;
+
         bool m_EnableOptReport;
         bool m_ForceAll;
+        bool m_AutoPolicy = false;
         std::vector<std::string> m_ForcedBuffers;
     };
-}
\ No newline at end of file
+}
@@ -36,8 +36,14 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <llvm/IR/Function.h>
 #include <llvm/IR/Instructions.h>
 #include <llvm/IR/GetElementPtrTypeIterator.h>
+#include <llvm/IR/InstIterator.h>
 #include <llvm/Analysis/ValueTracking.h>
+#include <llvm/Analysis/ScalarEvolution.h>
+#include <llvm/Support/raw_ostream.h>
 #include "common/LLVMWarningsPop.hpp"
+#include "common/debug/Debug.hpp"
+#include <fstream>
+#include <sstream>
 #include <string>
 #include "Probe/Assertion.h"
 
@@ -53,6 +59,7 @@ using namespace IGC::IGCMD;
 IGC_INITIALIZE_PASS_BEGIN(StatelessToStatefull, PASS_FLAG, PASS_DESCRIPTION, PASS_CFG_ONLY, PASS_ANALYSIS)
 IGC_INITIALIZE_PASS_DEPENDENCY(MetaDataUtilsWrapper)
 IGC_INITIALIZE_PASS_DEPENDENCY(AssumptionCacheTracker)
+IGC_INITIALIZE_PASS_DEPENDENCY(ScalarEvolutionWrapperPass)
 IGC_INITIALIZE_PASS_END(StatelessToStatefull, PASS_FLAG, PASS_DESCRIPTION, PASS_CFG_ONLY, PASS_ANALYSIS)
 
 // This pass turns a global/constants address space (stateless) load/store into a statefull a load/store.
@@ -139,9 +146,20 @@ IGC_INITIALIZE_PASS_END(StatelessToStatefull, PASS_FLAG, PASS_DESCRIPTION, PASS_
 //     example: kernelArg[-2]
 //
 //
+//  Offset ranges
+//    Besides ValueTracking on the GEP indices, offsets are proven non-negative with scalar
+//    evolution on (pointer - kernel argument), which follows phis and loop induction
+//    variables whose trip counts bound them. Pointers merged through phis and selects
+//    (e.g. pointer induction variables) are promoted when every incoming path is rooted
+//    at the same kernel argument; their offsets are rebuilt as i32 phis/selects.
+//    Accesses in subroutines are not promoted as the surface of a pointer argument is
+//    unknown there. EnableOptReportStatelessToStatefull lists the accesses left
+//    stateless and why.
+//
 // Possible Todos:
 //  - Fancier back tracing to a kernel argument
 //  - Handle > 2 operand GetElementPtr instructions // DONE!
+//  - Promote in subroutines whose pointer arguments come from one kernel argument
 //
 
 char StatelessToStatefull::ID = 0;
@@ -151,9 +169,11 @@ StatelessToStatefull::StatelessToStatefull(bool hasBufOff)
     m_hasBufferOffsetArg(hasBufOff),
     m_hasOptionalBufferOffsetArg(false),
     m_ACT(nullptr),
+    m_SE(nullptr),
     m_pImplicitArgs(nullptr),
     m_pKernelArgs(nullptr),
-    m_changed(false)
+    m_changed(false),
+    m_numPromoted(0)
 {
     initializeStatelessToStatefullPass(*PassRegistry::getPassRegistry());
 }
@@ -165,12 +185,27 @@ bool StatelessToStatefull::runOnFunction(llvm::Function& F)
 
     // skip device enqueue tests for now to avoid tracking binding tables acorss
     // enqueued blocks.
-    if ((F.getParent()->getNamedMetadata("igc.device.enqueue") != nullptr) ||
-        !isEntryFunc(pMdUtils, &F))
+    if (F.getParent()->getNamedMetadata("igc.device.enqueue") != nullptr)
     {
         return false;
     }
 
+    // TODO: promote accesses in the subroutines of the kernel's function
+    // group. That needs the surface and the i32 offset of a pointer argument
+    // passed along with it (or the callee cloned per call site), and the
+    // offset range proven at every call site; until then they stay A64 and
+    // are only reported.
+    if (!isEntryFunc(pMdUtils, &F))
+    {
+        if (IGC_IS_FLAG_ENABLED(EnableOptReportStatelessToStatefull))
+        {
+            reportSubroutine(F);
+        }
+        return false;
+    }
+
+    m_SE = &getAnalysis<ScalarEvolutionWrapperPass>().getSE();
+
     if (IGC_IS_FLAG_ENABLED(EnableCodeAssumption))
     {
         // Use assumption cache
@@ -193,10 +228,18 @@ bool StatelessToStatefull::runOnFunction(llvm::Function& F)
 
     visit(F);
 
+    if (IGC_IS_FLAG_ENABLED(EnableOptReportStatelessToStatefull))
+    {
+        emitOptReport(F);
+    }
+
     finalizeArgInitialValue(&F);
     delete m_pImplicitArgs;
     delete m_pKernelArgs;
     m_promotedKernelArgs.clear();
+    m_mergedPtrOffsets.clear();
+    m_unpromoted.clear();
+    m_numPromoted = 0;
     return m_changed;
 }
 
@@ -218,6 +261,90 @@ Argument* StatelessToStatefull::getBufferOffsetArg(Function* F, uint32_t ArgNumb
     return arg;
 }
 
+// The offset of the kernel argument itself within its surface: its
+// BUFFER_OFFSET implicit argument, or zero.
+Value* StatelessToStatefull::getBaseOffset(Function* F, uint32_t argNumber, bool isImplicitArg)
+{
+    // When SToSProducesPositivePointer is set, BUFFER_OFFSET are assumed to be zero,
+    // so is that for any implicit argument
+    if (m_hasBufferOffsetArg && !isImplicitArg &&
+        IGC_IS_FLAG_DISABLED(SToSProducesPositivePointer))
+    {
+        return getBufferOffsetArg(F, argNumber);
+    }
+    // BUFFER_OFFSET are zero.
+    return ConstantInt::get(Type::getInt32Ty(F->getContext()), 0);
+}
+
+//
+// Emit, before GEP, the byte offset GEP adds to its pointer operand, and
+// return PointerValue plus that offset (both as i32).
+//
+Value* StatelessToStatefull::emitGEPOffset(GetElementPtrInst* GEP, Value* PointerValue)
+{
+    Module* M = GEP->getModule();
+    const DataLayout* DL = &M->getDataLayout();
+    Type* int32Ty = Type::getInt32Ty(M->getContext());
+
+    Value* PtrOp = GEP->getPointerOperand();
+    PointerType* PtrTy = dyn_cast<PointerType>(PtrOp->getType());
+
+    IGC_ASSERT_MESSAGE(PtrTy, "Only accept scalar pointer!");
+
+    Type* Ty = PtrTy;
+    gep_type_iterator GTI = gep_type_begin(GEP);
+    for (auto OI = GEP->op_begin() + 1, E = GEP->op_end(); OI != E; ++OI, ++GTI)
+    {
+        Value* Idx = *OI;
+        if (StructType * StTy = GTI.getStructTypeOrNull())
+        {
+            unsigned Field = int_cast<unsigned>(cast<ConstantInt>(Idx)->getZExtValue());
+            if (Field)
+            {
+                uint64_t Offset = DL->getStructLayout(StTy)->getElementOffset(Field);
+
+                Value* OffsetValue = ConstantInt::get(int32Ty, Offset);
+
+                PointerValue = BinaryOperator::CreateAdd(PointerValue, OffsetValue, "", GEP);
+                cast<llvm::Instruction>(PointerValue)->setDebugLoc(GEP->getDebugLoc());
+            }
+            Ty = StTy->getElementType(Field);
+        }
+        else
+        {
+            Ty = GTI.getIndexedType();
+            if (const ConstantInt * CI = dyn_cast<ConstantInt>(Idx))
+            {
+                if (!CI->isZero())
+                {
+                    uint64_t Offset = DL->getTypeAllocSize(Ty) * CI->getSExtValue();
+                    Value* OffsetValue = ConstantInt::get(int32Ty, Offset);
+
+                    PointerValue = BinaryOperator::CreateAdd(PointerValue, OffsetValue, "", GEP);
+                    cast<llvm::Instruction>(PointerValue)->setDebugLoc(GEP->getDebugLoc());
+                }
+            }
+            else
+            {
+                Value* NewIdx = CastInst::CreateTruncOrBitCast(Idx, int32Ty, "", GEP);
+                cast<llvm::Instruction>(NewIdx)->setDebugLoc(GEP->getDebugLoc());
+
+                APInt ElementSize = APInt((unsigned int)int32Ty->getPrimitiveSizeInBits(), DL->getTypeAllocSize(Ty));
+
+                if (ElementSize != 1)
+                {
+                    NewIdx = BinaryOperator::CreateMul(NewIdx, ConstantInt::get(int32Ty, ElementSize), "", GEP);
+                    cast<llvm::Instruction>(NewIdx)->setDebugLoc(GEP->getDebugLoc());
+                }
+
+                PointerValue = BinaryOperator::CreateAdd(PointerValue, NewIdx, "", GEP);
+                cast<llvm::Instruction>(PointerValue)->setDebugLoc(GEP->getDebugLoc());
+            }
+        }
+    }
+    return PointerValue;
+}
+
 //
 // Convert GetElementPtrInst[s] into multiple instructions that compute the byte offset
 // from the base represented by these GEP instructions. GEPs vector keeps its elements
@@ -232,27 +359,11 @@ bool StatelessToStatefull::getOffsetFromGEP(
     Function* F, SmallVector<GetElementPtrInst*, 4> GEPs,
     uint32_t argNumber, bool isImplicitArg, Value*& offset)
 {
-    Module* M = F->getParent();
-    const DataLayout* DL = &M->getDataLayout();
-    Type* int32Ty = Type::getInt32Ty(M->getContext());
-
-    Value* PointerValue;
-    // When SToSProducesPositivePointer is set, BUFFER_OFFSET are assumed to be zero,
-    // so is that for any implicit argument
-    if (m_hasBufferOffsetArg && !isImplicitArg &&
-        IGC_IS_FLAG_DISABLED(SToSProducesPositivePointer))
+    Value* PointerValue = getBaseOffset(F, argNumber, isImplicitArg);
+    if (PointerValue == nullptr)
     {
-        PointerValue = getBufferOffsetArg(F, argNumber);
-        if (PointerValue == nullptr)
-        {
-            // Sanity check
-            return false;
-        }
-    }
-    else
-    {
-        // BUFFER_OFFSET are zero.
-        PointerValue = ConstantInt::get(int32Ty, 0);
+        // Sanity check
+        return false;
     }
 
     const int nGEPs = GEPs.size();
@@ -269,63 +380,7 @@ bool StatelessToStatefull::getOffsetFromGEP(
     //
     for (int i = nGEPs; i > 0; --i)
     {
-        GetElementPtrInst* GEP = GEPs[i - 1];
-        Value* PtrOp = GEP->getPointerOperand();
-        PointerType* PtrTy = dyn_cast<PointerType>(PtrOp->getType());
-
-        IGC_ASSERT_MESSAGE(PtrTy, "Only accept scalar pointer!");
-
-        Type* Ty = PtrTy;
-        gep_type_iterator GTI = gep_type_begin(GEP);
-        for (auto OI = GEP->op_begin() + 1, E = GEP->op_end(); OI != E; ++OI, ++GTI)
-        {
-            Value* Idx = *OI;
-            if (StructType * StTy = GTI.getStructTypeOrNull())
-            {
-                unsigned Field = int_cast<unsigned>(cast<ConstantInt>(Idx)->getZExtValue());
-                if (Field)
-                {
-                    uint64_t Offset = DL->getStructLayout(StTy)->getElementOffset(Field);
-
-                    Value* OffsetValue = ConstantInt::get(int32Ty, Offset);
-
-                    PointerValue = BinaryOperator::CreateAdd(PointerValue, OffsetValue, "", GEP);
-                    cast<llvm::Instruction>(PointerValue)->setDebugLoc(GEP->getDebugLoc());
-                }
-                Ty = StTy->getElementType(Field);
-            }
-            else
-            {
-                Ty = GTI.getIndexedType();
-                if (const ConstantInt * CI = dyn_cast<ConstantInt>(Idx))
-                {
-                    if (!CI->isZero())
-                    {
-                        uint64_t Offset = DL->getTypeAllocSize(Ty) * CI->getSExtValue();
-                        Value* OffsetValue = ConstantInt::get(int32Ty, Offset);
-
-                        PointerValue = BinaryOperator::CreateAdd(PointerValue, OffsetValue, "", GEP);
-                        cast<llvm::Instruction>(PointerValue)->setDebugLoc(GEP->getDebugLoc());
-                    }
-                }
-                else
-                {
-                    Value* NewIdx = CastInst::CreateTruncOrBitCast(Idx, int32Ty, "", GEP);
-                    cast<llvm::Instruction>(NewIdx)->setDebugLoc(GEP->getDebugLoc());
-
-                    APInt ElementSize = APInt((unsigned int)int32Ty->getPrimitiveSizeInBits(), DL->getTypeAllocSize(Ty));
-
-                    if (ElementSize != 1)
-                    {
-                        NewIdx = BinaryOperator::CreateMul(NewIdx, ConstantInt::get(int32Ty, ElementSize), "", GEP);
-                        cast<llvm::Instruction>(NewIdx)->setDebugLoc(GEP->getDebugLoc());
-                    }
-
-                    PointerValue = BinaryOperator::CreateAdd(PointerValue, NewIdx, "", GEP);
-                    cast<llvm::Instruction>(PointerValue)->setDebugLoc(GEP->getDebugLoc());
-                }
-            }
-        }
+        PointerValue = emitGEPOffset(GEPs[i - 1], PointerValue);
     }
     offset = PointerValue;
     return true;
@@ -455,6 +510,10 @@ bool StatelessToStatefull::pointerIsPositiveOffsetFromKernelArgument(
                         valueIsPositive(Idx, &(F->getParent()->getDataLayout()), AC);
                 }
             }
+            if (!gepProducesPositivePointer)
+            {
+                gepProducesPositivePointer = offsetIsKnownNonNegative(V, base);
+            }
 
             if (m_hasOptionalBufferOffsetArg)
             {
@@ -469,10 +528,215 @@ bool StatelessToStatefull::pointerIsPositiveOffsetFromKernelArgument(
             return true;
         }
     }
+    else if (const KernelArg * arg = getMergedPointerKernelArg(*ptrType, V))
+    {
+        // Same as above for a pointer merged through phis/selects; only the
+        // scalar evolution check applies here.
+        argNumber = arg->getAssociatedArgNo();
+        Value* argVal = const_cast<Argument*>(arg->getArg());
+        bool isPositive = true;
+        bool isAlignedPointee =
+            (IGC_IS_FLAG_DISABLED(UseSubDWAlignedPtrArg) || arg->isImplicitArg())
+            ? true
+            : (getPointeeAlign(DL, argVal) >= 4);
+
+        if (!arg->isImplicitArg() &&
+            isAlignedPointee &&
+            (!m_hasBufferOffsetArg || m_hasOptionalBufferOffsetArg) &&
+            IGC_IS_FLAG_DISABLED(SToSProducesPositivePointer))
+        {
+            isPositive = offsetIsKnownNonNegative(V, argVal);
+
+            if (m_hasOptionalBufferOffsetArg)
+            {
+                updateArgInfo(arg, isPositive);
+            }
+        }
+        if (m_hasBufferOffsetArg || (isPositive && isAlignedPointee))
+        {
+            if (m_mergedPtrOffsets.count(argVal) == 0)
+            {
+                Value* baseOffset = getBaseOffset(F, argNumber, arg->isImplicitArg());
+                if (baseOffset == nullptr)
+                {
+                    return false;
+                }
+                m_mergedPtrOffsets[argVal] = baseOffset;
+            }
+            offset = getOffsetFromMergedPointer(V);
+            kernelArg = arg;
+            return true;
+        }
+    }
 
     return false;
 }
 
+bool StatelessToStatefull::offsetIsKnownNonNegative(Value* V, Value* base)
+{
+    SmallPtrSet<Value*, 16> visited;
+    return offsetIsKnownNonNegative(V, base, visited);
+}
+
+bool StatelessToStatefull::offsetIsKnownNonNegative(
+    Value* V, Value* base, SmallPtrSetImpl<Value*>& visited)
+{
+    V = V->stripPointerCasts();
+    if (V == base->stripPointerCasts())
+    {
+        return true;
+    }
+    // A phi met again is the one being proven; assuming it holds is fine as
+    // every other incoming value must still be proven.
+    if (!visited.insert(V).second)
+    {
+        return true;
+    }
+
+    if (m_SE != nullptr &&
+        m_SE->isSCEVable(V->getType()) &&
+        m_SE->isSCEVable(base->getType()))
+    {
+        const SCEV* diff = m_SE->getMinusSCEV(m_SE->getSCEV(V), m_SE->getSCEV(base));
+        if (!isa<SCEVCouldNotCompute>(diff) && m_SE->getSignedRange(diff).isAllNonNegative())
+        {
+            return true;
+        }
+    }
+
+    // Scalar evolution gives up on phis other than induction variables
+    if (PHINode * PN = dyn_cast<PHINode>(V))
+    {
+        for (Value* In : PN->incoming_values())
+        {
+            if (!offsetIsKnownNonNegative(In, base, visited))
+                return false;
+        }
+        return true;
+    }
+    if (SelectInst * SI = dyn_cast<SelectInst>(V))
+    {
+        return offsetIsKnownNonNegative(SI->getTrueValue(), base, visited) &&
+            offsetIsKnownNonNegative(SI->getFalseValue(), base, visited);
+    }
+    if (GetElementPtrInst * GEP = dyn_cast<GetElementPtrInst>(V))
+    {
+        Function* F = GEP->getParent()->getParent();
+        for (auto U = GEP->idx_begin(), E = GEP->idx_end(); U != E; ++U)
+        {
+            if (!valueIsPositive(U->get(), &F->getParent()->getDataLayout(), getAC(F)))
+                return false;
+        }
+        return offsetIsKnownNonNegative(GEP->getPointerOperand(), base, visited);
+    }
+    return false;
+}
+
+const KernelArg* StatelessToStatefull::getMergedPointerKernelArg(const PointerType& ptrType, Value* V)
+{
+    const unsigned int ptrAS = ptrType.getAddressSpace();
+    const KernelArg* root = nullptr;
+    bool isMerged = false;
+
+    SmallPtrSet<Value*, 16> visited;
+    SmallVector<Value*, 16> worklist;
+    worklist.push_back(V->stripPointerCasts());
+    while (!worklist.empty())
+    {
+        Value* P = worklist.pop_back_val();
+        if (!visited.insert(P).second)
+        {
+            continue;
+        }
+        // stripPointerCasts might skip addrSpaceCast
+        PointerType* PTy = dyn_cast<PointerType>(P->getType());
+        if (!PTy || PTy->getAddressSpace() != ptrAS)
+        {
+            return nullptr;
+        }
+
+        if (GetElementPtrInst * GEP = dyn_cast<GetElementPtrInst>(P))
+        {
+            worklist.push_back(GEP->getPointerOperand()->stripPointerCasts());
+        }
+        else if (PHINode * PN = dyn_cast<PHINode>(P))
+        {
+            isMerged = true;
+            for (Value* In : PN->incoming_values())
+            {
+                worklist.push_back(In->stripPointerCasts());
+            }
+        }
+        else if (SelectInst * SI = dyn_cast<SelectInst>(P))
+        {
+            isMerged = true;
+            worklist.push_back(SI->getTrueValue()->stripPointerCasts());
+            worklist.push_back(SI->getFalseValue()->stripPointerCasts());
+        }
+        else if (isa<Argument>(P))
+        {
+            const KernelArg* arg = getKernelArg(P);
+            if (arg == nullptr || (root != nullptr && root != arg))
+            {
+                return nullptr;
+            }
+            root = arg;
+        }
+        else
+        {
+            return nullptr;
+        }
+    }
+    // plain GEP chains are handled by gepIsFromKernelArgument
+    return isMerged ? root : nullptr;
+}
+
+//
+// Rebuild the i32 offset of a pointer found by getMergedPointerKernelArg:
+// GEPs add their offsets as in getOffsetFromGEP, phis and selects get
+// i32 counterparts. Offsets are cached per function in m_mergedPtrOffsets,
+// which is seeded with the base offset of the kernel argument; a phi is
+// cached before its incoming values are visited so loops terminate.
+//
+Value* StatelessToStatefull::getOffsetFromMergedPointer(Value* V)
+{
+    V = V->stripPointerCasts();
+    auto II = m_mergedPtrOffsets.find(V);
+    if (II != m_mergedPtrOffsets.end())
+    {
+        return II->second;
+    }
+
+    Type* int32Ty = Type::getInt32Ty(V->getContext());
+    Value* offset = nullptr;
+    if (GetElementPtrInst * GEP = dyn_cast<GetElementPtrInst>(V))
+    {
+        offset = emitGEPOffset(GEP, getOffsetFromMergedPointer(GEP->getPointerOperand()));
+    }
+    else if (PHINode * PN = dyn_cast<PHINode>(V))
+    {
+        PHINode* offsetPN = PHINode::Create(int32Ty, PN->getNumIncomingValues(), "", PN);
+        offsetPN->setDebugLoc(PN->getDebugLoc());
+        m_mergedPtrOffsets[V] = offsetPN;
+        for (unsigned i = 0, e = PN->getNumIncomingValues(); i != e; ++i)
+        {
+            offsetPN->addIncoming(
+                getOffsetFromMergedPointer(PN->getIncomingValue(i)), PN->getIncomingBlock(i));
+        }
+        return offsetPN;
+    }
+    else
+    {
+        SelectInst* SI = cast<SelectInst>(V);
+        Value* trueOffset = getOffsetFromMergedPointer(SI->getTrueValue());
+        Value* falseOffset = getOffsetFromMergedPointer(SI->getFalseValue());
+        offset = SelectInst::Create(SI->getCondition(), trueOffset, falseOffset, "", SI);
+        cast<Instruction>(offset)->setDebugLoc(SI->getDebugLoc());
+    }
+    m_mergedPtrOffsets[V] = offset;
+    return offset;
+}
+
 void StatelessToStatefull::visitCallInst(CallInst& I)
 {
     auto doPromoteUntypedAtomics = [](const GenISAIntrinsic::ID intrinID, const GenIntrinsicInst* Inst)-> bool
@@ -605,6 +869,11 @@ void StatelessToStatefull::visitCallInst(CallInst& I)
 
                 m_changed = true;
                 m_promotedKernelArgs.insert(kernelArg);
+                ++m_numPromoted;
+            }
+            else
+            {
+                recordUnpromoted(I, ptr);
             }
         }
 
@@ -702,6 +971,11 @@ void StatelessToStatefull::visitLoadInst(LoadInst& I)
 
         m_changed = true;
         m_promotedKernelArgs.insert(kernelArg);
+        ++m_numPromoted;
+    }
+    else
+    {
+        recordUnpromoted(I, ptr);
     }
 
     // check if there's non-kernel-arg load/store
@@ -752,8 +1026,13 @@ void StatelessToStatefull::visitStoreInst(StoreInst& I)
 
             m_changed = true;
             m_promotedKernelArgs.insert(kernelArg);
+            ++m_numPromoted;
         }
     }
+    else
+    {
+        recordUnpromoted(I, ptr);
+    }
 
     if (IGC_IS_FLAG_ENABLED(DumpHasNonKernelArgLdSt) &&
         ptr != nullptr && !pointerIsFromKernelArgument(*ptr)) {
@@ -867,3 +1146,111 @@ void StatelessToStatefull::finalizeArgInitialValue(Function* F)
     }
     m_argsInfo.clear();
 }
+
+const char* StatelessToStatefull::getUnpromotedReason(Value* ptr)
+{
+    if (m_promotedKernelArgs.size() >= maxPromotionCount)
+    {
+        return "promotion limit reached";
+    }
+
+    PointerType* ptrType = cast<PointerType>(ptr->getType());
+    Value* base = ptr->stripPointerCasts();
+    GetElementPtrInst* gep = nullptr;
+    while (isa<GetElementPtrInst>(base)) {
+        gep = static_cast<GetElementPtrInst*>(base);
+        base = gep->getPointerOperand()->stripPointerCasts();
+    }
+
+    if (gepIsFromKernelArgument(*ptrType, gep) != nullptr ||
+        getMergedPointerKernelArg(*ptrType, ptr) != nullptr)
+    {
+        return "offset from the kernel argument not proven non-negative, or argument not DW-aligned";
+    }
+    if (isa<Argument>(base))
+    {
+        return gep == nullptr ? "kernel argument accessed without a GEP" : "pointer crosses an address space cast";
+    }
+    if (isa<PHINode>(base) || isa<SelectInst>(base))
+    {
+        return "pointer merges values not rooted at a single kernel argument";
+    }
+    if (isa<LoadInst>(base))
+    {
+        return "pointer loaded from memory";
+    }
+    if (isa<CallInst>(base))
+    {
+        return "pointer returned by a call";
+    }
+    if (isa<IntToPtrInst>(base))
+    {
+        return "pointer computed from an integer";
+    }
+    return "pointer not traceable to a kernel argument";
+}
+
+void StatelessToStatefull::recordUnpromoted(Instruction& I, Value* ptr)
+{
+    if (IGC_IS_FLAG_DISABLED(EnableOptReportStatelessToStatefull))
+    {
+        return;
+    }
+    unsigned AS = ptr->getType()->getPointerAddressSpace();
+    if (AS != ADDRESS_SPACE_GLOBAL && AS != ADDRESS_SPACE_CONSTANT)
+    {
+        return;
+    }
+
+    std::string str;
+    raw_string_ostream OS(str);
+    I.print(OS);
+    OS << "\n    reason: " << getUnpromotedReason(ptr);
+    m_unpromoted.push_back(OS.str());
+}
+
+void StatelessToStatefull::reportSubroutine(Function& F)
+{
+    for (Instruction& I : instructions(F))
+    {
+        Value* ptr = nullptr;
+        if (LoadInst * LI = dyn_cast<LoadInst>(&I))
+            ptr = LI->getPointerOperand();
+        else if (StoreInst * SI = dyn_cast<StoreInst>(&I))
+            ptr = SI->getPointerOperand();
+        if (ptr == nullptr)
+            continue;
+
+        unsigned AS = ptr->getType()->getPointerAddressSpace();
+        if (AS != ADDRESS_SPACE_GLOBAL && AS != ADDRESS_SPACE_CONSTANT)
+            continue;
+
+        std::string str;
+        raw_string_ostream OS(str);
+        I.print(OS);
+        OS << "\n    reason: access in a subroutine, only kernels are promoted";
+        m_unpromoted.push_back(OS.str());
+    }
+    emitOptReport(F);
+    m_unpromoted.clear();
+}
+
+void StatelessToStatefull::emitOptReport(Function& F) const
+{
+    std::stringstream report;
+    report << "Function " << F.getName().str() << std::endl
+        << "Stateless accesses promoted to stateful: " << m_numPromoted
+        << ", left stateless: " << m_unpromoted.size() << std::endl;
+    for (const std::string& access : m_unpromoted)
+    {
+        report << access << std::endl;
+    }
+
+    IGC::Debug::ods() << report.str();
+
+    std::stringstream optReportFile;
+    optReportFile << IGC::Debug::GetShaderOutputFolder() << "StatelessToStatefull.opt";
+    std::ofstream optReportStream;
+    optReportStream.open(optReportFile.str(), std::ios::app);
+    optReportStream << report.str();
+}
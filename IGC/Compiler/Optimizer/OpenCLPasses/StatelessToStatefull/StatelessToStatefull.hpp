@@ -34,6 +34,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <llvm/IR/InstVisitor.h>
 #include <llvm/IR/Instruction.h>
 #include <llvm/Analysis/AssumptionCache.h>
+#include <llvm/Analysis/ScalarEvolution.h>
 #include "common/LLVMWarningsPop.hpp"
 #include "Probe/Assertion.h"
 
@@ -60,6 +61,7 @@ namespace IGC
             AU.setPreservesCFG();
             AU.addRequired<MetaDataUtilsWrapper>();
             AU.addRequired<llvm::AssumptionCacheTracker>();
+            AU.addRequired<llvm::ScalarEvolutionWrapperPass>();
             AU.addRequired<CodeGenContextWrapper>();
         }
 
@@ -88,6 +90,20 @@ namespace IGC
         // check if the given pointer can be traced back to any kernel argument
         bool pointerIsFromKernelArgument(llvm::Value& ptr);
 
+        // Offset ranges: proves V - base >= 0 with scalar evolution, which
+        // sees through loop induction variables. Other phis and selects are
+        // checked per incoming value.
+        bool offsetIsKnownNonNegative(llvm::Value* V, llvm::Value* base);
+        bool offsetIsKnownNonNegative(
+            llvm::Value* V, llvm::Value* base, llvm::SmallPtrSetImpl<llvm::Value*>& visited);
+
+        // Pointers merged through phis/selects: return the kernel argument
+        // that every incoming path is rooted at, or nullptr.
+        const KernelArg* getMergedPointerKernelArg(const llvm::PointerType& ptrType, llvm::Value* V);
+        llvm::Value* getOffsetFromMergedPointer(llvm::Value* V);
+
+        llvm::Value* getBaseOffset(llvm::Function* F, uint32_t argNumber, bool isImplicitArg);
+        llvm::Value* emitGEPOffset(llvm::GetElementPtrInst* GEP, llvm::Value* PointerValue);
         bool getOffsetFromGEP(
             llvm::Function* F, llvm::SmallVector<llvm::GetElementPtrInst*, 4> GEPs,
             uint32_t argNumber, bool isImplicitArg, llvm::Value*& offset);
@@ -97,6 +113,12 @@ namespace IGC
         void updateArgInfo(const KernelArg* KA, bool IsPositive);
         void finalizeArgInitialValue(llvm::Function* F);
 
+        // opt report (EnableOptReportStatelessToStatefull)
+        const char* getUnpromotedReason(llvm::Value* ptr);
+        void recordUnpromoted(llvm::Instruction& I, llvm::Value* ptr);
+        void reportSubroutine(llvm::Function& F);
+        void emitOptReport(llvm::Function& F) const;
+
         const KernelArg* getKernelArg(llvm::Value* Arg)
         {
             IGC_ASSERT_MESSAGE(m_pKernelArgs, "Should initialize it before use!");
@@ -134,11 +156,18 @@ namespace IGC
                 : nullptr);
         }
 
+        llvm::ScalarEvolution* m_SE;
+
         ImplicitArgs* m_pImplicitArgs;
         KernelArgs* m_pKernelArgs;
         ArgInfoMap   m_argsInfo;
         bool m_changed;
         std::unordered_set<const KernelArg*> m_promotedKernelArgs; // ptr args which have been promoted to stateful
+        // i32 offsets of pointers merged through phis/selects, and of their kernel args
+        llvm::DenseMap<llvm::Value*, llvm::Value*> m_mergedPtrOffsets;
+
+        unsigned m_numPromoted;
+        std::vector<std::string> m_unpromoted;
     };
 
 }
@@ -44,6 +44,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Compiler/Optimizer/PreCompiledFuncImport.hpp"
 #include "Compiler/Optimizer/PreCompiledFuncLibrary.cpp"
 #include <unordered_map>
+#include <mutex>
 #include "Compiler/Builtins/LibraryIntS32DivRemEmu.hpp"
 #include "Compiler/Builtins/LibraryIntU32DivRemEmu.hpp"
 #include "Compiler/Builtins/LibraryIntS32DivRemEmuSP.hpp"
@@ -170,6 +171,150 @@ const LibraryModuleInfo PreCompiledFuncImport::m_libModInfos[NUM_LIBMODS] =
     /* LIBMOD_SP_DIV      */   { igcbuiltin_emu_sp_div, sizeof(igcbuiltin_emu_sp_div) }
 };
 
+namespace {
+    // For each function of a library module that has been imported so far,
+    // the names of the library functions it reaches (itself included).
+    // Shared by all compilations in the process, so that later imports go
+    // straight to materializing those instead of walking the call graph.
+    // The library bitcode doesn't depend on the DP rounding/denorm modes
+    // (they are call arguments), so the library module is the whole key.
+    class LibraryCalleeClosures
+    {
+    public:
+        bool lookup(int LibModID, StringRef FuncName, std::vector<std::string>& Closure)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto I = m_closures[LibModID].find(FuncName.str());
+            if (I == m_closures[LibModID].end())
+            {
+                return false;
+            }
+            Closure = I->second;
+            return true;
+        }
+
+        void insert(int LibModID, StringRef FuncName, const std::vector<std::string>& Closure)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_closures[LibModID].emplace(FuncName.str(), Closure);
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::unordered_map<std::string, std::vector<std::string>>
+            m_closures[PreCompiledFuncImport::NUM_LIBMODS];
+    };
+
+    LibraryCalleeClosures s_libCalleeClosures;
+
+    void materializeLibraryFunction(Function* F)
+    {
+        if (!F->isMaterializable())
+        {
+            return;
+        }
+        if (Error Err = F->materialize())
+        {
+            handleAllErrors(std::move(Err), [&](ErrorInfoBase& EIB) {
+                errs() << "===> Materialize Failure: " << EIB.message().c_str() << '\n';
+            });
+            IGC_ASSERT_MESSAGE(0, "Failed to materialize emulation function");
+        }
+    }
+
+    // Materializes Root and every library function reachable from it,
+    // returning their names.
+    void computeCalleeClosure(Function* Root, std::vector<std::string>& Closure)
+    {
+        SmallPtrSet<Function*, 16> visited;
+        SmallVector<Function*, 16> worklist;
+        visited.insert(Root);
+        worklist.push_back(Root);
+        while (!worklist.empty())
+        {
+            Function* F = worklist.pop_back_val();
+            materializeLibraryFunction(F);
+            Closure.push_back(F->getName().str());
+            for (auto& I : instructions(F))
+            {
+                for (Value* Op : I.operands())
+                {
+                    Function* Callee = dyn_cast<Function>(Op->stripPointerCasts());
+                    if (Callee && !Callee->isDeclaration() && visited.insert(Callee).second)
+                    {
+                        worklist.push_back(Callee);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void PreCompiledFuncImport::importLibraryModule(Module& M, int LibModID)
+{
+    // The library stays in the binary, so the lazy module can refer to it
+    // in place.
+    StringRef BitRef((const char*)m_libModInfos[LibModID].Mod, m_libModInfos[LibModID].ModSize);
+    llvm::Expected<std::unique_ptr<llvm::Module>> ModuleOrErr =
+        llvm::getLazyBitcodeModule(MemoryBufferRef(BitRef, ""), M.getContext());
+    if (llvm::Error EC = ModuleOrErr.takeError())
+    {
+        consumeError(std::move(EC));
+        IGC_ASSERT_MESSAGE(0, "llvm getLazyBitcodeModule - FAILED to parse bitcode");
+        return;
+    }
+    std::unique_ptr<llvm::Module> LibModule = std::move(*ModuleOrErr);
+    IGC_ASSERT_MESSAGE(LibModule, "llvm version mismatch - could not load llvm module");
+
+    // Materialize what M calls from this library. Functions M already has
+    // (from an earlier round) are not linked again.
+    bool needed = false;
+    for (Function& F : M)
+    {
+        if (!F.isDeclaration() || F.isIntrinsic())
+        {
+            continue;
+        }
+        Function* LibF = LibModule->getFunction(F.getName());
+        if (!LibF || LibF->isDeclaration())
+        {
+            continue;
+        }
+        needed = true;
+
+        std::vector<std::string> closure;
+        if (s_libCalleeClosures.lookup(LibModID, LibF->getName(), closure))
+        {
+            for (const std::string& name : closure)
+            {
+                materializeLibraryFunction(LibModule->getFunction(name));
+            }
+        }
+        else
+        {
+            computeCalleeClosure(LibF, closure);
+            s_libCalleeClosures.insert(LibModID, LibF->getName(), closure);
+        }
+    }
+    if (!needed)
+    {
+        return;
+    }
+
+    // Set target triple and datalayout to the original module (emulation func
+    // works for both 64 & 32 bit applications).
+    LibModule->setDataLayout(M.getDataLayout());
+    LibModule->setTargetTriple(M.getTargetTriple());
+
+    // Link only what M references; the functions left unmaterialized are
+    // dropped with the library module.
+    llvm::Linker ld(M);
+    if (ld.linkInModule(std::move(LibModule), llvm::Linker::LinkOnlyNeeded))
+    {
+        IGC_ASSERT_MESSAGE(0, "Error linking the two modules");
+    }
+}
+
 // This function scans intructions before emulation. It converts double-related
 // operations (intrinsics, instructions) into ones that can be emulated. It has:
 //   1. Intrinsics
@@ -398,7 +543,6 @@ bool PreCompiledFuncImport::runOnModule(Module& M)
 
     for (int i = 0; i < NUM_LIBMODS; ++i) {
         m_libModuleToBeImported[i] = false;
-        m_libModuleAlreadyImported[i] = false;
     }
 
     SmallSet<Function*, 32> origFunctions;
@@ -425,44 +569,13 @@ bool PreCompiledFuncImport::runOnModule(Module& M)
         m_CallRemDiv.clear();
         if (m_changed)
         {
-            llvm::Linker ld(M);
+            // The second round may need functions of a library that the
+            // first round didn't, so libraries can be imported twice.
             for (int i = 0; i < NUM_LIBMODS; ++i)
             {
-                if (!m_libModuleToBeImported[i]) {
-                    continue;
-                }
-
-                if (m_libModuleAlreadyImported[i])
-                    continue;
-
-                const char* pLibraryModule = (const char*)m_libModInfos[i].Mod;
-                uint32_t libSize = m_libModInfos[i].ModSize;
-
-                // Load the module we want to compile and link it to existing module
-                StringRef BitRef(pLibraryModule, libSize);
-                llvm::Expected<std::unique_ptr<llvm::Module>> ModuleOrErr =
-                    llvm::parseBitcodeFile(MemoryBufferRef(BitRef.str(), ""), M.getContext());
-                if (llvm::Error EC = ModuleOrErr.takeError())
-                {
-                    IGC_ASSERT_MESSAGE(0, "llvm getLazyBitcodeModule - FAILED to parse bitcode");
-                }
-                std::unique_ptr<llvm::Module> m_pBuiltinModule = std::move(*ModuleOrErr);
-                IGC_ASSERT_MESSAGE(m_pBuiltinModule, "llvm version mismatch - could not load llvm module");
-
-                // Set target triple and datalayout to the original module (emulation func
-                // works for both 64 & 32 bit applications).
-                m_pBuiltinModule->setDataLayout(M.getDataLayout());
-                m_pBuiltinModule->setTargetTriple(M.getTargetTriple());
-
-                // Linking the two modules
-                llvm::Linker ld(M);
-
-                if (ld.linkInModule(std::move(m_pBuiltinModule)))
-                {
-                    IGC_ASSERT_MESSAGE(0, "Error linking the two modules");
+                if (m_libModuleToBeImported[i]) {
+                    importLibraryModule(M, i);
                 }
-                m_libModuleAlreadyImported[i] = true;
-                m_pBuiltinModule = nullptr;
             }
         }
         for (int i = 0; i < NUM_LIBMODS; ++i)
@@ -223,7 +223,10 @@ namespace IGC
         bool isDPConvFunc(llvm::Function* F) const;
 
         bool m_libModuleToBeImported[NUM_LIBMODS];
-        bool m_libModuleAlreadyImported[NUM_LIBMODS];
+
+        // Links in the functions of the given library module that M calls
+        // (and whatever those call), materializing nothing else.
+        void importLibraryModule(llvm::Module& M, int LibModID);
 
         bool Int32DivRemEmuRemaining = true;
 
@@ -132,6 +132,9 @@ void PromoteStatelessToBindless::GetAccessInstToSrcPointerMap(Instruction* inst,
             return;
     }
 
+    // TODO: like StatelessToStatefull, this only sees accesses rooted at an
+    // argument of the function itself; pointers passed to subroutines are not
+    // traced across the call.
     std::vector<Value*> tempList;
     Value* srcPtr = IGC::TracePointerSource(resourcePtr, false, true, true, tempList);
 
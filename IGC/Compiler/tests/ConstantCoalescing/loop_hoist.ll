@@ -0,0 +1,80 @@
+;===================== begin_copyright_notice ==================================
+
+;Copyright (c) 2017 Intel Corporation
+
+;Permission is hereby granted, free of charge, to any person obtaining a
+;copy of this software and associated documentation files (the
+;"Software"), to deal in the Software without restriction, including
+;without limitation the rights to use, copy, modify, merge, publish,
+;distribute, sublicense, and/or sell copies of the Software, and to
+;permit persons to whom the Software is furnished to do so, subject to
+;the following conditions:
+
+;The above copyright notice and this permission notice shall be included
+;in all copies or substantial portions of the Software.
+
+;THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+;OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+;MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+;IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+;CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+;TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+;SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+;======================= end_copyright_notice ==================================
+; RUN: igc_opt %s -S -o - -igc-constant-coalescing -igc-constant-coalescing-loop-hoist | FileCheck %s
+
+; Uniform loads of loop-invariant constant memory are moved to the loop
+; preheader when they run on every path out of the loop. The i64 loads
+; are left alone by the coalescing itself, which only merges dwords.
+
+define void @hoist(i64 addrspace(2)* %cb, i32 %n, i64 addrspace(1)* %out) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %latch ]
+  %acc = phi i64 [ 0, %entry ], [ %acc.next, %latch ]
+  %inv = load i64, i64 addrspace(2)* %cb, align 8
+  %c = icmp ult i32 %i, 7
+  br i1 %c, label %cond, label %latch
+
+cond:
+  %p1 = getelementptr i64, i64 addrspace(2)* %cb, i64 1
+  %cnd = load i64, i64 addrspace(2)* %p1, align 8
+  br label %latch
+
+latch:
+  %v = phi i64 [ %inv, %loop ], [ %cnd, %cond ]
+  %acc.next = add i64 %acc, %v
+  %i.next = add i32 %i, 1
+  %done = icmp eq i32 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  store i64 %acc.next, i64 addrspace(1)* %out, align 8
+  ret void
+}
+
+; %inv dominates the only exiting block and is hoisted.
+; CHECK-LABEL: define void @hoist(
+; CHECK: entry:
+; CHECK-NEXT: %inv = load i64, i64 addrspace(2)* %cb, align 8
+; CHECK-NEXT: br label %loop
+
+; CHECK: loop:
+; CHECK-NOT: load
+; CHECK: br i1 %c, label %cond, label %latch
+
+; %cnd only runs when %c holds and stays in its block.
+; CHECK: cond:
+; CHECK-NEXT: %p1 = getelementptr i64, i64 addrspace(2)* %cb, i64 1
+; CHECK-NEXT: %cnd = load i64, i64 addrspace(2)* %p1, align 8
+; CHECK-NEXT: br label %latch
+
+!igc.functions = !{!0}
+!0 = !{void (i64 addrspace(2)*, i32, i64 addrspace(1)*)* @hoist, !1}
+!1 = !{!2, !3}
+!2 = !{!"function_type", i32 0}
+!3 = !{!"implicit_arg_desc"}
@@ -0,0 +1,136 @@
+;===================== begin_copyright_notice ==================================
+
+;Copyright (c) 2017 Intel Corporation
+
+;Permission is hereby granted, free of charge, to any person obtaining a
+;copy of this software and associated documentation files (the
+;"Software"), to deal in the Software without restriction, including
+;without limitation the rights to use, copy, modify, merge, publish,
+;distribute, sublicense, and/or sell copies of the Software, and to
+;permit persons to whom the Software is furnished to do so, subject to
+;the following conditions:
+
+;The above copyright notice and this permission notice shall be included
+;in all copies or substantial portions of the Software.
+
+;THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+;OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+;MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+;IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+;CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+;TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+;SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+;======================= end_copyright_notice ==================================
+; RUN: igc_opt %s -S -o - -igc-emu64ops | FileCheck %s
+
+; Index and hash style 64-bit arithmetic whose operands are known to be
+; 32-bit wide: these get the narrow expansions instead of the `*_pair`
+; sequences.
+
+define void @mul_zext(i32 %a, i32 %b, i64 addrspace(1)* %dst) {
+; CHECK-LABEL: define void @mul_zext
+; CHECK-NOT: GenISA.mul.pair
+; CHECK: [[LO:%.*]] = mul i32 %a, %b
+; CHECK: [[HI:%.*]] = call i32 @llvm.genx.GenISA.umulH.i32(i32 %a, i32 %b)
+; CHECK: insertelement <2 x i32> undef, i32 [[LO]], i32 0
+; CHECK: insertelement <2 x i32> {{.*}}, i32 [[HI]], i32 1
+  %x = zext i32 %a to i64
+  %y = zext i32 %b to i64
+  %m = mul i64 %x, %y
+  store i64 %m, i64 addrspace(1)* %dst, align 8
+  ret void
+}
+
+define void @mul_sext(i32 %a, i32 %b, i64 addrspace(1)* %dst) {
+; CHECK-LABEL: define void @mul_sext
+; CHECK-NOT: GenISA.mul.pair
+; CHECK: [[LO:%.*]] = mul i32 %a, %b
+; CHECK: [[HI:%.*]] = call i32 @llvm.genx.GenISA.imulH.i32(i32 %a, i32 %b)
+; CHECK: insertelement <2 x i32> undef, i32 [[LO]], i32 0
+; CHECK: insertelement <2 x i32> {{.*}}, i32 [[HI]], i32 1
+  %x = sext i32 %a to i64
+  %y = sext i32 %b to i64
+  %m = mul i64 %x, %y
+  store i64 %m, i64 addrspace(1)* %dst, align 8
+  ret void
+}
+
+define void @mul_sext_const(i32 %a, i64 addrspace(1)* %dst) {
+; CHECK-LABEL: define void @mul_sext_const
+; CHECK-NOT: GenISA.mul.pair
+; CHECK: [[LO:%.*]] = mul i32 %a, -24
+; CHECK: [[HI:%.*]] = call i32 @llvm.genx.GenISA.imulH.i32(i32 %a, i32 -24)
+; CHECK: insertelement <2 x i32> undef, i32 [[LO]], i32 0
+; CHECK: insertelement <2 x i32> {{.*}}, i32 [[HI]], i32 1
+  %x = sext i32 %a to i64
+  %m = mul i64 %x, -24
+  store i64 %m, i64 addrspace(1)* %dst, align 8
+  ret void
+}
+
+define void @mul_wide(i64 %x, i32 %b, i64 addrspace(1)* %dst) {
+; CHECK-LABEL: define void @mul_wide
+; CHECK-NOT: GenISA.umulH
+; CHECK: call { i32, i32 } @llvm.genx.GenISA.mul.pair(i32 {{%.*}}, i32 {{%.*}}, i32 %b, i32 0)
+  %y = zext i32 %b to i64
+  %m = mul i64 %x, %y
+  store i64 %m, i64 addrspace(1)* %dst, align 8
+  ret void
+}
+
+; The Lo of `zext %b << 32` is 0, so Lo of the sum is Lo of %x and only the
+; Hi halves are added (the Hi of the shift is %b, as `shl i32 %b, 0`).
+define void @add_hi_only(i64 %x, i32 %b, i64 addrspace(1)* %dst) {
+; CHECK-LABEL: define void @add_hi_only
+; CHECK-NOT: GenISA.add.pair
+; CHECK: [[X:%.*]] = bitcast i64 %x to <2 x i32>
+; CHECK: [[XLO:%.*]] = extractelement <2 x i32> [[X]], i32 0
+; CHECK: [[XHI:%.*]] = extractelement <2 x i32> [[X]], i32 1
+; CHECK: [[Y:%.*]] = shl i32 %b, 0
+; CHECK: [[HI:%.*]] = add i32 [[XHI]], [[Y]]
+; CHECK: insertelement <2 x i32> undef, i32 [[XLO]], i32 0
+; CHECK: insertelement <2 x i32> {{.*}}, i32 [[HI]], i32 1
+  %y = zext i32 %b to i64
+  %s = shl i64 %y, 32
+  %r = add i64 %x, %s
+  store i64 %r, i64 addrspace(1)* %dst, align 8
+  ret void
+}
+
+define void @sub_hi_only(i64 %x, i32 %b, i64 addrspace(1)* %dst) {
+; CHECK-LABEL: define void @sub_hi_only
+; CHECK-NOT: GenISA.sub.pair
+; CHECK: [[X:%.*]] = bitcast i64 %x to <2 x i32>
+; CHECK: [[XLO:%.*]] = extractelement <2 x i32> [[X]], i32 0
+; CHECK: [[XHI:%.*]] = extractelement <2 x i32> [[X]], i32 1
+; CHECK: [[Y:%.*]] = shl i32 %b, 0
+; CHECK: [[HI:%.*]] = sub i32 [[XHI]], [[Y]]
+; CHECK: insertelement <2 x i32> undef, i32 [[XLO]], i32 0
+; CHECK: insertelement <2 x i32> {{.*}}, i32 [[HI]], i32 1
+  %y = zext i32 %b to i64
+  %s = shl i64 %y, 32
+  %r = sub i64 %x, %s
+  store i64 %r, i64 addrspace(1)* %dst, align 8
+  ret void
+}
+
+define void @add_pair(i64 %x, i64 %y, i64 addrspace(1)* %dst) {
+; CHECK-LABEL: define void @add_pair
+; CHECK: call { i32, i32 } @llvm.genx.GenISA.add.pair(i32 {{%.*}}, i32 {{%.*}}, i32 {{%.*}}, i32 {{%.*}})
+  %r = add i64 %x, %y
+  store i64 %r, i64 addrspace(1)* %dst, align 8
+  ret void
+}
+
+!igc.functions = !{!0, !3, !4, !5, !6, !7, !8}
+!0 = !{void (i32, i32, i64 addrspace(1)*)* @mul_zext, !1}
+!1 = !{!2}
+!2 = !{!"function_type", i32 0}
+!3 = !{void (i32, i32, i64 addrspace(1)*)* @mul_sext, !1}
+!4 = !{void (i32, i64 addrspace(1)*)* @mul_sext_const, !1}
+!5 = !{void (i64, i32, i64 addrspace(1)*)* @mul_wide, !1}
+!6 = !{void (i64, i32, i64 addrspace(1)*)* @add_hi_only, !1}
+!7 = !{void (i64, i32, i64 addrspace(1)*)* @sub_hi_only, !1}
+!8 = !{void (i64, i64, i64 addrspace(1)*)* @add_pair, !1}
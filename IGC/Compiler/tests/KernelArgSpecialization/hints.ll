@@ -0,0 +1,79 @@
+;===================== begin_copyright_notice ==================================
+
+;Copyright (c) 2017 Intel Corporation
+
+;Permission is hereby granted, free of charge, to any person obtaining a
+;copy of this software and associated documentation files (the
+;"Software"), to deal in the Software without restriction, including
+;without limitation the rights to use, copy, modify, merge, publish,
+;distribute, sublicense, and/or sell copies of the Software, and to
+;permit persons to whom the Software is furnished to do so, subject to
+;the following conditions:
+
+;The above copyright notice and this permission notice shall be included
+;in all copies or substantial portions of the Software.
+
+;THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+;OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+;MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+;IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+;CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+;TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+;SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+;======================= end_copyright_notice ==================================
+; RUN: igc_opt %s -S -o - -igc-kernel-arg-specialization \
+; RUN:   -igc-kernel-arg-hints=foo:0=0x100000010,1=0x3f800000 \
+; RUN:   -igc-kernel-arg-hints=foo:0=4 \
+; RUN:   -igc-kernel-arg-hints=foo:2=0 \
+; RUN:   -igc-kernel-arg-hints=bar:0=1 | FileCheck %s
+
+; The first two hints each add a variant of @foo with the hinted arguments
+; replaced; the i32 value is truncated to the argument's size. A hint on a
+; pointer argument or on a function that isn't a kernel is dropped.
+
+; CHECK-LABEL: define spir_kernel void @foo(
+; CHECK: store i32 %n,
+; CHECK: store float %f,
+
+; CHECK-LABEL: define void @bar(
+; CHECK: ret void
+
+; CHECK-LABEL: define spir_kernel void @foo__spec0(
+; CHECK: store i32 16,
+; CHECK: store float 1.000000e+00,
+
+; CHECK-LABEL: define spir_kernel void @foo__spec1(
+; CHECK: store i32 4,
+; CHECK: store float %f,
+
+; CHECK-NOT: define {{.*}}@foo__spec2
+; CHECK-NOT: define {{.*}}@bar__spec
+
+; Each variant is a kernel of its own.
+; CHECK-DAG: !{void (i32, float, i32 addrspace(1)*, float addrspace(1)*)* @foo__spec0, !{{[0-9]+}}}
+; CHECK-DAG: !{void (i32, float, i32 addrspace(1)*, float addrspace(1)*)* @foo__spec1, !{{[0-9]+}}}
+
+define spir_kernel void @foo(i32 %n, float %f, i32 addrspace(1)* %p, float addrspace(1)* %q) {
+entry:
+  store i32 %n, i32 addrspace(1)* %p, align 4
+  store float %f, float addrspace(1)* %q, align 4
+  ret void
+}
+
+define void @bar(i32 %n) {
+entry:
+  ret void
+}
+
+!igc.functions = !{!0}
+!IGCMetadata = !{!3}
+
+!0 = !{void (i32, float, i32 addrspace(1)*, float addrspace(1)*)* @foo, !1}
+!1 = !{!2, !6}
+!2 = !{!"function_type", i32 0}
+!6 = !{!"implicit_arg_desc"}
+!3 = !{!"ModuleMD", !4}
+!4 = !{!"compOpt", !5}
+!5 = !{!"EnableZEBinary", i1 true}
@@ -0,0 +1,172 @@
+;===================== begin_copyright_notice ==================================
+
+;Copyright (c) 2017 Intel Corporation
+
+;Permission is hereby granted, free of charge, to any person obtaining a
+;copy of this software and associated documentation files (the
+;"Software"), to deal in the Software without restriction, including
+;without limitation the rights to use, copy, modify, merge, publish,
+;distribute, sublicense, and/or sell copies of the Software, and to
+;permit persons to whom the Software is furnished to do so, subject to
+;the following conditions:
+
+;The above copyright notice and this permission notice shall be included
+;in all copies or substantial portions of the Software.
+
+;THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+;OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+;MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+;IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+;CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+;TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+;SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+;======================= end_copyright_notice ==================================
+; RUN: igc_opt %s -S -o - -lower-expect -igc-layout -igc-layout-probability | FileCheck %s --check-prefix=PROB
+; RUN: igc_opt %s -S -o - -lower-expect -igc-layout -igc-layout-probability -igc-layout-cold-ratio=256 | FileCheck %s --check-prefix=SINK
+
+; Layout driven by branch probabilities: the likely successor falls through,
+; and cold blocks behind a branch_weights hint move to the end of the
+; function unless that would break the structured control flow.
+
+declare i1 @llvm.expect.i1(i1, i1)
+
+; __builtin_expect makes %common the fall-through; without it, %rare would be.
+; PROB-LABEL: define void @expect_fallthrough
+; PROB: {{^}}entry:
+; PROB: {{^}}common:
+; PROB: {{^}}rare:
+; PROB: {{^}}exit:
+define void @expect_fallthrough(i32 %a, i32 addrspace(1)* %p) {
+entry:
+  %c = icmp ne i32 %a, 0
+  %e = call i1 @llvm.expect.i1(i1 %c, i1 true)
+  br i1 %e, label %common, label %rare
+
+rare:
+  store i32 2, i32 addrspace(1)* %p
+  br label %exit
+
+common:
+  store i32 1, i32 addrspace(1)* %p
+  br label %exit
+
+exit:
+  ret void
+}
+
+; %err only leads to the return block, so it is moved in front of it, past
+; the unrelated %other.
+; PROB-LABEL: define void @sink_cold
+; PROB: {{^}}entry:
+; PROB: {{^}}check:
+; PROB: {{^}}work:
+; PROB: {{^}}err:
+; PROB: {{^}}other:
+; PROB: {{^}}exit:
+; SINK-LABEL: define void @sink_cold
+; SINK: {{^}}entry:
+; SINK: {{^}}check:
+; SINK: {{^}}work:
+; SINK: {{^}}other:
+; SINK: {{^}}err:
+; SINK: {{^}}exit:
+define void @sink_cold(i32 %a, i32 %b, i32 addrspace(1)* %p) {
+entry:
+  %c = icmp ne i32 %a, 0
+  br i1 %c, label %other, label %check, !prof !0
+
+other:
+  store i32 1, i32 addrspace(1)* %p
+  br label %exit
+
+check:
+  %c2 = icmp ne i32 %b, 0
+  %e = call i1 @llvm.expect.i1(i1 %c2, i1 true)
+  br i1 %e, label %work, label %err
+
+work:
+  store i32 2, i32 addrspace(1)* %p
+  br label %exit
+
+err:
+  store i32 -1, i32 addrspace(1)* %p
+  br label %exit
+
+exit:
+  ret void
+}
+
+; A cold block inside a loop stays in the loop.
+; SINK-LABEL: define void @cold_in_loop
+; SINK: {{^}}entry:
+; SINK: {{^}}loop:
+; SINK: {{^}}err:
+; SINK: {{^}}latch:
+; SINK: {{^}}after:
+; SINK: {{^}}exit:
+define void @cold_in_loop(i32 %n, i32 addrspace(1)* %p) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %latch ]
+  %c = icmp ne i32 %i, 1000
+  %e = call i1 @llvm.expect.i1(i1 %c, i1 true)
+  br i1 %e, label %latch, label %err
+
+err:
+  store i32 -1, i32 addrspace(1)* %p
+  br label %latch
+
+latch:
+  store i32 %i, i32 addrspace(1)* %p
+  %i.next = add i32 %i, 1
+  %cmp = icmp slt i32 %i.next, %n
+  br i1 %cmp, label %loop, label %after
+
+after:
+  store i32 %n, i32 addrspace(1)* %p
+  br label %exit
+
+exit:
+  ret void
+}
+
+; A cold block that rejoins the hot code stays in front of it; moving it to
+; the end would need a backward branch.
+; SINK-LABEL: define void @cold_rejoins
+; SINK: {{^}}entry:
+; SINK: {{^}}check:
+; SINK: {{^}}fixup:
+; SINK: {{^}}work:
+; SINK: {{^}}other:
+; SINK: {{^}}exit:
+define void @cold_rejoins(i32 %a, i32 %b, i32 addrspace(1)* %p) {
+entry:
+  %c = icmp ne i32 %a, 0
+  br i1 %c, label %other, label %check, !prof !0
+
+other:
+  store i32 1, i32 addrspace(1)* %p
+  br label %exit
+
+check:
+  %c2 = icmp ne i32 %b, 0
+  %e = call i1 @llvm.expect.i1(i1 %c2, i1 true)
+  br i1 %e, label %work, label %fixup
+
+fixup:
+  store i32 -1, i32 addrspace(1)* %p
+  br label %work
+
+work:
+  store i32 2, i32 addrspace(1)* %p
+  br label %exit
+
+exit:
+  ret void
+}
+
+!0 = !{!"branch_weights", i32 1, i32 1}
@@ -0,0 +1,122 @@
+;===================== begin_copyright_notice ==================================
+
+;Copyright (c) 2017 Intel Corporation
+
+;Permission is hereby granted, free of charge, to any person obtaining a
+;copy of this software and associated documentation files (the
+;"Software"), to deal in the Software without restriction, including
+;without limitation the rights to use, copy, modify, merge, publish,
+;distribute, sublicense, and/or sell copies of the Software, and to
+;permit persons to whom the Software is furnished to do so, subject to
+;the following conditions:
+
+;The above copyright notice and this permission notice shall be included
+;in all copies or substantial portions of the Software.
+
+;THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+;OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+;MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+;IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+;CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+;TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+;SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+;======================= end_copyright_notice ==================================
+; RUN: igc_opt %s -S -o - -igc-layout | FileCheck %s --check-prefix=STATIC
+; RUN: igc_opt %s -S -o - -igc-layout -igc-block-profile=%S/Inputs/profile.txt | FileCheck %s --check-prefix=PROF
+
+; Layout driven by a block profile (Inputs/profile.txt, shader hash 0 as in
+; igc_opt): the block that ran most often falls through. Without a profile
+; the first successor with instructions is visited first and placed last.
+
+; PROF-LABEL: define void @diamond
+; PROF: {{^}}entry:
+; PROF: {{^}}then:
+; PROF: {{^}}else:
+; PROF: {{^}}exit:
+; STATIC-LABEL: define void @diamond
+; STATIC: {{^}}entry:
+; STATIC: {{^}}else:
+; STATIC: {{^}}then:
+; STATIC: {{^}}exit:
+define void @diamond(i32 %a, i32 addrspace(1)* %p) {
+entry:
+  %c = icmp ne i32 %a, 0
+  br i1 %c, label %then, label %else
+
+then:
+  store i32 1, i32 addrspace(1)* %p
+  br label %exit
+
+else:
+  store i32 2, i32 addrspace(1)* %p
+  br label %exit
+
+exit:
+  ret void
+}
+
+; The profile of @stale was taken from a different CFG (checksum mismatch),
+; so its counts are ignored and the static layout is kept.
+; PROF-LABEL: define void @stale
+; PROF: {{^}}entry:
+; PROF: {{^}}else:
+; PROF: {{^}}then:
+; PROF: {{^}}exit:
+define void @stale(i32 %a, i32 addrspace(1)* %p) {
+entry:
+  %c = icmp ne i32 %a, 0
+  br i1 %c, label %then, label %else
+
+then:
+  store i32 1, i32 addrspace(1)* %p
+  br label %exit
+
+else:
+  store i32 2, i32 addrspace(1)* %p
+  br label %exit
+
+exit:
+  ret void
+}
+
+; @loop is compiled into two kernels of the shader. %else is hotter in the
+; first one, %then in the sum of both, so %then falls through.
+; PROF-LABEL: define void @loop
+; PROF: {{^}}header:
+; PROF: {{^}}then:
+; PROF: {{^}}else:
+; PROF: {{^}}latch:
+; STATIC-LABEL: define void @loop
+; STATIC: {{^}}header:
+; STATIC: {{^}}else:
+; STATIC: {{^}}then:
+; STATIC: {{^}}latch:
+define void @loop(i32 %n, i32 addrspace(1)* %p) {
+entry:
+  br label %header
+
+header:
+  %i = phi i32 [ 0, %entry ], [ %inc, %latch ]
+  %odd = and i32 %i, 7
+  %c = icmp eq i32 %odd, 0
+  br i1 %c, label %then, label %else
+
+then:
+  store i32 %i, i32 addrspace(1)* %p
+  br label %latch
+
+else:
+  %q = getelementptr i32, i32 addrspace(1)* %p, i32 %i
+  store i32 %i, i32 addrspace(1)* %q
+  br label %latch
+
+latch:
+  %inc = add i32 %i, 1
+  %done = icmp eq i32 %inc, %n
+  br i1 %done, label %exit, label %header
+
+exit:
+  ret void
+}
@@ -0,0 +1,126 @@
+;===================== begin_copyright_notice ==================================
+
+;Copyright (c) 2017 Intel Corporation
+
+;Permission is hereby granted, free of charge, to any person obtaining a
+;copy of this software and associated documentation files (the
+;"Software"), to deal in the Software without restriction, including
+;without limitation the rights to use, copy, modify, merge, publish,
+;distribute, sublicense, and/or sell copies of the Software, and to
+;permit persons to whom the Software is furnished to do so, subject to
+;the following conditions:
+
+;The above copyright notice and this permission notice shall be included
+;in all copies or substantial portions of the Software.
+
+;THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+;OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+;MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+;IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+;CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+;TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+;SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+;======================= end_copyright_notice ==================================
+; RUN: igc_opt %s -S -o - -igc-priv-mem-to-reg -igc-hybrid-priv-mem | FileCheck %s
+
+; [64 x float] is too large to promote whole, so a window of 48 elements goes
+; to a vector alloca and the other 16 stay in a private array.
+
+target datalayout = "e-p:32:32:32-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f16:16:16-f32:32:32-f64:64:64-f80:128:128-v16:16:16-v24:32:32-v32:32:32-v48:64:64-v64:64:64-v96:128:128-v128:128:128-v192:256:256-v256:256:256-v512:512:512-v1024:1024:1024-a:64:64-f80:128:128-n8:16:32:64"
+
+; Constant indices go straight to one of the two allocas. The window starts
+; at the lowest index covering the most accesses, here 3, so index 3 is hot
+; element 0 and index 60 is cold element 60 - 48 = 12.
+
+; CHECK-LABEL: define void @const_idx
+; CHECK: %a.hot = alloca <48 x float>
+; CHECK: %a.cold = alloca [16 x float]
+; CHECK-NOT: alloca [64 x float]
+; CHECK-NOT: call void @llvm.dbg.declare
+; CHECK: [[V0:%.*]] = load <48 x float>, <48 x float>* %a.hot
+; CHECK: [[V1:%.*]] = insertelement <48 x float> [[V0]], float %x, i32 0
+; CHECK: store <48 x float> [[V1]], <48 x float>* %a.hot
+; CHECK: [[P60:%.*]] = getelementptr inbounds [16 x float], [16 x float]* %a.cold, i32 0, i32 12
+; CHECK: store float %y, float* [[P60]]
+; CHECK: [[V2:%.*]] = load <48 x float>, <48 x float>* %a.hot
+; CHECK: [[L3:%.*]] = extractelement <48 x float> [[V2]], i32 0
+; CHECK: [[Q60:%.*]] = getelementptr inbounds [16 x float], [16 x float]* %a.cold, i32 0, i32 12
+; CHECK: [[L60:%.*]] = load float, float* [[Q60]]
+; CHECK: fadd float [[L3]], [[L60]]
+; CHECK-NOT: call void @llvm.dbg.declare
+; CHECK: ret void
+
+define void @const_idx(float %x, float %y, float addrspace(1)* %out) !dbg !6 {
+entry:
+  %a = alloca [64 x float], align 4
+  call void @llvm.dbg.declare(metadata [64 x float]* %a, metadata !9, metadata !DIExpression()), !dbg !14
+  %p3 = getelementptr inbounds [64 x float], [64 x float]* %a, i32 0, i32 3
+  store float %x, float* %p3, align 4
+  %p60 = getelementptr inbounds [64 x float], [64 x float]* %a, i32 0, i32 60
+  store float %y, float* %p60, align 4
+  %l3 = load float, float* %p3, align 4
+  %l60 = load float, float* %p60, align 4
+  %s = fadd float %l3, %l60
+  store float %s, float addrspace(1)* %out, align 4
+  ret void
+}
+
+; A dynamic index branches on whether it falls in the window [5, 53).
+
+; CHECK-LABEL: define void @dyn_idx
+; CHECK: %a.hot = alloca <48 x float>
+; CHECK: %a.cold = alloca [16 x float]
+; CHECK: [[OFF:%.*]] = sub i32 [[IDX:%.*]], 5
+; CHECK: [[IN:%.*]] = icmp ult i32 [[OFF]], 48
+; CHECK: br i1 [[IN]], label
+; CHECK: [[H0:%.*]] = load <48 x float>, <48 x float>* %a.hot
+; CHECK: [[HIDX:%.*]] = sub i32 [[IDX]], 5
+; CHECK: [[H1:%.*]] = insertelement <48 x float> [[H0]], float %x, i32 [[HIDX]]
+; CHECK: store <48 x float> [[H1]], <48 x float>* %a.hot
+; CHECK: [[CSUB:%.*]] = sub i32 [[IDX]], 48
+; CHECK: [[CLOW:%.*]] = icmp ult i32 [[IDX]], 5
+; CHECK: [[CIDX:%.*]] = select i1 [[CLOW]], i32 [[IDX]], i32 [[CSUB]]
+; CHECK: [[CPTR:%.*]] = getelementptr inbounds [16 x float], [16 x float]* %a.cold, i32 0, i32 [[CIDX]]
+; CHECK: store float %x, float* [[CPTR]]
+; CHECK: [[L0:%.*]] = load <48 x float>, <48 x float>* %a.hot
+; CHECK: [[L5:%.*]] = extractelement <48 x float> [[L0]], i32 0
+; CHECK: store float [[L5]], float addrspace(1)* %out
+; CHECK-NOT: alloca [64 x float]
+; CHECK: ret void
+
+define void @dyn_idx(float %x, i32 %i, float addrspace(1)* %out) {
+entry:
+  %a = alloca [64 x float], align 4
+  %pi = getelementptr inbounds [64 x float], [64 x float]* %a, i32 0, i32 %i
+  store float %x, float* %pi, align 4
+  %p5 = getelementptr inbounds [64 x float], [64 x float]* %a, i32 0, i32 5
+  %l5 = load float, float* %p5, align 4
+  store float %l5, float addrspace(1)* %out, align 4
+  ret void
+}
+
+declare void @llvm.dbg.declare(metadata, metadata, metadata)
+
+!llvm.dbg.cu = !{!0}
+!llvm.module.flags = !{!3}
+!igc.functions = !{!15, !18}
+
+!0 = distinct !DICompileUnit(language: DW_LANG_C99, file: !1, producer: "clang", isOptimized: false, runtimeVersion: 0, emissionKind: FullDebug, enums: !2)
+!1 = !DIFile(filename: "hybrid.cl", directory: "/")
+!2 = !{}
+!3 = !{i32 2, !"Debug Info Version", i32 3}
+!6 = distinct !DISubprogram(name: "const_idx", scope: !1, file: !1, line: 1, type: !7, isLocal: false, isDefinition: true, scopeLine: 1, isOptimized: false, unit: !0, retainedNodes: !2)
+!7 = !DISubroutineType(types: !8)
+!8 = !{null}
+!9 = !DILocalVariable(name: "a", scope: !6, file: !1, line: 2, type: !10)
+!10 = !DICompositeType(tag: DW_TAG_array_type, baseType: !11, size: 2048, elements: !12)
+!11 = !DIBasicType(name: "float", size: 32, encoding: DW_ATE_float)
+!12 = !{!13}
+!13 = !DISubrange(count: 64)
+!14 = !DILocation(line: 2, column: 11, scope: !6)
+!15 = !{void (float, float, float addrspace(1)*)* @const_idx, !16}
+!16 = !{!17}
+!17 = !{!"function_type", i32 0}
+!18 = !{void (float, i32, float addrspace(1)*)* @dyn_idx, !16}
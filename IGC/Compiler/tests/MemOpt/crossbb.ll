@@ -0,0 +1,129 @@
+;===================== begin_copyright_notice ==================================
+
+;Copyright (c) 2020 Intel Corporation
+
+;Permission is hereby granted, free of charge, to any person obtaining a
+;copy of this software and associated documentation files (the
+;"Software"), to deal in the Software without restriction, including
+;without limitation the rights to use, copy, modify, merge, publish,
+;distribute, sublicense, and/or sell copies of the Software, and to
+;permit persons to whom the Software is furnished to do so, subject to
+;the following conditions:
+
+;The above copyright notice and this permission notice shall be included
+;in all copies or substantial portions of the Software.
+
+;THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+;OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+;MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+;IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+;CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+;TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+;SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+;======================= end_copyright_notice ==================================
+; RUN: igc_opt %s -S -o - -basicaa -igc-memopt -instcombine | FileCheck %s
+
+target datalayout = "e-p:32:32:32-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f16:16:16-f32:32:32-f64:64:64-f80:128:128-v16:16:16-v24:32:32-v32:32:32-v48:64:64-v64:64:64-v96:128:128-v128:128:128-v192:256:256-v256:256:256-v512:512:512-v1024:1024:1024-a:64:64-f80:128:128-n8:16:32:64"
+
+define void @g0(i32* noalias %dst, i32* noalias %src, i32 %c) {
+entry:
+  %0 = load i32, i32* %src, align 4
+  %cmp = icmp eq i32 %c, 0
+  br i1 %cmp, label %if.then, label %if.end
+
+if.then:
+  store i32 0, i32* %dst, align 4
+  br label %if.end
+
+if.end:
+  %arrayidx1 = getelementptr inbounds i32, i32* %src, i64 1
+  %1 = load i32, i32* %arrayidx1, align 4
+  %add = add i32 %0, %1
+  %arrayidx2 = getelementptr inbounds i32, i32* %dst, i64 1
+  store i32 %add, i32* %arrayidx2, align 4
+  ret void
+}
+
+; The store in the if-converted region doesn't alias '%src'. Loads from
+; control-equivalent BBs are merged into the leading one.
+
+; CHECK-LABEL: define void @g0
+; CHECK: entry:
+; CHECK: %0 = bitcast i32* %src to <2 x i32>*
+; CHECK: %1 = load <2 x i32>, <2 x i32>* %0, align 4
+; CHECK: if.then:
+; CHECK: if.end:
+; CHECK-NOT: load i32
+; CHECK: ret void
+
+
+define void @g1(i32* %dst, i32* %src, i32 %c) {
+entry:
+  %0 = load i32, i32* %src, align 4
+  %cmp = icmp eq i32 %c, 0
+  br i1 %cmp, label %if.then, label %if.end
+
+if.then:
+  store i32 0, i32* %dst, align 4
+  br label %if.end
+
+if.end:
+  %arrayidx1 = getelementptr inbounds i32, i32* %src, i64 1
+  %1 = load i32, i32* %arrayidx1, align 4
+  %add = add i32 %0, %1
+  %arrayidx2 = getelementptr inbounds i32, i32* %dst, i64 1
+  store i32 %add, i32* %arrayidx2, align 4
+  ret void
+}
+
+; Without 'noalias' attribute, the store in the if-converted region may write
+; '%src'. Hence, loads across it cannot be merged.
+
+; CHECK-LABEL: define void @g1
+; CHECK: entry:
+; CHECK: %0 = load i32, i32* %src, align 4
+; CHECK: if.end:
+; CHECK: %1 = load i32, i32* %arrayidx1, align 4
+; CHECK: ret void
+
+
+define void @g2(i32* noalias %dst, i32* noalias %src, i32 %c) {
+entry:
+  %cmp = icmp eq i32 %c, 0
+  br i1 %cmp, label %if.then, label %if.end
+
+if.then:
+  %0 = load i32, i32* %src, align 4
+  store i32 %0, i32* %dst, align 4
+  br label %if.end
+
+if.end:
+  %arrayidx1 = getelementptr inbounds i32, i32* %src, i64 1
+  %1 = load i32, i32* %arrayidx1, align 4
+  %arrayidx2 = getelementptr inbounds i32, i32* %dst, i64 1
+  store i32 %1, i32* %arrayidx2, align 4
+  ret void
+}
+
+; Conditionally executed loads/stores are never merged with ones from
+; control-equivalent BBs.
+
+; CHECK-LABEL: define void @g2
+; CHECK: if.then:
+; CHECK: %0 = load i32, i32* %src, align 4
+; CHECK: store i32 %0, i32* %dst, align 4
+; CHECK: if.end:
+; CHECK: %1 = load i32, i32* %arrayidx1, align 4
+; CHECK: store i32 %1, i32* %arrayidx2, align 4
+; CHECK: ret void
+
+!igc.functions = !{!0, !3, !4}
+
+!0 = !{void (i32*, i32*, i32)* @g0, !1}
+!3 = !{void (i32*, i32*, i32)* @g1, !1}
+!4 = !{void (i32*, i32*, i32)* @g2, !1}
+
+!1 = !{!2}
+!2 = !{!"function_type", i32 0}
@@ -0,0 +1,121 @@
+;===================== begin_copyright_notice ==================================
+
+;Copyright (c) 2017 Intel Corporation
+
+;Permission is hereby granted, free of charge, to any person obtaining a
+;copy of this software and associated documentation files (the
+;"Software"), to deal in the Software without restriction, including
+;without limitation the rights to use, copy, modify, merge, publish,
+;distribute, sublicense, and/or sell copies of the Software, and to
+;permit persons to whom the Software is furnished to do so, subject to
+;the following conditions:
+
+;The above copyright notice and this permission notice shall be included
+;in all copies or substantial portions of the Software.
+
+;THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+;OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+;MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+;IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+;CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+;TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+;SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+;======================= end_copyright_notice ==================================
+; RUN: igc_opt %s -S -o - -igc-move-private-memory-to-slm -igc-auto-private-memory-to-slm -igc-private-memory-to-slm-hw-threads=64 | FileCheck %s
+
+; The occupancy model runs with 64 hardware threads per subslice, 64 KB of
+; SLM and SIMD16 (the required sub-group size).
+;
+; @occupancy: 64 work items take 4 threads, so 16 work groups fit on a
+; subslice without SLM. %small needs 256 bytes of SLM and keeps all 16;
+; %big needs 8 KB and would leave room for 7 work groups only.
+;
+; @size: one work item, 64 work groups fit without SLM. %huge would need
+; 512 bytes and keep all 64, but at 512 bytes per work item it is larger
+; than AutoPrivateMemoryToSLMMaxSize (256) and is not considered.
+
+; CHECK: @occupancy.small = addrspace(3) global [64 x i32] undef, section "localSLM", align 4
+; CHECK: @two.first = addrspace(3) global [64 x i32] undef, section "localSLM", align 4
+; CHECK: @two.second = addrspace(3) global [64 x i32] undef, section "localSLM", align 4
+; CHECK-NOT: @occupancy.big
+; CHECK-NOT: @size.huge
+
+define void @occupancy(<8 x i32> %r0, <8 x i32> %payloadHeader, i16 %localIdX, i16 %localIdY, i16 %localIdZ) {
+entry:
+  %small = alloca i32, align 4
+  %big = alloca [32 x i32], align 4
+  store i32 1, i32* %small, align 4
+  %p = getelementptr inbounds [32 x i32], [32 x i32]* %big, i32 0, i32 1
+  store i32 2, i32* %p, align 4
+  ret void
+}
+
+; The pointer to %small becomes the work item's slot in @occupancy.small,
+; localIdX + 64 * localIdY + 64 * localIdZ.
+
+; CHECK-LABEL: define void @occupancy(
+; CHECK-NOT: %small = alloca
+; CHECK: [[X:%.*]] = zext i16 %localIdX to i32
+; CHECK: [[Y:%.*]] = zext i16 %localIdY to i32
+; CHECK: [[Z:%.*]] = zext i16 %localIdZ to i32
+; CHECK: [[YOFF:%.*]] = mul i32 64, [[Y]]
+; CHECK: [[ZOFF:%.*]] = mul i32 64, [[Z]]
+; CHECK: [[YZ:%.*]] = add i32 [[YOFF]], [[ZOFF]]
+; CHECK: [[OFF:%.*]] = add i32 [[X]], [[YZ]]
+; CHECK: [[SMALL:%.*]] = getelementptr i32, i32* addrspacecast ({{.*}}@occupancy.small{{.*}} to i32*), i32 [[OFF]]
+; CHECK: %big = alloca [32 x i32], align 4
+; CHECK: store i32 1, i32* [[SMALL]], align 4
+
+define void @size(<8 x i32> %r0, <8 x i32> %payloadHeader, i16 %localIdX, i16 %localIdY, i16 %localIdZ) {
+entry:
+  %huge = alloca [128 x i32], align 4
+  %p = getelementptr inbounds [128 x i32], [128 x i32]* %huge, i32 0, i32 1
+  store i32 3, i32* %p, align 4
+  ret void
+}
+
+; CHECK-LABEL: define void @size(
+; CHECK: %huge = alloca [128 x i32], align 4
+
+; @two: both allocations fit. %first was the insertion point for the local
+; IDs and is erased once moved, so those of %second go to the top of the
+; entry block, ahead of the ones of %first.
+
+define void @two(<8 x i32> %r0, <8 x i32> %payloadHeader, i16 %localIdX, i16 %localIdY, i16 %localIdZ) {
+entry:
+  %first = alloca i32, align 4
+  %second = alloca i32, align 4
+  store i32 1, i32* %first, align 4
+  store i32 2, i32* %second, align 4
+  ret void
+}
+
+; CHECK-LABEL: define void @two(
+; CHECK-NOT: alloca
+; CHECK: [[X2:%.*]] = zext i16 %localIdX to i32
+; CHECK: [[X1:%.*]] = zext i16 %localIdX to i32
+; CHECK: [[OFF1:%.*]] = add i32 [[X1]],
+; CHECK: [[FIRST:%.*]] = getelementptr i32, i32* addrspacecast ({{.*}}@two.first{{.*}} to i32*), i32 [[OFF1]]
+; CHECK: [[OFF2:%.*]] = add i32 [[X2]],
+; CHECK: [[SECOND:%.*]] = getelementptr i32, i32* addrspacecast ({{.*}}@two.second{{.*}} to i32*), i32 [[OFF2]]
+; CHECK: store i32 1, i32* [[FIRST]], align 4
+; CHECK: store i32 2, i32* [[SECOND]], align 4
+
+!igc.functions = !{!0, !10, !13}
+!0 = !{void (<8 x i32>, <8 x i32>, i16, i16, i16)* @occupancy, !1}
+!1 = !{!2, !3, !9, !20}
+!2 = !{!"function_type", i32 0}
+!3 = !{!"implicit_arg_desc", !4, !5, !6, !7, !8}
+!4 = !{i32 0}
+!5 = !{i32 1}
+!6 = !{i32 7}
+!7 = !{i32 8}
+!8 = !{i32 9}
+!9 = !{!"thread_group_size", i32 64, i32 1, i32 1}
+!10 = !{void (<8 x i32>, <8 x i32>, i16, i16, i16)* @size, !11}
+!11 = !{!2, !3, !12, !20}
+!12 = !{!"thread_group_size", i32 1, i32 1, i32 1}
+!13 = !{void (<8 x i32>, <8 x i32>, i16, i16, i16)* @two, !1}
+!20 = !{!"sub_group_size", i32 16}
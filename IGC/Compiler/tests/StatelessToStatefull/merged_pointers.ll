@@ -0,0 +1,213 @@
+;===================== begin_copyright_notice ==================================
+
+;Copyright (c) 2017 Intel Corporation
+
+;Permission is hereby granted, free of charge, to any person obtaining a
+;copy of this software and associated documentation files (the
+;"Software"), to deal in the Software without restriction, including
+;without limitation the rights to use, copy, modify, merge, publish,
+;distribute, sublicense, and/or sell copies of the Software, and to
+;permit persons to whom the Software is furnished to do so, subject to
+;the following conditions:
+
+;The above copyright notice and this permission notice shall be included
+;in all copies or substantial portions of the Software.
+
+;THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+;OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+;MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+;IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+;CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+;TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+;SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+;======================= end_copyright_notice ==================================
+; RUN: igc_opt %s -S -o - -igc-stateless-to-statefull-resolution | FileCheck %s
+
+; Promotion of pointers merged through phis/selects and of offsets proven
+; non-negative. Argument 0 of every kernel is bound to surface 0, so a
+; promoted access goes through addrspace(131072).
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f16:16:16-f32:32:32-f64:64:64-f80:128:128-v16:16:16-v24:32:32-v32:32:32-v48:64:64-v64:64:64-v96:128:128-v128:128:128-v192:256:256-v256:256:256-v512:512:512-v1024:1024:1024-a:64:64-f80:128:128-n8:16:32:64"
+
+; A phi of two GEPs off the same argument gets an i32 offset phi.
+
+; CHECK-LABEL: define void @phi_same_arg
+; CHECK: [[OT:%.*]] = add i32 0, 4
+; CHECK: [[OF:%.*]] = add i32 0, 8
+; CHECK: [[OFF:%.*]] = phi i32 [ [[OT]], %t ], [ [[OF]], %f ]
+; CHECK: [[PTR:%.*]] = inttoptr i32 [[OFF]] to float addrspace(131072)*
+; CHECK: load float, float addrspace(131072)* [[PTR]]
+; CHECK: ret void
+
+define void @phi_same_arg(float addrspace(1)* %a, i1 %c) {
+entry:
+  br i1 %c, label %t, label %f
+t:
+  %pt = getelementptr inbounds float, float addrspace(1)* %a, i64 1
+  br label %m
+f:
+  %pf = getelementptr inbounds float, float addrspace(1)* %a, i64 2
+  br label %m
+m:
+  %p = phi float addrspace(1)* [ %pt, %t ], [ %pf, %f ]
+  %v = load float, float addrspace(1)* %p, align 4
+  %q = getelementptr inbounds float, float addrspace(1)* %a, i64 4
+  store float %v, float addrspace(1)* %q, align 4
+  ret void
+}
+
+; The surface is unknown when the incoming pointers come from different
+; arguments.
+
+; CHECK-LABEL: define void @phi_mixed_args
+; CHECK-NOT: phi i32
+; CHECK: %p = phi float addrspace(1)* [ %pt, %t ], [ %pf, %f ]
+; CHECK: load float, float addrspace(1)* %p
+; CHECK: ret void
+
+define void @phi_mixed_args(float addrspace(1)* %a, float addrspace(1)* %b, i1 %c) {
+entry:
+  br i1 %c, label %t, label %f
+t:
+  %pt = getelementptr inbounds float, float addrspace(1)* %a, i64 1
+  br label %m
+f:
+  %pf = getelementptr inbounds float, float addrspace(1)* %b, i64 1
+  br label %m
+m:
+  %p = phi float addrspace(1)* [ %pt, %t ], [ %pf, %f ]
+  %v = load float, float addrspace(1)* %p, align 4
+  %q = getelementptr inbounds float, float addrspace(1)* %a, i64 4
+  store float %v, float addrspace(1)* %q, align 4
+  ret void
+}
+
+; CHECK-LABEL: define void @select_same_arg
+; CHECK: [[O1:%.*]] = add i32 0, 4
+; CHECK: [[O3:%.*]] = add i32 0, 12
+; CHECK: [[OFF:%.*]] = select i1 %c, i32 [[O1]], i32 [[O3]]
+; CHECK: [[PTR:%.*]] = inttoptr i32 [[OFF]] to float addrspace(131072)*
+; CHECK: load float, float addrspace(131072)* [[PTR]]
+; CHECK: ret void
+
+define void @select_same_arg(float addrspace(1)* %a, i1 %c) {
+entry:
+  %p1 = getelementptr inbounds float, float addrspace(1)* %a, i64 1
+  %p3 = getelementptr inbounds float, float addrspace(1)* %a, i64 3
+  %p = select i1 %c, float addrspace(1)* %p1, float addrspace(1)* %p3
+  %v = load float, float addrspace(1)* %p, align 4
+  store float %v, float addrspace(1)* %p1, align 4
+  ret void
+}
+
+; The index counts down from 15 to 0, which known bits cannot bound but
+; scalar evolution can from the trip count.
+
+; CHECK-LABEL: define void @loop_offset
+; CHECK: [[IDX:%.*]] = trunc i64 %idx to i32
+; CHECK: [[BYTES:%.*]] = mul i32 [[IDX]], 4
+; CHECK: [[OFF:%.*]] = add i32 0, [[BYTES]]
+; CHECK: [[PTR:%.*]] = inttoptr i32 [[OFF]] to float addrspace(131072)*
+; CHECK: load float, float addrspace(131072)* [[PTR]]
+; CHECK: ret void
+
+define void @loop_offset(float addrspace(1)* %a) {
+entry:
+  br label %loop
+loop:
+  %i = phi i32 [ 15, %entry ], [ %i.next, %loop ]
+  %acc = phi float [ 0.0, %entry ], [ %sum, %loop ]
+  %idx = sext i32 %i to i64
+  %p = getelementptr inbounds float, float addrspace(1)* %a, i64 %idx
+  %v = load float, float addrspace(1)* %p, align 4
+  %sum = fadd float %acc, %v
+  %i.next = add nsw i32 %i, -1
+  %cmp = icmp sgt i32 %i, 0
+  br i1 %cmp, label %loop, label %exit
+exit:
+  %q = getelementptr inbounds float, float addrspace(1)* %a, i64 16
+  store float %sum, float addrspace(1)* %q, align 4
+  ret void
+}
+
+; A pointer induction variable: the offset phi refers to itself through
+; the increment.
+
+; CHECK-LABEL: define void @ptr_iv
+; CHECK: [[OFF:%.*]] = phi i32 [ 0, %entry ], [ [[NEXT:%.*]], %loop ]
+; CHECK: [[PTR:%.*]] = inttoptr i32 [[OFF]] to float addrspace(131072)*
+; CHECK: store float 0.000000e+00, float addrspace(131072)* [[PTR]]
+; CHECK: [[NEXT]] = add i32 [[OFF]], 4
+; CHECK: ret void
+
+define void @ptr_iv(float addrspace(1)* %a, i32 %n) {
+entry:
+  br label %loop
+loop:
+  %p = phi float addrspace(1)* [ %a, %entry ], [ %p.next, %loop ]
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  store float 0.0, float addrspace(1)* %p, align 4
+  %p.next = getelementptr inbounds float, float addrspace(1)* %p, i64 1
+  %i.next = add i32 %i, 1
+  %cmp = icmp ult i32 %i.next, %n
+  br i1 %cmp, label %loop, label %exit
+exit:
+  ret void
+}
+
+; Nothing bounds %n, so the access stays stateless.
+
+; CHECK-LABEL: define void @unprovable
+; CHECK: %p = getelementptr inbounds float, float addrspace(1)* %a, i64 %n
+; CHECK: load float, float addrspace(1)* %p
+; CHECK: ret void
+
+define void @unprovable(float addrspace(1)* %a, i64 %n) {
+entry:
+  %p = getelementptr inbounds float, float addrspace(1)* %a, i64 %n
+  %v = load float, float addrspace(1)* %p, align 4
+  %q = getelementptr inbounds float, float addrspace(1)* %a, i64 1
+  store float %v, float addrspace(1)* %q, align 4
+  ret void
+}
+
+!igc.functions = !{!0, !3, !4, !5, !6, !7}
+
+!0 = !{void (float addrspace(1)*, i1)* @phi_same_arg, !1}
+!1 = !{!2, !8}
+!2 = !{!"function_type", i32 0}
+!8 = !{!"implicit_arg_desc"}
+!3 = !{void (float addrspace(1)*, float addrspace(1)*, i1)* @phi_mixed_args, !1}
+!4 = !{void (float addrspace(1)*, i1)* @select_same_arg, !1}
+!5 = !{void (float addrspace(1)*)* @loop_offset, !1}
+!6 = !{void (float addrspace(1)*, i32)* @ptr_iv, !1}
+!7 = !{void (float addrspace(1)*, i64)* @unprovable, !1}
+
+!IGCMetadata = !{!10}
+
+!10 = !{!"ModuleMD", !11}
+!11 = !{!"FuncMD", !12, !13, !20, !21, !22, !23, !24, !25, !26, !27, !28, !29}
+!12 = !{!"FuncMDMap[0]", void (float addrspace(1)*, i1)* @phi_same_arg}
+!13 = !{!"FuncMDValue[0]", !14}
+!14 = !{!"resAllocMD", !15}
+!15 = !{!"argAllocMDList", !16, !17, !18}
+!16 = !{!"argAllocMDListVec[0]", !30, !31, !32}
+!17 = !{!"argAllocMDListVec[1]", !30, !31, !33}
+!18 = !{!"argAllocMDListVec[2]", !30, !31, !34}
+!20 = !{!"FuncMDMap[1]", void (float addrspace(1)*, float addrspace(1)*, i1)* @phi_mixed_args}
+!21 = !{!"FuncMDValue[1]", !14}
+!22 = !{!"FuncMDMap[2]", void (float addrspace(1)*, i1)* @select_same_arg}
+!23 = !{!"FuncMDValue[2]", !14}
+!24 = !{!"FuncMDMap[3]", void (float addrspace(1)*)* @loop_offset}
+!25 = !{!"FuncMDValue[3]", !14}
+!26 = !{!"FuncMDMap[4]", void (float addrspace(1)*, i32)* @ptr_iv}
+!27 = !{!"FuncMDValue[4]", !14}
+!28 = !{!"FuncMDMap[5]", void (float addrspace(1)*, i64)* @unprovable}
+!29 = !{!"FuncMDValue[5]", !14}
+!30 = !{!"type", i32 1}
+!31 = !{!"extensionType", i32 -1}
+!32 = !{!"indexType", i32 0}
+!33 = !{!"indexType", i32 1}
+!34 = !{!"indexType", i32 2}
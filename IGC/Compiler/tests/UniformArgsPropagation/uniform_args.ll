@@ -0,0 +1,148 @@
+;===================== begin_copyright_notice ==================================
+
+;Copyright (c) 2017 Intel Corporation
+
+;Permission is hereby granted, free of charge, to any person obtaining a
+;copy of this software and associated documentation files (the
+;"Software"), to deal in the Software without restriction, including
+;without limitation the rights to use, copy, modify, merge, publish,
+;distribute, sublicense, and/or sell copies of the Software, and to
+;permit persons to whom the Software is furnished to do so, subject to
+;the following conditions:
+
+;The above copyright notice and this permission notice shall be included
+;in all copies or substantial portions of the Software.
+
+;THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+;OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+;MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+;IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+;CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+;TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+;SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+;======================= end_copyright_notice ==================================
+; RUN: igc_opt %s -S -o - -UniformArgsPropagation | FileCheck %s --check-prefixes=CHECK,TWO
+; RUN: igc_opt %s -S -o - -UniformArgsPropagation -igc-uniform-args-max-clones=1 | FileCheck %s --check-prefixes=CHECK,ONE
+; RUN: igc_opt %s -S -o - -UniformArgsPropagation -igc-uniform-args-max-clones=0 | FileCheck %s --check-prefixes=CHECK,NONE
+
+; %u and the values built from it are uniform; %lid is the per-lane local id.
+
+@sink = addrspace(1) global i32 0
+
+define void @kernel(i32 %u, <8 x i32> %r0, <8 x i32> %payloadHeader, i16 %localIdX, i16 %localIdY, i16 %localIdZ) {
+entry:
+  %lid = zext i16 %localIdX to i32
+  %u1 = add i32 %u, 1
+  call void @callee_all(i32 %u, i32 5)
+  call void @callee_all(i32 %u1, i32 7)
+  call void @callee_div(i32 %u)
+  call void @callee_div(i32 %lid)
+  call void @rec(i32 %u)
+  call void @callee_clones(i32 %u, i32 %lid)
+  call void @callee_clones(i32 %u1, i32 %lid)
+  call void @callee_clones(i32 %lid, i32 %u)
+  call void @callee_clones(i32 %lid, i32 %lid)
+  ret void
+}
+
+; The call to @callee_div with %lid keeps its argument per lane; the other
+; one goes to a uniform clone unless cloning is off. @callee_clones has two
+; uniform patterns: argument 0 at two call sites and argument 1 at one.
+; Clones are made for the most common patterns first.
+
+; CHECK-LABEL: define void @kernel(
+; CHECK: call void @callee_all(i32 %u, i32 5)
+; CHECK: call void @callee_all(i32 %u1, i32 7)
+; TWO: call void @callee_div.uniform(i32 %u)
+; ONE: call void @callee_div.uniform(i32 %u)
+; NONE: call void @callee_div(i32 %u)
+; CHECK: call void @callee_div(i32 %lid)
+; CHECK: call void @rec(i32 %u)
+; TWO: call void @callee_clones.uniform(i32 %u, i32 %lid)
+; TWO: call void @callee_clones.uniform(i32 %u1, i32 %lid)
+; TWO: call void @[[CLONE1:callee_clones\.uniform\.[0-9]+]](i32 %lid, i32 %u)
+; ONE: call void @callee_clones.uniform(i32 %u, i32 %lid)
+; ONE: call void @callee_clones.uniform(i32 %u1, i32 %lid)
+; ONE: call void @callee_clones(i32 %lid, i32 %u)
+; NONE: call void @callee_clones(i32 %u, i32 %lid)
+; NONE: call void @callee_clones(i32 %u1, i32 %lid)
+; NONE: call void @callee_clones(i32 %lid, i32 %u)
+; CHECK: call void @callee_clones(i32 %lid, i32 %lid)
+
+; Uniform at every call site.
+define internal void @callee_all(i32 %x, i32 %y) {
+  %s = add i32 %x, %y
+  store i32 %s, i32 addrspace(1)* @sink
+  ret void
+}
+
+; CHECK-LABEL: define internal void @callee_all(i32 "igc.uniform" %x, i32 "igc.uniform" %y)
+
+; One call site passes a per-lane value.
+define internal void @callee_div(i32 %x) {
+  store i32 %x, i32 addrspace(1)* @sink
+  ret void
+}
+
+; CHECK-LABEL: define internal void @callee_div(i32 %x)
+
+; Only called with %u and with values computed from its own argument.
+define internal void @rec(i32 %n) {
+entry:
+  store i32 %n, i32 addrspace(1)* @sink
+  %c = icmp eq i32 %n, 0
+  br i1 %c, label %done, label %next
+
+next:
+  %m = sub i32 %n, 1
+  call void @rec(i32 %m)
+  br label %done
+
+done:
+  ret void
+}
+
+; CHECK-LABEL: define internal void @rec(i32 "igc.uniform" %n)
+; CHECK: call void @rec(i32 %m)
+
+define internal void @callee_clones(i32 %a, i32 %b) {
+  %s = sub i32 %a, %b
+  store i32 %s, i32 addrspace(1)* @sink
+  ret void
+}
+
+; CHECK-LABEL: define internal void @callee_clones(i32 %a, i32 %b)
+
+; TWO: define internal void @callee_div.uniform(i32 "igc.uniform" %x)
+; TWO-NEXT: store i32 %x, i32 addrspace(1)* @sink
+; TWO: define internal void @callee_clones.uniform(i32 "igc.uniform" %a, i32 %b)
+; TWO-NEXT: %s = sub i32 %a, %b
+; TWO: define internal void @[[CLONE1]](i32 %a, i32 "igc.uniform" %b)
+; TWO-NEXT: %s = sub i32 %a, %b
+; TWO-NOT: define
+
+; ONE: define internal void @callee_div.uniform(i32 "igc.uniform" %x)
+; ONE: define internal void @callee_clones.uniform(i32 "igc.uniform" %a, i32 %b)
+; ONE-NOT: define {{.*}}@callee_clones.uniform.
+
+; NONE-NOT: .uniform(
+
+!igc.functions = !{!0, !10, !11, !12, !13}
+!0 = !{void (i32, <8 x i32>, <8 x i32>, i16, i16, i16)* @kernel, !1}
+!1 = !{!2, !3}
+!2 = !{!"function_type", i32 0}
+!3 = !{!"implicit_arg_desc", !4, !5, !6, !7, !8}
+!4 = !{i32 0}
+!5 = !{i32 1}
+!6 = !{i32 7}
+!7 = !{i32 8}
+!8 = !{i32 9}
+!10 = !{void (i32, i32)* @callee_all, !20}
+!11 = !{void (i32)* @callee_div, !20}
+!12 = !{void (i32)* @rec, !20}
+!13 = !{void (i32, i32)* @callee_clones, !20}
+!20 = !{!21, !22}
+!21 = !{!"function_type", i32 2}
+!22 = !{!"implicit_arg_desc"}
@@ -2085,9 +2085,12 @@ void DwarfDebug::identifyScopeMarkers()
     }
 }
 
-// Walk up the scope chain of given debug loc and find line number info
-// for the function.
-static DebugLoc getFnDebugLoc(DebugLoc DL, const LLVMContext& Ctx)
+// Walk up the scope chain of given debug loc and find the subprogram and
+// line number info for the function. This does not create a DILocation for
+// the result: that would modify the LLVMContext, which DWARF emission
+// otherwise only reads (and which may be shared with other emitters).
+// Without a subprogram, Line is left as is and the scope returned is null.
+static DISubprogram* getFnDebugLoc(DebugLoc DL, unsigned& Line)
 {
     // Get MDNode for DebugLoc's scope.
     while (DILocation * InlinedAt = DL.getInlinedAt())
@@ -2101,13 +2104,12 @@ static DebugLoc getFnDebugLoc(DebugLoc DL, const LLVMContext& Ctx)
     {
         // Check for number of operands since the compatibility is cheap here.
         if (SP->getNumOperands() > 19)
-        {
-            return DebugLoc::get(SP->getScopeLine(), 0, SP);
-        }
-        return DebugLoc::get(SP->getLine(), 0, SP);
+            Line = SP->getScopeLine();
+        else
+            Line = SP->getLine();
     }
 
-    return DebugLoc();
+    return SP;
 }
 
 // Gather pre-function debug information.  Assumes being called immediately
@@ -2230,11 +2232,11 @@ void DwarfDebug::beginFunction(const Function* MF, IGC::VISAModule* v)
     // Record beginning of function.
     if (PrologEndLoc)
     {
-        DebugLoc FnStartDL = getFnDebugLoc(PrologEndLoc, MF->getContext());
-        const MDNode* Scope = FnStartDL.getScope();
+        unsigned FnStartLine = 0;
+        const MDNode* Scope = getFnDebugLoc(PrologEndLoc, FnStartLine);
         // We'd like to list the prologue as "not statements" but GDB behaves
         // poorly if we do that. Revisit this with caution/GDB (7.5+) testing.
-        recordSourceLine(FnStartDL.getLine(), FnStartDL.getCol(), Scope, DWARF2_FLAG_IS_STMT);
+        recordSourceLine(FnStartLine, 0, Scope, DWARF2_FLAG_IS_STMT);
     }
 }
 
@@ -3468,25 +3470,10 @@ void DwarfDebug::gatherDISubprogramNodes()
 bool VISAModule::getVarInfo(std::string prefix, unsigned int vreg, DbgDecoder::VarInfo& var)
 {
     std::string name = prefix + std::to_string(vreg);
-    if (VirToPhyMap.size() == 0)
-    {
-        // populate map one time
-        auto co = getCompileUnit();
-        if (co)
-        {
-            for (auto& v : co->Vars)
-            {
-                VirToPhyMap.insert(std::make_pair(v.name, v));
-            }
-        }
-    }
-
-    auto it = VirToPhyMap.find(name);
-    if (it == VirToPhyMap.end())
+    auto co = getCompileUnit();
+    if (!co)
         return false;
-
-    var = (*it).second;
-    return true;
+    return co->getVarInfo(name, var);
 }
 
 bool VISAModule::hasOrIsStackCall() const
@@ -48,6 +48,18 @@ void IGC::DbgDecoder::VarInfo::print(llvm::raw_ostream& OS) const {
     PrintItems(OS, lrs, ", ");
     OS << " }";
 }
+IGC::DbgDecoder::VarInfo IGC::DbgDecoder::VarRecord::decode() const {
+    VarInfo v;
+    v.name = name.str();
+    v.lrs.reserve(numLRs);
+    const void* dbg = lrs;
+    for (unsigned int i = 0; i != numLRs; i++)
+        v.lrs.push_back(readLiveIntervalsVISA(dbg));
+    return v;
+}
+void IGC::DbgDecoder::VarRecord::print(llvm::raw_ostream& OS) const {
+    decode().print(OS);
+}
 void IGC::DbgDecoder::LiveIntervalGenISA::print(llvm::raw_ostream& OS) const {
     OS << "LInt-G[" << start << ";" << end << "] ";
     var.print(OS);
@@ -28,6 +28,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "llvm/Config/llvm-config.h"
 
 #include "common/LLVMWarningsPush.hpp"
+#include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
 #include "common/LLVMWarningsPop.hpp"
@@ -37,6 +38,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <type_traits>
 #include <algorithm>
 #include <cstdint>
+#include <string>
 #include <vector>
 
 namespace IGC
@@ -184,6 +186,22 @@ namespace IGC
             void print (llvm::raw_ostream& OS) const;
             void dump() const { print(llvm::dbgs()); }
         };
+        // An encoded variable record: its name and where its live intervals
+        // are in the debug info buffer. Large kernels have many variables
+        // and only the ones referred to from the llvm debug info are ever
+        // looked at, so the intervals are decoded on demand.
+        class VarRecord
+        {
+        public:
+            llvm::StringRef name;
+            const void* lrs = nullptr;
+            uint16_t numLRs = 0;
+
+            VarInfo decode() const;
+
+            void print (llvm::raw_ostream& OS) const;
+            void dump() const { print(llvm::dbgs()); }
+        };
         class SubroutineInfo
         {
         public:
@@ -257,12 +275,23 @@ namespace IGC
             uint32_t relocOffset = 0;
             std::vector<std::pair<unsigned int, unsigned int>> CISAOffsetMap;
             std::vector<std::pair<unsigned int, unsigned int>> CISAIndexMap;
-            std::vector<VarInfo> Vars;
+            // sorted by name (stable, so the first of equal names wins)
+            std::vector<VarRecord> Vars;
 
             uint16_t numSubRoutines = 0;
             std::vector<SubroutineInfo> subs;
             CallFrameInfo cfi;
 
+            bool getVarInfo(llvm::StringRef name, VarInfo& var) const
+            {
+                auto it = std::lower_bound(Vars.begin(), Vars.end(), name,
+                    [](const VarRecord& r, llvm::StringRef n) { return r.name < n; });
+                if (it == Vars.end() || it->name != name)
+                    return false;
+                var = it->decode();
+                return true;
+            }
+
             void print (llvm::raw_ostream& OS) const;
             void dump() const { print(llvm::dbgs()); }
         };
@@ -270,38 +299,51 @@ namespace IGC
         std::vector<DbgInfoFormat> compiledObjs;
 
     private:
-        void readMappingReg(DbgDecoder::Mapping& mapping)
+        // The readers take the cursor explicitly so that VarRecord can decode
+        // live intervals long after the initial pass over the buffer.
+        static void readMappingReg(const void*& dbg, DbgDecoder::Mapping& mapping)
         {
             mapping.r.regNum = read<uint16_t>(dbg);
             mapping.r.subRegNum = read<uint16_t>(dbg);
         }
 
-        void readMappingMem(DbgDecoder::Mapping& mapping)
+        static void readMappingMem(const void*& dbg, DbgDecoder::Mapping& mapping)
         {
             uint32_t temp = read<uint32_t>(dbg);
             mapping.m.memoryOffset = (temp & 0x7fffffff);
             mapping.m.isBaseOffBEFP = (temp & 0x80000000);
         }
 
-        LiveIntervalsVISA readLiveIntervalsVISA()
+        static LiveIntervalsVISA readLiveIntervalsVISA(const void*& dbg)
         {
             DbgDecoder::LiveIntervalsVISA lv;
             lv.start = read<uint16_t>(dbg);
             lv.end = read<uint16_t>(dbg);
-            lv.var = readVarAlloc();
+            lv.var = readVarAlloc(dbg);
             return lv;
         }
 
-        LiveIntervalGenISA readLiveIntervalGenISA()
+        static void skipLiveIntervalsVISA(const void*& dbg)
+        {
+            read<uint16_t>(dbg); // start
+            read<uint16_t>(dbg); // end
+            read<uint8_t>(dbg); // virtual type
+            auto physicalType = read<uint8_t>(dbg);
+            // register and memory mappings are both 4 bytes
+            if (physicalType <= VarAlloc::PhyTypeMemory)
+                dbg = (const char*)dbg + sizeof(uint32_t);
+        }
+
+        static LiveIntervalGenISA readLiveIntervalGenISA(const void*& dbg)
         {
             DbgDecoder::LiveIntervalGenISA lr;
             lr.start = read<uint32_t>(dbg);
             lr.end = read<uint32_t>(dbg);
-            lr.var = readVarAlloc();
+            lr.var = readVarAlloc(dbg);
             return lr;
         }
 
-        RegInfoMapping readRegInfoMapping()
+        static RegInfoMapping readRegInfoMapping(const void*& dbg)
         {
             DbgDecoder::RegInfoMapping info;
             info.srcRegOff = read<uint16_t>(dbg);
@@ -309,16 +351,16 @@ namespace IGC
             info.dstInReg = (bool)read<uint8_t>(dbg);
             if (info.dstInReg)
             {
-                readMappingReg(info.dst);
+                readMappingReg(dbg, info.dst);
             }
             else
             {
-                readMappingMem(info.dst);
+                readMappingMem(dbg, info.dst);
             }
             return info;
         }
 
-        VarAlloc readVarAlloc()
+        static VarAlloc readVarAlloc(const void*& dbg)
         {
             DbgDecoder::VarAlloc data;
 
@@ -335,11 +377,11 @@ namespace IGC
                 data.physicalType == (unsigned)PhyType::Flag ||
                 data.physicalType == (unsigned)PhyType::GRF)
             {
-                readMappingReg(data.mapping);
+                readMappingReg(dbg, data.mapping);
             }
             else if (data.physicalType == (unsigned)PhyType::Mem)
             {
-                readMappingMem(data.mapping);
+                readMappingMem(dbg, data.mapping);
             }
             return data;
         }
@@ -363,6 +405,7 @@ namespace IGC
 
                 // cisa offsets map
                 uint32_t count = read<uint32_t>(dbg);
+                f.CISAOffsetMap.reserve(count);
                 for (unsigned int j = 0; j != count; j++)
                 {
                     uint32_t cisaOffset = read<uint32_t>(dbg);
@@ -372,6 +415,7 @@ namespace IGC
 
                 // cisa index map
                 count = read<uint32_t>(dbg);
+                f.CISAIndexMap.reserve(count);
                 for (unsigned int j = 0; j != count; j++)
                 {
                     uint32_t cisaIndex = read<uint32_t>(dbg);
@@ -379,25 +423,26 @@ namespace IGC
                     f.CISAIndexMap.push_back(std::make_pair(cisaIndex, f.relocOffset + genOffset));
                 }
 
-                // var info
+                // var info (indexed only, see VarRecord)
                 count = read<uint32_t>(dbg);
+                f.Vars.reserve(count);
                 for (unsigned int j = 0; j != count; j++)
                 {
-                    VarInfo v;
+                    VarRecord v;
 
                     nameLen = read<uint16_t>(dbg);
-                    for (unsigned int k = 0; k != nameLen; k++)
-                        v.name += read<char>(dbg);
+                    v.name = llvm::StringRef((const char*)dbg, nameLen);
+                    dbg = (const char*)dbg + nameLen;
 
-                    auto countLRs = read<uint16_t>(dbg);
-                    for (unsigned int k = 0; k != countLRs; k++)
-                    {
-                        LiveIntervalsVISA lv = readLiveIntervalsVISA();
-                        v.lrs.push_back(lv);
-                    }
+                    v.numLRs = read<uint16_t>(dbg);
+                    v.lrs = dbg;
+                    for (unsigned int k = 0; k != v.numLRs; k++)
+                        skipLiveIntervalsVISA(dbg);
 
                     f.Vars.push_back(v);
                 }
+                std::stable_sort(f.Vars.begin(), f.Vars.end(),
+                    [](const VarRecord& a, const VarRecord& b) { return a.name < b.name; });
 
                 // subroutines
                 count = read<uint16_t>(dbg);
@@ -413,7 +458,7 @@ namespace IGC
                     auto countLRs = read<uint16_t>(dbg);
                     for (unsigned int k = 0; k != countLRs; k++)
                     {
-                        LiveIntervalsVISA lv = readLiveIntervalsVISA();
+                        LiveIntervalsVISA lv = readLiveIntervalsVISA(dbg);
                         sub.retval.push_back(lv);
                     }
                     f.subs.push_back(sub);
@@ -427,7 +472,7 @@ namespace IGC
                     count = read<uint16_t>(dbg);
                     for (unsigned int j = 0; j != count; j++)
                     {
-                        LiveIntervalGenISA lv = readLiveIntervalGenISA();;
+                        LiveIntervalGenISA lv = readLiveIntervalGenISA(dbg);
                         f.cfi.befp.push_back(lv);
                     }
                 }
@@ -437,7 +482,7 @@ namespace IGC
                     count = read<uint16_t>(dbg);
                     for (unsigned int j = 0; j != count; j++)
                     {
-                        LiveIntervalGenISA lv = readLiveIntervalGenISA();
+                        LiveIntervalGenISA lv = readLiveIntervalGenISA(dbg);
                         f.cfi.callerbefp.push_back(lv);
                     }
                 }
@@ -447,7 +492,7 @@ namespace IGC
                     count = read<uint16_t>(dbg);
                     for (unsigned int j = 0; j != count; j++)
                     {
-                        LiveIntervalGenISA lv = readLiveIntervalGenISA();
+                        LiveIntervalGenISA lv = readLiveIntervalGenISA(dbg);
                         f.cfi.retAddr.push_back(lv);
                     }
                 }
@@ -458,7 +503,7 @@ namespace IGC
                     phyRegSave.genIPOffset = read<uint32_t>(dbg);
                     phyRegSave.numEntries = read<uint16_t>(dbg);
                     for (unsigned int k = 0; k != phyRegSave.numEntries; k++)
-                        phyRegSave.data.push_back(readRegInfoMapping());
+                        phyRegSave.data.push_back(readRegInfoMapping(dbg));
                     f.cfi.calleeSaveEntry.push_back(phyRegSave);
                 }
 
@@ -469,16 +514,17 @@ namespace IGC
                     phyRegSave.genIPOffset = read<uint32_t>(dbg);
                     phyRegSave.numEntries = read<uint16_t>(dbg);
                     for (unsigned int k = 0; k != phyRegSave.numEntries; k++)
-                        phyRegSave.data.push_back(readRegInfoMapping());
+                        phyRegSave.data.push_back(readRegInfoMapping(dbg));
                     f.cfi.callerSaveEntry.push_back(phyRegSave);
                 }
 
-                compiledObjs.push_back(f);
+                compiledObjs.push_back(std::move(f));
             }
         }
 
     public:
         // TODO: we should pass the size too
+        // Variable records point into buf, so it has to outlive the decoder.
         DbgDecoder(const void* buf) : dbg(buf)
         {
             if (buf)
@@ -493,14 +539,8 @@ namespace IGC
                     k.kernelName.compare(kernelName) != 0)
                     continue;
 
-                for (auto& v : k.Vars)
-                {
-                    if (v.name.compare(name) == 0)
-                    {
-                        var = v;
-                        return true;
-                    }
-                }
+                if (k.getVarInfo(name, var))
+                    return true;
             }
 
             return false;
@@ -470,16 +470,6 @@ namespace IGC
         std::vector<std::pair<unsigned int, unsigned int>> GenISAToVISAIndex;
         std::map<unsigned int, std::vector<unsigned int>> VISAIndexToAllGenISAOff;
         std::map<unsigned int, unsigned int> GenISAInstSizeBytes;
-        class comparer
-        {
-        public:
-            bool operator()(const std::string& v1, const std::string& v2) const
-            {
-                return v1.compare(v2) < 0;
-            }
-        };
-        std::map<std::string, DbgDecoder::VarInfo, comparer> VirToPhyMap;
-
         bool getVarInfo(std::string prefix, unsigned int vreg, DbgDecoder::VarInfo& var);
         bool hasOrIsStackCall() const;
         std::vector<DbgDecoder::SubroutineInfo>* getSubroutines() const;
@@ -87,6 +87,10 @@ struct CompileOptions {
   bool DumpAsm = false;
   bool DumpDebugInfo = false;
   bool TimePasses = false;
+  // Kernels of an OpenCL/ZE module are compiled on this many threads
+  // (when the module can be split per kernel). 0 stands for the number
+  // of hardware threads.
+  unsigned CodeGenThreads = 1;
 };
 
 class ExternalData {
@@ -116,6 +116,11 @@ struct GenXBackendOptions {
   // (part of CMABI pass by historical reasons).
   GlobalsLocalizationConfig GlobalsLocalization;
 
+  // Whether vISA builders are used one at a time with those of other
+  // compilations that set it. Set for kernels of a module compiled on
+  // several threads, as vISA is not known to be thread safe.
+  bool SerializeVISABuilders = false;
+
   GenXBackendOptions();
 };
 
@@ -170,6 +175,7 @@ public:
   }
 
   bool asmDumpsEnabled() const { return Options.EnableAsmDumps; }
+  bool serializeVISABuilders() const { return Options.SerializeVISABuilders; }
   bool dbgInfoDumpsEnabled() const { return Options.EnableDebugInfoDumps; }
   const std::string &dbgInfoDumpsNameOverride() const {
     return Options.DebugInfoDumpsNameOverride;
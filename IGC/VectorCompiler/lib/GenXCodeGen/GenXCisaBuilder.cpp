@@ -83,6 +83,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include <algorithm>
 #include <map>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -6214,8 +6215,21 @@ static VISABuilder *createVISABuilder(const GenXSubtarget &ST,
   return VB;
 }
 
+// Never destroyed, as the lock may be held by a compilation still running
+// at exit.
+static std::mutex &getVISABuilderMutex() {
+  static std::mutex *Mutex = new std::mutex();
+  return *Mutex;
+}
+
+void GenXModule::lockVISABuilders() {
+  if (SerializeVISABuilders && !VISABuilderLock.owns_lock())
+    VISABuilderLock = std::unique_lock<std::mutex>(getVISABuilderMutex());
+}
+
 void GenXModule::InitCISABuilder() {
   IGC_ASSERT(ST);
+  lockVISABuilders();
   GenXTargetMachine *TM = &getAnalysis<TargetPassConfig>()
                               .getTM<GenXTargetMachine>();
   const bool OptimizationDisabled = TM->getOptLevel() == CodeGenOpt::None;
@@ -6240,6 +6254,7 @@ void GenXModule::DestroyCISABuilder() {
 
 void GenXModule::InitVISAAsmReader() {
   IGC_ASSERT(ST);
+  lockVISABuilders();
   VISAAsmTextReader =
       createVISABuilder(*ST, EnableKernelDebug, AsmDumpsEnabled,
                         /*OptimizationDisabled*/false,
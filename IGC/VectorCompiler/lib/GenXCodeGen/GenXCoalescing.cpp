@@ -210,6 +210,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/Timer.h"
 
 #include <algorithm>
 #include <vector>
@@ -217,6 +218,11 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 using namespace llvm;
 using namespace genx;
 
+// Coalescing phases are timed separately (under -ftime-report), as the
+// interference queries they do are where the time of the pass goes.
+static constexpr const char *TimerGroupName = "genx-coalescing";
+static constexpr const char *TimerGroupDesc = "GenX coalescing phases";
+
 static cl::opt<unsigned> GenXShowCoalesceFailThreshold("genx-show-coalesce-fail-threshold", cl::init(UINT_MAX), cl::Hidden,
                                       cl::desc("GenX size threshold (bytes) for showing coalesce fails."));
 static cl::opt<bool> GenXCoalescingLessCopies(
@@ -467,23 +473,35 @@ bool GenXCoalescing::runOnFunctionGroup(FunctionGroup &FG)
   recordCandidates(&FG);
 
   // Process the copy coalescing candidates.
-  for (unsigned i = 0; i != CopyCandidates.size(); ++i)
-    processCopyCandidate(&CopyCandidates[i]);
+  {
+    NamedRegionTimer T("copy", "Copy coalescing", TimerGroupName,
+                       TimerGroupDesc, TimePassesIsEnabled);
+    for (unsigned i = 0; i != CopyCandidates.size(); ++i)
+      processCopyCandidate(&CopyCandidates[i]);
+  }
 
   // Record the call arg and return value pre-copy candidates.
   recordCallCandidates(&FG);
 
   // Sort the array of normal coalescing candidates (including phi ones) then
   // process them.
-  std::sort(NormalCandidates.begin(), NormalCandidates.end());
-  for (unsigned i = 0; i != NormalCandidates.size(); ++i)
-    processCandidate(&NormalCandidates[i]);
+  {
+    NamedRegionTimer T("normal", "Normal coalescing", TimerGroupName,
+                       TimerGroupDesc, TimePassesIsEnabled);
+    std::sort(NormalCandidates.begin(), NormalCandidates.end());
+    for (unsigned i = 0; i != NormalCandidates.size(); ++i)
+      processCandidate(&NormalCandidates[i]);
+  }
 
   // Now scan all phi nodes again, inserting copies where necessary. Doing
   // them in one go here ensures that the copies appear in the predecessor
   // blocks in the same order as the phi nodes, which is the basis on which
   // we computed live ranges.
-  processPhiNodes(&FG);
+  {
+    NamedRegionTimer T("phi", "Phi copy insertion", TimerGroupName,
+                       TimerGroupDesc, TimePassesIsEnabled);
+    processPhiNodes(&FG);
+  }
 
   // Scan all the calls, inserting copies where necessary for call arg
   // pre-copies and return value pre- and post-copies. Doing them in one go
@@ -499,7 +517,11 @@ bool GenXCoalescing::runOnFunctionGroup(FunctionGroup &FG)
   coalesceCallables();
   coalesceOutputArgs(&FG);
 
-  applyCopies();
+  {
+    NamedRegionTimer T("apply", "Copy insertion", TimerGroupName,
+                       TimerGroupDesc, TimePassesIsEnabled);
+    applyCopies();
+  }
 
   CopyCandidates.clear();
   NormalCandidates.clear();
@@ -49,6 +49,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "llvmWrapper/IR/Instructions.h"
 
 #include "llvm/ADT/SmallSet.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/CodeGen/TargetPassConfig.h"
 #include "llvm/IR/BasicBlock.h"
 #include "llvm/IR/DiagnosticInfo.h"
@@ -59,11 +60,16 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "llvm/IR/Type.h"
 #include "llvm/Support/Debug.h"
 
+#include <algorithm>
 #include <unordered_set>
 
 using namespace llvm;
 using namespace genx;
 
+STATISTIC(NumInterferenceQueries, "Number of live range interference queries");
+STATISTIC(NumSegmentsSkipped,
+          "Number of segments skipped without an overlap check");
+
 char GenXLiveness::ID = 0;
 INITIALIZE_PASS_BEGIN(GenXLiveness, "GenXLiveness", "GenXLiveness", false, false)
 INITIALIZE_PASS_END(GenXLiveness, "GenXLiveness", "GenXLiveness", false, false)
@@ -951,6 +957,37 @@ bool GenXLiveness::twoAddrInterfere(LiveRange *LR1, LiveRange *LR2)
   return !SitesSet.empty();
 }
 
+/***********************************************************************
+ * skipSegmentsEndingBefore : advance I past the segments that end before Pos
+ *
+ * Segments of a live range are sorted and do not overlap, so their ends are
+ * sorted too. The search gallops from I: the common case of the very next
+ * segment being the one we want stays cheap, while a long run of segments of
+ * a big live range (that cannot overlap anything in a small one) is skipped
+ * in logarithmic time.
+ */
+static LiveRange::iterator skipSegmentsEndingBefore(LiveRange::iterator I,
+    LiveRange::iterator E, unsigned Pos)
+{
+  if (I == E || I->getEnd() >= Pos)
+    return I;
+  // I ends before Pos. Find a bound Hi that does not.
+  auto Lo = I, Hi = E;
+  for (size_t Step = 1; Step < size_t(E - Lo); Step *= 2) {
+    auto Probe = Lo + Step;
+    if (Probe->getEnd() >= Pos) {
+      Hi = Probe;
+      break;
+    }
+    Lo = Probe;
+  }
+  auto Found = std::partition_point(Lo + 1, Hi,
+      [Pos](const Segment &S) { return S.getEnd() < Pos; });
+  // every segment in [I, Found) ends before Pos
+  NumSegmentsSkipped += Found - I;
+  return Found;
+}
+
 /***********************************************************************
  * getSingleInterferenceSites : check whether two live ranges interfere,
  *      returning single number interference sites
@@ -971,14 +1008,24 @@ bool GenXLiveness::twoAddrInterfere(LiveRange *LR1, LiveRange *LR2)
  * example [19,20), causes the start number to be pushed into Sites. The
  * function returns true only if there is interference that cannot be described
  * in Sites.
+ *
+ * The walk skips runs of segments that cannot overlap (see
+ * skipSegmentsEndingBefore), so checking a short live range against a long
+ * one costs O(short * log(long)) rather than O(short + long).
  */
 bool GenXLiveness::getSingleInterferenceSites(LiveRange *LR1, LiveRange *LR2,
     SmallVectorImpl<unsigned> *Sites)
 {
+  ++NumInterferenceQueries;
   // Swap if necessary to make LR1 the one with more segments.
   if (LR1->size() < LR2->size())
     std::swap(LR1, LR2);
+  if (!LR2->size())
+    return false;
   auto Idx2 = LR2->begin(), End2 = LR2->end();
+  // Quick rejection when LR2 ends before LR1 starts.
+  if ((End2 - 1)->getEnd() < LR1->begin()->getStart())
+    return false;
   // Find segment in LR1 that contains or is the next after the start
   // of the first segment in LR2, including the case that the start of
   // the LR2 segment abuts the end of the LR1 segment.
@@ -1006,12 +1053,16 @@ bool GenXLiveness::getSingleInterferenceSites(LiveRange *LR1, LiveRange *LR2,
           Sites->push_back(Idx1->getStart());
         }
     }
-    // Advance whichever one has the lowest End.
+    // Advance whichever one has the lowest End, skipping the segments that
+    // end before the other one's current segment starts: those cannot
+    // overlap it or anything after it.
     if (Idx1->getEnd() < Idx2->getEnd()) {
-      if (++Idx1 == End1)
+      Idx1 = skipSegmentsEndingBefore(Idx1 + 1, End1, Idx2->getStart());
+      if (Idx1 == End1)
         return false;
     } else {
-      if (++Idx2 == End2)
+      Idx2 = skipSegmentsEndingBefore(Idx2 + 1, End2, Idx1->getStart());
+      if (Idx2 == End2)
         return false;
     }
   }
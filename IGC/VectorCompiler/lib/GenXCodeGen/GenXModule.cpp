@@ -111,6 +111,7 @@ bool GenXModule::runOnModule(Module &M) {
   const auto &BC = getAnalysis<GenXBackendConfig>();
   AsmDumpsEnabled = BC.asmDumpsEnabled();
   EnableKernelDebug = BC.kernelDebugEnabled();
+  SerializeVISABuilders = BC.serializeVISABuilders();
 
   InlineAsm = CheckForInlineAsm(M);
 
@@ -68,6 +68,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <inc/common/sku_wa.h>
 
 #include <map>
+#include <mutex>
 #include <string>
 #include <vector>
 #include "Probe/Assertion.h"
@@ -91,6 +92,10 @@ namespace llvm {
     BumpPtrAllocator ArgStorage;
     bool AsmDumpsEnabled = false;
     bool EnableKernelDebug = false;
+    bool SerializeVISABuilders = false;
+    // held while a vISA builder exists, if SerializeVISABuilders
+    std::unique_lock<std::mutex> VISABuilderLock;
+    void lockVISABuilders();
 
     VISABuilder *CisaBuilder = nullptr;
     void InitCISABuilder();
@@ -108,6 +113,8 @@ namespace llvm {
       DestroyCISABuilder();
       DestroyVISAAsmReader();
       ArgStorage.Reset();
+      if (VISABuilderLock.owns_lock())
+        VISABuilderLock.unlock();
     }
 
   public:
@@ -26,6 +26,8 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "GenXWATable.h"
 
+#include "llvmWrapper/Bitcode/BitcodeWriter.h"
+#include "llvmWrapper/Support/MemoryBuffer.h"
 #include "llvmWrapper/Target/TargetMachine.h"
 
 #include "vc/GenXCodeGen/GenXOCLRuntimeInfo.h"
@@ -38,8 +40,10 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "vc/Support/Status.h"
 #include "llvm/GenXIntrinsics/GenXIntrOpts.h"
 #include "llvm/GenXIntrinsics/GenXIntrinsics.h"
+#include "llvm/GenXIntrinsics/GenXMetadata.h"
 #include "llvm/GenXIntrinsics/GenXSPIRVReaderAdaptor.h"
 
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringExtras.h"
@@ -48,6 +52,8 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "llvm/Analysis/TargetTransformInfo.h"
 #include "llvm/Bitcode/BitcodeReader.h"
 #include "llvm/CodeGen/MachineModuleInfo.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/Instructions.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Verifier.h"
@@ -56,6 +62,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "llvm/Option/ArgList.h"
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
 #include "llvm/Support/DynamicLibrary.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/FileSystem.h"
@@ -72,12 +79,19 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "llvm/Transforms/IPO.h"
 #include "llvm/Transforms/IPO/PassManagerBuilder.h"
 #include "llvm/Transforms/Scalar.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+#include "llvm/Transforms/Utils/ValueMapper.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cctype>
+#include <iterator>
 #include <memory>
+#include <mutex>
 #include <new>
 #include <set>
 #include <sstream>
+#include <thread>
 #include <string>
 #include <vector>
 #include "Probe/Assertion.h"
@@ -92,6 +106,8 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 using namespace llvm;
 
+#define DEBUG_TYPE "GENX_WRAPPER"
+
 #if defined(_WIN64)
 // TODO: rename to SPIRVDLL64.dll when binary components are fixed.
 static constexpr char *SpirvLibName = "SPIRVDLL.dll";
@@ -326,8 +342,10 @@ createTargetMachine(const vc::CompileOptions &Opts, Triple &TheTriple) {
 }
 
 // Create backend options for immutable config pass. Override default
-// values with provided ones.
-static GenXBackendOptions createBackendOptions(const vc::CompileOptions &Opts) {
+// values with provided ones. IsKernelPart is set for a kernel split off
+// the module and compiled alongside the others.
+static GenXBackendOptions createBackendOptions(const vc::CompileOptions &Opts,
+                                               bool IsKernelPart = false) {
   GenXBackendOptions BackendOpts;
   if (Opts.StackMemSize)
     BackendOpts.StackSurfaceMaxSize = Opts.StackMemSize.getValue();
@@ -339,6 +357,12 @@ static GenXBackendOptions createBackendOptions(const vc::CompileOptions &Opts) {
       (Opts.Binary == vc::BinaryKind::OpenCL)
           ? GlobalsLocalizationConfig::CreateLocalizationWithLimit()
           : GlobalsLocalizationConfig::CreateForcedLocalization();
+  if (IsKernelPart) {
+    // The dumper is shared by all parts and would give them the same
+    // dump names.
+    BackendOpts.Dumper = nullptr;
+    BackendOpts.SerializeVISABuilders = true;
+  }
   return BackendOpts;
 }
 
@@ -405,10 +429,11 @@ static void dumpFinalOutput(const vc::CompileOptions &Opts, const Module &M,
 static void populateCodeGenPassManager(const vc::CompileOptions &Opts,
                                        const vc::ExternalData &ExtData,
                                        TargetMachine &TM, raw_pwrite_stream &OS,
-                                       legacy::PassManager &PM) {
+                                       legacy::PassManager &PM,
+                                       bool IsKernelPart = false) {
   TargetLibraryInfoImpl TLII{TM.getTargetTriple()};
   PM.add(new TargetLibraryInfoWrapperPass(TLII));
-  PM.add(new GenXBackendConfig{createBackendOptions(Opts),
+  PM.add(new GenXBackendConfig{createBackendOptions(Opts, IsKernelPart),
                                createBackendData(ExtData)});
   // Non-constant pointer.
   WA_TABLE *WaTable = Opts.WATable.get();
@@ -422,26 +447,243 @@ static void populateCodeGenPassManager(const vc::CompileOptions &Opts,
 
 static vc::ocl::CompileOutput runOclCodeGen(const vc::CompileOptions &Opts,
                                             const vc::ExternalData &ExtData,
-                                            TargetMachine &TM, Module &M) {
+                                            TargetMachine &TM, Module &M,
+                                            bool IsKernelPart = false) {
   legacy::PassManager PM;
 
   SmallString<32> IsaBinary;
   raw_svector_ostream OS(IsaBinary);
   raw_null_ostream NullOS;
   if (Opts.DumpIsa)
-    populateCodeGenPassManager(Opts, ExtData, TM, OS, PM);
+    populateCodeGenPassManager(Opts, ExtData, TM, OS, PM, IsKernelPart);
   else
-    populateCodeGenPassManager(Opts, ExtData, TM, NullOS, PM);
+    populateCodeGenPassManager(Opts, ExtData, TM, NullOS, PM, IsKernelPart);
 
   GenXOCLRuntimeInfo::CompiledModuleT CompiledModule;
   PM.add(createGenXOCLInfoExtractorPass(CompiledModule));
 
   PM.run(M);
-  dumpFinalOutput(Opts, M, IsaBinary);
+  if (!IsKernelPart)
+    dumpFinalOutput(Opts, M, IsaBinary);
 
   return CompiledModule;
 }
 
+// Parallel OpenCL/ZE codegen {{
+// Once every kernel carries its own copy of the subroutines it calls (which
+// is what function groups are built from anyway), kernels do not share
+// anything in codegen. A single LLVMContext cannot be used from several
+// threads though, so the module is split per kernel, every part is passed
+// through bitcode into a context of its own and goes through the usual
+// codegen pipeline on a worker thread. Results are merged in the order of
+// genx.kernels, so the output does not depend on scheduling.
+//
+// Only the LLVM side runs concurrently: parts take turns with their vISA
+// builders (see GenXBackendOptions::SerializeVISABuilders), and dumps are
+// off. The options and external data are only read.
+
+static Function *getKernelFunction(const MDNode &Node) {
+  auto *VM = dyn_cast_or_null<ValueAsMetadata>(
+      Node.getOperand(genx::KernelMDOp::FunctionRef).get());
+  return VM ? dyn_cast<Function>(VM->getValue()) : nullptr;
+}
+
+// Whether linking in builtins may bring module data along; module data
+// of the parts could not be merged. Only the symbol table of the builtins
+// module is read.
+static bool mayImportModuleData(const vc::ExternalData &ExtData,
+                                const Module &M) {
+  LLVMContext Context;
+  Expected<std::unique_ptr<Module>> ExpBiF = getLazyBitcodeModule(
+      IGCLLVM::makeMemoryBufferRef(ExtData.getOCLGenericBIFModule()), Context);
+  if (!ExpBiF) {
+    consumeError(ExpBiF.takeError());
+    return true;
+  }
+  const Module &BiF = *ExpBiF.get();
+  if (std::none_of(BiF.global_begin(), BiF.global_end(),
+                   [](const GlobalVariable &GV) {
+                     return !GV.getName().startswith("llvm.");
+                   }))
+    return false;
+  return std::any_of(M.begin(), M.end(), [&BiF](const Function &F) {
+    const Function *Builtin =
+        F.isDeclaration() ? BiF.getFunction(F.getName()) : nullptr;
+    return Builtin && !Builtin->isDeclaration();
+  });
+}
+
+// Collects kernels of the module if it can be compiled per kernel.
+static bool collectSplittableKernels(const vc::CompileOptions &Opts,
+                                     const vc::ExternalData &ExtData,
+                                     Module &M,
+                                     std::vector<Function *> &Kernels) {
+  // Dumps and timers are per module and are not thread safe.
+  if (Opts.EmitDebugInfo || Opts.DumpIR || Opts.DumpIsa || Opts.DumpAsm ||
+      Opts.DumpDebugInfo || Opts.TimePasses)
+    return false;
+  // -asm-name numbers kernels by their position in the module, which is
+  // the same in every part.
+  auto &RegisteredOpts = cl::getRegisteredOptions();
+  auto AsmName = RegisteredOpts.find("asm-name");
+  if (AsmName != RegisteredOpts.end() && AsmName->second->getNumOccurrences())
+    return false;
+  NamedMDNode *Named = M.getNamedMetadata(genx::FunctionMD::GenXKernels);
+  if (!Named)
+    return false;
+  for (MDNode *Node : Named->operands()) {
+    Function *Kernel = getKernelFunction(*Node);
+    if (!Kernel || Kernel->isDeclaration())
+      return false;
+    Kernels.push_back(Kernel);
+  }
+  if (Kernels.size() < 2)
+    return false;
+  // Module level data, stack calls and indirect calls tie kernels together.
+  if (std::any_of(M.global_begin(), M.global_end(),
+                  [](const GlobalVariable &GV) {
+                    return !GV.getName().startswith("llvm.");
+                  }))
+    return false;
+  if (std::any_of(M.begin(), M.end(), [](const Function &F) {
+        return F.hasFnAttribute(genx::FunctionMD::CMStackCall) ||
+               (!F.isDeclaration() && F.hasAddressTaken());
+      }))
+    return false;
+  return !mayImportModuleData(ExtData, M);
+}
+
+// Returns bitcode of a module that has \p Kernel and the functions it
+// (transitively) calls, and nothing else.
+static SmallVector<char, 0> extractKernelModule(Module &M, Function *Kernel) {
+  SmallPtrSet<const Function *, 16> Reachable{Kernel};
+  SmallVector<const Function *, 16> Worklist{Kernel};
+  while (!Worklist.empty()) {
+    const Function *F = Worklist.pop_back_val();
+    for (const Instruction &I : instructions(F))
+      if (auto *CI = dyn_cast<CallInst>(&I))
+        if (const Function *Callee = CI->getCalledFunction())
+          if (!Callee->isDeclaration() && Reachable.insert(Callee).second)
+            Worklist.push_back(Callee);
+  }
+
+  ValueToValueMapTy VMap;
+  std::unique_ptr<Module> Part =
+      CloneModule(M, VMap, [&Reachable](const GlobalValue *GV) {
+        auto *F = dyn_cast<Function>(GV);
+        return !F || Reachable.count(F);
+      });
+
+  // Keep the descriptor of this kernel only.
+  auto *PartKernel = cast<Function>(VMap[Kernel]);
+  NamedMDNode *Named = Part->getNamedMetadata(genx::FunctionMD::GenXKernels);
+  MDNode *KernelNode = nullptr;
+  for (MDNode *Node : Named->operands())
+    if (getKernelFunction(*Node) == PartKernel)
+      KernelNode = Node;
+  IGC_ASSERT_MESSAGE(KernelNode, "kernel descriptor is lost");
+  Named->clearOperands();
+  Named->addOperand(KernelNode);
+
+  // Functions that were not cloned became unused declarations.
+  for (Function &F : M)
+    if (!F.isDeclaration() && !Reachable.count(&F)) {
+      auto *Decl = cast<Function>(VMap[&F]);
+      IGC_ASSERT_MESSAGE(Decl->use_empty(), "unexpected use of other kernel");
+      Decl->eraseFromParent();
+    }
+
+  SmallVector<char, 0> Bitcode;
+  raw_svector_ostream OS(Bitcode);
+  IGCLLVM::WriteBitcodeToFile(Part.get(), OS);
+  return Bitcode;
+}
+
+static Expected<vc::ocl::CompileOutput>
+compileKernelModule(ArrayRef<char> Bitcode, const vc::CompileOptions &Opts,
+                    const vc::ExternalData &ExtData, Triple TheTriple) {
+  LLVMContext Context;
+  Expected<std::unique_ptr<Module>> ExpModule =
+      getModuleFromLLVMBinary(Bitcode, Context);
+  if (!ExpModule)
+    return ExpModule.takeError();
+  auto ExpTargetMachine = createTargetMachine(Opts, TheTriple);
+  if (!ExpTargetMachine)
+    return ExpTargetMachine.takeError();
+  return runOclCodeGen(Opts, ExtData, *ExpTargetMachine.get(),
+                       *ExpModule.get(), /*IsKernelPart=*/true);
+}
+
+// Module data of the parts cannot be merged. Builtins that bring it are
+// ruled out before splitting; this catches whatever else produces it.
+static bool hasModuleData(const vc::ocl::CompileOutput &Output) {
+  const GenXOCLRuntimeInfo::ModuleInfoT &Info = Output.ModuleInfo;
+  return !Info.ConstantData.Buffer.empty() ||
+         Info.ConstantData.AdditionalZeroedSpace ||
+         !Info.GlobalData.Buffer.empty() || Info.GlobalData.AdditionalZeroedSpace;
+}
+
+// Returns None when the module has to be compiled as a whole. A part that
+// fails to compile would fail in the whole module too, so its error is
+// returned instead of retrying serially.
+static Expected<Optional<vc::ocl::CompileOutput>>
+runParallelOclCodeGen(const vc::CompileOptions &Opts,
+                      const vc::ExternalData &ExtData, TargetMachine &TM,
+                      Module &M) {
+  std::vector<Function *> Kernels;
+  if (!collectSplittableKernels(Opts, ExtData, M, Kernels))
+    return Optional<vc::ocl::CompileOutput>{};
+
+  std::vector<SmallVector<char, 0>> Parts;
+  Parts.reserve(Kernels.size());
+  for (Function *Kernel : Kernels)
+    Parts.push_back(extractKernelModule(M, Kernel));
+
+  std::vector<Optional<vc::ocl::CompileOutput>> Results(Parts.size());
+  Error Err = Error::success();
+  std::mutex ErrMutex;
+  std::atomic<unsigned> NextPart{0};
+  auto Worker = [&]() {
+    for (unsigned Idx = NextPart++; Idx < Parts.size(); Idx = NextPart++) {
+      auto ExpOutput =
+          compileKernelModule(Parts[Idx], Opts, ExtData, TM.getTargetTriple());
+      if (!ExpOutput) {
+        std::lock_guard<std::mutex> Lock{ErrMutex};
+        Err = joinErrors(std::move(Err), ExpOutput.takeError());
+        continue;
+      }
+      Results[Idx] = std::move(ExpOutput.get());
+    }
+  };
+  unsigned NumThreads = Opts.CodeGenThreads;
+  if (NumThreads == 0)
+    NumThreads = std::max(std::thread::hardware_concurrency(), 1u);
+  NumThreads = std::min<unsigned>(NumThreads, Parts.size());
+  std::vector<std::thread> Threads;
+  for (unsigned I = 1; I < NumThreads; ++I)
+    Threads.emplace_back(Worker);
+  Worker();
+  for (std::thread &T : Threads)
+    T.join();
+  if (Err)
+    return std::move(Err);
+
+  vc::ocl::CompileOutput Output;
+  for (auto &&[Kernel, Result] : llvm::zip(Kernels, Results)) {
+    if (hasModuleData(*Result)) {
+      LLVM_DEBUG(dbgs() << "vc: " << Kernel->getName()
+                        << " has module data, compiling the module as a "
+                           "whole\n");
+      return Optional<vc::ocl::CompileOutput>{};
+    }
+    Output.PointerSizeInBytes = Result->PointerSizeInBytes;
+    std::move(Result->Kernels.begin(), Result->Kernels.end(),
+              std::back_inserter(Output.Kernels));
+  }
+  return Optional<vc::ocl::CompileOutput>{std::move(Output)};
+}
+// }} Parallel OpenCL/ZE codegen
+
 static vc::cm::CompileOutput runCmCodeGen(const vc::CompileOptions &Opts,
                                           const vc::ExternalData &ExtData,
                                           TargetMachine &TM, Module &M) {
@@ -456,14 +698,21 @@ static vc::cm::CompileOutput runCmCodeGen(const vc::CompileOptions &Opts,
   return Output;
 }
 
-static vc::CompileOutput runCodeGen(const vc::CompileOptions &Opts,
-                                    const vc::ExternalData &ExtData,
-                                    TargetMachine &TM, Module &M) {
+static Expected<vc::CompileOutput> runCodeGen(const vc::CompileOptions &Opts,
+                                              const vc::ExternalData &ExtData,
+                                              TargetMachine &TM, Module &M) {
   switch (Opts.Binary) {
   case vc::BinaryKind::CM:
     return runCmCodeGen(Opts, ExtData, TM, M);
   case vc::BinaryKind::OpenCL:
   case vc::BinaryKind::ZE:
+    if (Opts.CodeGenThreads != 1) {
+      auto ExpOutput = runParallelOclCodeGen(Opts, ExtData, TM, M);
+      if (!ExpOutput)
+        return ExpOutput.takeError();
+      if (ExpOutput->hasValue())
+        return std::move(ExpOutput->getValue());
+    }
     return runOclCodeGen(Opts, ExtData, TM, M);
   }
   IGC_ASSERT_EXIT_MESSAGE(0, "Unknown runtime kind");
@@ -531,13 +780,13 @@ Expected<vc::CompileOutput> vc::Compile(ArrayRef<char> Input,
   if (Opts.DumpIR && Opts.Dumper)
     Opts.Dumper->dumpModule(M, "optimized.ll");
 
-  vc::CompileOutput Output = runCodeGen(Opts, ExtData, TM, M);
+  Expected<vc::CompileOutput> ExpOutput = runCodeGen(Opts, ExtData, TM, M);
 
   // Print timers if any and restore old TimePassesIsEnabled value.
   TimerGroup::printAll(llvm::errs());
   TimePassesIsEnabled = TimePassesIsEnabledLocal;
 
-  return Output;
+  return ExpOutput;
 }
 
 static Expected<opt::InputArgList>
@@ -652,6 +901,15 @@ static Error fillInternalOptions(const opt::ArgList &InternalOptions,
   if (InternalOptions.hasArg(vc::options::OPT_ftime_report))
     Opts.TimePasses = true;
 
+  if (opt::Arg *A =
+          InternalOptions.getLastArg(vc::options::OPT_codegen_threads)) {
+    StringRef Val = A->getValue();
+    unsigned Result;
+    if (Val.getAsInteger(/*Radix=*/0, Result))
+      return makeOptionError(*A, InternalOptions, /*IsInternal=*/true);
+    Opts.CodeGenThreads = Result;
+  }
+
   if (opt::Arg *A =
           InternalOptions.getLastArg(vc::options::OPT_binary_format)) {
     StringRef Val = A->getValue();
@@ -0,0 +1,128 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2021 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+
+// Kernels compiled on several threads (-codegen-threads) have to come out
+// exactly as the serially compiled ones, in the same order.
+
+#include "vc/GenXCodeGen/GenXWrapper.h"
+
+#include "llvmWrapper/Bitcode/BitcodeWriter.h"
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <string>
+#include <variant>
+
+using namespace llvm;
+
+namespace {
+
+// Two kernels sharing a subroutine, as they come from the SPIR-V reader.
+constexpr const char TwoKernels[] = R"(
+target triple = "spir64-unknown-unknown"
+
+define internal spir_func i32 @shared(i32 %x) #1 {
+  %y = mul i32 %x, 3
+  ret i32 %y
+}
+
+define spir_kernel void @first() #0 {
+  %v = call spir_func i32 @shared(i32 1)
+  ret void
+}
+
+define spir_kernel void @second() #0 {
+  %v = call spir_func i32 @shared(i32 2)
+  ret void
+}
+
+attributes #0 = { noinline nounwind "VCFunction" "VCSLMSize"="0" }
+attributes #1 = { noinline nounwind "VCFunction" }
+)";
+
+std::unique_ptr<MemoryBuffer> createEmptyBiFModule() {
+  LLVMContext Context;
+  Module M{"bif", Context};
+  std::string Bitcode;
+  raw_string_ostream OS{Bitcode};
+  IGCLLVM::WriteBitcodeToFile(&M, OS);
+  OS.flush();
+  return MemoryBuffer::getMemBufferCopy(Bitcode);
+}
+
+vc::ocl::CompileOutput compile(unsigned CodeGenThreads) {
+  vc::CompileOptions Opts;
+  Opts.FType = vc::FileType::LLVM_TEXT;
+  Opts.CPUStr = "Gen9";
+  Opts.Binary = vc::BinaryKind::ZE;
+  Opts.CodeGenThreads = CodeGenThreads;
+  vc::ExternalData ExtData{createEmptyBiFModule()};
+
+  StringRef Input{TwoKernels};
+  Expected<vc::CompileOutput> ExpOutput =
+      vc::Compile({Input.data(), Input.size()}, Opts, ExtData, {}, {});
+  EXPECT_TRUE(static_cast<bool>(ExpOutput))
+      << toString(ExpOutput.takeError());
+  if (!ExpOutput)
+    return {};
+  auto *Output = std::get_if<vc::ocl::CompileOutput>(&ExpOutput.get());
+  EXPECT_NE(Output, nullptr);
+  return Output ? std::move(*Output) : vc::ocl::CompileOutput{};
+}
+
+void expectSameKernels(const vc::ocl::CompileOutput &Serial,
+                       const vc::ocl::CompileOutput &Parallel) {
+  EXPECT_EQ(Serial.PointerSizeInBytes, Parallel.PointerSizeInBytes);
+  ASSERT_EQ(Serial.Kernels.size(), Parallel.Kernels.size());
+  for (unsigned I = 0; I < Serial.Kernels.size(); ++I) {
+    const auto &S = Serial.Kernels[I];
+    const auto &P = Parallel.Kernels[I];
+    EXPECT_EQ(S.getKernelInfo().getName(), P.getKernelInfo().getName());
+    EXPECT_EQ(S.getGenBinary(), P.getGenBinary());
+  }
+}
+
+TEST(CodeGenThreads, TwoThreadsMatchSerial) {
+  vc::ocl::CompileOutput Serial = compile(1);
+  ASSERT_EQ(Serial.Kernels.size(), 2u);
+  EXPECT_EQ(Serial.Kernels[0].getKernelInfo().getName(), "first");
+  EXPECT_EQ(Serial.Kernels[1].getKernelInfo().getName(), "second");
+  expectSameKernels(Serial, compile(2));
+}
+
+TEST(CodeGenThreads, ThreadPerCoreMatchesSerial) {
+  expectSameKernels(compile(1), compile(0));
+}
+
+} // namespace
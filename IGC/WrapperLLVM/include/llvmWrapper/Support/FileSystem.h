@@ -0,0 +1,47 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+
+#ifndef IGCLLVM_SUPPORT_FILESYSTEM_H
+#define IGCLLVM_SUPPORT_FILESYSTEM_H
+
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/FileSystem.h"
+
+namespace IGCLLVM {
+namespace sys {
+namespace fs {
+#if LLVM_VERSION_MAJOR < 9
+    // The F_* open flags were renamed OF_* (and later removed) in LLVM-9.
+    constexpr llvm::sys::fs::OpenFlags OF_None = llvm::sys::fs::F_None;
+    constexpr llvm::sys::fs::OpenFlags OF_Text = llvm::sys::fs::F_Text;
+#else
+    using llvm::sys::fs::OF_None;
+    using llvm::sys::fs::OF_Text;
+#endif
+} // namespace fs
+} // namespace sys
+} // namespace IGCLLVM
+#endif
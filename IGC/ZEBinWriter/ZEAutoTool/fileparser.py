@@ -9,6 +9,8 @@ from io import StringIO
 ZEINFO_HPP = "ZEInfo.hpp"
 ZEINFOYAML_HPP = "ZEInfoYAML.hpp"
 ZEINFOYAML_CPP = "ZEInfoYAML.cpp"
+ZEINFOBINARY_HPP = "ZEInfoBinary.hpp"
+ZEINFOBINARY_CPP = "ZEInfoBinary.cpp"
 
 COPYRIGHT = """/*===================== begin_copyright_notice ==================================
 
@@ -91,6 +93,37 @@ YAML_HPP_HEADER = """//===- ZEInfoYAML.hpp -------------------------------------
 #endif
 """
 
+BINARY_CPP_HEADER = """//===- ZEInfoBinary.cpp ---------------------------------------------*- C++ -*-===//
+// ZE Binary Utilitis
+//
+// file
+//===----------------------------------------------------------------------===//\n
+// ******************** DO NOT MODIFY DIRECTLY *********************************
+// This file is auto-generated by ZEAutoTool/fileparser.py
+
+#include <ZEInfoBinary.hpp>
+using namespace zebin;\n
+"""
+
+BINARY_HPP_HEADER = """//===- ZEInfoBinary.hpp -----------------------------------------*- C++ -*-===//
+// ZE Binary Utilitis
+//
+// \\file
+// This file declares the mapping between zeInfo structs and the binary
+// encoding of .ze_info.bin section
+//===----------------------------------------------------------------------===//\n
+// ******************** DO NOT MODIFY DIRECTLY *********************************
+// This file is auto-generated by ZEAutoTool/fileparser.py
+
+#ifndef ZE_INFO_BINARY_HPP
+#define ZE_INFO_BINARY_HPP
+
+#include <ZEInfo.hpp>
+#include <ZEInfoBinaryTraits.hpp>
+
+namespace zebin {
+"""
+
 
 """
 Given row of pandas dataframe, convert type item to zeinfo type
@@ -145,6 +178,15 @@ def format_zeinfoyaml_cpp_mapping(row):
     return "    io.mapOptional(" + '"' + first + '"' + ", info." + first + ", " + default_val + ");\n"
 
 
+"""
+Create binary mappings in ZEInfoBinary.cpp
+Every field is always encoded so there's no required/optional distinction
+"""
+def format_zeinfobinary_cpp_mapping(row):
+    first = row[row.index[0]]
+    return "    io.map(" + '"' + first + '"' + ", info." + first + ");\n"
+
+
 """
 src_lines: list of lines from the given zeinfo .md file
 start: a string indicating the start of a block of text to be collected
@@ -232,6 +274,18 @@ def pandas_create_zeinfoyaml_cpp(df, struct_name, types, output_file):
     output_file.write("}\n")
 
 
+"""
+Write binary mapping lines to ZEInfoBinary.cpp
+"""
+def pandas_create_zeinfobinary_cpp(df, struct_name, output_file):
+    df["BinaryCode"] = df.apply(format_zeinfobinary_cpp_mapping, axis=1)
+    struct_line = "void ZEInfoBinaryTraits<zeInfo" + struct_name + ">::mapping(ZEInfoBinaryIO& io, zeInfo" + struct_name + "& info)\n{\n"
+    output_file.write(struct_line)
+    for item in df["BinaryCode"].values:
+        output_file.write(item)
+    output_file.write("}\n")
+
+
 """
 Parses top layer tables and writes to ZEInfo.hpp
 Stores all struct names and whether they are a vector in yaml_hpp_args
@@ -299,6 +353,10 @@ def create_zeinfo_hpp_yaml_cpp(src_lines, folder):
     yaml_cpp = open(cpp_path, "a")
     yaml_cpp.write(YAML_CPP_HEADER)
 
+    binary_cpp_path = os.path.join(folder, ZEINFOBINARY_CPP)
+    binary_cpp = open(binary_cpp_path, "a")
+    binary_cpp.write(BINARY_CPP_HEADER)
+
     # get version number
     version_block, index, pounds = get_text_block(src_lines, "# ZE Info", "\n", "Version")
     src_lines = src_lines[index:]
@@ -341,6 +399,7 @@ def create_zeinfo_hpp_yaml_cpp(src_lines, folder):
                 else:
                     check_vectors[comm_list[1]] = ""
                 pandas_create_zeinfoyaml_cpp(df, struct_name, valid_types, yaml_cpp)
+                pandas_create_zeinfobinary_cpp(df, struct_name, binary_cpp)
                 if struct_name == "Container":
                     container_df = [(df, "Container")]
                 elif pounds == 1:
@@ -363,6 +422,7 @@ def create_zeinfo_hpp_yaml_cpp(src_lines, folder):
 
 
     yaml_cpp.close()
+    binary_cpp.close()
 
 
     zeinfo_hpp.write("struct PreDefinedAttrGetter{\n")
@@ -408,10 +468,32 @@ def create_yaml_hpp(yaml_hpp_vectors, folder):
     output_file.close()
 
 
+"""
+Writes to ZEInfoBinary.hpp
+"""
+def create_binary_hpp(yaml_hpp_vectors, folder):
+    file = os.path.join(folder, ZEINFOBINARY_HPP)
+    output_file = open(file, "a")
+    output_file.write(BINARY_HPP_HEADER)
+
+    for item in yaml_hpp_vectors.keys():
+        singular = yaml_hpp_vectors[item]
+        if singular != "":
+            struct = "zeInfo" + singular
+        else:
+            struct = "zeInfo" + item
+        output_file.write("    template<>\n    struct ZEInfoBinaryTraits<" + struct + "> {\n")
+        output_file.write("        static void mapping(ZEInfoBinaryIO& io, " + struct + "& info);\n    };\n")
+
+    output_file.write("}\n#endif") # namespace zebin, ZE_INFO_BINARY_HPP
+    output_file.close()
+
+
 def main(argv):
     source_file = argv[0]
     dir_path = os.path.dirname(os.path.realpath(__file__))
-    zeinfo_files = [ZEINFO_HPP, ZEINFOYAML_HPP, ZEINFOYAML_CPP]
+    zeinfo_files = [ZEINFO_HPP, ZEINFOYAML_HPP, ZEINFOYAML_CPP,
+                    ZEINFOBINARY_HPP, ZEINFOBINARY_CPP]
     zebin_path = os.path.join(os.path.join(dir_path, ".."), "zebin")
     source_path = os.path.join(zebin_path, "source")
     spec_path = os.path.join(zebin_path, "spec")
@@ -434,6 +516,7 @@ def main(argv):
 
     check_vectors = create_zeinfo_hpp_yaml_cpp(src_lines, public)
     create_yaml_hpp(check_vectors, public)
+    create_binary_hpp(check_vectors, public)
 
 
 if __name__ == "__main__":
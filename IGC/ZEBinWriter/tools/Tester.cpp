@@ -25,10 +25,21 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 ======================= end_copyright_notice ==================================*/
 #include "Tester.hpp"
 #include "ZEELFObjectBuilder.hpp"
+#include "ZEInfoBinary.hpp"
 #include "ZEinfoYAML.hpp"
 
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
 #include <iostream>
 #include <fstream>
+#include <string>
+#include <vector>
 
 using llvm::yaml::Output;
 using llvm::yaml::Input;
@@ -101,6 +112,13 @@ static void getTestZEInfo(zeInfoContainer& ks)
     bti2.arg_index = 10;
     k1.binding_table_indices.push_back(bti2);
 
+    // an int64 field after an int32 one, which the binary encoding aligns
+    k1.specialization_of = "kernel_name_0";
+    zeInfoSpecializedArgument spec_arg;
+    spec_arg.arg_index = 1;
+    spec_arg.value = 0x123456789abcdefLL;
+    k1.specialized_arguments.push_back(spec_arg);
+
     zeInfoKernel k2;
     k2.name = "kernel_name_2";
     k2.execution_env.actual_kernel_start_offset = 0;
@@ -144,6 +162,103 @@ void Tester::testZEInfoOutput()
     out_yout << out_ks;
 }
 
+void Tester::testZEInfoBinary()
+{
+    zeInfoContainer in_ks;
+    getTestZEInfo(in_ks);
+    std::vector<uint8_t> bin;
+    writeZEInfoBinary(in_ks, bin);
+
+    // the tables and the int64 fields must be 8-byte aligned for the
+    // section to be read in place
+    using llvm::support::endian::read32le;
+    uint32_t rootOffset = read32le(&bin[offsetof(ZEInfoBinaryHeader, rootOffset)]);
+    uint32_t strTabOffset = read32le(&bin[offsetof(ZEInfoBinaryHeader, strTabOffset)]);
+    if (rootOffset % ZEINFO_BINARY_ALIGNMENT ||
+        strTabOffset % ZEINFO_BINARY_ALIGNMENT ||
+        bin.size() % ZEINFO_BINARY_ALIGNMENT ||
+        getZEInfoBinaryRecordSize<zeInfoKernel>() % ZEINFO_BINARY_ALIGNMENT ||
+        getZEInfoBinaryRecordSize<zeInfoSpecializedArgument>() != 16)
+        std::cerr << "ERROR: .ze_info.bin is not 8-byte aligned\n";
+
+    ZEInfoBinaryReader reader(bin.data(), bin.size());
+    zeInfoContainer out_ks;
+    if (!reader.read(out_ks)) {
+        std::cerr << "ERROR: cannot decode .ze_info.bin: " << reader.getError() << "\n";
+        return;
+    }
+
+    // the decoded zeInfo must be the same as the encoded one
+    std::string in_string, out_string;
+    llvm::raw_string_ostream in_OS(in_string), out_OS(out_string);
+    Output in_yout(in_OS), out_yout(out_OS);
+    in_yout << in_ks;
+    out_yout << out_ks;
+    if (in_OS.str() != out_OS.str())
+        std::cerr << "ERROR: .ze_info.bin round trip mismatch\n";
+
+    // and so are the kernels decoded one by one
+    for (uint32_t i = 0; i < reader.getNumKernels(); ++i) {
+        zeInfoKernel k;
+        if (!reader.readKernel(i, k) || k.name != in_ks.kernels[i].name)
+            std::cerr << "ERROR: .ze_info.bin kernel " << i << " mismatch\n";
+    }
+}
+
+// contains - true if bytes contains the NUL-terminated string str
+static bool contains(const std::vector<uint8_t>& bytes, const char* str)
+{
+    const uint8_t* b = (const uint8_t*)str;
+    return std::search(bytes.begin(), bytes.end(), b, b + strlen(str) + 1) !=
+        bytes.end();
+}
+
+void Tester::testZEInfoEncodings()
+{
+    zeInfoContainer ks;
+    getTestZEInfo(ks);
+
+    // the binary encoding is little-endian whatever the host is
+    std::vector<uint8_t> bin;
+    writeZEInfoBinary(ks, bin);
+    static const uint8_t magic[] = { 'Z', 'E', 'B', 'I' };
+    if (bin.size() < sizeof(magic) || memcmp(bin.data(), magic, sizeof(magic)))
+        std::cerr << "ERROR: .ze_info.bin is not little-endian\n";
+
+    // without a known encoding, ze_info falls back to YAML
+    struct {
+        uint32_t encodings;
+        bool yaml, binary;
+    } cases[] = {
+        { 0x0, true, false },
+        { 0x4, true, false },
+        { ZEELFObjectBuilder::ZEINFO_BINARY | 0x4, false, true },
+        { ZEELFObjectBuilder::ZEINFO_YAML | ZEELFObjectBuilder::ZEINFO_BINARY, true, true },
+    };
+    for (const auto& c : cases) {
+        TargetFlags flag;
+        flag.packed = 0;
+        ZEELFObjectBuilder builder(true, ET_ZEBIN_EXE, 0, flag);
+        builder.setZEInfoEncoding(c.encodings);
+        zeInfoContainer zeInfo = ks;
+        builder.addSectionZEInfo(zeInfo);
+        std::vector<uint8_t> elf;
+        builder.finalize([&elf](uint64_t size) {
+            elf.resize(size);
+            return elf.data();
+        });
+        if (contains(elf, ".ze_info") != c.yaml ||
+            contains(elf, ".ze_info.bin") != c.binary)
+            std::cerr << "ERROR: wrong ze_info sections for encodings "
+                      << c.encodings << "\n";
+        // the section follows the YAML one, whatever the size of the latter
+        auto bin_it = std::search(elf.begin(), elf.end(), magic, magic + 4);
+        if (bin_it != elf.end() &&
+            (bin_it - elf.begin()) % ZEINFO_BINARY_ALIGNMENT != 0)
+            std::cerr << "ERROR: .ze_info.bin is not 8-byte aligned in the ELF\n";
+    }
+}
+
 void Tester::testELFOutput()
 {
     TargetFlags flag;
@@ -185,4 +300,102 @@ void Tester::testELFOutput()
     llvm::raw_fd_ostream os("testELFOutput", EC);
     builder.finalize(os);
     os.close();
-}
\ No newline at end of file
+}
+
+void Tester::benchELFOutput(unsigned numKernels)
+{
+    const uint64_t kernelSize = 4096;
+    const int iterations = 5;
+
+    // kernel binaries are owned by the caller, the builder only references
+    // them
+    std::vector<uint8_t> text(numKernels * kernelSize, 0x1);
+    uint8_t global_buff[64] = { 0x0 };
+
+    TargetFlags flag;
+    flag.packed = 0;
+    ZEELFObjectBuilder builder(true, ET_ZEBIN_EXE, 0, flag);
+    zeInfoContainer zeInfo;
+
+    ZEELFObjectBuilder::SectionID global =
+        builder.addSectionData("global", global_buff, sizeof(global_buff));
+    builder.addSymbol("global_buffer", 0, sizeof(global_buff),
+        llvm::ELF::STB_GLOBAL, llvm::ELF::STT_OBJECT, global);
+
+    for (unsigned i = 0; i < numKernels; ++i) {
+        std::string name = "kernel_" + std::to_string(i);
+        ZEELFObjectBuilder::SectionID id = builder.addSectionText(
+            name, text.data() + i * kernelSize, kernelSize, 0, 4);
+        builder.addSymbol(name, 0, kernelSize, llvm::ELF::STB_GLOBAL,
+            llvm::ELF::STT_FUNC, id);
+        builder.addRelocation(16, "global_buffer",
+            R_TYPE_ZEBIN::R_ZE_SYM_ADDR, id);
+
+        zeInfo.kernels.emplace_back();
+        zeInfoKernel& k = zeInfo.kernels.back();
+        k.name = name;
+        k.execution_env.grf_count = 128;
+        k.execution_env.simd_size = 16;
+        zeInfoPayloadArgument arg;
+        arg.arg_type = "arg_pointer";
+        arg.offset = 0;
+        arg.size = 8;
+        arg.arg_index = 0;
+        arg.addrmode = "stateless";
+        arg.addrspace = "global";
+        arg.access_type = "readwrite";
+        k.payload_arguments.push_back(arg);
+    }
+    builder.addSectionZEInfo(zeInfo);
+
+    typedef std::chrono::steady_clock clock;
+    auto toMS = [](clock::duration d) {
+        return std::chrono::duration<double, std::milli>(d).count();
+    };
+
+    // stream: write into a growing buffer and then copy the object into its
+    // final container, as a caller of finalize(raw_pwrite_stream&) does
+    double streamMS = 0.0;
+    uint64_t streamPeak = 0;
+    std::vector<char> streamOut;
+    for (int i = 0; i < iterations; ++i) {
+        auto start = clock::now();
+        llvm::SmallVector<char, 64> buf;
+        llvm::raw_svector_ostream os(buf);
+        builder.finalize(os);
+        streamOut.assign(buf.begin(), buf.end());
+        double ms = toMS(clock::now() - start);
+        streamMS = (i == 0) ? ms : std::min(streamMS, ms);
+        streamPeak = buf.capacity() + streamOut.size();
+    }
+
+    // preallocated: the object is laid out first and written directly into
+    // its final container
+    double preallocMS = 0.0;
+    uint64_t preallocPeak = 0;
+    std::vector<char> preallocOut;
+    for (int i = 0; i < iterations; ++i) {
+        auto start = clock::now();
+        preallocOut.clear();
+        preallocOut.shrink_to_fit();
+        builder.finalize([&preallocOut](uint64_t size) {
+            preallocOut.resize(size);
+            return reinterpret_cast<uint8_t*>(preallocOut.data());
+        });
+        double ms = toMS(clock::now() - start);
+        preallocMS = (i == 0) ? ms : std::min(preallocMS, ms);
+        preallocPeak = preallocOut.size();
+    }
+
+    bool match = streamOut.size() == preallocOut.size() &&
+        std::memcmp(streamOut.data(), preallocOut.data(), streamOut.size()) == 0;
+
+    std::cout << "kernels: " << numKernels
+              << ", ELF size: " << preallocOut.size() << " bytes\n";
+    std::cout << "stream:       " << streamMS << " ms, peak output memory "
+              << streamPeak << " bytes\n";
+    std::cout << "preallocated: " << preallocMS << " ms, peak output memory "
+              << preallocPeak << " bytes\n";
+    if (!match)
+        std::cerr << "ERROR: the two outputs differ\n";
+}
@@ -37,7 +37,15 @@ namespace zebin {
 class Tester {
 public:
     static void testZEInfoOutput();
+    // round-trip the test zeInfo through the binary encoding
+    static void testZEInfoBinary();
+    // the binary encoding's byte order and the fallback of unknown
+    // ZEInfoEncoding values to YAML
+    static void testZEInfoEncodings();
     static void testELFOutput();
+    // benchmark writing an ELF object with numKernels kernels through a
+    // growing stream versus into one preallocated buffer
+    static void benchELFOutput(unsigned numKernels);
 };
 
 } // namespace zebin
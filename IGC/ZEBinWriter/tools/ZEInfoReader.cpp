@@ -28,6 +28,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "Tester.hpp"
 #include <ZEInfo.hpp>
+#include <ZEInfoBinaryTraits.hpp>
 #include <ZEinfoYAML.hpp>
 
 #include <llvm/Object/ObjectFile.h>
@@ -36,6 +37,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <llvm/Support/MemoryBuffer.h>
 #include <llvm/Support/Error.h>
 
+#include <chrono>
 #include <fstream>
 #include <iostream>
 #include <string>
@@ -70,6 +72,133 @@ static void dumpZEInfo(std::unique_ptr<llvm::object::ObjectFile> object) {
         std::cerr << "Given ELF object has no .ze_info section";
 }
 
+// getSectionContents - get the contents of the section with given name,
+// return false if there's no such section
+static bool getSectionContents(
+    const llvm::object::ObjectFile& object, llvm::StringRef sectName,
+    llvm::StringRef& content)
+{
+    for (auto sect : object.sections()) {
+        llvm::StringRef name;
+        sect.getName(name);
+        if (name == sectName) {
+            sect.getContents(content);
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool parseZEInfoYAML(llvm::StringRef content, zeInfoContainer& zeInfo)
+{
+    llvm::yaml::Input yin(content);
+    yin >> zeInfo;
+    return !yin.error();
+}
+
+static std::string toYAML(zeInfoContainer& zeInfo)
+{
+    std::string str;
+    llvm::raw_string_ostream os(str);
+    llvm::yaml::Output yout(os);
+    yout << zeInfo;
+    return os.str();
+}
+
+// validateZEInfoBin - validate and decode .ze_info.bin section. If the object
+// has .ze_info as well, both must have the same contents
+static int validateZEInfoBin(const llvm::object::ObjectFile& object)
+{
+    llvm::StringRef binContent;
+    if (!getSectionContents(object, ".ze_info.bin", binContent)) {
+        std::cerr << "Given ELF object has no .ze_info.bin section\n";
+        return 1;
+    }
+
+    ZEInfoBinaryReader reader(
+        (const uint8_t*)binContent.data(), binContent.size());
+    zeInfoContainer binZEInfo;
+    if (!reader.read(binZEInfo)) {
+        std::cerr << "Invalid .ze_info.bin section: " << reader.getError() << "\n";
+        return 1;
+    }
+    std::cout << ".ze_info.bin: valid, version " << binZEInfo.version << ", "
+              << reader.getNumKernels() << " kernels\n";
+
+    llvm::StringRef yamlContent;
+    if (!getSectionContents(object, ".ze_info", yamlContent))
+        return 0;
+
+    zeInfoContainer yamlZEInfo;
+    if (!parseZEInfoYAML(yamlContent, yamlZEInfo)) {
+        std::cerr << "Invalid .ze_info section\n";
+        return 1;
+    }
+    if (toYAML(yamlZEInfo) != toYAML(binZEInfo)) {
+        std::cerr << ".ze_info.bin does not match .ze_info\n";
+        return 1;
+    }
+    std::cout << ".ze_info.bin: matches .ze_info\n";
+    return 0;
+}
+
+// benchZEInfo - compare the time of parsing .ze_info and decoding
+// .ze_info.bin of the given object
+static int benchZEInfo(const llvm::object::ObjectFile& object, unsigned iterations)
+{
+    llvm::StringRef yamlContent, binContent;
+    if (!getSectionContents(object, ".ze_info", yamlContent) ||
+        !getSectionContents(object, ".ze_info.bin", binContent)) {
+        std::cerr << "Benchmark requires both .ze_info and .ze_info.bin sections\n";
+        return 1;
+    }
+
+    typedef std::chrono::steady_clock clock;
+    auto toUS = [](clock::duration d) {
+        return std::chrono::duration<double, std::micro>(d).count();
+    };
+
+    auto start = clock::now();
+    for (unsigned i = 0; i < iterations; ++i) {
+        zeInfoContainer zeInfo;
+        if (!parseZEInfoYAML(yamlContent, zeInfo)) {
+            std::cerr << "Invalid .ze_info section\n";
+            return 1;
+        }
+    }
+    double yamlUS = toUS(clock::now() - start) / iterations;
+
+    start = clock::now();
+    for (unsigned i = 0; i < iterations; ++i) {
+        ZEInfoBinaryReader reader(
+            (const uint8_t*)binContent.data(), binContent.size());
+        zeInfoContainer zeInfo;
+        if (!reader.read(zeInfo)) {
+            std::cerr << "Invalid .ze_info.bin section: " << reader.getError() << "\n";
+            return 1;
+        }
+    }
+    double binUS = toUS(clock::now() - start) / iterations;
+
+    // look up the last kernel only, as a runtime loading one kernel would
+    start = clock::now();
+    for (unsigned i = 0; i < iterations; ++i) {
+        ZEInfoBinaryReader reader(
+            (const uint8_t*)binContent.data(), binContent.size());
+        zeInfoKernel kernel;
+        if (reader.getNumKernels() != 0)
+            reader.readKernel(reader.getNumKernels() - 1, kernel);
+    }
+    double kernelUS = toUS(clock::now() - start) / iterations;
+
+    std::cout << ".ze_info (YAML):       " << yamlContent.size() << " bytes, "
+              << yamlUS << " us\n";
+    std::cout << ".ze_info.bin:          " << binContent.size() << " bytes, "
+              << binUS << " us (" << yamlUS / binUS << "x)\n";
+    std::cout << ".ze_info.bin (kernel): " << kernelUS << " us\n";
+    return 0;
+}
+
 
 /// ---------------- Command line options --------------------------------- ///
 static llvm::cl::opt<string> InputFilename(
@@ -80,6 +209,17 @@ static llvm::cl::opt<bool> DumpZEInfo ("info",
 
 static llvm::cl::opt<bool> RunTestZEInfo ("test-ze-info",
     llvm::cl::desc("Run static zeinfo generating tests, print the result to std output"));
+
+static llvm::cl::opt<bool> ValidateZEInfoBin ("info-bin",
+    llvm::cl::desc("Validate .ze_info.bin section, and compare it with .ze_info if any"));
+
+static llvm::cl::opt<unsigned> BenchZEInfo ("bench-ze-info",
+    llvm::cl::desc("Benchmark parsing .ze_info against decoding .ze_info.bin for the given iterations"),
+    llvm::cl::value_desc("iterations"));
+
+static llvm::cl::opt<unsigned> BenchELFOutput ("bench-elf-output",
+    llvm::cl::desc("Benchmark writing an ELF object with the given number of kernels"),
+    llvm::cl::value_desc("kernels"));
 /// ----------------------------------------------------------------------- ///
 
 int zeinfo_reader_main(int argc, const char** argv) {
@@ -89,6 +229,13 @@ int zeinfo_reader_main(int argc, const char** argv) {
     // FIXME: This is just a static test, need to be enhanced
     if (RunTestZEInfo) {
         Tester::testZEInfoOutput();
+        Tester::testZEInfoBinary();
+        Tester::testZEInfoEncodings();
+        return 0;
+    }
+
+    if (BenchELFOutput) {
+        Tester::benchELFOutput(BenchELFOutput);
         return 0;
     }
 
@@ -113,6 +260,12 @@ int zeinfo_reader_main(int argc, const char** argv) {
 
     std::unique_ptr<llvm::object::ObjectFile> obj = std::move(ObjOrErr.get());
 
+    if (ValidateZEInfoBin && validateZEInfoBin(*obj))
+        return 1;
+
+    if (BenchZEInfo && benchZEInfo(*obj, BenchZEInfo))
+        return 1;
+
     if (DumpZEInfo)
         dumpZEInfo(std::move(obj));
 
@@ -52,7 +52,8 @@ enum SHT_ZEBIN : uint32_t
 {
     SHT_ZEBIN_SPIRV      = 0xff000009, // .spv.kernel section, value the same as SHT_OPENCL_SPIRV
     SHT_ZEBIN_ZEINFO     = 0xff000011, // .ze.info section
-    SHT_ZEBIN_GTPIN_INFO = 0xff000012  // .gtpin_info section
+    SHT_ZEBIN_GTPIN_INFO = 0xff000012, // .gtpin_info section
+    SHT_ZEBIN_ZEINFO_BIN = 0xff000013  // .ze_info.bin section, binary encoded .ze_info
 };
 
 // ELF relocation type for ELF32_Rel::ELF32_R_TYPE
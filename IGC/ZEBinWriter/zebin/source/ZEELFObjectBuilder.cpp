@@ -25,6 +25,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 ======================= end_copyright_notice ==================================*/
 #include <ZEELFObjectBuilder.hpp>
 #include <ZEInfo.hpp>
+#include <ZEInfoBinaryTraits.hpp>
 #include <ZEInfoYAML.hpp>
 
 #ifndef ZEBinStandAloneBuild
@@ -39,6 +40,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "common/LLVMWarningsPop.hpp"
 #endif
 
+#include <cstring>
 #include <iostream>
 #include "Probe/Assertion.h"
 
@@ -52,7 +54,13 @@ public:
     ELFWriter(llvm::raw_pwrite_stream& OS,
         ZEELFObjectBuilder& objBuilder);
 
+    // lay out the ELF file: assign every section its offset and size and
+    // finalize the string table. Nothing is written to OS. Return the size of
+    // the ELF file in byte
+    uint64_t layout();
+
     // write the ELF file into OS, return the number of written bytes
+    // The file is laid out first if layout has not been called
     uint64_t write();
 
 private:
@@ -62,7 +70,8 @@ private:
     typedef ZEELFObjectBuilder::ZEInfoSection ZEInfoSection;
     typedef ZEELFObjectBuilder::RelocationListTy RelocationListTy;
     typedef std::map<ZEELFObjectBuilder::SectionID, uint32_t> SectionIndexMapTy;
-    typedef std::map<std::string, uint64_t> SymNameIndexMapTy;
+    // the names are owned by ZEELFObjectBuilder's symbol lists
+    typedef std::map<llvm::StringRef, uint64_t> SymNameIndexMapTy;
 
     struct SectionHdrEntry {
         uint32_t name    = 0;
@@ -72,6 +81,8 @@ private:
         uint32_t link    = 0;
         uint32_t info    = 0;
         uint32_t entsize = 0;
+        // the section's offset in the file is aligned to this if non-zero
+        uint32_t addralign = 0;
 
         const Section* section = nullptr;
     };
@@ -81,9 +92,14 @@ private:
     // set m_SectionHdrEntries and adjust the section index, also creaet
     // strings for sections' name in StringTableBuilder
     void createSectionHdrEntries();
+    // set m_SymNameIdxMap, also create strings for symbols' name in
+    // StringTableBuilder
+    void createSymbolEntries();
+    // set the offset, size and other attributes of every SectionHdrEntry
+    void layoutSections();
     // write elf header
     void writeHeader();
-    // write sections and set the attributes in SectionHdrEntry
+    // write sections at the offsets set by layoutSections
     void writeSections();
     // write a raw section
     uint64_t writeSectionData(const uint8_t* data, uint64_t size, uint32_t padding);
@@ -93,12 +109,12 @@ private:
     uint64_t writeRelocTab(const RelocationListTy& relocs);
     // write ze info section
     uint64_t writeZEInfo();
+    // write binary encoded ze info section
+    uint64_t writeZEInfoBin();
     // write string table
     uint64_t writeStrTab();
     // write section header
     void writeSectionHeader();
-    // write the section header's offset into ELF header
-    void writeSectionHdrOffset(uint64_t offset);
     // wirite number of zero bytes
     void writePadding(uint32_t size);
 
@@ -120,6 +136,8 @@ private:
 
     uint32_t getSymTabEntSize();
     uint32_t getRelocTabEntSize();
+    uint32_t getELFHeaderSize();
+    uint32_t getSectionHdrEntSize();
 
     // name is the string table index of the symbol name
     void writeSymbol(uint32_t name, uint64_t value, uint64_t size,
@@ -149,6 +167,48 @@ private:
     // section information for constructing section header
     SectionHdrListTy m_SectionHdrEntries;
 
+    // serialized ze_info contents, created at layout for knowing its size
+    std::string m_ZEInfoStr;
+    std::vector<uint8_t> m_ZEInfoBin;
+
+    // the section header's offset and the total file size, set by layout
+    uint64_t m_SectionHdrOffset = 0;
+    uint64_t m_TotalSize = 0;
+    bool m_IsLaidOut = false;
+
+};
+
+/// ELFBufferStream - A raw_pwrite_stream writes into a fixed size buffer
+///                   owned by the caller. It is unbuffered so the contents
+///                   are copied only once, straight into the given buffer
+class ELFBufferStream : public llvm::raw_pwrite_stream {
+public:
+    ELFBufferStream() : llvm::raw_pwrite_stream(/*Unbuffered=*/true) {}
+
+    void setBuffer(uint8_t* buf, uint64_t size) {
+        m_Buf = buf;
+        m_Size = size;
+        m_Pos = 0;
+    }
+
+private:
+    void write_impl(const char* ptr, size_t size) override {
+        IGC_ASSERT_MESSAGE(m_Pos + size <= m_Size, "ELFBufferStream overflow");
+        memcpy(m_Buf + m_Pos, ptr, size);
+        m_Pos += size;
+    }
+
+    void pwrite_impl(const char* ptr, size_t size, uint64_t offset) override {
+        IGC_ASSERT_MESSAGE(offset + size <= m_Pos, "ELFBufferStream overflow");
+        memcpy(m_Buf + offset, ptr, size);
+    }
+
+    uint64_t current_pos() const override { return m_Pos; }
+
+private:
+    uint8_t* m_Buf = nullptr;
+    uint64_t m_Size = 0;
+    uint64_t m_Pos = 0;
 };
 
 } // namespace zebin
@@ -171,7 +231,7 @@ ZEELFObjectBuilder::addStandardSection(
 
     // total required padding is (padding + need_padding_for_align)
     sections.emplace_back(
-        ZEELFObjectBuilder::StandardSection(name, sectName, data, size, type,
+        ZEELFObjectBuilder::StandardSection(std::move(name), std::move(sectName), data, size, type,
             (need_padding_for_align + padding), m_sectionId));
     ++m_sectionId;
     return sections.back();
@@ -274,10 +334,10 @@ void ZEELFObjectBuilder::addSymbol(
 {
     if (binding == llvm::ELF::STB_LOCAL)
         m_localSymbols.emplace_back(
-            ZEELFObjectBuilder::Symbol(name, addr, size, binding, type, sectionId));
+            ZEELFObjectBuilder::Symbol(std::move(name), addr, size, binding, type, sectionId));
     else
         m_globalSymbols.emplace_back(
-            ZEELFObjectBuilder::Symbol(name, addr, size, binding, type, sectionId));
+            ZEELFObjectBuilder::Symbol(std::move(name), addr, size, binding, type, sectionId));
 }
 
 ZEELFObjectBuilder::RelocSection&
@@ -310,7 +370,7 @@ void ZEELFObjectBuilder::addRelocation(
     RelocSection& reloc_sect = getOrCreateRelocSection(sectionId);
     // create the relocation
     reloc_sect.m_Relocations.emplace_back(
-        ZEELFObjectBuilder::Relocation(offset, symName, type));
+        ZEELFObjectBuilder::Relocation(offset, std::move(symName), type));
 }
 
 uint64_t ZEELFObjectBuilder::finalize(llvm::raw_pwrite_stream& os)
@@ -319,6 +379,20 @@ uint64_t ZEELFObjectBuilder::finalize(llvm::raw_pwrite_stream& os)
     return w.write();
 }
 
+uint64_t ZEELFObjectBuilder::finalize(
+    const std::function<uint8_t*(uint64_t)>& allocBuffer)
+{
+    ELFBufferStream os;
+    ELFWriter w(os, *this);
+    uint64_t size = w.layout();
+    uint8_t* buf = allocBuffer(size);
+    IGC_ASSERT(nullptr != buf);
+    os.setBuffer(buf, size);
+    uint64_t written = w.write();
+    IGC_ASSERT(written == size);
+    return written;
+}
+
 std::string ZEELFObjectBuilder::getSectionNameBySectionID(SectionID id)
 {
     // do linear search that we assume there won't be too many sections
@@ -354,8 +428,7 @@ uint64_t ELFWriter::writeSectionData(const uint8_t* data, uint64_t size, uint32_
 
 void ELFWriter::writePadding(uint32_t size)
 {
-    for (uint32_t i = 0; i < size; ++i)
-        m_W.write<uint8_t>(0x0);
+    m_W.OS.write_zeros(size);
 }
 
 uint32_t ELFWriter::getSymTabEntSize()
@@ -374,6 +447,22 @@ uint32_t ELFWriter::getRelocTabEntSize()
         return sizeof(ELF::Elf32_Rel);
 }
 
+uint32_t ELFWriter::getELFHeaderSize()
+{
+    if (is64Bit())
+        return sizeof(ELF::Elf64_Ehdr);
+    else
+        return sizeof(ELF::Elf32_Ehdr);
+}
+
+uint32_t ELFWriter::getSectionHdrEntSize()
+{
+    if (is64Bit())
+        return sizeof(ELF::Elf64_Shdr);
+    else
+        return sizeof(ELF::Elf32_Shdr);
+}
+
 void ELFWriter::writeSymbol(uint32_t name, uint64_t value, uint64_t size,
     uint8_t binding, uint8_t type, uint8_t other, uint16_t shndx)
 {
@@ -414,9 +503,9 @@ uint64_t ELFWriter::writeRelocTab(const RelocationListTy& relocs)
 
     for (const ZEELFObjectBuilder::Relocation& reloc : relocs) {
         // the target symbol's name must have been added into symbol table
-        IGC_ASSERT(m_SymNameIdxMap.find(reloc.symName()) != m_SymNameIdxMap.end());
-        writeRelocation(
-            reloc.offset(), reloc.type(), m_SymNameIdxMap[reloc.symName()]);
+        auto symIt = m_SymNameIdxMap.find(reloc.symName());
+        IGC_ASSERT(symIt != m_SymNameIdxMap.end());
+        writeRelocation(reloc.offset(), reloc.type(), symIt->second);
     }
 
     return m_W.OS.tell() - start_off;
@@ -426,15 +515,12 @@ uint64_t ELFWriter::writeSymTab()
 {
     uint64_t start_off = m_W.OS.tell();
 
-    uint64_t symidx = 0;
-
     // index 0 is the null symbol
     writeSymbol(0, 0, 0, 0, 0, 0, ELF::SHN_UNDEF);
-    ++symidx;
 
     auto writeOneSym = [&](ZEELFObjectBuilder::Symbol& sym) {
-        // create symbol name entry in str table
-        uint32_t nameoff = m_StrTabBuilder.add(StringRef(sym.name()));
+        // symbol name entry has been created in createSymbolEntries
+        uint32_t nameoff = m_StrTabBuilder.getOffset(StringRef(sym.name()));
 
         uint16_t sect_idx = 0;
         if (sym.sectionId() >= 0) {
@@ -449,10 +535,6 @@ uint64_t ELFWriter::writeSymTab()
 
         writeSymbol(nameoff, sym.addr(), sym.size(), sym.binding(), sym.type(),
             0, sect_idx);
-        // symbol name must be unique
-        IGC_ASSERT(m_SymNameIdxMap.find(sym.name()) == m_SymNameIdxMap.end());
-        m_SymNameIdxMap.insert(std::make_pair(sym.name(), symidx));
-        ++symidx;
     };
 
     // Write the local symbols first
@@ -471,10 +553,17 @@ uint64_t ELFWriter::writeSymTab()
 uint64_t ELFWriter::writeZEInfo()
 {
     uint64_t start_off = m_W.OS.tell();
-    // serialize ze_info contents
-    llvm::yaml::Output yout(m_W.OS);
-    IGC_ASSERT(nullptr != m_ObjBuilder.m_zeInfoSection);
-    yout << m_ObjBuilder.m_zeInfoSection->getZeInfo();
+    // ze_info contents have been serialized in layoutSections
+    m_W.OS.write(m_ZEInfoStr.data(), m_ZEInfoStr.size());
+
+    return m_W.OS.tell() - start_off;
+}
+
+uint64_t ELFWriter::writeZEInfoBin()
+{
+    uint64_t start_off = m_W.OS.tell();
+    // ze_info contents have been encoded in layoutSections
+    m_W.OS.write((const char*)m_ZEInfoBin.data(), m_ZEInfoBin.size());
 
     return m_W.OS.tell() - start_off;
 }
@@ -483,11 +572,7 @@ uint64_t ELFWriter::writeStrTab()
 {
     uint64_t start_off = m_W.OS.tell();
 
-    // at this point, all strings should be added. Finalized the string table
-    // and write it to OS
-    // must finlized it in order, that we take the offset of
-    // section and symbols' name when added
-    m_StrTabBuilder.finalizeInOrder();
+    // the string table has been finalized in layout
     m_StrTabBuilder.write(m_W.OS);
 
     return m_W.OS.tell() - start_off;
@@ -517,26 +602,31 @@ void ELFWriter::writeSectionHeader()
     for (SectionHdrEntry& entry : m_SectionHdrEntries) {
         writeSecHdrEntry(
             entry.name, entry.type, 0, 0, entry.offset, entry.size, entry.link,
-            entry.info, 0, entry.entsize);
+            entry.info, entry.addralign, entry.entsize);
     }
 }
 
-void ELFWriter::writeSections()
+void ELFWriter::layoutSections()
 {
+    // sections are placed right after the ELF header in the order of
+    // m_SectionHdrEntries, followed by the section header
+    uint64_t offset = getELFHeaderSize();
     for (SectionHdrEntry& entry : m_SectionHdrEntries) {
-        entry.offset = m_W.OS.tell();
+        if (entry.addralign)
+            offset = (offset + entry.addralign - 1) / entry.addralign * entry.addralign;
+        entry.offset = offset;
 
         switch(entry.type) {
         case ELF::SHT_PROGBITS:
-        case SHT_ZEBIN_SPIRV: {
+        case SHT_ZEBIN_SPIRV:
+        case SHT_ZEBIN_GTPIN_INFO: {
             IGC_ASSERT(nullptr != entry.section);
             IGC_ASSERT(entry.section->getKind() == Section::STANDARD);
             const StandardSection* const stdsect =
                 static_cast<const StandardSection*>(entry.section);
             IGC_ASSERT(nullptr != stdsect);
             IGC_ASSERT(stdsect->m_size + stdsect->m_padding);
-            entry.size = writeSectionData(
-                stdsect->m_data, stdsect->m_size, stdsect->m_padding);
+            entry.size = stdsect->m_size + stdsect->m_padding;
             break;
         }
         case ELF::SHT_NOBITS: {
@@ -547,7 +637,9 @@ void ELFWriter::writeSections()
             break;
         }
         case ELF::SHT_SYMTAB:
-            entry.size = writeSymTab();
+            // local and global symbols, and the first null symbol
+            entry.size = (m_ObjBuilder.m_localSymbols.size() +
+                m_ObjBuilder.m_globalSymbols.size() + 1) * getSymTabEntSize();
             entry.entsize = getSymTabEntSize();
             entry.link = m_StringTableIndex;
             // one greater than the last local symbol index, including the
@@ -561,16 +653,27 @@ void ELFWriter::writeSections()
             const RelocSection* const relocSec =
                 static_cast<const RelocSection*>(entry.section);
             IGC_ASSERT(nullptr != relocSec);
-            entry.size = writeRelocTab(relocSec->m_Relocations);
+            entry.size = relocSec->m_Relocations.size() * getRelocTabEntSize();
             entry.entsize = getRelocTabEntSize();
             break;
         }
-        case SHT_ZEBIN_ZEINFO:
-            entry.size = writeZEInfo();
+        case SHT_ZEBIN_ZEINFO: {
+            // serialize ze_info contents
+            llvm::raw_string_ostream zeInfoOS(m_ZEInfoStr);
+            llvm::yaml::Output yout(zeInfoOS);
+            IGC_ASSERT(nullptr != m_ObjBuilder.m_zeInfoSection);
+            yout << m_ObjBuilder.m_zeInfoSection->getZeInfo();
+            zeInfoOS.flush();
+            entry.size = m_ZEInfoStr.size();
+            break;
+        }
+        case SHT_ZEBIN_ZEINFO_BIN:
+            IGC_ASSERT(nullptr != m_ObjBuilder.m_zeInfoSection);
+            writeZEInfoBinary(m_ObjBuilder.m_zeInfoSection->getZeInfo(), m_ZEInfoBin);
+            entry.size = m_ZEInfoBin.size();
             break;
-
         case ELF::SHT_STRTAB:
-            entry.size = writeStrTab();
+            entry.size = m_StrTabBuilder.getSize();
             break;
 
         case ELF::SHT_NULL:
@@ -584,25 +687,68 @@ void ELFWriter::writeSections()
             IGC_ASSERT(0);
             break;
         }
+
+        // bss and the null section occupy no space in the file
+        if (entry.type != ELF::SHT_NOBITS && entry.type != ELF::SHT_NULL)
+            offset += entry.size;
     }
+
+    m_SectionHdrOffset = offset;
+    m_TotalSize = offset + m_SectionHdrEntries.size() * getSectionHdrEntSize();
 }
 
-void ELFWriter::writeSectionHdrOffset(uint64_t offset)
+void ELFWriter::writeSections()
 {
-    auto &stream = static_cast<raw_pwrite_stream &>(m_W.OS);
-
-    if (is64Bit()) {
-        uint64_t Val =
-            support::endian::byte_swap<uint64_t>(offset, m_W.Endian);
-        stream.pwrite(reinterpret_cast<char *>(&Val), sizeof(Val),
-            offsetof(ELF::Elf64_Ehdr, e_shoff));
+    uint64_t start_off = m_W.OS.tell();
+    for (SectionHdrEntry& entry : m_SectionHdrEntries) {
+        // padding for the section's alignment, see layoutSections
+        uint64_t cur_off = m_W.OS.tell() - start_off + getELFHeaderSize();
+        IGC_ASSERT(cur_off <= entry.offset);
+        writePadding((uint32_t)(entry.offset - cur_off));
+        IGC_ASSERT(m_W.OS.tell() - start_off + getELFHeaderSize() == entry.offset);
 
-    } else {
-        uint32_t Val =
-            support::endian::byte_swap<uint32_t>(
-                static_cast<uint32_t>(offset), m_W.Endian);
-        stream.pwrite(reinterpret_cast<char *>(&Val), sizeof(Val),
-            offsetof(ELF::Elf32_Ehdr, e_shoff));
+        switch(entry.type) {
+        case ELF::SHT_PROGBITS:
+        case SHT_ZEBIN_SPIRV:
+        case SHT_ZEBIN_GTPIN_INFO: {
+            const StandardSection* const stdsect =
+                static_cast<const StandardSection*>(entry.section);
+            uint64_t size = writeSectionData(
+                stdsect->m_data, stdsect->m_size, stdsect->m_padding);
+            IGC_ASSERT(size == entry.size);
+            break;
+        }
+        case ELF::SHT_SYMTAB: {
+            uint64_t size = writeSymTab();
+            IGC_ASSERT(size == entry.size);
+            break;
+        }
+        case ELF::SHT_REL: {
+            const RelocSection* const relocSec =
+                static_cast<const RelocSection*>(entry.section);
+            uint64_t size = writeRelocTab(relocSec->m_Relocations);
+            IGC_ASSERT(size == entry.size);
+            break;
+        }
+        case SHT_ZEBIN_ZEINFO: {
+            uint64_t size = writeZEInfo();
+            IGC_ASSERT(size == entry.size);
+            break;
+        }
+        case SHT_ZEBIN_ZEINFO_BIN: {
+            uint64_t size = writeZEInfoBin();
+            IGC_ASSERT(size == entry.size);
+            break;
+        }
+        case ELF::SHT_STRTAB: {
+            uint64_t size = writeStrTab();
+            IGC_ASSERT(size == entry.size);
+            break;
+        }
+        default:
+            // SHT_NOBITS and SHT_NULL have no contents
+            break;
+        }
     }
 }
 
@@ -638,22 +784,20 @@ void ELFWriter::writeHeader()
     // e_phoff, no program header
     writeWord(0);
 
-    // e_shoff, will write it later
-    writeWord(0);
+    // e_shoff, the section header follows all sections
+    writeWord(m_SectionHdrOffset);
 
     // e_flags
     m_W.write<uint32_t>(m_ObjBuilder.m_flags.packed);
 
     // e_ehsize = ELF header size
-    m_W.write<uint16_t>(is64Bit() ?
-        sizeof(ELF::Elf64_Ehdr) : sizeof(ELF::Elf32_Ehdr));
+    m_W.write<uint16_t>(getELFHeaderSize());
 
     m_W.write<uint16_t>(0);          // e_phentsize = prog header entry size
     m_W.write<uint16_t>(0);          // e_phnum = # prog header entries = 0
 
     // e_shentsize
-    m_W.write<uint16_t>(is64Bit() ?
-        sizeof(ELF::Elf64_Shdr) : sizeof(ELF::Elf32_Shdr));
+    m_W.write<uint16_t>(getSectionHdrEntSize());
 
     // e_shnum
     m_W.write<uint16_t>(numOfSections());
@@ -674,15 +818,33 @@ ELFWriter::ELFWriter(llvm::raw_pwrite_stream& OS,
 {
 }
 
+uint64_t ELFWriter::layout()
+{
+    if (m_IsLaidOut)
+        return m_TotalSize;
+
+    createSectionHdrEntries();
+    createSymbolEntries();
+    // at this point, all strings should be added. Finalize the string table
+    // in order, that we take the offset of section and symbols' name when
+    // added
+    m_StrTabBuilder.finalizeInOrder();
+    layoutSections();
+
+    m_IsLaidOut = true;
+    return m_TotalSize;
+}
+
 uint64_t ELFWriter::write()
 {
+    layout();
+
     uint64_t start = m_W.OS.tell();
-    createSectionHdrEntries();
     writeHeader();
     writeSections();
-    uint64_t sectHdrOff = m_W.OS.tell();
+    IGC_ASSERT(m_W.OS.tell() - start == m_SectionHdrOffset);
     writeSectionHeader();
-    writeSectionHdrOffset(sectHdrOff);
+    IGC_ASSERT(m_W.OS.tell() - start == m_TotalSize);
     return m_W.OS.tell() - start;
 }
 
@@ -718,6 +880,7 @@ void ELFWriter::createSectionHdrEntries()
     // all other standard sections follow the order of being added (spv, debug)
     // .rel
     // .ze_info
+    // .ze_info.bin
     // .strtab
 
     // first entry is NULL section
@@ -769,12 +932,25 @@ void ELFWriter::createSectionHdrEntries()
         }
     }
 
-    // .ze_info
-    // every object must have exactly one ze_info section
+    // .ze_info and .ze_info.bin
+    // every object must have exactly one ze_info section, in YAML and/or
+    // binary encoding
+    IGC_ASSERT((m_ObjBuilder.m_zeInfoEncodings &
+        (ZEELFObjectBuilder::ZEINFO_YAML | ZEELFObjectBuilder::ZEINFO_BINARY)) != 0);
     if (m_ObjBuilder.m_zeInfoSection != nullptr) {
-        createSectionHdrEntry(m_ObjBuilder.m_ZEInfoName, SHT_ZEBIN_ZEINFO,
-            m_ObjBuilder.m_zeInfoSection);
-        ++index;
+        if (m_ObjBuilder.m_zeInfoEncodings & ZEELFObjectBuilder::ZEINFO_YAML) {
+            createSectionHdrEntry(m_ObjBuilder.m_ZEInfoName, SHT_ZEBIN_ZEINFO,
+                m_ObjBuilder.m_zeInfoSection);
+            ++index;
+        }
+        if (m_ObjBuilder.m_zeInfoEncodings & ZEELFObjectBuilder::ZEINFO_BINARY) {
+            SectionHdrEntry& entry = createSectionHdrEntry(
+                m_ObjBuilder.m_ZEInfoBinName, SHT_ZEBIN_ZEINFO_BIN,
+                m_ObjBuilder.m_zeInfoSection);
+            // so that its 8-byte fields can be read in place
+            entry.addralign = ZEINFO_BINARY_ALIGNMENT;
+            ++index;
+        }
     }
     else
         IGC_ASSERT(0);
@@ -784,6 +960,26 @@ void ELFWriter::createSectionHdrEntries()
     createSectionHdrEntry(m_ObjBuilder.m_StrTabName, ELF::SHT_STRTAB);
 }
 
+void ELFWriter::createSymbolEntries()
+{
+    // symbol index 0 is the null symbol. Local symbols come first and then
+    // global symbols, the same order as they are written in writeSymTab
+    uint64_t symidx = 1;
+    auto createOneSym = [&](ZEELFObjectBuilder::Symbol& sym) {
+        // create symbol name entry in str table
+        m_StrTabBuilder.add(StringRef(sym.name()));
+        // symbol name must be unique
+        IGC_ASSERT(m_SymNameIdxMap.find(sym.name()) == m_SymNameIdxMap.end());
+        m_SymNameIdxMap.insert(std::make_pair(StringRef(sym.name()), symidx));
+        ++symidx;
+    };
+
+    for (ZEELFObjectBuilder::Symbol& sym : m_ObjBuilder.m_localSymbols)
+        createOneSym(sym);
+    for (ZEELFObjectBuilder::Symbol& sym : m_ObjBuilder.m_globalSymbols)
+        createOneSym(sym);
+}
+
 // createKernel - create a zeInfoKernel and add it into zeInfoContainer
 zeInfoKernel& ZEInfoBuilder::createKernel(const std::string& name)
 {
@@ -46,8 +46,10 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "common/LLVMWarningsPop.hpp"
 #endif
 
+#include <functional>
 #include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace llvm {
@@ -173,8 +175,27 @@ public:
     SectionID addSectionDebug(std::string name, const uint8_t* data, uint64_t size);
 
     // add ze_info section
+    // The section is emitted in the encodings set by setZEInfoEncoding
     void addSectionZEInfo(zeInfoContainer& zeInfo);
 
+    // ZEInfoEncoding - the encodings ze_info can be emitted in, can be combined
+    // - ZEINFO_YAML  : .ze_info section in YAML
+    // - ZEINFO_BINARY: .ze_info.bin section in the binary encoding defined in
+    //                  ZEInfoBinaryTraits.hpp
+    enum ZEInfoEncoding : uint32_t {
+        ZEINFO_YAML   = 0x1,
+        ZEINFO_BINARY = 0x2
+    };
+
+    // set the encodings ze_info will be emitted in. YAML only by default.
+    // Unknown bits are ignored; if no known encoding is left, YAML is used as
+    // every object must have a ze_info section
+    void setZEInfoEncoding(uint32_t encodings)
+    {
+        encodings &= (ZEINFO_YAML | ZEINFO_BINARY);
+        m_zeInfoEncodings = encodings ? encodings : (uint32_t)ZEINFO_YAML;
+    }
+
     // add a symbol
     // - name    : symbol's name
     // - addr    : symbol's address. The binary offset of where this symbol is
@@ -202,6 +223,16 @@ public:
     // return number of written bytes
     uint64_t finalize(llvm::raw_pwrite_stream& os);
 
+    // finalize - Finalize the ELF Object, write ELF file into a single buffer
+    // provided by the caller
+    // - allocBuffer: called exactly once with the final size of the ELF file
+    //                in byte, and must return a buffer at least that large.
+    //                The whole object is laid out before the buffer is
+    //                requested, so the output is written in place without
+    //                any intermediate growing stream or extra copy
+    // return number of written bytes
+    uint64_t finalize(const std::function<uint8_t*(uint64_t)>& allocBuffer);
+
 private:
     class Section {
     public:
@@ -224,7 +255,8 @@ private:
     public:
         StandardSection(std::string name, std::string sectName, const uint8_t* data, uint64_t size,
             unsigned type, uint32_t padding, uint32_t id)
-            : Section(id), m_name(name), m_sectName(sectName), m_data(data), m_size(size), m_type(type),
+            : Section(id), m_name(std::move(name)), m_sectName(std::move(sectName)),
+              m_data(data), m_size(size), m_type(type),
               m_padding(padding)
         {}
 
@@ -266,7 +298,7 @@ private:
     public:
         Symbol(std::string name, uint64_t addr, uint64_t size, uint8_t binding,
             uint8_t type, SectionID sectionId)
-            : m_name(name), m_addr(addr), m_size(size), m_binding(binding),
+            : m_name(std::move(name)), m_addr(addr), m_size(size), m_binding(binding),
             m_type(type), m_sectionId(sectionId)
         {}
 
@@ -289,7 +321,7 @@ private:
     class Relocation {
     public:
         Relocation(uint64_t offset, std::string symName, R_TYPE_ZEBIN type)
-            : m_offset(offset), m_symName(symName), m_type(type)
+            : m_offset(offset), m_symName(std::move(symName)), m_type(type)
         {}
 
         uint64_t            offset()  const { return m_offset;  }
@@ -309,7 +341,7 @@ private:
     class RelocSection : public Section {
     public:
         RelocSection(SectionID myID, SectionID targetID, std::string sectName)
-            : Section(myID), m_TargetID(targetID), m_sectName(sectName)
+            : Section(myID), m_TargetID(targetID), m_sectName(std::move(sectName))
         {}
 
         Kind getKind() const { return RELOC; }
@@ -342,6 +374,7 @@ private:
     const std::string m_SpvName       = ".spv";
     const std::string m_DebugName     = ".debug_info";
     const std::string m_ZEInfoName    = ".ze_info";
+    const std::string m_ZEInfoBinName = ".ze_info.bin";
     const std::string m_GTPinInfoName = ".gtpin_info";
     const std::string m_StrTabName    = ".strtab";
 
@@ -364,6 +397,8 @@ private:
 
     // every ze object contains only one ze_info section
     ZEInfoSection* m_zeInfoSection = nullptr;
+    // ZEInfoEncoding bits
+    uint32_t m_zeInfoEncodings = ZEINFO_YAML;
     SymbolListTy m_localSymbols;
     SymbolListTy m_globalSymbols;
 
@@ -0,0 +1,449 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+#include <ZEInfoBinaryTraits.hpp>
+#include <ZEInfoBinary.hpp>
+
+#ifndef ZEBinStandAloneBuild
+#include "common/LLVMWarningsPush.hpp"
+#endif
+
+#include "llvm/Support/Endian.h"
+
+#ifndef ZEBinStandAloneBuild
+#include "common/LLVMWarningsPop.hpp"
+#endif
+
+#include <cstring>
+#include <map>
+#include <unordered_map>
+#include "Probe/Assertion.h"
+
+using namespace zebin;
+using namespace llvm::support;
+
+namespace {
+
+// the header as little-endian words, in declaration order
+static const size_t ZEINFO_BINARY_HEADER_WORDS =
+    sizeof(ZEInfoBinaryHeader) / sizeof(uint32_t);
+
+static void writeHeader(const ZEInfoBinaryHeader& header, uint8_t* out)
+{
+    const uint32_t words[] = {
+        header.magic, header.version, header.schemaHash, header.size,
+        header.rootOffset, header.strTabOffset, header.strTabSize,
+        header.reserved };
+    static_assert(sizeof(words) == sizeof(ZEInfoBinaryHeader),
+        "ZEInfoBinaryHeader changed, update writeHeader and readHeader");
+    for (size_t i = 0; i < ZEINFO_BINARY_HEADER_WORDS; ++i)
+        endian::write32le(out + 4 * i, words[i]);
+}
+
+static void readHeader(const uint8_t* in, ZEInfoBinaryHeader& header)
+{
+    uint32_t* words[] = {
+        &header.magic, &header.version, &header.schemaHash, &header.size,
+        &header.rootOffset, &header.strTabOffset, &header.strTabSize,
+        &header.reserved };
+    for (size_t i = 0; i < ZEINFO_BINARY_HEADER_WORDS; ++i)
+        *words[i] = endian::read32le(in + 4 * i);
+}
+
+/// ZEInfoBinarySchemaHasher - hash the schema of a zeInfo struct and all the
+///                            structs it contains
+class ZEInfoBinarySchemaHasher : public ZEInfoBinaryIO {
+public:
+    bool outputting() const override { return false; }
+
+    void map(const char* name, zeinfo_int32_t& val) override { add(name, "i32"); }
+    void map(const char* name, zeinfo_int64_t& val) override { add(name, "i64"); }
+    void map(const char* name, zeinfo_bool_t& val) override  { add(name, "bool"); }
+    void map(const char* name, zeinfo_str_t& val) override   { add(name, "str"); }
+    using ZEInfoBinaryIO::map;
+
+    uint32_t getHash() const { return m_Hash; }
+
+protected:
+    void beginStruct(const char* name) override { add(name, "{"); }
+    void endStruct() override { add("", "}"); }
+    uint32_t beginSequence(const char* name, uint32_t count, uint32_t recordSize) override {
+        add(name, "[");
+        // walk one default-constructed element for the element's schema
+        return 1;
+    }
+    void beginElement(uint32_t index) override {}
+    void endSequence() override { add("", "]"); }
+
+private:
+    // FNV-1a
+    void add(const char* name, const char* type) {
+        for (const char* s : {name, ":", type, ";"}) {
+            for (; *s; ++s) {
+                m_Hash ^= (uint8_t)*s;
+                m_Hash *= 16777619u;
+            }
+        }
+    }
+
+    uint32_t m_Hash = 2166136261u;
+};
+
+/// ZEInfoBinaryOutput - encode zeInfo structs
+class ZEInfoBinaryOutput : public ZEInfoBinaryIO {
+public:
+    // out: the buffer the section is appended to
+    // base: offset of the section in out
+    ZEInfoBinaryOutput(std::vector<uint8_t>& out, size_t base)
+        : m_Out(out), m_Base(base) {}
+
+    bool outputting() const override { return true; }
+
+    void map(const char* name, zeinfo_int32_t& val) override { write32((uint32_t)val); }
+    void map(const char* name, zeinfo_int64_t& val) override { write64((uint64_t)val); }
+    void map(const char* name, zeinfo_bool_t& val) override { write32(val ? 1 : 0); }
+    void map(const char* name, zeinfo_str_t& val) override {
+        write32(addString(val));
+        write32((uint32_t)val.size());
+    }
+    using ZEInfoBinaryIO::map;
+
+    // reserve a zero-filled, aligned record of given size at the end of the
+    // section, and return its offset
+    uint32_t allocate(uint32_t size) {
+        uint32_t off = alignZEInfoBinary((uint32_t)(m_Out.size() - m_Base));
+        m_Out.resize(m_Base + off + size, 0);
+        return off;
+    }
+
+    void setCursor(uint32_t off) { m_Cursor = off; }
+
+    const std::string& getStrTab() const { return m_StrTab; }
+
+protected:
+    uint32_t beginSequence(const char* name, uint32_t count, uint32_t recordSize) override {
+        uint32_t off = count ? allocate(count * recordSize) : 0;
+        write32(count);
+        write32(off);
+        m_SeqStack.push_back({ m_Cursor, off, recordSize });
+        return count;
+    }
+
+    void beginElement(uint32_t index) override {
+        const Sequence& seq = m_SeqStack.back();
+        m_Cursor = seq.offset + index * seq.recordSize;
+    }
+
+    void endSequence() override {
+        m_Cursor = m_SeqStack.back().cursor;
+        m_SeqStack.pop_back();
+    }
+
+private:
+    uint8_t* reserve(uint32_t size) {
+        IGC_ASSERT(m_Base + m_Cursor + size <= m_Out.size());
+        uint8_t* p = m_Out.data() + m_Base + m_Cursor;
+        m_Cursor += size;
+        return p;
+    }
+    void write32(uint32_t val) { endian::write32le(reserve(4), val); }
+    void write64(uint64_t val) {
+        // the skipped slot is left zero-filled
+        m_Cursor = alignZEInfoBinary(m_Cursor);
+        endian::write64le(reserve(8), val);
+    }
+
+    // strings are pooled, the same string is stored once
+    uint32_t addString(const std::string& str) {
+        auto it = m_StrOffsets.find(str);
+        if (it != m_StrOffsets.end())
+            return it->second;
+        uint32_t off = (uint32_t)m_StrTab.size();
+        m_StrTab.append(str);
+        m_StrOffsets.insert(std::make_pair(str, off));
+        return off;
+    }
+
+    struct Sequence {
+        uint32_t cursor;     // cursor to resume at the end of the sequence
+        uint32_t offset;     // offset of the element array
+        uint32_t recordSize; // element's record size
+    };
+
+    std::vector<uint8_t>& m_Out;
+    size_t m_Base;
+    uint32_t m_Cursor = 0;
+    std::vector<Sequence> m_SeqStack;
+    std::string m_StrTab;
+    std::unordered_map<std::string, uint32_t> m_StrOffsets;
+};
+
+/// ZEInfoBinaryInput - decode zeInfo structs, with all offsets and sizes
+///                     validated against the section bounds
+class ZEInfoBinaryInput : public ZEInfoBinaryIO {
+public:
+    // recordsEnd: end of the records, which is the start of string table
+    ZEInfoBinaryInput(const uint8_t* data, uint32_t recordsEnd,
+        const char* strTab, uint32_t strTabSize, uint32_t cursor)
+        : m_Data(data), m_RecordsEnd(recordsEnd), m_StrTab(strTab),
+          m_StrTabSize(strTabSize), m_Cursor(cursor) {}
+
+    bool outputting() const override { return false; }
+
+    void map(const char* name, zeinfo_int32_t& val) override {
+        val = (zeinfo_int32_t)read32(name);
+    }
+    void map(const char* name, zeinfo_int64_t& val) override {
+        val = (zeinfo_int64_t)read64(name);
+    }
+    void map(const char* name, zeinfo_bool_t& val) override { val = read32(name) != 0; }
+    void map(const char* name, zeinfo_str_t& val) override {
+        uint32_t slot[2];
+        slot[0] = read32(name);
+        slot[1] = read32(name);
+        if (!isValid())
+            return;
+        if (slot[0] > m_StrTabSize || slot[1] > m_StrTabSize - slot[0]) {
+            setError(name, "string out of bounds");
+            return;
+        }
+        val.assign(m_StrTab + slot[0], slot[1]);
+    }
+    using ZEInfoBinaryIO::map;
+
+    // do not decode the elements of sequences, but only record their slots
+    void setShallow(bool shallow) { m_Shallow = shallow; }
+    // the slot of the sequence with given name, recorded in shallow mode
+    bool getSequenceSlot(const std::string& name, uint32_t& count, uint32_t& offset) const {
+        auto it = m_SeqSlots.find(name);
+        if (it == m_SeqSlots.end())
+            return false;
+        count = it->second.first;
+        offset = it->second.second;
+        return true;
+    }
+
+    bool isValid() const { return m_Error.empty(); }
+    const std::string& getError() const { return m_Error; }
+
+protected:
+    uint32_t beginSequence(const char* name, uint32_t, uint32_t recordSize) override {
+        uint32_t count = read32(name);
+        uint32_t off = read32(name);
+        // always pushed as endSequence is always called
+        m_SeqStack.push_back({ m_Cursor, off, recordSize });
+        if (!isValid())
+            return 0;
+        if (count != 0 && (off > m_RecordsEnd ||
+            (uint64_t)count * recordSize > m_RecordsEnd - off)) {
+            setError(name, "element array out of bounds");
+            return 0;
+        }
+        if (count != 0 && off != alignZEInfoBinary(off)) {
+            setError(name, "element array misaligned");
+            return 0;
+        }
+        if (m_Shallow) {
+            m_SeqSlots[name] = std::make_pair(count, off);
+            return 0;
+        }
+        return count;
+    }
+
+    void beginElement(uint32_t index) override {
+        const Sequence& seq = m_SeqStack.back();
+        m_Cursor = seq.offset + index * seq.recordSize;
+    }
+
+    void endSequence() override {
+        m_Cursor = m_SeqStack.back().cursor;
+        m_SeqStack.pop_back();
+    }
+
+private:
+    // returns nullptr (and sets the error) if size bytes can't be read
+    const uint8_t* consume(const char* name, uint32_t size) {
+        if (!isValid())
+            return nullptr;
+        if (m_Cursor > m_RecordsEnd || size > m_RecordsEnd - m_Cursor) {
+            setError(name, "record out of bounds");
+            return nullptr;
+        }
+        const uint8_t* p = m_Data + m_Cursor;
+        m_Cursor += size;
+        return p;
+    }
+    uint32_t read32(const char* name) {
+        const uint8_t* p = consume(name, 4);
+        return p ? endian::read32le(p) : 0;
+    }
+    uint64_t read64(const char* name) {
+        m_Cursor = alignZEInfoBinary(m_Cursor);
+        const uint8_t* p = consume(name, 8);
+        return p ? endian::read64le(p) : 0;
+    }
+
+    void setError(const char* name, const char* msg) {
+        m_Error = std::string(name) + ": " + msg;
+    }
+
+    struct Sequence {
+        uint32_t cursor;
+        uint32_t offset;
+        uint32_t recordSize;
+    };
+
+    const uint8_t* m_Data;
+    uint32_t m_RecordsEnd;
+    const char* m_StrTab;
+    uint32_t m_StrTabSize;
+    uint32_t m_Cursor;
+    bool m_Shallow = false;
+    std::vector<Sequence> m_SeqStack;
+    std::map<std::string, std::pair<uint32_t, uint32_t>> m_SeqSlots;
+    std::string m_Error;
+};
+
+} // namespace
+
+uint32_t zebin::getZEInfoBinarySchemaHash()
+{
+    static const uint32_t hash = [] {
+        zeInfoContainer info;
+        ZEInfoBinarySchemaHasher hasher;
+        ZEInfoBinaryTraits<zeInfoContainer>::mapping(hasher, info);
+        return hasher.getHash();
+    }();
+    return hash;
+}
+
+void zebin::writeZEInfoBinary(zeInfoContainer& zeInfo, std::vector<uint8_t>& out)
+{
+    size_t base = out.size();
+    ZEInfoBinaryOutput output(out, base);
+
+    output.allocate(sizeof(ZEInfoBinaryHeader));
+    uint32_t rootOffset =
+        output.allocate(getZEInfoBinaryRecordSize<zeInfoContainer>());
+    output.setCursor(rootOffset);
+    ZEInfoBinaryTraits<zeInfoContainer>::mapping(output, zeInfo);
+
+    // string table, padded to keep the section size aligned
+    const std::string& strTab = output.getStrTab();
+    uint32_t strTabOffset = output.allocate(alignZEInfoBinary((uint32_t)strTab.size()));
+    memcpy(out.data() + base + strTabOffset, strTab.data(), strTab.size());
+
+    ZEInfoBinaryHeader header;
+    header.magic = ZEINFO_BINARY_MAGIC;
+    header.version = ZEINFO_BINARY_VERSION;
+    header.schemaHash = getZEInfoBinarySchemaHash();
+    header.size = (uint32_t)(out.size() - base);
+    header.rootOffset = rootOffset;
+    header.strTabOffset = strTabOffset;
+    header.strTabSize = (uint32_t)strTab.size();
+    header.reserved = 0;
+    writeHeader(header, out.data() + base);
+}
+
+ZEInfoBinaryReader::ZEInfoBinaryReader(const uint8_t* data, size_t size)
+    : m_Data(data), m_Size(size)
+{
+    if (size < sizeof(ZEInfoBinaryHeader)) {
+        m_Error = "section is smaller than the header";
+        return;
+    }
+    readHeader(data, m_Header);
+    if (m_Header.magic != ZEINFO_BINARY_MAGIC) {
+        m_Error = "invalid magic number";
+        return;
+    }
+    if (m_Header.version != ZEINFO_BINARY_VERSION) {
+        m_Error = "unsupported version " + std::to_string(m_Header.version);
+        return;
+    }
+    if (m_Header.schemaHash != getZEInfoBinarySchemaHash()) {
+        m_Error = "zeInfo schema mismatch";
+        return;
+    }
+    if (m_Header.size > size ||
+        m_Header.strTabOffset > m_Header.size ||
+        m_Header.strTabSize > m_Header.size - m_Header.strTabOffset ||
+        m_Header.rootOffset < sizeof(ZEInfoBinaryHeader) ||
+        m_Header.rootOffset > m_Header.strTabOffset ||
+        m_Header.rootOffset != alignZEInfoBinary(m_Header.rootOffset) ||
+        m_Header.strTabOffset != alignZEInfoBinary(m_Header.strTabOffset)) {
+        m_Error = "invalid section layout";
+        return;
+    }
+
+    // locate the kernels' offset table
+    zeInfoContainer root;
+    ZEInfoBinaryInput input(m_Data, m_Header.strTabOffset,
+        (const char*)m_Data + m_Header.strTabOffset, m_Header.strTabSize,
+        m_Header.rootOffset);
+    input.setShallow(true);
+    ZEInfoBinaryTraits<zeInfoContainer>::mapping(input, root);
+    if (!input.isValid()) {
+        m_Error = input.getError();
+        return;
+    }
+    bool found = input.getSequenceSlot("kernels", m_NumKernels, m_KernelsOffset);
+    IGC_ASSERT(found);
+    (void)found;
+}
+
+bool ZEInfoBinaryReader::read(zeInfoContainer& zeInfo)
+{
+    if (!isValid())
+        return false;
+    ZEInfoBinaryInput input(m_Data, m_Header.strTabOffset,
+        (const char*)m_Data + m_Header.strTabOffset, m_Header.strTabSize,
+        m_Header.rootOffset);
+    ZEInfoBinaryTraits<zeInfoContainer>::mapping(input, zeInfo);
+    if (!input.isValid()) {
+        m_Error = input.getError();
+        return false;
+    }
+    return true;
+}
+
+bool ZEInfoBinaryReader::readKernel(uint32_t index, zeInfoKernel& kernel)
+{
+    if (!isValid())
+        return false;
+    if (index >= m_NumKernels) {
+        m_Error = "kernel index out of range";
+        return false;
+    }
+    ZEInfoBinaryInput input(m_Data, m_Header.strTabOffset,
+        (const char*)m_Data + m_Header.strTabOffset, m_Header.strTabSize,
+        m_KernelsOffset + index * getZEInfoBinaryRecordSize<zeInfoKernel>());
+    ZEInfoBinaryTraits<zeInfoKernel>::mapping(input, kernel);
+    if (!input.isValid()) {
+        m_Error = input.getError();
+        return false;
+    }
+    return true;
+}
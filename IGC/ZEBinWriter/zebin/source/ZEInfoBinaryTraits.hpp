@@ -0,0 +1,236 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+//===- ZEInfoBinaryTraits.hpp -----------------------------------*- C++ -*-===//
+// ZE Binary Utilitis
+//
+// \file
+// This file declares the binary encoding of zeInfo (.ze_info.bin section),
+// an alternative to the YAML .ze_info section that can be read without
+// parsing
+//===----------------------------------------------------------------------===//
+
+#ifndef ZE_INFO_BINARY_TRAITS_HPP
+#define ZE_INFO_BINARY_TRAITS_HPP
+
+#include <ZEInfo.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace zebin {
+
+// The encoding is derived from the zeInfo structs: each struct is a
+// fixed-size record and its fields are laid out in the order given by its
+// ZEInfoBinaryTraits::mapping (generated from the spec, see ZEInfoBinary.hpp).
+// Every field takes a 4-byte aligned slot:
+//   int32, bool : 4 bytes
+//   int64       : 8 bytes, 8-byte aligned (the slot before is padded)
+//   string      : {uint32 offset, uint32 size} into the string table
+//   vector      : {uint32 count, uint32 offset} of an array of elements,
+//                 each element is a record of the element type
+//   struct      : the record of the struct, inlined
+// Record sizes are rounded up to ZEINFO_BINARY_ALIGNMENT. As records are
+// fixed-size, a vector slot is an offset table: its element i is at
+// offset + i * recordSize, so a kernel can be located and decoded without
+// touching the others. All offsets are from the beginning of the section,
+// all values are little-endian.
+//
+// Section layout, every table starting ZEINFO_BINARY_ALIGNMENT aligned:
+//   ZEInfoBinaryHeader
+//   zeInfoContainer record
+//   element arrays, in the order they are mapped
+//   string table, padded to keep the section size aligned
+// The ELF writer aligns the section itself the same way, so a reader can
+// access the 8-byte fields in place if the binary is loaded 8-byte aligned.
+struct ZEInfoBinaryHeader {
+    uint32_t magic;        // ZEINFO_BINARY_MAGIC
+    uint32_t version;      // ZEINFO_BINARY_VERSION, version of this encoding
+    uint32_t schemaHash;   // hash of the zeInfo schema, see getZEInfoBinarySchemaHash
+    uint32_t size;         // size of the section in byte
+    uint32_t rootOffset;   // offset of the zeInfoContainer record
+    uint32_t strTabOffset; // offset of the string table
+    uint32_t strTabSize;   // size of the string table in byte
+    uint32_t reserved;
+};
+
+static const uint32_t ZEINFO_BINARY_MAGIC   = 0x4942455a; // "ZEBI"
+static const uint32_t ZEINFO_BINARY_VERSION = 2;
+// alignment of the section, of its tables and of int64 fields
+static const uint32_t ZEINFO_BINARY_ALIGNMENT = 8;
+
+inline uint32_t alignZEInfoBinary(uint32_t offset)
+{
+    return (offset + ZEINFO_BINARY_ALIGNMENT - 1) & ~(ZEINFO_BINARY_ALIGNMENT - 1);
+}
+
+class ZEInfoBinaryIO;
+
+// ZEInfoBinaryTraits - specialized for every zeInfo struct in ZEInfoBinary.hpp
+template<class T>
+struct ZEInfoBinaryTraits {
+    // static void mapping(ZEInfoBinaryIO& io, T& info);
+};
+
+// the record size of T in byte
+template<class T> uint32_t getZEInfoBinaryRecordSize();
+
+/// ZEInfoBinaryIO - The interface that ZEInfoBinaryTraits::mapping uses to
+///                  visit a zeInfo struct. Implemented by the encoder, the
+///                  decoder and the schema walkers in ZEInfoBinaryTraits.cpp
+class ZEInfoBinaryIO {
+public:
+    virtual ~ZEInfoBinaryIO() {}
+
+    // true if the mapped values are read (encoding), false if they are
+    // written (decoding)
+    virtual bool outputting() const = 0;
+
+    virtual void map(const char* name, zeinfo_int32_t& val) = 0;
+    virtual void map(const char* name, zeinfo_int64_t& val) = 0;
+    virtual void map(const char* name, zeinfo_bool_t& val) = 0;
+    virtual void map(const char* name, zeinfo_str_t& val) = 0;
+
+    // nested struct, inlined into the current record
+    template<class T>
+    void map(const char* name, T& info) {
+        beginStruct(name);
+        ZEInfoBinaryTraits<T>::mapping(*this, info);
+        endStruct();
+    }
+
+    template<class T>
+    void map(const char* name, std::vector<T>& seq) {
+        uint32_t count = beginSequence(
+            name, (uint32_t)seq.size(), getZEInfoBinaryRecordSize<T>());
+        if (!outputting())
+            seq.resize(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            beginElement(i);
+            map(name, seq[i]);
+        }
+        endSequence();
+    }
+
+protected:
+    virtual void beginStruct(const char* name) {}
+    virtual void endStruct() {}
+    // return the number of elements to map
+    virtual uint32_t beginSequence(
+        const char* name, uint32_t count, uint32_t recordSize) = 0;
+    virtual void beginElement(uint32_t index) = 0;
+    virtual void endSequence() = 0;
+};
+
+/// ZEInfoBinaryRecordSizer - compute the record size of a zeInfo struct
+class ZEInfoBinaryRecordSizer : public ZEInfoBinaryIO {
+public:
+    bool outputting() const override { return false; }
+
+    void map(const char* name, zeinfo_int32_t& val) override { m_Size += 4; }
+    void map(const char* name, zeinfo_int64_t& val) override {
+        m_Size = alignZEInfoBinary(m_Size) + 8;
+    }
+    void map(const char* name, zeinfo_bool_t& val) override  { m_Size += 4; }
+    void map(const char* name, zeinfo_str_t& val) override   { m_Size += 8; }
+    using ZEInfoBinaryIO::map;
+
+    uint32_t getSize() const { return alignZEInfoBinary(m_Size); }
+
+protected:
+    uint32_t beginSequence(const char* name, uint32_t count, uint32_t recordSize) override {
+        // only the slot is part of the record, the elements are not
+        m_Size += 8;
+        return 0;
+    }
+    void beginElement(uint32_t index) override {}
+    void endSequence() override {}
+
+private:
+    uint32_t m_Size = 0;
+};
+
+template<class T> uint32_t getZEInfoBinaryRecordSize()
+{
+    static const uint32_t size = [] {
+        T info;
+        ZEInfoBinaryRecordSizer sizer;
+        ZEInfoBinaryTraits<T>::mapping(sizer, info);
+        return sizer.getSize();
+    }();
+    return size;
+}
+
+// sequences of scalars have the scalar slots as their elements
+template<> inline uint32_t getZEInfoBinaryRecordSize<zeinfo_int32_t>() { return 4; }
+template<> inline uint32_t getZEInfoBinaryRecordSize<zeinfo_int64_t>() { return 8; }
+template<> inline uint32_t getZEInfoBinaryRecordSize<zeinfo_bool_t>()  { return 4; }
+template<> inline uint32_t getZEInfoBinaryRecordSize<zeinfo_str_t>()   { return 8; }
+
+// getZEInfoBinarySchemaHash - hash of the names and types of all fields of
+// all zeInfo structs. An encoder and a decoder built from different schemas
+// (for example, a field was added to the spec) have different hashes
+uint32_t getZEInfoBinarySchemaHash();
+
+// writeZEInfoBinary - encode the given zeInfo, the encoded section is
+// appended to out
+void writeZEInfoBinary(zeInfoContainer& zeInfo, std::vector<uint8_t>& out);
+
+/// ZEInfoBinaryReader - Validate and decode a .ze_info.bin section. The
+///                      section is read in place, it can be decoded as a
+///                      whole or kernel by kernel
+class ZEInfoBinaryReader {
+public:
+    // data must be live through the reader
+    ZEInfoBinaryReader(const uint8_t* data, size_t size);
+
+    // false if the header is invalid or the section is encoded with another
+    // version or schema, see getError
+    bool isValid() const { return m_Error.empty(); }
+    const std::string& getError() const { return m_Error; }
+
+    uint32_t getNumKernels() const { return m_NumKernels; }
+
+    // decode the whole section, return false on error
+    bool read(zeInfoContainer& zeInfo);
+
+    // decode the index-th kernel only, return false on error
+    bool readKernel(uint32_t index, zeInfoKernel& kernel);
+
+private:
+    const uint8_t* m_Data;
+    size_t m_Size;
+    ZEInfoBinaryHeader m_Header;
+    // the element array of zeInfoContainer::kernels
+    uint32_t m_NumKernels = 0;
+    uint32_t m_KernelsOffset = 0;
+    std::string m_Error;
+};
+
+} // namespace zebin
+
+#endif // ZE_INFO_BINARY_TRAITS_HPP
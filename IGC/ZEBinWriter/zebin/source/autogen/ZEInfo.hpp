@@ -101,11 +101,17 @@ struct zeInfoExperimentalProperties
     zeinfo_int32_t has_non_kernel_arg_store = -1;
     zeinfo_int32_t has_non_kernel_arg_atomic = -1;
 };
+struct zeInfoSpecializedArgument
+{
+    zeinfo_int32_t arg_index = 0;
+    zeinfo_int64_t value = 0;
+};
 typedef std::vector<zeInfoPayloadArgument> PayloadArgumentsTy;
 typedef std::vector<zeInfoPerThreadPayloadArgument> PerThreadPayloadArgumentsTy;
 typedef std::vector<zeInfoBindingTableIndex> BindingTableIndicesTy;
 typedef std::vector<zeInfoPerThreadMemoryBuffer> PerThreadMemoryBuffersTy;
 typedef std::vector<zeInfoExperimentalProperties> ExperimentalPropertiesTy;
+typedef std::vector<zeInfoSpecializedArgument> SpecializedArgumentsTy;
 struct zeInfoKernel
 {
     zeinfo_str_t name;
@@ -115,6 +121,8 @@ struct zeInfoKernel
     BindingTableIndicesTy binding_table_indices;
     PerThreadMemoryBuffersTy per_thread_memory_buffers;
     ExperimentalPropertiesTy experimental_properties;
+    zeinfo_str_t specialization_of;
+    SpecializedArgumentsTy specialized_arguments;
 };
 typedef std::vector<zeInfoKernel> KernelsTy;
 struct zeInfoContainer
@@ -123,7 +131,7 @@ struct zeInfoContainer
     KernelsTy kernels;
 };
 struct PreDefinedAttrGetter{
-    static zeinfo_str_t getVersionNumber() { return "1.2"; }
+    static zeinfo_str_t getVersionNumber() { return "1.3"; }
 
     enum class ArgType {
         packed_local_ids,
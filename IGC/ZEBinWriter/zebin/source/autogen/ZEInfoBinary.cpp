@@ -0,0 +1,116 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+//===- ZEInfoBinary.cpp ---------------------------------------------*- C++ -*-===//
+// ZE Binary Utilitis
+//
+// file
+//===----------------------------------------------------------------------===//
+
+// ******************** DO NOT MODIFY DIRECTLY *********************************
+// This file is auto-generated by ZEAutoTool/fileparser.py
+
+#include <ZEInfoBinary.hpp>
+using namespace zebin;
+
+void ZEInfoBinaryTraits<zeInfoContainer>::mapping(ZEInfoBinaryIO& io, zeInfoContainer& info)
+{
+    io.map("version", info.version);
+    io.map("kernels", info.kernels);
+}
+void ZEInfoBinaryTraits<zeInfoKernel>::mapping(ZEInfoBinaryIO& io, zeInfoKernel& info)
+{
+    io.map("name", info.name);
+    io.map("execution_env", info.execution_env);
+    io.map("payload_arguments", info.payload_arguments);
+    io.map("per_thread_payload_arguments", info.per_thread_payload_arguments);
+    io.map("binding_table_indices", info.binding_table_indices);
+    io.map("per_thread_memory_buffers", info.per_thread_memory_buffers);
+    io.map("experimental_properties", info.experimental_properties);
+    io.map("specialization_of", info.specialization_of);
+    io.map("specialized_arguments", info.specialized_arguments);
+}
+void ZEInfoBinaryTraits<zeInfoExecutionEnv>::mapping(ZEInfoBinaryIO& io, zeInfoExecutionEnv& info)
+{
+    io.map("actual_kernel_start_offset", info.actual_kernel_start_offset);
+    io.map("barrier_count", info.barrier_count);
+    io.map("disable_mid_thread_preemption", info.disable_mid_thread_preemption);
+    io.map("grf_count", info.grf_count);
+    io.map("has_4gb_buffers", info.has_4gb_buffers);
+    io.map("has_device_enqueue", info.has_device_enqueue);
+    io.map("has_fence_for_image_access", info.has_fence_for_image_access);
+    io.map("has_global_atomics", info.has_global_atomics);
+    io.map("has_multi_scratch_spaces", info.has_multi_scratch_spaces);
+    io.map("has_no_stateless_write", info.has_no_stateless_write);
+    io.map("offset_to_skip_per_thread_data_load", info.offset_to_skip_per_thread_data_load);
+    io.map("offset_to_skip_set_ffid_gp", info.offset_to_skip_set_ffid_gp);
+    io.map("required_sub_group_size", info.required_sub_group_size);
+    io.map("required_work_group_size", info.required_work_group_size);
+    io.map("simd_size", info.simd_size);
+    io.map("slm_size", info.slm_size);
+    io.map("subgroup_independent_forward_progress", info.subgroup_independent_forward_progress);
+    io.map("work_group_walk_order_dimensions", info.work_group_walk_order_dimensions);
+}
+void ZEInfoBinaryTraits<zeInfoPayloadArgument>::mapping(ZEInfoBinaryIO& io, zeInfoPayloadArgument& info)
+{
+    io.map("arg_type", info.arg_type);
+    io.map("offset", info.offset);
+    io.map("size", info.size);
+    io.map("arg_index", info.arg_index);
+    io.map("addrmode", info.addrmode);
+    io.map("addrspace", info.addrspace);
+    io.map("access_type", info.access_type);
+}
+void ZEInfoBinaryTraits<zeInfoPerThreadPayloadArgument>::mapping(ZEInfoBinaryIO& io, zeInfoPerThreadPayloadArgument& info)
+{
+    io.map("arg_type", info.arg_type);
+    io.map("offset", info.offset);
+    io.map("size", info.size);
+}
+void ZEInfoBinaryTraits<zeInfoBindingTableIndex>::mapping(ZEInfoBinaryIO& io, zeInfoBindingTableIndex& info)
+{
+    io.map("bti_value", info.bti_value);
+    io.map("arg_index", info.arg_index);
+}
+void ZEInfoBinaryTraits<zeInfoPerThreadMemoryBuffer>::mapping(ZEInfoBinaryIO& io, zeInfoPerThreadMemoryBuffer& info)
+{
+    io.map("type", info.type);
+    io.map("usage", info.usage);
+    io.map("size", info.size);
+    io.map("slot", info.slot);
+    io.map("is_simt_thread", info.is_simt_thread);
+}
+void ZEInfoBinaryTraits<zeInfoExperimentalProperties>::mapping(ZEInfoBinaryIO& io, zeInfoExperimentalProperties& info)
+{
+    io.map("has_non_kernel_arg_load", info.has_non_kernel_arg_load);
+    io.map("has_non_kernel_arg_store", info.has_non_kernel_arg_store);
+    io.map("has_non_kernel_arg_atomic", info.has_non_kernel_arg_atomic);
+}
+void ZEInfoBinaryTraits<zeInfoSpecializedArgument>::mapping(ZEInfoBinaryIO& io, zeInfoSpecializedArgument& info)
+{
+    io.map("arg_index", info.arg_index);
+    io.map("value", info.value);
+}
+
@@ -0,0 +1,81 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+//===- ZEInfoBinary.hpp -----------------------------------------*- C++ -*-===//
+// ZE Binary Utilitis
+//
+// \file
+// This file declares the mapping between zeInfo structs and the binary
+// encoding of .ze_info.bin section
+//===----------------------------------------------------------------------===//
+
+// ******************** DO NOT MODIFY DIRECTLY *********************************
+// This file is auto-generated by ZEAutoTool/fileparser.py
+
+#ifndef ZE_INFO_BINARY_HPP
+#define ZE_INFO_BINARY_HPP
+
+#include <ZEInfo.hpp>
+#include <ZEInfoBinaryTraits.hpp>
+
+namespace zebin {
+    template<>
+    struct ZEInfoBinaryTraits<zeInfoContainer> {
+        static void mapping(ZEInfoBinaryIO& io, zeInfoContainer& info);
+    };
+    template<>
+    struct ZEInfoBinaryTraits<zeInfoKernel> {
+        static void mapping(ZEInfoBinaryIO& io, zeInfoKernel& info);
+    };
+    template<>
+    struct ZEInfoBinaryTraits<zeInfoExecutionEnv> {
+        static void mapping(ZEInfoBinaryIO& io, zeInfoExecutionEnv& info);
+    };
+    template<>
+    struct ZEInfoBinaryTraits<zeInfoPayloadArgument> {
+        static void mapping(ZEInfoBinaryIO& io, zeInfoPayloadArgument& info);
+    };
+    template<>
+    struct ZEInfoBinaryTraits<zeInfoPerThreadPayloadArgument> {
+        static void mapping(ZEInfoBinaryIO& io, zeInfoPerThreadPayloadArgument& info);
+    };
+    template<>
+    struct ZEInfoBinaryTraits<zeInfoBindingTableIndex> {
+        static void mapping(ZEInfoBinaryIO& io, zeInfoBindingTableIndex& info);
+    };
+    template<>
+    struct ZEInfoBinaryTraits<zeInfoPerThreadMemoryBuffer> {
+        static void mapping(ZEInfoBinaryIO& io, zeInfoPerThreadMemoryBuffer& info);
+    };
+    template<>
+    struct ZEInfoBinaryTraits<zeInfoExperimentalProperties> {
+        static void mapping(ZEInfoBinaryIO& io, zeInfoExperimentalProperties& info);
+    };
+    template<>
+    struct ZEInfoBinaryTraits<zeInfoSpecializedArgument> {
+        static void mapping(ZEInfoBinaryIO& io, zeInfoSpecializedArgument& info);
+    };
+}
+#endif
@@ -50,6 +50,8 @@ void MappingTraits<zeInfoKernel>::mapping(IO& io, zeInfoKernel& info)
     io.mapOptional("binding_table_indices", info.binding_table_indices);
     io.mapOptional("per_thread_memory_buffers", info.per_thread_memory_buffers);
     io.mapOptional("experimental_properties", info.experimental_properties);
+    io.mapOptional("specialization_of", info.specialization_of, std::string());
+    io.mapOptional("specialized_arguments", info.specialized_arguments);
 }
 void MappingTraits<zeInfoExecutionEnv>::mapping(IO& io, zeInfoExecutionEnv& info)
 {
@@ -107,3 +109,8 @@ void MappingTraits<zeInfoExperimentalProperties>::mapping(IO& io, zeInfoExperime
     io.mapOptional("has_non_kernel_arg_store", info.has_non_kernel_arg_store, -1);
     io.mapOptional("has_non_kernel_arg_atomic", info.has_non_kernel_arg_atomic, -1);
 }
+void MappingTraits<zeInfoSpecializedArgument>::mapping(IO& io, zeInfoSpecializedArgument& info)
+{
+    io.mapRequired("arg_index", info.arg_index);
+    io.mapRequired("value", info.value);
+}
@@ -52,6 +52,7 @@ LLVM_YAML_IS_SEQUENCE_VECTOR(zebin::zeInfoPerThreadPayloadArgument)
 LLVM_YAML_IS_SEQUENCE_VECTOR(zebin::zeInfoBindingTableIndex)
 LLVM_YAML_IS_SEQUENCE_VECTOR(zebin::zeInfoPerThreadMemoryBuffer)
 LLVM_YAML_IS_SEQUENCE_VECTOR(zebin::zeInfoExperimentalProperties)
+LLVM_YAML_IS_SEQUENCE_VECTOR(zebin::zeInfoSpecializedArgument)
 namespace llvm {
     namespace yaml{
         template<>
@@ -86,6 +87,10 @@ namespace llvm {
         struct MappingTraits<zebin::zeInfoExperimentalProperties> {
             static void mapping(IO& io, zebin::zeInfoExperimentalProperties& info);
         };
+        template<>
+        struct MappingTraits<zebin::zeInfoSpecializedArgument> {
+            static void mapping(IO& io, zebin::zeInfoSpecializedArgument& info);
+        };
     }
 }
 #endif
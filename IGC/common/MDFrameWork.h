@@ -155,6 +155,12 @@ namespace IGC
     int dim2 = 0;
     };
 
+    struct SpecializedArgMD
+    {
+        int argIndex = 0;
+        uint64_t value = 0;
+    };
+
     struct FuncArgMD
     {
         int bufferLocationIndex = -1;
@@ -191,6 +197,11 @@ namespace IGC
 
         std::vector<std::string> UserAnnotations;
 
+        // Set on a kernel variant created from constant argument hints:
+        // the generic kernel's name and the argument values it assumes.
+        std::string specializationOf;
+        std::vector<SpecializedArgMD> specializedArgs;
+
         std::vector<int32_t> m_OpenCLArgAddressSpaces;
         std::vector<std::string> m_OpenCLArgAccessQualifiers;
         std::vector<std::string> m_OpenCLArgTypes;
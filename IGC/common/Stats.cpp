@@ -35,6 +35,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <llvm/Support/FormattedStream.h>
 #include <llvm/Support/raw_os_ostream.h>
 #include <llvm/Support/Debug.h>
+#include <llvm/Support/Format.h>
 #include "common/LLVMWarningsPop.hpp"
 
 #include "common/secure_string.h"
@@ -43,6 +44,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <iomanip>
 #include <sstream>
 #include <iostream>
+#include <mutex>
 #include "Probe/Assertion.h"
 
 #if GET_TIME_STATS
@@ -671,7 +673,17 @@ void TimeStats::printTime( ShaderType type, ShaderHash hash, void* context ) con
         shaderName = shaderName.substr(shaderName.find_last_of("\\") + 1, shaderName.size());
     }
 
-    pp.printTimeCSV( shaderName );
+    // DumpTimeStatsJSON on its own only asks for the JSON record
+    const char* jsonFile = IGC_GET_REGKEYSTRING(DumpTimeStatsJSON);
+    const bool dumpJSON = jsonFile && jsonFile[0] != '\0';
+    if (dumpJSON)
+    {
+        pp.printTimeJSON( jsonFile, shaderName );
+    }
+    if (!dumpJSON || IGC_IS_FLAG_ENABLED(DumpTimeStats))
+    {
+        pp.printTimeCSV( shaderName );
+    }
 
     // Skip printing PerPass info to CSV for now
     //pp.printPerPassTimeCSV( shaderName );
@@ -1107,6 +1119,61 @@ void TimeStats::printTimeCSV( std::string const& corpusName ) const
 
 }
 
+void TimeStats::printTimeJSON( llvm::raw_ostream& OS, std::string const& shaderName ) const
+{
+    if (!m_isPostProcessed)
+    {
+        postProcess().printTimeJSON( OS, shaderName );
+        return;
+    }
+
+    OS << "{\"shader\":\"";
+    for (char c : shaderName)
+    {
+        // JSON does not allow raw control characters inside strings
+        if (c == '"' || c == '\\')
+            OS << '\\' << c;
+        else if ((unsigned char)c < 0x20)
+            OS << llvm::format("\\u%04x", (unsigned char)c);
+        else
+            OS << c;
+    }
+    OS << "\",\"timers\":{";
+    bool first = true;
+    for (int i = 0; i < MAX_COMPILE_TIME_INTERVALS; i++)
+    {
+        const COMPILE_TIME_INTERVALS interval = static_cast<COMPILE_TIME_INTERVALS>(i);
+        if (getCompileHit(interval) == 0 && getCompileTime(interval) == 0)
+            continue;
+        OS << (first ? "" : ",") << "\"" << g_cCompTimeIntervals[i] << "\":{\"ms\":"
+            << llvm::format("%.6f", getCompileTimeMS(interval))
+            << ",\"hits\":" << getCompileHit(interval) << "}";
+        first = false;
+    }
+    OS << "}}\n";
+}
+
+void TimeStats::printTimeJSON( const char* fileName, std::string const& shaderName ) const
+{
+    IGC_ASSERT_MESSAGE(m_isPostProcessed, "Print functions should only be called on a Post-Processed TimeStats object");
+
+    // One self-contained object per line so that concurrent compiles and
+    // consumers reading the file while it grows never see partial records.
+    std::string line;
+    llvm::raw_string_ostream OS(line);
+    printTimeJSON( OS, shaderName );
+    OS.flush();
+
+    static std::mutex fileMutex;
+    std::lock_guard<std::mutex> lock(fileMutex);
+    FILE* fp = fopen(fileName, "a");
+    if (fp)
+    {
+        fwrite(line.data(), 1, line.size(), fp);
+        fclose(fp);
+    }
+}
+
 void TimeStats::printPerPassTimeCSV(std::string const& corpusName) const
 {
     IGC_ASSERT_MESSAGE(m_isPostProcessed, "Print functions should only be called on a Post-Processed TimeStats object");
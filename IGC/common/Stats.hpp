@@ -250,6 +250,8 @@ public:
     void printSumTime() const;
     /// Print the times for all passes
     void printPerPassSumTime( llvm::raw_ostream& OS ) const;
+    /// Print the accumulated times for a single shader as one JSON line
+    void printTimeJSON( llvm::raw_ostream& OS, std::string const& shaderName ) const;
 
     /// Add other's statistics to this
     void sumWith( const TimeStats* pOther );
@@ -281,6 +283,8 @@ private:
 
     /// \deprecated Print the currently accumulated times in csv format
     void printTimeCSV( std::string const& corpusName ) const;
+    /// Append the currently accumulated times as one JSON line to fileName
+    void printTimeJSON( const char* fileName, std::string const& shaderName ) const;
     void printPerPassTimeCSV( std::string const& corpusName ) const;
     void printPerPassSumTimeCSV(const char* fileName) const;
 
@@ -25,6 +25,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 ======================= end_copyright_notice ==================================*/
 #include "common/debug/Dump.hpp"
 
+#include "common/debug/DumpSink.hpp"
 #include "common/debug/TeeOutputStream.hpp"
 
 #include "AdaptorCommon/customApi.hpp"
@@ -630,14 +631,11 @@ Dump::Dump( DumpName const& dumpName, DumpType type )
 
 Dump::~Dump()
 {
-    std::ofstream asmFile(m_name.str());
-
     // Delete the stream first to flush all data to the underlying m_string.
     delete m_pStream;
     m_pStream = nullptr;
 
-    asmFile << m_string;
-    asmFile.close();
+    DumpSink::get().write(m_name.str(), std::move(m_string), false);
 }
 
 llvm::raw_ostream& Dump::stream() const
@@ -0,0 +1,394 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+#include "common/debug/DumpSink.hpp"
+
+#include "common/debug/Debug.hpp"
+#include "common/igc_regkeys.hpp"
+
+#include "common/LLVMWarningsPush.hpp"
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/Compression.h>
+#include <llvm/Support/Error.h>
+#include "common/LLVMWarningsPop.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace IGC;
+using namespace IGC::Debug;
+
+namespace
+{
+#if defined(__linux__)
+    // Queued dumps the crash handler can still write out.  Each slot holds
+    // the already opened file, so the handler needs nothing but write(2)
+    // and close(2).  Whoever moves a slot from Ready to Writing (the writer
+    // thread, shutdown() or the handler) writes the dump.
+    struct CrashSlot
+    {
+        enum State { Free, Filling, Ready, Writing };
+        std::atomic<int> state{ Free };
+        int fd = -1;
+        const char* data = nullptr;
+        size_t size = 0;
+    };
+    static_assert(ATOMIC_INT_LOCK_FREE == 2, "the crash handler relies on lock-free atomics");
+
+    // Shared by all sinks.  A dump queued while every slot is taken is
+    // written as usual but is lost if the process crashes.
+    CrashSlot g_crashSlots[256];
+
+    const int g_crashSignals[] = { SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT };
+    struct sigaction g_prevActions[sizeof(g_crashSignals) / sizeof(g_crashSignals[0])];
+
+    void writeAll(int fd, const char* data, size_t size)
+    {
+        while (size > 0)
+        {
+            ssize_t n = ::write(fd, data, size);
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                return;
+            }
+            data += n;
+            size -= size_t(n);
+        }
+    }
+
+    void crashHandler(int sig)
+    {
+        const int savedErrno = errno;
+        for (CrashSlot& slot : g_crashSlots)
+        {
+            int expected = CrashSlot::Ready;
+            if (slot.state.compare_exchange_strong(expected, CrashSlot::Writing))
+            {
+                writeAll(slot.fd, slot.data, slot.size);
+                ::close(slot.fd);
+            }
+        }
+        errno = savedErrno;
+
+        // Leave the signal to whoever handled it before; it is delivered
+        // again once this handler returns.
+        for (size_t i = 0; i < sizeof(g_crashSignals) / sizeof(g_crashSignals[0]); i++)
+        {
+            if (g_crashSignals[i] == sig)
+                sigaction(sig, &g_prevActions[i], nullptr);
+        }
+        raise(sig);
+    }
+
+    void installCrashHandler()
+    {
+        static std::once_flag once;
+        std::call_once(once, []() {
+            struct sigaction action = {};
+            action.sa_handler = crashHandler;
+            action.sa_flags = SA_ONSTACK;
+            sigemptyset(&action.sa_mask);
+            for (size_t i = 0; i < sizeof(g_crashSignals) / sizeof(g_crashSignals[0]); i++)
+                sigaction(g_crashSignals[i], &action, &g_prevActions[i]);
+        });
+    }
+
+    // Opens path and publishes contents to the crash handler.  Returns
+    // nullptr when no slot is free or the file cannot be opened.
+    CrashSlot* acquireCrashSlot(const std::string& path, const std::string& contents)
+    {
+        for (CrashSlot& slot : g_crashSlots)
+        {
+            int expected = CrashSlot::Free;
+            if (!slot.state.compare_exchange_strong(expected, CrashSlot::Filling))
+                continue;
+            slot.fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+            if (slot.fd < 0)
+            {
+                slot.state.store(CrashSlot::Free);
+                return nullptr;
+            }
+            slot.data = contents.data();
+            slot.size = contents.size();
+            slot.state.store(CrashSlot::Ready);
+            return &slot;
+        }
+        return nullptr;
+    }
+#else
+    struct CrashSlot;
+#endif
+
+    struct PendingDump
+    {
+        std::string path;
+        std::string contents;
+        bool binary;
+        CrashSlot* slot = nullptr;
+    };
+
+    void writeFile(const PendingDump& d)
+    {
+#if defined(__linux__)
+        if (d.slot)
+        {
+            int expected = CrashSlot::Ready;
+            if (!d.slot->state.compare_exchange_strong(expected, CrashSlot::Writing))
+                return; // taken by the crash handler
+            writeAll(d.slot->fd, d.contents.data(), d.contents.size());
+            ::close(d.slot->fd);
+            d.slot->fd = -1;
+            d.slot->state.store(CrashSlot::Free);
+            return;
+        }
+#endif
+        std::ofstream file(d.path,
+            d.binary ? std::ios::out | std::ios::binary : std::ios::out);
+        file.write(d.contents.data(), d.contents.size());
+    }
+} // anonymous namespace
+
+struct DumpSink::Impl
+{
+    // configuration
+    bool   async = false;
+    bool   compress = false;
+    size_t queueLimit = 0;   // bytes
+    size_t rateLimit = 0;    // bytes per second, 0 for unlimited
+
+    std::thread             writer;
+    std::mutex              mutex;
+    std::condition_variable notEmpty; // writer waits on this
+    std::condition_variable drained;  // producers and shutdown() wait on this
+    // heap allocated so that the contents a crash slot points to stay put
+    std::deque<std::unique_ptr<PendingDump>> queue;
+    size_t                  queuedBytes = 0;
+    unsigned                inFlight = 0; // popped but not yet on disk
+    bool                    exiting = false;
+
+    // token bucket for DumpRateLimitMB
+    std::mutex rateMutex;
+    double     tokens = 0;
+    std::chrono::steady_clock::time_point lastRefill;
+    bool       reportedDrop = false;
+
+    explicit Impl(const Options& opts);
+    bool admit(size_t bytes);
+    void enqueue(std::unique_ptr<PendingDump> d);
+    void writerLoop();
+    void shutdown();
+};
+
+DumpSink::Impl::Impl(const Options& opts)
+{
+    async = opts.async;
+    compress = opts.compress && llvm::zlib::isAvailable();
+    queueLimit = size_t(std::max(1u, opts.queueMB)) << 20;
+    rateLimit = size_t(opts.rateLimitMB) << 20;
+    tokens = (double)rateLimit;
+    lastRefill = std::chrono::steady_clock::now();
+
+    if (async)
+    {
+#if defined(__linux__)
+        installCrashHandler();
+#endif
+        writer = std::thread(&Impl::writerLoop, this);
+    }
+}
+
+bool DumpSink::Impl::admit(size_t bytes)
+{
+    if (rateLimit == 0)
+        return true;
+
+    std::lock_guard<std::mutex> lock(rateMutex);
+    auto now = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(now - lastRefill).count();
+    lastRefill = now;
+    tokens = std::min((double)rateLimit, tokens + elapsed * rateLimit);
+
+    // A dump bigger than the whole budget is let through when the bucket is
+    // full (leaving it in debt); otherwise it could never be written.
+    if (tokens >= (double)std::min(bytes, rateLimit))
+    {
+        tokens -= (double)bytes;
+        return true;
+    }
+    if (!reportedDrop)
+    {
+        reportedDrop = true;
+        ods() << "IGC: DumpRateLimitMB exceeded; some shader dumps were dropped\n";
+    }
+    return false;
+}
+
+void DumpSink::Impl::enqueue(std::unique_ptr<PendingDump> d)
+{
+#if defined(__linux__)
+    d->slot = acquireCrashSlot(d->path, d->contents);
+#endif
+    const size_t bytes = d->contents.size();
+    std::unique_lock<std::mutex> lock(mutex);
+    if (exiting)
+    {
+        lock.unlock();
+        writeFile(*d);
+        return;
+    }
+    // Always accept into an empty queue so that a single dump larger than
+    // the limit cannot block forever.
+    drained.wait(lock, [&]() {
+        return queue.empty() || queuedBytes + bytes <= queueLimit;
+    });
+    queuedBytes += bytes;
+    queue.push_back(std::move(d));
+    notEmpty.notify_one();
+}
+
+void DumpSink::Impl::writerLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;)
+    {
+        notEmpty.wait(lock, [&]() { return !queue.empty() || exiting; });
+        if (queue.empty())
+            return;
+        std::unique_ptr<PendingDump> d = std::move(queue.front());
+        queue.pop_front();
+        queuedBytes -= d->contents.size();
+        ++inFlight;
+        lock.unlock();
+
+        writeFile(*d);
+        d.reset();
+
+        lock.lock();
+        --inFlight;
+        drained.notify_all();
+    }
+}
+
+// Stops the writer and writes whatever is still queued on the calling
+// thread.  Later writes go straight to disk.
+void DumpSink::Impl::shutdown()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    if (exiting)
+        return;
+    exiting = true;
+    std::deque<std::unique_ptr<PendingDump>> pending;
+    pending.swap(queue);
+    queuedBytes = 0;
+    notEmpty.notify_all();
+    drained.notify_all();
+    // Give the writer a moment to finish the file it is on.  At exit it may
+    // already have been terminated by the OS, hence the timeout.
+    drained.wait_for(lock, std::chrono::seconds(2), [&]() { return inFlight == 0; });
+    lock.unlock();
+
+    for (const auto& d : pending)
+        writeFile(*d);
+}
+
+DumpSink::DumpSink(const Options& opts) : m_pImpl(new Impl(opts))
+{
+}
+
+DumpSink::~DumpSink()
+{
+    m_pImpl->shutdown();
+    if (m_pImpl->writer.joinable())
+        m_pImpl->writer.join();
+    delete m_pImpl;
+}
+
+DumpSink& DumpSink::get()
+{
+    // The process-wide sink is leaked: joining the writer from a static
+    // destructor deadlocks when the library is unloaded on some platforms.
+    // Instead, whatever is still queued at exit is written out by the
+    // exiting thread.  Crashes are covered by the crash slots above.
+    static DumpSink* sink = []() {
+        Options opts;
+        opts.async = IGC_IS_FLAG_ENABLED(DumpAsync);
+        opts.compress = IGC_IS_FLAG_ENABLED(DumpCompress);
+        opts.queueMB = IGC_GET_FLAG_VALUE(DumpAsyncQueueMB);
+        opts.rateLimitMB = IGC_GET_FLAG_VALUE(DumpRateLimitMB);
+        DumpSink* s = new DumpSink(opts);
+        if (opts.async)
+            std::atexit([]() { DumpSink::get().m_pImpl->shutdown(); });
+        return s;
+    }();
+    return *sink;
+}
+
+std::string DumpSink::write(std::string path, std::string contents, bool binary)
+{
+    Impl& impl = *m_pImpl;
+    if (!impl.admit(contents.size()))
+        return std::string();
+
+    if (impl.compress && !contents.empty())
+    {
+        llvm::SmallVector<char, 0> compressed;
+        if (llvm::Error err = llvm::zlib::compress(contents, compressed))
+        {
+            // keep the uncompressed dump rather than losing it
+            llvm::consumeError(std::move(err));
+        }
+        else
+        {
+            contents.assign(compressed.begin(), compressed.end());
+            path += ".zlib";
+            binary = true;
+        }
+    }
+
+    if (!impl.async)
+        writeFile(PendingDump{ path, std::move(contents), binary });
+    else
+        impl.enqueue(std::unique_ptr<PendingDump>(
+            new PendingDump{ path, std::move(contents), binary }));
+    return path;
+}
@@ -0,0 +1,92 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace IGC
+{
+namespace Debug
+{
+    // Destination for shader dumps (IR, patch tokens, binaries...).
+    //
+    // By default every write goes straight to disk on the calling thread,
+    // exactly as the dump code used to do.  With DumpAsync enabled the
+    // contents are handed to a single background writer thread instead so
+    // that dumping all passes of a large shader does not serialize the
+    // compile on file I/O.  The queue is bounded (DumpAsyncQueueMB); a
+    // producer that finds it full waits for the writer rather than dropping
+    // the dump.
+    //
+    // Independently of DumpAsync:
+    //  - DumpCompress stores dumps zlib-compressed with a ".zlib" suffix
+    //    (when LLVM was built with zlib; otherwise dumps are stored as is).
+    //  - DumpRateLimitMB caps the number of dump bytes written per second;
+    //    dumps over the limit are dropped and reported once on ods().
+    //
+    // Pending writes of the process-wide sink are flushed at process exit.
+    // On Linux the file of a queued dump is opened when it is queued, and a
+    // SIGSEGV/SIGBUS/SIGILL/SIGFPE/SIGABRT handler writes out the dumps
+    // still waiting with write(2) before passing the signal on.  The dump
+    // the writer thread is on when the process crashes may be truncated.
+    class DumpSink
+    {
+    public:
+        struct Options
+        {
+            bool     async = false;
+            bool     compress = false;
+            unsigned queueMB = 256;
+            unsigned rateLimitMB = 0; // 0 for unlimited
+        };
+
+        // The process-wide sink, configured from the registry keys above.
+        // It is never destroyed.
+        static DumpSink& get();
+
+        // A separately configured sink; the destructor writes out
+        // everything still queued.
+        explicit DumpSink(const Options& opts);
+        ~DumpSink();
+
+        // Writes contents to path (replacing the file).  binary selects
+        // the stream mode, which only matters for newline translation.
+        // Returns the path actually written, which has a ".zlib" suffix
+        // when the dump was compressed, or an empty string when the rate
+        // limit dropped the dump.
+        std::string write(std::string path, std::string contents, bool binary);
+
+        DumpSink(const DumpSink&) = delete;
+        DumpSink& operator=(const DumpSink&) = delete;
+
+    private:
+        struct Impl;
+        Impl* m_pImpl;
+    };
+
+} // namespace Debug
+} // namespace IGC
@@ -921,6 +921,12 @@ void LoadRegistryKeys(const std::string& options, bool *RegFlagNameError)
             IGC::Debug::SetDebugFlag(IGC::Debug::DebugFlag::TIME_STATS_PER_SHADER, true);
         }
 
+        if (IGC_GET_REGKEYSTRING(DumpTimeStatsJSON)[0] != '\0')
+        {
+            // Per-shader records are written by the same code path as the .csv
+            IGC::Debug::SetDebugFlag(IGC::Debug::DebugFlag::TIME_STATS_PER_SHADER, true);
+        }
+
         switch (IGC_GET_FLAG_VALUE(ForceOCLSIMDWidth))
         {
         case 32:
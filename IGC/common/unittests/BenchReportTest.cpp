@@ -0,0 +1,198 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+
+// The igc_compile_bench report format and comparison, and the time stat
+// records it reads back from DumpTimeStatsJSON.
+#include "CompileBench/BenchReport.hpp"
+#include "common/Stats.hpp"
+
+#include "common/LLVMWarningsPush.hpp"
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/JSON.h>
+#include <llvm/Support/raw_ostream.h>
+#include "common/LLVMWarningsPop.hpp"
+
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+using namespace IGC::CompileBench;
+using namespace llvm;
+
+namespace {
+
+InputResult makeInput(const std::string& name, double wallMS, uint64_t codeSize)
+{
+    InputResult in;
+    in.name = name;
+    in.succeeded = true;
+    in.codeSize = codeSize;
+    for (int i = 0; i < 10; i++)
+    {
+        in.wallMS.push_back(wallMS + 0.01 * i);
+        in.timersMS["TIME_CodeGen"].push_back(wallMS / 2 + 0.01 * i);
+    }
+    return in;
+}
+
+TEST(BenchReportTest, ReadsBackWhatItWrites)
+{
+    Report report;
+    report.igcLibrary = "libigc.so";
+    report.iterations = 10;
+    report.inputs.push_back(makeInput("a/kernel.spv", 10.0, 4096));
+    InputResult failed;
+    failed.name = "b \"quoted\"\n.bc";
+    report.inputs.push_back(failed);
+
+    SmallString<128> path;
+    int fd = -1;
+    ASSERT_FALSE(sys::fs::createTemporaryFile("benchreport", "json", fd, path));
+    {
+        raw_fd_ostream OS(fd, /*shouldClose=*/true);
+        OS << toJSON(report);
+    }
+    Expected<Report> read = readReport(path);
+    sys::fs::remove(path);
+    ASSERT_TRUE(bool(read)) << toString(read.takeError());
+
+    EXPECT_EQ(read->igcLibrary, report.igcLibrary);
+    EXPECT_EQ(read->iterations, report.iterations);
+    ASSERT_EQ(read->inputs.size(), 2u);
+    EXPECT_EQ(read->inputs[0].name, "a/kernel.spv");
+    EXPECT_TRUE(read->inputs[0].succeeded);
+    EXPECT_EQ(read->inputs[0].codeSize, 4096u);
+    EXPECT_EQ(read->inputs[0].wallMS, report.inputs[0].wallMS);
+    EXPECT_EQ(read->inputs[0].timersMS, report.inputs[0].timersMS);
+    EXPECT_EQ(read->inputs[1].name, failed.name);
+    EXPECT_FALSE(read->inputs[1].succeeded);
+}
+
+TEST(BenchReportTest, RejectsOtherJSON)
+{
+    SmallString<128> path;
+    int fd = -1;
+    ASSERT_FALSE(sys::fs::createTemporaryFile("benchreport", "json", fd, path));
+    {
+        raw_fd_ostream OS(fd, /*shouldClose=*/true);
+        OS << "{\"shader\":\"x\",\"timers\":{}}";
+    }
+    Expected<Report> read = readReport(path);
+    sys::fs::remove(path);
+    EXPECT_FALSE(bool(read));
+    consumeError(read.takeError());
+}
+
+TEST(BenchReportTest, CountsRegressions)
+{
+    Report base, same, slower, bigger;
+    base.inputs = { makeInput("a", 10.0, 1000), makeInput("b", 20.0, 1000) };
+    same.inputs = base.inputs;
+    slower.inputs = { makeInput("a", 12.0, 1000), makeInput("b", 18.0, 1000) };
+    bigger.inputs = { makeInput("a", 10.0, 1100), makeInput("b", 20.0, 1000) };
+
+    std::string out;
+    raw_string_ostream OS(out);
+    EXPECT_EQ(compareReports(base, same, CompareOptions(), OS), 0u);
+    // b got faster, which is not a regression
+    EXPECT_EQ(compareReports(base, slower, CompareOptions(), OS), 1u);
+    EXPECT_EQ(compareReports(base, bigger, CompareOptions(), OS), 1u);
+
+    // a change below the threshold is not reported however significant
+    CompareOptions loose;
+    loose.thresholdPct = 25.0;
+    EXPECT_EQ(compareReports(base, slower, loose, OS), 0u);
+
+    // an input that stops compiling is a regression
+    Report broken = base;
+    broken.inputs[1].succeeded = false;
+    EXPECT_EQ(compareReports(base, broken, CompareOptions(), OS), 1u);
+    EXPECT_EQ(compareReports(broken, base, CompareOptions(), OS), 0u);
+
+    out.clear();
+    compareReports(base, slower, CompareOptions(), OS);
+    Expected<json::Value> result = json::parse(OS.str());
+    ASSERT_TRUE(bool(result)) << toString(result.takeError());
+    const json::Object* summary = result->getAsObject()->getObject("summary");
+    ASSERT_NE(summary, nullptr);
+    const json::Array* regressions = summary->getArray("regressions");
+    ASSERT_NE(regressions, nullptr);
+    ASSERT_EQ(regressions->size(), 1u);
+    EXPECT_EQ((*regressions)[0].getAsString(), StringRef("a"));
+}
+
+TEST(BenchReportTest, MedianAndRankTest)
+{
+    EXPECT_EQ(median({}), 0.0);
+    EXPECT_EQ(median({ 3, 1, 2 }), 2.0);
+    EXPECT_EQ(median({ 4, 1, 3, 2 }), 2.5);
+
+    std::vector<double> a, b;
+    for (int i = 0; i < 10; i++)
+    {
+        a.push_back(10.0 + i);
+        b.push_back(30.0 + i);
+    }
+    EXPECT_LT(mannWhitneyP(a, b), 0.001);
+    EXPECT_NEAR(mannWhitneyP(a, a), 1.0, 1e-9);
+    EXPECT_EQ(mannWhitneyP(a, {}), 1.0);
+    // all samples tied
+    EXPECT_EQ(mannWhitneyP({ 1, 1, 1 }, { 1, 1 }), 1.0);
+}
+
+TEST(BenchReportTest, TimeStatsRecordIsValidJSON)
+{
+    TimeStats stats;
+    stats.recordTimerStart(TIME_TOTAL);
+    stats.recordTimerEnd(TIME_TOTAL);
+
+    std::string name = "OCL_asm\"0\\1\n\t";
+    for (char c = 1; c < 0x20; c++)
+        name += c;
+    std::string line;
+    raw_string_ostream OS(line);
+    stats.printTimeJSON(OS, name);
+    OS.flush();
+
+    ASSERT_FALSE(line.empty());
+    EXPECT_EQ(line.back(), '\n');
+    EXPECT_EQ(line.find('\n'), line.size() - 1);
+    Expected<json::Value> record = json::parse(line);
+    ASSERT_TRUE(bool(record)) << toString(record.takeError());
+    const json::Object* obj = record->getAsObject();
+    ASSERT_NE(obj, nullptr);
+    EXPECT_EQ(obj->getString("shader"), StringRef(name));
+    const json::Object* timers = obj->getObject("timers");
+    ASSERT_NE(timers, nullptr);
+    const json::Object* total = timers->getObject("Total");
+    ASSERT_NE(total, nullptr);
+    EXPECT_EQ(total->getInteger("hits").getValueOr(0), 1);
+    EXPECT_TRUE(total->getNumber("ms").hasValue());
+}
+
+} // namespace
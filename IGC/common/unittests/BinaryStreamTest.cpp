@@ -0,0 +1,235 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+
+// Util::BinaryStream against a std::string model under random sequences of
+// writes, chaining, patching and padding, and a benchmark of the patch token
+// program assembly path (run with --gtest_also_run_disabled_tests).
+#include "AdaptorOCL/OCL/util/BinaryStream.h"
+
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace Util;
+
+namespace {
+
+// A stream and the bytes it must hold.
+struct Modeled
+{
+    Modeled() : stream(new BinaryStream) {}
+
+    std::unique_ptr<BinaryStream> stream;
+    std::string model;
+};
+
+std::string randomBytes(std::mt19937& rng, size_t n)
+{
+    std::string s(n, '\0');
+    for (auto& c : s)
+        c = (char)(rng() & 0xff);
+    return s;
+}
+
+void expectContents(Modeled& m, const char* what)
+{
+    ASSERT_EQ(m.stream->Size(), (std::streamsize)m.model.size()) << what;
+    std::vector<char> copy(m.model.size() + 1, '\x5a');
+    ASSERT_TRUE(m.stream->CopyTo(copy.data(), (std::streamsize)copy.size()));
+    EXPECT_EQ(std::string(copy.data(), m.model.size()), m.model) << what;
+    // CopyTo writes Size() bytes and no more
+    EXPECT_EQ(copy.back(), '\x5a') << what;
+    if (!m.model.empty())
+    {
+        char small = '\x5a';
+        EXPECT_FALSE(m.stream->CopyTo(&small, m.stream->Size() - 1)) << what;
+    }
+}
+
+TEST(BinaryStreamTest, MatchesStringModel)
+{
+    std::mt19937 rng(20201019);
+    for (int run = 0; run < 20; ++run)
+    {
+        // the stream under test and a few it chains from, which keep
+        // changing after they have been written
+        Modeled dst;
+        std::vector<Modeled> srcs(3);
+
+        for (int step = 0; step < 300; ++step)
+        {
+            Modeled& m = (rng() % 4 == 0) ? srcs[rng() % srcs.size()] : dst;
+            // mostly small writes, some over the chaining threshold
+            size_t n = (rng() % 8 == 0) ? 1024 + rng() % 4096 : rng() % 300;
+
+            switch (rng() % 10)
+            {
+            case 0:
+            case 1:
+            {
+                std::string bytes = randomBytes(rng, n);
+                ASSERT_TRUE(m.stream->Write(bytes.data(), (std::streamsize)bytes.size()));
+                m.model += bytes;
+                break;
+            }
+            case 2:
+            {
+                uint32_t value = rng();
+                ASSERT_TRUE(m.stream->Write(value));
+                m.model.append((const char*)&value, sizeof(value));
+                break;
+            }
+            case 3:
+            {
+                Modeled& src = (rng() % 5 == 0) ? m : srcs[rng() % srcs.size()];
+                std::string bytes = src.model;
+                ASSERT_TRUE(m.stream->Write(*src.stream));
+                m.model += bytes;
+                break;
+            }
+            case 4:
+            {
+                if (m.model.empty())
+                    break;
+                size_t loc = rng() % m.model.size();
+                size_t len = 1 + rng() % (m.model.size() - loc);
+                std::string bytes = randomBytes(rng, len);
+                ASSERT_TRUE(m.stream->WriteAt(bytes.data(), (std::streamsize)len, (std::streamsize)loc));
+                m.model.replace(loc, len, bytes);
+                // past the end
+                EXPECT_FALSE(m.stream->WriteAt(bytes.data(), (std::streamsize)len + 1,
+                    (std::streamsize)(m.model.size() - len)));
+                break;
+            }
+            case 5:
+            {
+                std::streamsize alignment = (std::streamsize)1 << (rng() % 7);
+                ASSERT_TRUE(m.stream->Align(alignment));
+                m.model.resize((m.model.size() + alignment - 1) / alignment * alignment, '\0');
+                break;
+            }
+            case 6:
+            {
+                ASSERT_TRUE(m.stream->AddPadding((std::streamsize)(n % 64)));
+                m.model.append(n % 64, '\0');
+                break;
+            }
+            case 7:
+            {
+                m.stream->Reserve((std::streamsize)(m.model.size() + n));
+                std::string bytes = randomBytes(rng, n);
+                if (n > 0)
+                    memcpy(m.stream->Append((std::streamsize)n), bytes.data(), n);
+                m.model += bytes;
+                break;
+            }
+            case 8:
+            {
+                const char* p = m.stream->GetLinearPointer();
+                ASSERT_EQ(std::string(p, m.model.size()), m.model);
+                break;
+            }
+            case 9:
+            {
+                if (&m != &dst && rng() % 4 == 0)
+                {
+                    // start a source over; what was chained from it stays
+                    m.stream.reset(new BinaryStream);
+                    m.model.clear();
+                }
+                break;
+            }
+            }
+        }
+
+        expectContents(dst, "destination");
+        for (auto& src : srcs)
+            expectContents(src, "source");
+    }
+}
+
+TEST(BinaryStreamTest, RejectsBadArguments)
+{
+    BinaryStream s;
+    EXPECT_FALSE(s.Write("x", -1));
+    EXPECT_FALSE(s.AddPadding(-1));
+    EXPECT_TRUE(s.Write("abcd", 4));
+    EXPECT_FALSE(s.WriteAt("x", 1, -1));
+    EXPECT_FALSE(s.WriteAt("x", -1, 0));
+    EXPECT_FALSE(s.WriteAt("xy", 2, 3));
+    // a patch that ends exactly at the end
+    EXPECT_TRUE(s.WriteAt("xy", 2, 2));
+    EXPECT_EQ(std::string(s.GetLinearPointer(), 4), "abxy");
+}
+
+// Mimics the OpenCL program assembly: every kernel stream gets a header, its
+// ISA, a patch list and a surface state heap, is aligned, and is written
+// into the program stream, which the driver then copies out.
+TEST(BinaryStreamTest, DISABLED_ProgramAssemblyBenchmark)
+{
+    const size_t isaSize = 64 * 1024;
+    std::vector<char> isa(isaSize, '\x7f');
+    std::vector<char> ssh(4096, '\0');
+
+    for (unsigned numKernels : { 100u, 500u })
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        BinaryStream program;
+        for (unsigned k = 0; k < numKernels; ++k)
+        {
+            BinaryStream kernel;
+            char header[72] = {};
+            kernel.Write(header, sizeof(header));
+            kernel.Reserve(kernel.Size() + (std::streamsize)isaSize + 128);
+            kernel.Write(isa.data(), (std::streamsize)isa.size());
+            kernel.Align(64);
+            for (unsigned token = 0; token < 200; ++token)
+            {
+                uint32_t patch[4] = { token, 16, k, token * 4 };
+                kernel.Write(patch);
+            }
+            kernel.Write(ssh.data(), (std::streamsize)ssh.size());
+            kernel.WriteAt((uint32_t)kernel.Size(), 4);
+            program.Write(kernel);
+        }
+        std::vector<char> out((size_t)program.Size());
+        ASSERT_TRUE(program.CopyTo(out.data(), (std::streamsize)out.size()));
+
+        double ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+        printf("%u kernels: %zu bytes in %.2f ms\n", numKernels, out.size(), ms);
+    }
+}
+
+} // namespace
@@ -0,0 +1,196 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+
+// Parsing of block profiles and lookup of the counts of a function (see
+// BlockProfile.hpp).
+#include "Compiler/CISACodeGen/BlockProfile.hpp"
+
+#include "common/LLVMWarningsPush.hpp"
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/AsmParser/Parser.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/SourceMgr.h>
+#include "common/LLVMWarningsPop.hpp"
+
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <string>
+
+using namespace IGC;
+using namespace llvm;
+
+namespace {
+
+class BlockProfileTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        SMDiagnostic Err;
+        M = parseAssemblyString(
+            "define void @f(i1 %c) {\n"
+            "entry:\n"
+            "  br i1 %c, label %a, label %b\n"
+            "a:\n"
+            "  br label %exit\n"
+            "b:\n"
+            "  br label %exit\n"
+            "exit:\n"
+            "  ret void\n"
+            "}\n"
+            "define void @g() {\n"
+            "entry:\n"
+            "  ret void\n"
+            "}\n", Err, C);
+        ASSERT_TRUE(M);
+        F = M->getFunction("f");
+        G = M->getFunction("g");
+        assignProfileBlockIds(*F);
+        assignProfileBlockIds(*G);
+    }
+
+    // "func <name> <checksum>" for the current CFG of \p Fn
+    static std::string func(const Function& Fn)
+    {
+        return "func " + Fn.getName().str() + " " +
+            utohexstr(getProfileChecksum(Fn)) + "\n";
+    }
+
+    std::string parse(const std::string& Text)
+    {
+        std::string Error;
+        bool Parsed = Profile.parse(Text, Error);
+        EXPECT_EQ(Parsed, Error.empty());
+        return Error;
+    }
+
+    LLVMContext C;
+    std::unique_ptr<Module> M;
+    Function* F = nullptr;
+    Function* G = nullptr;
+    BlockProfile Profile;
+};
+
+TEST_F(BlockProfileTest, LooksUpCountsByHashAndName)
+{
+    EXPECT_EQ(parse("# comment\n"
+                    "\n"
+                    "kernel 0x1f k   # trailing comment\n" + func(*F) +
+                    "0 10\n"
+                    "1 7\n"
+                    "3 10\n"
+                    "kernel 2 other\n" + func(*F) +
+                    "2 5\n"), "");
+
+    const BlockProfile::FunctionCounts* Counts = Profile.lookup(0x1f, *F);
+    ASSERT_NE(Counts, nullptr);
+    EXPECT_EQ(Counts->counts.size(), 3u);
+    EXPECT_EQ(Counts->counts.lookup(0), 10u);
+    EXPECT_EQ(Counts->counts.lookup(1), 7u);
+    EXPECT_EQ(Counts->counts.count(2), 0u);
+    EXPECT_EQ(Counts->counts.lookup(3), 10u);
+
+    Counts = Profile.lookup(2, *F);
+    ASSERT_NE(Counts, nullptr);
+    EXPECT_EQ(Counts->counts.lookup(2), 5u);
+
+    EXPECT_EQ(Profile.lookup(3, *F), nullptr);
+    EXPECT_EQ(Profile.lookup(0x1f, *G), nullptr);
+
+    uint64_t Entry = 0;
+    EXPECT_TRUE(Profile.getEntryCount(0x1f, "f", Entry));
+    EXPECT_EQ(Entry, 10u);
+    EXPECT_FALSE(Profile.getEntryCount(2, "f", Entry));
+    EXPECT_FALSE(Profile.getEntryCount(0x1f, "g", Entry));
+}
+
+TEST_F(BlockProfileTest, MergesFunctionAcrossKernels)
+{
+    EXPECT_EQ(parse("kernel 1 k1\n" + func(*F) + func(*G) +
+                    "0 3\n"
+                    "kernel 1 k2\n" + func(*F) +
+                    "0 2\n"
+                    "2 4\n" + func(*G) +
+                    "0 5\n"), "");
+
+    const BlockProfile::FunctionCounts* Counts = Profile.lookup(1, *F);
+    ASSERT_NE(Counts, nullptr);
+    EXPECT_EQ(Counts->counts.lookup(0), 2u);
+    EXPECT_EQ(Counts->counts.lookup(2), 4u);
+
+    uint64_t Entry = 0;
+    EXPECT_TRUE(Profile.getEntryCount(1, "g", Entry));
+    EXPECT_EQ(Entry, 8u);
+}
+
+TEST_F(BlockProfileTest, IgnoresStaleCounts)
+{
+    EXPECT_EQ(parse("kernel 1 k1\n"
+                    "func f 1234\n"
+                    "0 3\n"), "");
+    EXPECT_EQ(Profile.lookup(1, *F), nullptr);
+
+    // Counts of a kernel that disagrees with the first checksum seen for the
+    // function are dropped rather than merged.
+    EXPECT_EQ(parse("kernel 1 k1\n" + func(*F) +
+                    "0 3\n"
+                    "kernel 1 k2\n"
+                    "func f 1234\n"
+                    "0 100\n"), "");
+    const BlockProfile::FunctionCounts* Counts = Profile.lookup(1, *F);
+    ASSERT_NE(Counts, nullptr);
+    EXPECT_EQ(Counts->counts.lookup(0), 3u);
+
+    // A CFG change after the profile was taken invalidates it.
+    BasicBlock* A = &*std::next(F->begin());
+    BasicBlock* B = &*std::next(F->begin(), 2);
+    F->getEntryBlock().getTerminator()->setSuccessor(0, B);
+    F->getEntryBlock().getTerminator()->setSuccessor(1, A);
+    EXPECT_EQ(Profile.lookup(1, *F), nullptr);
+}
+
+TEST_F(BlockProfileTest, RejectsMalformedLines)
+{
+    const std::string Kernel = "kernel 1 k\n" + func(*F);
+    EXPECT_EQ(parse("kernel 1\n"), "line 1: expected 'kernel <hash> <name>'");
+    EXPECT_EQ(parse("kernel xyz k\n"), "line 1: expected 'kernel <hash> <name>'");
+    EXPECT_EQ(parse("kernel 1 k\nfunc f\n"), "line 2: expected 'func <name> <checksum>'");
+    EXPECT_EQ(parse("kernel 1 k\nfunc f 0x\n"), "line 2: expected 'func <name> <checksum>'");
+    EXPECT_EQ(parse("func f 1\n"), "line 1: 'func' outside of a kernel");
+    EXPECT_EQ(parse("kernel 1 k\n0 1\n"), "line 2: block count outside of a function");
+    EXPECT_EQ(parse(Kernel + "0\n"), "line 3: expected '<block id> <count>'");
+    EXPECT_EQ(parse(Kernel + "0 1 2\n"), "line 3: expected '<block id> <count>'");
+    EXPECT_EQ(parse(Kernel + "a 1\n"), "line 3: expected '<block id> <count>'");
+    EXPECT_EQ(parse(Kernel + "0 -1\n"), "line 3: expected '<block id> <count>'");
+
+    // A bad line discards what was parsed before it.
+    EXPECT_NE(parse(Kernel + "0 1\nbogus\n"), "");
+    EXPECT_EQ(Profile.lookup(1, *F), nullptr);
+}
+
+} // namespace
@@ -0,0 +1,190 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+
+// DWARF emission of several kernels on the DebugInfoEmitThreads worker pool
+// gives the same binary as emitting them one after another.
+#include "AdaptorOCL/TranslationBlock.h"
+#include "AdaptorOCL/GlobalData.h"
+#include "common/igc_regkeys.hpp"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace TC;
+
+namespace {
+
+const char KernelText[] =
+    "target datalayout = \"e-i64:64-v16:16-v24:32-v32:32-v48:64-v96:128-v192:256-v256:256-v512:512-v1024:1024\"\n"
+    "target triple = \"spir64-unknown-unknown\"\n"
+    "\n"
+    "define spir_kernel void @scale(float addrspace(1)* %out, float addrspace(1)* %in) "
+    "!kernel_arg_addr_space !1 !kernel_arg_access_qual !2 !kernel_arg_type !3 "
+    "!kernel_arg_base_type !3 !kernel_arg_type_qual !4 !dbg !10 {\n"
+    "entry:\n"
+    "  %id = call spir_func i64 @_Z13get_global_idj(i32 0), !dbg !13\n"
+    "  %src = getelementptr inbounds float, float addrspace(1)* %in, i64 %id, !dbg !14\n"
+    "  %v = load float, float addrspace(1)* %src, align 4, !dbg !14\n"
+    "  %r = fmul float %v, 2.0, !dbg !14\n"
+    "  %dst = getelementptr inbounds float, float addrspace(1)* %out, i64 %id, !dbg !14\n"
+    "  store float %r, float addrspace(1)* %dst, align 4, !dbg !14\n"
+    "  ret void, !dbg !15\n"
+    "}\n"
+    "\n"
+    "define spir_kernel void @offset(float addrspace(1)* %out, float addrspace(1)* %in) "
+    "!kernel_arg_addr_space !1 !kernel_arg_access_qual !2 !kernel_arg_type !3 "
+    "!kernel_arg_base_type !3 !kernel_arg_type_qual !4 !dbg !20 {\n"
+    "entry:\n"
+    "  %id = call spir_func i64 @_Z13get_global_idj(i32 0), !dbg !21\n"
+    "  %src = getelementptr inbounds float, float addrspace(1)* %in, i64 %id, !dbg !22\n"
+    "  %v = load float, float addrspace(1)* %src, align 4, !dbg !22\n"
+    "  %r = fadd float %v, 1.0, !dbg !22\n"
+    "  %dst = getelementptr inbounds float, float addrspace(1)* %out, i64 %id, !dbg !22\n"
+    "  store float %r, float addrspace(1)* %dst, align 4, !dbg !22\n"
+    "  ret void, !dbg !23\n"
+    "}\n"
+    "\n"
+    "declare spir_func i64 @_Z13get_global_idj(i32)\n"
+    "\n"
+    "!llvm.dbg.cu = !{!5}\n"
+    "!llvm.module.flags = !{!8}\n"
+    "!opencl.spir.version = !{!0}\n"
+    "!opencl.ocl.version = !{!0}\n"
+    "!0 = !{i32 1, i32 2}\n"
+    "!1 = !{i32 1, i32 1}\n"
+    "!2 = !{!\"none\", !\"none\"}\n"
+    "!3 = !{!\"float*\", !\"float*\"}\n"
+    "!4 = !{!\"\", !\"\"}\n"
+    "!5 = distinct !DICompileUnit(language: DW_LANG_C99, file: !6, producer: \"clang\", "
+    "isOptimized: false, runtimeVersion: 0, emissionKind: FullDebug, enums: !7)\n"
+    "!6 = !DIFile(filename: \"kernels.cl\", directory: \"/\")\n"
+    "!7 = !{}\n"
+    "!8 = !{i32 2, !\"Debug Info Version\", i32 3}\n"
+    "!9 = !DISubroutineType(types: !7)\n"
+    "!10 = distinct !DISubprogram(name: \"scale\", scope: !6, file: !6, line: 1, type: !9, "
+    "isLocal: false, isDefinition: true, scopeLine: 2, isOptimized: false, unit: !5, retainedNodes: !7)\n"
+    "!13 = !DILocation(line: 3, column: 14, scope: !10)\n"
+    "!14 = !DILocation(line: 4, column: 13, scope: !10)\n"
+    "!15 = !DILocation(line: 5, column: 1, scope: !10)\n"
+    "!20 = distinct !DISubprogram(name: \"offset\", scope: !6, file: !6, line: 7, type: !9, "
+    "isLocal: false, isDefinition: true, scopeLine: 8, isOptimized: false, unit: !5, retainedNodes: !7)\n"
+    "!21 = !DILocation(line: 9, column: 14, scope: !20)\n"
+    "!22 = !DILocation(line: 10, column: 13, scope: !20)\n"
+    "!23 = !DILocation(line: 11, column: 1, scope: !20)\n";
+
+class DebugTranslation
+{
+public:
+    DebugTranslation()
+    {
+        m_Platform.eProductFamily = IGFX_SKYLAKE;
+        m_Platform.eRenderCoreFamily = IGFX_GEN9_CORE;
+        m_Platform.usDeviceID = 0x1912;
+        m_SysInfo.EUCount = 24;
+        m_SysInfo.ThreadCount = 24 * 7;
+        m_SysInfo.SliceCount = 1;
+        m_SysInfo.SubSliceCount = 3;
+        m_SysInfo.MaxEuPerSubSlice = 8;
+
+        m_GlobalData.pPlatform = &m_Platform;
+        m_GlobalData.pSkuTable = &m_SkuTable;
+        m_GlobalData.pWaTable = &m_WaTable;
+        m_GlobalData.pSysInfo = &m_SysInfo;
+
+        STB_CreateArgs createArgs;
+        createArgs.TranslationCode.Type.Input = TB_DATA_FORMAT_LLVM_TEXT;
+        createArgs.TranslationCode.Type.Output = TB_DATA_FORMAT_DEVICE_BINARY;
+        createArgs.pCreateData = &m_GlobalData;
+        m_Block = Create(&createArgs);
+    }
+
+    ~DebugTranslation()
+    {
+        if (m_Block)
+        {
+            Delete(m_Block);
+        }
+    }
+
+    bool valid() const { return m_Block != nullptr; }
+
+    // Returns the binary, or an empty vector if the translation failed.
+    std::vector<char> translate(const char* options)
+    {
+        std::string input = KernelText;
+        STB_TranslateInputArgs args;
+        args.pInput = const_cast<char*>(input.data());
+        args.InputSize = (uint32_t)input.size();
+        args.pOptions = options;
+        args.OptionsSize = (uint32_t)std::char_traits<char>::length(options);
+        STB_TranslateOutputArgs output;
+        std::vector<char> binary;
+        if (m_Block->Translate(&args, &output))
+        {
+            binary.assign(output.pOutput, output.pOutput + output.OutputSize);
+        }
+        m_Block->FreeAllocations(&output);
+        return binary;
+    }
+
+private:
+    PLATFORM m_Platform = {};
+    SKU_FEATURE_TABLE m_SkuTable = {};
+    WA_TABLE m_WaTable = {};
+    GT_SYSTEM_INFO m_SysInfo = {};
+    SGlobalData m_GlobalData = {};
+    CTranslationBlock* m_Block = nullptr;
+};
+
+TEST(DebugInfoEmitTest, ThreadedMatchesSerial)
+{
+#if defined(IGC_DEBUG_VARIABLES)
+    DebugTranslation translation;
+    ASSERT_TRUE(translation.valid());
+
+    IGC_SET_FLAG_VALUE(DebugInfoEmitThreads, 1);
+    std::vector<char> serial = translation.translate("-g");
+    ASSERT_FALSE(serial.empty());
+    // the debug ELF names the source file
+    std::string file = "kernels.cl";
+    EXPECT_NE(std::search(serial.begin(), serial.end(), file.begin(), file.end()), serial.end());
+
+    // more threads than units, one per core, and two sharing the units
+    for (unsigned threads : { 16u, 0u, 2u })
+    {
+        IGC_SET_FLAG_VALUE(DebugInfoEmitThreads, threads);
+        EXPECT_EQ(translation.translate("-g"), serial) << threads << " threads";
+    }
+    IGC_SET_FLAG_VALUE(DebugInfoEmitThreads, 1);
+#else
+    GTEST_SKIP() << "DebugInfoEmitThreads is fixed without IGC_DEBUG_VARIABLES";
+#endif
+}
+
+} // namespace
@@ -0,0 +1,180 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+#include "common/debug/DumpSink.hpp"
+
+#include "common/LLVMWarningsPush.hpp"
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/Compression.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include "common/LLVMWarningsPop.hpp"
+
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <csignal>
+#include <cstdlib>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+using namespace IGC::Debug;
+using namespace llvm;
+
+namespace {
+
+class DumpSinkTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_FALSE(sys::fs::createUniqueDirectory("dumpsink", Dir));
+    }
+
+    void TearDown() override
+    {
+        sys::fs::remove_directories(Dir);
+    }
+
+    std::string path(StringRef Name) const
+    {
+        SmallString<128> P(Dir);
+        sys::path::append(P, Name);
+        return std::string(P.str());
+    }
+
+    static std::string read(const std::string& Path)
+    {
+        auto Buf = MemoryBuffer::getFile(Path);
+        if (!Buf)
+            return "<missing>";
+        return (*Buf)->getBuffer().str();
+    }
+
+    SmallString<128> Dir;
+};
+
+TEST_F(DumpSinkTest, WritesSynchronously)
+{
+    DumpSink::Options Opts;
+    DumpSink Sink(Opts);
+    std::string Written = Sink.write(path("a.ll"), "define void @f()", false);
+    EXPECT_EQ(Written, path("a.ll"));
+    EXPECT_EQ(read(Written), "define void @f()");
+}
+
+TEST_F(DumpSinkTest, AsyncWritesEverythingBeforeDestruction)
+{
+    DumpSink::Options Opts;
+    Opts.async = true;
+    Opts.queueMB = 1;
+    std::string Big(600 << 10, 'x'); // two of these fill the queue
+    {
+        DumpSink Sink(Opts);
+        for (unsigned i = 0; i < 8; ++i)
+            EXPECT_EQ(Sink.write(path("d" + std::to_string(i)), Big, true),
+                      path("d" + std::to_string(i)));
+    }
+    for (unsigned i = 0; i < 8; ++i)
+        EXPECT_EQ(read(path("d" + std::to_string(i))), Big);
+}
+
+TEST_F(DumpSinkTest, CompressAppendsSuffix)
+{
+    if (!zlib::isAvailable())
+        return; // dumps are stored uncompressed; nothing to check
+    DumpSink::Options Opts;
+    Opts.compress = true;
+    DumpSink Sink(Opts);
+    std::string Contents(4096, 'a');
+    std::string Written = Sink.write(path("c.ll"), Contents, false);
+    ASSERT_EQ(Written, path("c.ll") + ".zlib");
+    EXPECT_EQ(read(path("c.ll")), "<missing>");
+
+    std::string Compressed = read(Written);
+    SmallVector<char, 0> Uncompressed;
+    ASSERT_FALSE(errorToBool(
+        zlib::uncompress(Compressed, Uncompressed, Contents.size())));
+    EXPECT_EQ(std::string(Uncompressed.begin(), Uncompressed.end()), Contents);
+}
+
+TEST_F(DumpSinkTest, RateLimitDropsAndReportsNoPath)
+{
+    DumpSink::Options Opts;
+    Opts.rateLimitMB = 1;
+    DumpSink Sink(Opts);
+    std::string HalfMB(512 << 10, 'r');
+    EXPECT_EQ(Sink.write(path("r0"), HalfMB, true), path("r0"));
+    EXPECT_EQ(Sink.write(path("r1"), HalfMB, true), path("r1"));
+    // the budget for this second is used up
+    EXPECT_EQ(Sink.write(path("r2"), HalfMB, true), "");
+    EXPECT_EQ(read(path("r2")), "<missing>");
+}
+
+#if defined(__linux__)
+// Queues dumps behind one the writer cannot finish, then aborts.
+void crashWithQueuedDumps(const std::vector<std::string>& Paths)
+{
+    DumpSink::Options Opts;
+    Opts.async = true;
+    DumpSink* Sink = new DumpSink(Opts); // never destroyed, as for get()
+
+    // Nothing reads the pipe, so the writer blocks once it is full.
+    int Pipe[2];
+    if (pipe(Pipe) != 0)
+        std::_Exit(1);
+    Sink->write("/proc/self/fd/" + std::to_string(Pipe[1]),
+                std::string(1 << 20, 'p'), true);
+    int Buffered = 0;
+    while (ioctl(Pipe[0], FIONREAD, &Buffered) == 0 && Buffered < (64 << 10))
+        usleep(1000);
+
+    for (size_t i = 0; i < Paths.size(); ++i)
+        Sink->write(Paths[i], std::string(1000 + i, char('a' + i)), false);
+    std::abort();
+}
+
+TEST_F(DumpSinkTest, CrashWritesQueuedDumps)
+{
+    std::vector<std::string> Paths;
+    for (unsigned i = 0; i < 8; ++i)
+        Paths.push_back(path("q" + std::to_string(i)));
+
+    // the child must share Dir, so it is forked rather than re-executed
+    testing::FLAGS_gtest_death_test_style = "fast";
+    EXPECT_EXIT(crashWithQueuedDumps(Paths), testing::KilledBySignal(SIGABRT), "");
+    for (size_t i = 0; i < Paths.size(); ++i)
+        EXPECT_EQ(read(Paths[i]), std::string(1000 + i, char('a' + i)));
+}
+#endif
+
+} // namespace
@@ -0,0 +1,132 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+
+// -intel-kernel-arg-hints parsing and the zeInfo fields of the kernel
+// variants it produces (see KernelArgSpecialization).
+#include "Compiler/CodeGenPublic.h"
+#include "AdaptorOCL/TranslationBlock.h"
+#include <ZEInfo.hpp>
+#include <ZEInfoYAML.hpp>
+
+#include "common/LLVMWarningsPush.hpp"
+#include <llvm/Support/YAMLTraits.h>
+#include <llvm/Support/raw_ostream.h>
+#include "common/LLVMWarningsPop.hpp"
+
+#include "gtest/gtest.h"
+
+#include <string>
+
+using namespace IGC;
+
+namespace {
+
+typedef OpenCLProgramContext::InternalOptions InternalOptions;
+
+std::vector<InternalOptions::KernelArgHint> parse(const char* Options)
+{
+    TC::STB_TranslateInputArgs Args;
+    Args.pInternalOptions = Options;
+    Args.InternalOptionsSize = (uint32_t)strlen(Options);
+    return InternalOptions(&Args).KernelArgHints;
+}
+
+TEST(KernelArgHintsTest, ParsesRepeatedHints)
+{
+    auto Hints = parse("-cl-intel-kernel-arg-hints=foo:1=16,3=0x20 "
+                       "-ze-intel-kernel-arg-hints=bar:0=-1 -cl-intel-no-spill");
+    ASSERT_EQ(Hints.size(), 2u);
+    EXPECT_EQ(Hints[0].kernelName, "foo");
+    ASSERT_EQ(Hints[0].args.size(), 2u);
+    EXPECT_EQ(Hints[0].args[0], std::make_pair(1u, (uint64_t)16));
+    EXPECT_EQ(Hints[0].args[1], std::make_pair(3u, (uint64_t)0x20));
+    EXPECT_EQ(Hints[1].kernelName, "bar");
+    ASSERT_EQ(Hints[1].args.size(), 1u);
+    EXPECT_EQ(Hints[1].args[0], std::make_pair(0u, ~(uint64_t)0));
+}
+
+TEST(KernelArgHintsTest, IgnoresMalformedHints)
+{
+    EXPECT_TRUE(parse("-intel-kernel-arg-hints=foo").empty());
+    EXPECT_TRUE(parse("-intel-kernel-arg-hints=:0=1").empty());
+    EXPECT_TRUE(parse("-intel-kernel-arg-hints=foo:").empty());
+    EXPECT_TRUE(parse("-intel-kernel-arg-hints=foo:x=1").empty());
+    EXPECT_TRUE(parse("-intel-kernel-arg-hints=foo:0=").empty());
+    EXPECT_TRUE(parse("-intel-kernel-arg-hints=foo:0=1;1=2").empty());
+    // The malformed hint doesn't take the following ones with it.
+    auto Hints = parse("-intel-kernel-arg-hints=foo:0 -intel-kernel-arg-hints=bar:2=3");
+    ASSERT_EQ(Hints.size(), 1u);
+    EXPECT_EQ(Hints[0].kernelName, "bar");
+}
+
+TEST(KernelArgHintsTest, ZEInfoYAML)
+{
+    zebin::zeInfoContainer Info;
+    Info.version = "1.3";
+    zebin::zeInfoKernel Generic;
+    Generic.name = "foo";
+    Info.kernels.push_back(Generic);
+    zebin::zeInfoKernel Variant;
+    Variant.name = "foo__spec0";
+    Variant.specialization_of = "foo";
+    zebin::zeInfoSpecializedArgument Arg;
+    Arg.arg_index = 1;
+    Arg.value = 16;
+    Variant.specialized_arguments.push_back(Arg);
+    Arg.arg_index = 3;
+    Arg.value = 0xffffffff;
+    Variant.specialized_arguments.push_back(Arg);
+    Info.kernels.push_back(Variant);
+
+    std::string YAML;
+    llvm::raw_string_ostream OS(YAML);
+    llvm::yaml::Output YOut(OS);
+    YOut << Info;
+    OS.flush();
+
+    // The generic kernel carries neither field.
+    size_t VariantPos = YAML.find("foo__spec0");
+    ASSERT_NE(VariantPos, std::string::npos) << YAML;
+    EXPECT_EQ(YAML.find("specialization_of"), YAML.find("specialization_of", VariantPos)) << YAML;
+    EXPECT_NE(YAML.find("specialization_of: foo\n", VariantPos), std::string::npos) << YAML;
+
+    zebin::zeInfoContainer ReadBack;
+    llvm::yaml::Input YIn(YAML);
+    YIn >> ReadBack;
+    ASSERT_FALSE(YIn.error());
+    ASSERT_EQ(ReadBack.kernels.size(), 2u);
+    EXPECT_TRUE(ReadBack.kernels[0].specialization_of.empty());
+    EXPECT_TRUE(ReadBack.kernels[0].specialized_arguments.empty());
+    const zebin::zeInfoKernel& K = ReadBack.kernels[1];
+    EXPECT_EQ(K.specialization_of, "foo");
+    ASSERT_EQ(K.specialized_arguments.size(), 2u);
+    EXPECT_EQ(K.specialized_arguments[0].arg_index, 1);
+    EXPECT_EQ(K.specialized_arguments[0].value, 16);
+    EXPECT_EQ(K.specialized_arguments[1].arg_index, 3);
+    EXPECT_EQ(K.specialized_arguments[1].value, 0xffffffff);
+}
+
+} // namespace
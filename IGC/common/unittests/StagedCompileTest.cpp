@@ -0,0 +1,245 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+
+// The stage 1 cache of staged compilation, and a stage 1 compile followed by
+// stage 2, with and without -intel-stage2-background.
+#include "AdaptorOCL/StagedCompile.hpp"
+#include "AdaptorOCL/TranslationBlock.h"
+#include "AdaptorOCL/GlobalData.h"
+
+#include "gtest/gtest.h"
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace TC;
+
+namespace {
+
+const char KernelText[] =
+    "target datalayout = \"e-i64:64-v16:16-v24:32-v32:32-v48:64-v96:128-v192:256-v256:256-v512:512-v1024:1024\"\n"
+    "target triple = \"spir64-unknown-unknown\"\n"
+    "\n"
+    "define spir_kernel void @scale(float addrspace(1)* %out, float addrspace(1)* %in) "
+    "!kernel_arg_addr_space !1 !kernel_arg_access_qual !2 !kernel_arg_type !3 "
+    "!kernel_arg_base_type !3 !kernel_arg_type_qual !4 {\n"
+    "entry:\n"
+    "  %id = call spir_func i64 @_Z13get_global_idj(i32 0)\n"
+    "  %src = getelementptr inbounds float, float addrspace(1)* %in, i64 %id\n"
+    "  %v = load float, float addrspace(1)* %src, align 4\n"
+    "  %r = fmul float %v, 2.0\n"
+    "  %dst = getelementptr inbounds float, float addrspace(1)* %out, i64 %id\n"
+    "  store float %r, float addrspace(1)* %dst, align 4\n"
+    "  ret void\n"
+    "}\n"
+    "\n"
+    "declare spir_func i64 @_Z13get_global_idj(i32)\n"
+    "\n"
+    "!opencl.spir.version = !{!0}\n"
+    "!opencl.ocl.version = !{!0}\n"
+    "!0 = !{i32 1, i32 2}\n"
+    "!1 = !{i32 1, i32 1}\n"
+    "!2 = !{!\"none\", !\"none\"}\n"
+    "!3 = !{!\"float*\", !\"float*\"}\n"
+    "!4 = !{!\"\", !\"\"}\n";
+
+IGC::CPlatform makePlatform(PRODUCT_FAMILY family, unsigned short deviceId)
+{
+    PLATFORM platform = {};
+    platform.eProductFamily = family;
+    platform.eRenderCoreFamily = IGFX_GEN9_CORE;
+    platform.usDeviceID = deviceId;
+    return IGC::CPlatform(platform);
+}
+
+STB_TranslateInputArgs makeArgs(const std::string& input, const std::string& internalOptions)
+{
+    STB_TranslateInputArgs args;
+    args.pInput = const_cast<char*>(input.data());
+    args.InputSize = (uint32_t)input.size();
+    args.pInternalOptions = internalOptions.c_str();
+    args.InternalOptionsSize = (uint32_t)internalOptions.size();
+    return args;
+}
+
+TEST(StagedCompileTest, KeyIgnoresStagingOptions)
+{
+    std::string input = "program";
+    IGC::CPlatform platform = makePlatform(IGFX_SKYLAKE, 0x1912);
+    StagedCompileKey stage1(makeArgs(input, "-cl-intel-no-spill -intel-stage1-fast-compile"),
+        TB_DATA_FORMAT_LLVM_TEXT, platform);
+    StagedCompileKey stage2(makeArgs(input, "-intel-stage2-compile -cl-intel-no-spill"),
+        TB_DATA_FORMAT_LLVM_TEXT, platform);
+    EXPECT_TRUE(stage1 == stage2);
+    EXPECT_EQ(StagedCompileKey::Hash()(stage1), StagedCompileKey::Hash()(stage2));
+}
+
+TEST(StagedCompileTest, KeyComparesEveryInput)
+{
+    std::string input = "program";
+    IGC::CPlatform platform = makePlatform(IGFX_SKYLAKE, 0x1912);
+    StagedCompileKey base(makeArgs(input, ""), TB_DATA_FORMAT_LLVM_TEXT, platform);
+
+    EXPECT_FALSE(base == StagedCompileKey(makeArgs("programs", ""),
+        TB_DATA_FORMAT_LLVM_TEXT, platform));
+    EXPECT_FALSE(base == StagedCompileKey(makeArgs(input, "-cl-intel-no-spill"),
+        TB_DATA_FORMAT_LLVM_TEXT, platform));
+    EXPECT_FALSE(base == StagedCompileKey(makeArgs(input, ""),
+        TB_DATA_FORMAT_SPIR_V, platform));
+    EXPECT_FALSE(base == StagedCompileKey(makeArgs(input, ""),
+        TB_DATA_FORMAT_LLVM_TEXT, makePlatform(IGFX_SKYLAKE, 0x1916)));
+
+    STB_TranslateInputArgs withOptions = makeArgs(input, "");
+    withOptions.pOptions = "-cl-fast-relaxed-math";
+    withOptions.OptionsSize = (uint32_t)strlen(withOptions.pOptions);
+    EXPECT_FALSE(base == StagedCompileKey(withOptions, TB_DATA_FORMAT_LLVM_TEXT, platform));
+
+    uint32_t ids[] = { 1 };
+    uint64_t values[] = { 7 };
+    STB_TranslateInputArgs withSpec = makeArgs(input, "");
+    withSpec.pSpecConstantsIds = ids;
+    withSpec.pSpecConstantsValues = values;
+    withSpec.SpecConstantsSize = 1;
+    StagedCompileKey spec7(withSpec, TB_DATA_FORMAT_LLVM_TEXT, platform);
+    values[0] = 8;
+    StagedCompileKey spec8(withSpec, TB_DATA_FORMAT_LLVM_TEXT, platform);
+    EXPECT_FALSE(base == spec7);
+    EXPECT_FALSE(spec7 == spec8);
+}
+
+TEST(StagedCompileTest, CacheDoesNotMatchOnHashAlone)
+{
+    IGC::CPlatform platform = makePlatform(IGFX_SKYLAKE, 0x1912);
+    StagedCompileKey first(makeArgs("first", ""), TB_DATA_FORMAT_LLVM_TEXT, platform);
+    StagedCompileKey second(makeArgs("second", ""), TB_DATA_FORMAT_LLVM_TEXT, platform);
+    // force a collision
+    second.hash = first.hash;
+
+    StagedCompileCache& cache = StagedCompileCache::get();
+    auto state = std::make_shared<StagedCompileState>();
+    cache.put(first, state);
+    EXPECT_EQ(cache.take(second), nullptr);
+    EXPECT_EQ(cache.take(first), state);
+    EXPECT_EQ(cache.take(first), nullptr);
+}
+
+class StagedTranslation
+{
+public:
+    StagedTranslation()
+    {
+        m_Platform.eProductFamily = IGFX_SKYLAKE;
+        m_Platform.eRenderCoreFamily = IGFX_GEN9_CORE;
+        m_Platform.usDeviceID = 0x1912;
+        m_SysInfo.EUCount = 24;
+        m_SysInfo.ThreadCount = 24 * 7;
+        m_SysInfo.SliceCount = 1;
+        m_SysInfo.SubSliceCount = 3;
+        m_SysInfo.MaxEuPerSubSlice = 8;
+
+        m_GlobalData.pPlatform = &m_Platform;
+        m_GlobalData.pSkuTable = &m_SkuTable;
+        m_GlobalData.pWaTable = &m_WaTable;
+        m_GlobalData.pSysInfo = &m_SysInfo;
+
+        STB_CreateArgs createArgs;
+        createArgs.TranslationCode.Type.Input = TB_DATA_FORMAT_LLVM_TEXT;
+        createArgs.TranslationCode.Type.Output = TB_DATA_FORMAT_DEVICE_BINARY;
+        createArgs.pCreateData = &m_GlobalData;
+        m_Block = Create(&createArgs);
+    }
+
+    ~StagedTranslation()
+    {
+        if (m_Block)
+        {
+            Delete(m_Block);
+        }
+    }
+
+    bool valid() const { return m_Block != nullptr; }
+
+    // Returns the binary, or an empty vector if the translation failed.
+    std::vector<char> translate(const std::string& internalOptions)
+    {
+        std::string input = KernelText;
+        STB_TranslateInputArgs args = makeArgs(input, internalOptions);
+        STB_TranslateOutputArgs output;
+        std::vector<char> binary;
+        if (m_Block->Translate(&args, &output))
+        {
+            binary.assign(output.pOutput, output.pOutput + output.OutputSize);
+        }
+        m_Block->FreeAllocations(&output);
+        return binary;
+    }
+
+private:
+    PLATFORM m_Platform = {};
+    SKU_FEATURE_TABLE m_SkuTable = {};
+    WA_TABLE m_WaTable = {};
+    GT_SYSTEM_INFO m_SysInfo = {};
+    SGlobalData m_GlobalData = {};
+    CTranslationBlock* m_Block = nullptr;
+};
+
+TEST(StagedCompileTest, Stage1ThenStage2)
+{
+    StagedTranslation translation;
+    ASSERT_TRUE(translation.valid());
+
+    std::vector<char> full = translation.translate("");
+    ASSERT_FALSE(full.empty());
+
+    std::vector<char> stage1 = translation.translate("-intel-stage1-fast-compile");
+    ASSERT_FALSE(stage1.empty());
+    std::vector<char> stage2 = translation.translate("-intel-stage2-compile");
+    // stage 2 hands back the stage 1 binary when no kernel would get a
+    // wider SIMD
+    EXPECT_TRUE(stage2 == full || stage2 == stage1);
+}
+
+TEST(StagedCompileTest, Stage1ThenBackgroundStage2)
+{
+    StagedTranslation translation;
+    ASSERT_TRUE(translation.valid());
+
+    std::vector<char> full = translation.translate("");
+    ASSERT_FALSE(full.empty());
+    ASSERT_FALSE(translation.translate("-intel-stage1-fast-compile").empty());
+    std::vector<char> expected = translation.translate("-intel-stage2-compile");
+    ASSERT_FALSE(expected.empty());
+
+    ASSERT_FALSE(translation.translate(
+        "-intel-stage1-fast-compile -intel-stage2-background").empty());
+    // runs while stage 2 may still be going in the background
+    EXPECT_EQ(translation.translate(""), full);
+    EXPECT_EQ(translation.translate("-intel-stage2-compile"), expected);
+}
+
+} // namespace
@@ -7322,6 +7322,71 @@ void gtPinData::removeUnmarkedInsts()
     }
 }
 
+void gtPinData::setBlockCount(G4_Label* label, uint64_t count)
+{
+    if (!label)
+    {
+        entryCount = count;
+        hasEntryCount = true;
+    }
+    else
+    {
+        blockCounts[label] = count;
+    }
+    blockFrequencies.clear();
+}
+
+void gtPinData::computeBlockFrequencies()
+{
+    G4_BB* entryBB = kernel.fg.getEntryBB();
+    uint64_t entry = entryCount;
+    if (!hasEntryCount)
+    {
+        // the entry block may still carry a label of its own
+        auto it = entryBB->empty() || !entryBB->front()->isLabel() ?
+            blockCounts.end() : blockCounts.find(entryBB->front()->getLabel());
+        if (it == blockCounts.end())
+        {
+            return;
+        }
+        entry = it->second;
+    }
+    // a kernel that never ran tells nothing about relative hotness
+    if (entry == 0)
+    {
+        return;
+    }
+
+    uint64_t count = entry;
+    for (auto bb : kernel.fg)
+    {
+        if (bb != entryBB && !bb->empty() && bb->front()->isLabel())
+        {
+            auto it = blockCounts.find(bb->front()->getLabel());
+            if (it != blockCounts.end())
+            {
+                count = it->second;
+            }
+        }
+        blockFrequencies[bb] = (float)count / entry;
+    }
+}
+
+bool gtPinData::getBlockFrequency(G4_BB* bb, float& freq)
+{
+    if (blockFrequencies.empty())
+    {
+        computeBlockFrequencies();
+    }
+    auto it = blockFrequencies.find(bb);
+    if (it == blockFrequencies.end())
+    {
+        return false;
+    }
+    freq = it->second;
+    return true;
+}
+
 unsigned int G4_Kernel::calleeSaveStart()
 {
     return getCallerSaveLastGRF() + 1;
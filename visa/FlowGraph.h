@@ -1362,7 +1362,20 @@ public:
     void setGTPinInitFromL0(bool val) { gtpinInitFromL0 = val; }
     bool isGTPinInitFromL0() { return gtpinInitFromL0; }
 
+    // Block execution counts fed back from an instrumented run. A block is
+    // keyed by the label that starts it; a null label stands for the entry
+    // of the kernel/function.
+    void setBlockCount(G4_Label* label, uint64_t count);
+    bool hasBlockProfile() const { return hasEntryCount || !blockCounts.empty(); }
+    // Execution count of bb per entry of the kernel/function. Blocks that
+    // don't start with a profiled label (e.g. ones split by vISA) inherit
+    // the count of the lexically preceding block. Returns false if the
+    // profile has no count for the entry.
+    bool getBlockFrequency(G4_BB* bb, float& freq);
+
 private:
+    void computeBlockFrequencies();
+
     G4_Kernel& kernel;
     std::set<G4_INST*> markedInsts;
     RAPass whichRAPass;
@@ -1378,6 +1391,12 @@ private:
 
     G4_BB* perThreadPayloadBB = nullptr;
     G4_BB* crossThreadPayloadBB = nullptr;
+
+    std::unordered_map<G4_Label*, uint64_t> blockCounts;
+    uint64_t entryCount = 0;
+    bool hasEntryCount = false;
+    // computed on first query, once the CFG is final
+    std::unordered_map<G4_BB*, float> blockFrequencies;
 };
 
 class RelocationEntry
@@ -1599,6 +1618,11 @@ public:
         return gtPinInfo && gtPinInfo->getGTPinInit();
     }
 
+    bool hasBlockProfile()
+    {
+        return gtPinInfo && gtPinInfo->hasBlockProfile();
+    }
+
     gtPinData* getGTPinData()
     {
         if (!gtPinInfo)
@@ -2059,12 +2059,29 @@ uint32_t GlobalRA::getRefCount(int loopNestLevel)
     return (uint32_t)std::pow(IN_LOOP_REFERENCE_COUNT_FACTOR, std::min(loopNestLevel, 8));
 }
 
+// Reference weight of the instructions in bb. With a block profile the
+// measured execution count per entry replaces the loop-nest estimate: a
+// straight-line block that runs once weighs IN_LOOP_REFERENCE_COUNT_FACTOR,
+// so never-executed blocks (weight 1) become the cheapest places to spill.
+uint32_t GlobalRA::getRefCount(G4_Kernel& kernel, G4_BB* bb)
+{
+    float freq = 0.0f;
+    if (kernel.hasBlockProfile() &&
+        kernel.getGTPinData()->getBlockFrequency(bb, freq))
+    {
+        float maxRefCount = (float)getRefCount(8);
+        float weight = std::ceil(freq * IN_LOOP_REFERENCE_COUNT_FACTOR);
+        return (uint32_t)std::max(1.0f, std::min(weight, maxRefCount));
+    }
+    return getRefCount(kernel.getOption(vISA_ConsiderLoopInfoInRA) ?
+        bb->getNestLevel() : 0);
+}
+
 // handle return value interference for fcall
 void Interference::buildInterferenceForFcall(G4_BB* bb, BitSet& live, G4_INST* inst, std::list<G4_INST*>::reverse_iterator i, const G4_VarBase* regVar)
 {
     assert(inst->opcode() == G4_pseudo_fcall && "expect fcall inst");
-    unsigned refCount = GlobalRA::getRefCount(kernel.getOption(vISA_ConsiderLoopInfoInRA) ?
-        bb->getNestLevel() : 0);
+    unsigned refCount = GlobalRA::getRefCount(kernel, bb);
 
     if (regVar->isRegAllocPartaker())
     {
@@ -2085,8 +2102,7 @@ bool GlobalRA::isReRAPass()
 
 void Interference::buildInterferenceForDst(G4_BB* bb, BitSet& live, G4_INST* inst, std::list<G4_INST*>::reverse_iterator i, G4_DstRegRegion* dst)
 {
-    unsigned refCount = GlobalRA::getRefCount(kernel.getOption(vISA_ConsiderLoopInfoInRA) ?
-        bb->getNestLevel() : 0);
+    unsigned refCount = GlobalRA::getRefCount(kernel, bb);
 
     if (dst->getBase()->isRegAllocPartaker())
     {
@@ -2169,8 +2185,7 @@ void Interference::buildInterferenceForDst(G4_BB* bb, BitSet& live, G4_INST* ins
 void Interference::buildInterferenceWithinBB(G4_BB* bb, BitSet& live)
 {
     DebugInfoState state(kernel.fg.mem);
-    unsigned refCount = GlobalRA::getRefCount(kernel.getOption(vISA_ConsiderLoopInfoInRA) ?
-        bb->getNestLevel() : 0);
+    unsigned refCount = GlobalRA::getRefCount(kernel, bb);
 
     for (auto i = bb->rbegin(); i != bb->rend(); i++)
     {
@@ -1190,6 +1190,7 @@ namespace vISA
         void emitFGWithLiveness(LivenessAnalysis& liveAnalysis);
         void reportSpillInfo(const LivenessAnalysis& liveness, const GraphColor& coloring) const;
         static uint32_t getRefCount(int loopNestLevel);
+        static uint32_t getRefCount(G4_Kernel& kernel, G4_BB* bb);
         bool isReRAPass();
         void updateSubRegAlignment(G4_SubReg_Align subAlign);
         bool isChannelSliced();
@@ -660,6 +660,7 @@ public:
     VISA_BUILDER_API int GetRelocations(RelocListType &relocs);
     VISA_BUILDER_API int GetGTPinBuffer(void*& buffer, unsigned int& size);
     VISA_BUILDER_API int SetGTPinInit(void* buffer);
+    VISA_BUILDER_API int SetBlockProfile(VISA_LabelOpnd* label, uint64_t count);
     VISA_BUILDER_API int GetFreeGRFInfo(void*& buffer, unsigned int& size);
 
     VISA_BUILDER_API int GetFunctionId(unsigned int& id) const;
@@ -8089,6 +8089,21 @@ int VISAKernelImpl::GetGTPinBuffer(void*& buffer, unsigned int& size)
     return VISA_SUCCESS;
 }
 
+int VISAKernelImpl::SetBlockProfile(VISA_LabelOpnd* label, uint64_t count)
+{
+    if (!m_kernel)
+        return VISA_FAILURE;
+
+    // the profile only steers finalization; it is not part of the vISA binary
+    if (IS_GEN_BOTH_PATH)
+    {
+        G4_Label* lbl = label ? (G4_Label*)label->g4opnd : nullptr;
+        m_kernel->getGTPinData()->setBlockCount(lbl, count);
+    }
+
+    return VISA_SUCCESS;
+}
+
 int VISAKernelImpl::GetFreeGRFInfo(void*& buffer, unsigned int& size)
 {
     buffer = nullptr;
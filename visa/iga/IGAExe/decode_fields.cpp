@@ -431,3 +431,41 @@ bool debugCompaction(Opts opts)
     return st != IGA_SUCCESS;
 }
 
+
+bool benchmarkDecoders(Opts opts)
+{
+    if (opts.inputFiles.size() != 1) {
+        fatalExitWithMessage("-Xdbench requires one kernel binary");
+        return true;
+    }
+    const std::string &inpFile = opts.inputFiles[0];
+    inferPlatform(inpFile, opts);
+    ensurePlatformIsSet(opts);
+
+    igax::Bits bits;
+    readBinaryFile(inpFile.c_str(), bits);
+
+    std::ofstream *outfile = nullptr;
+    if (!opts.outputFile.empty()) {
+        outfile = new std::ofstream(opts.outputFile, std::ios::out);
+    }
+    std::ostream &os = outfile ? *outfile : std::cout;
+
+    iga_status_t st =
+        iga::BenchmarkDecoders(
+            static_cast<iga::Platform>(opts.platform),
+            opts.benchIterations,
+            os,
+            bits.data(),
+            bits.size());
+    if (st != IGA_SUCCESS) {
+        std::cerr << "-Xdbench: " << inpFile << ": " <<
+            iga_status_to_string(st) << "\n";
+    }
+
+    if (!opts.outputFile.empty()) {
+        delete outfile;
+    }
+
+    return st != IGA_SUCCESS;
+}
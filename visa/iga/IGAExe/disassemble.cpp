@@ -25,9 +25,24 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 ======================= end_copyright_notice ==================================*/
 #include "iga_main.hpp"
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <sstream>
+#include <thread>
 
-bool disassemble(
-    const Opts &opts, igax::Context &ctx, const std::string &inpFile)
+
+static iga_disassemble_options_t makeDisassembleOpts(const Opts &opts)
+{
+    iga_disassemble_options_t dopts = IGA_DISASSEMBLE_OPTIONS_INIT();
+    dopts.formatting_opts = makeFormattingOpts(opts);
+    setOptBit(dopts.decoder_opts,
+        IGA_DECODING_OPT_NATIVE,
+        opts.useNativeEncoder);
+    return dopts;
+}
+
+static std::vector<unsigned char> readInput(const std::string &inpFile)
 {
     std::vector<unsigned char> inp;
     if (inpFile == IGA_STDIN_FILENAME) {
@@ -35,32 +50,190 @@ bool disassemble(
     } else {
         readBinaryFile(inpFile.c_str(), inp);
     }
+    return inp;
+}
 
-    iga_disassemble_options_t dopts = IGA_DISASSEMBLE_OPTIONS_INIT();
-    dopts.formatting_opts = makeFormattingOpts(opts);
-    setOptBit(dopts.decoder_opts,
-        IGA_DECODING_OPT_NATIVE,
-        opts.useNativeEncoder);
+// as above, but read errors go to 'diags' rather than ending the process
+static bool readInput(
+    const std::string &inpFile,
+    std::vector<unsigned char> &inp,
+    std::ostream &diags)
+{
+    if (inpFile == IGA_STDIN_FILENAME) {
+        setStdinBinary();
+        if (!tryReadBinaryStream(std::cin, inp)) {
+            diags << IGA_EXE << ": stdin: error reading\n";
+            return false;
+        }
+        return true;
+    }
+    return readBinaryFile(inpFile.c_str(), inp, diags);
+}
+
+// disassembles to 'os' (or a string if 'os' is nullptr);
+// diagnostics go to 'diags'
+static bool disassembleTo(
+    const Opts &opts,
+    igax::Context &ctx,
+    const std::vector<unsigned char> &inp,
+    std::ostream *os,
+    std::string &text,
+    std::ostream &diags)
+{
+    iga_disassemble_options_t dopts = makeDisassembleOpts(opts);
     try {
-        auto r = ctx.disassembleToString(inp.data(), inp.size(), dopts);
-        for (auto &w : r.warnings) {
-            emitWarningToStderr(w, inp);
+        std::vector<igax::Diagnostic> warnings;
+        if (os) {
+            auto r = ctx.disassembleToStream(*os, inp.data(), inp.size(), dopts);
+            warnings = r.warnings;
+        } else {
+            auto r = ctx.disassembleToString(inp.data(), inp.size(), dopts);
+            warnings = r.warnings;
+            text = r.value;
+        }
+        for (auto &w : warnings) {
+            emitWarningToStream(diags, w, inp);
         }
-        writeText(opts, r.value);
         return true;
     } catch (const igax::DisassembleError &err) {
         // some error where we can report several potentially
         for (auto &e : err.errors) {
-            emitErrorToStderr(e, inp);
+            emitErrorToStream(diags, e, inp);
         }
         if (err.errors.empty()) {
             // e.g. some failures don't have diagnostics
             //      invalid project for instance
-            err.emit(std::cerr);
+            err.emit(diags);
         }
     } catch (const igax::Error &err) {
         // some other error
-        err.emit(std::cerr);
+        err.emit(diags);
     }
     return false;
 }
+
+
+bool disassemble(
+    const Opts &opts, igax::Context &ctx, const std::string &inpFile)
+{
+    std::vector<unsigned char> inp = readInput(inpFile);
+
+    if (opts.streamed) {
+        // -Xstream: decode and format a chunk at a time straight to the output
+        std::ofstream file;
+        std::ostream *os = &std::cout;
+        if (opts.outputFile != "") {
+            file.open(opts.outputFile.c_str());
+            if (!file.good()) {
+                fatalExitWithMessage(
+                    opts.outputFile.c_str(), ": failed to open file");
+            }
+            os = &file;
+        }
+        std::string unused;
+        return disassembleTo(opts, ctx, inp, os, unused, std::cerr);
+    }
+
+    std::string text;
+    if (!disassembleTo(opts, ctx, inp, nullptr, text, std::cerr)) {
+        return false;
+    }
+    writeText(opts, text);
+    return true;
+}
+
+
+// -Xjobs=N: disassembles the input files on N worker threads.
+//
+// Each worker owns its own igax::Context; the platform models are immutable
+// and shared by all contexts.  The outputs (and diagnostics) are buffered
+// per file and emitted in input order, so the result is identical to
+// the sequential mode except that with -o all files are concatenated to
+// the output file.
+bool disassembleBatch(
+    const Opts &baseOpts,
+    const std::vector<Opts> &fileOpts,
+    const std::vector<std::string> &inpFiles)
+{
+    struct FileResult {
+        bool done = false;
+        bool success = false;
+        std::string text;
+        std::string diags;
+    };
+    std::vector<FileResult> results(inpFiles.size());
+    std::mutex resultsMutex;
+    std::condition_variable resultsReady;
+    std::atomic<size_t> nextFile(0);
+
+    auto worker = [&] () {
+        for (size_t i = nextFile++; i < inpFiles.size(); i = nextFile++) {
+            const Opts &opts = fileOpts[i];
+            std::stringstream streamed, diags;
+            std::string text;
+            bool success = false;
+            try {
+                igax::Context ctx(opts.platform);
+                std::vector<unsigned char> inp;
+                // only -Xstream formats chunk by chunk (and so without
+                // symbolic labels); otherwise this matches disassemble()
+                success = readInput(inpFiles[i], inp, diags) &&
+                    disassembleTo(opts, ctx, inp,
+                        opts.streamed ? &streamed : nullptr, text, diags);
+                if (opts.streamed)
+                    text = streamed.str();
+            } catch (const igax::Error &err) {
+                err.emit(diags);
+            }
+
+            std::lock_guard<std::mutex> lock(resultsMutex);
+            results[i].text = text;
+            results[i].diags = diags.str();
+            results[i].success = success;
+            results[i].done = true;
+            resultsReady.notify_all();
+        }
+    };
+
+    size_t numJobs = std::min<size_t>(
+        (size_t)std::max(baseOpts.jobs, 1), inpFiles.size());
+    std::vector<std::thread> workers;
+    for (size_t j = 0; j < numJobs; j++) {
+        workers.emplace_back(worker);
+    }
+
+    std::ofstream file;
+    std::ostream *os = &std::cout;
+    if (baseOpts.outputFile != "") {
+        file.open(baseOpts.outputFile.c_str());
+        if (!file.good()) {
+            fatalExitWithMessage(
+                baseOpts.outputFile.c_str(), ": failed to open file");
+        }
+        os = &file;
+    }
+
+    // emit results in input order as they complete
+    bool hasError = false;
+    for (size_t i = 0; i < inpFiles.size(); i++) {
+        std::string text, diags;
+        bool success;
+        {
+            std::unique_lock<std::mutex> lock(resultsMutex);
+            resultsReady.wait(lock, [&] () {return results[i].done;});
+            text.swap(results[i].text);
+            diags.swap(results[i].diags);
+            success = results[i].success;
+        }
+        std::cerr << diags;
+        if (success) {
+            writeTextStream(inpFiles[i].c_str(), *os, text.c_str());
+        }
+        hasError |= !success;
+    }
+
+    for (auto &w : workers) {
+        w.join();
+    }
+    return !hasError;
+}
@@ -330,6 +330,27 @@ extern "C" int iga_main(int argc, const char **argv)
         [] (const char *, const opts::ErrorHandler &, Opts &baseOpts) {
             baseOpts.mode = Opts::Mode::XDCMP;
         });
+    xGrp.defineOpt(
+        "dbench",
+        nullptr,
+        "INT",
+        "benchmarks the instruction decoders",
+        "This mode decodes a kernel binary the given number of times with "
+        "each available full decoder (GED and native) and reports the time "
+        "per instruction.  It then times decoding only the instruction "
+        "headers, with GED's field getters and with the table driven "
+        "header decoder.  The header decoder's opcode and size "
+        "classification is also checked against GED.\n"
+        "\n"
+        "EXAMPLES:\n"
+        "  % iga -Xdbench=100 foo.krn9\n",
+        opts::OptAttrs::ALLOW_UNSET,
+        [] (const char *cinp, const opts::ErrorHandler &eh, Opts &baseOpts) {
+            baseOpts.mode = Opts::Mode::XDBENCH;
+            baseOpts.benchIterations = eh.parseInt(cinp);
+            if (baseOpts.benchIterations < 1)
+                eh("iterations must be positive");
+        });
     xGrp.defineFlag(
         "dsd",
         nullptr,
@@ -379,6 +400,21 @@ extern "C" int iga_main(int argc, const char **argv)
         [] (const char *, const opts::ErrorHandler &, Opts &baseOpts) {
             baseOpts.mode = Opts::Mode::XIFS;
         });
+    xGrp.defineOpt(
+        "jobs",
+        nullptr,
+        "INT",
+        "disassembles input files on multiple threads",
+        "This disassembles the input files on the given number of worker "
+        "threads.  Output is emitted in the order of the input files; "
+        "with -o all outputs are concatenated to the given file.  "
+        "All input files must be disassembled (-d or inferred).",
+        opts::OptAttrs::ALLOW_UNSET,
+        [] (const char *cinp, const opts::ErrorHandler &eh, Opts &baseOpts) {
+            baseOpts.jobs = eh.parseInt(cinp);
+            if (baseOpts.jobs < 1)
+                eh("jobs must be positive");
+        });
     xGrp.defineFlag(
         "ldst-syntax",
         nullptr,
@@ -429,6 +465,15 @@ extern "C" int iga_main(int argc, const char **argv)
         [] (const char *, const opts::ErrorHandler &, Opts &baseOpts) {
             baseOpts.printLdSt = false;
         });
+    xGrp.defineFlag(
+        "stream",
+        nullptr,
+        "disassembles in fixed-size chunks",
+        "The kernel is decoded and formatted a chunk at a time and written "
+        "directly to the output; this bounds memory use for large inputs.  "
+        "Labels are always numeric in this mode (as with -n).",
+        opts::OptAttrs::ALLOW_UNSET,
+        baseOpts.streamed);
     xGrp.defineFlag(
         "syntax-exts",
         nullptr,
@@ -553,11 +598,32 @@ extern "C" int iga_main(int argc, const char **argv)
         hasError |= debugCompaction(baseOpts);
     } else if (baseOpts.mode == Opts::Mode::XDSD) {
         hasError |= decodeSendDescriptor(baseOpts);
+    } else if (baseOpts.mode == Opts::Mode::XDBENCH) {
+        hasError |= benchmarkDecoders(baseOpts);
     } else {
         if (baseOpts.inputFiles.empty()) {
             fatalExitWithMessage("at least one file required");
         }
 
+        if (baseOpts.jobs > 1) {
+            std::vector<Opts> fileOpts;
+            for (auto &inpFile : baseOpts.inputFiles) {
+                if (inpFile != IGA_STDIN_FILENAME &&
+                    !doesFileExist(inpFile.c_str()))
+                {
+                    fatalExitWithMessage(inpFile, ": file not found");
+                }
+                fileOpts.push_back(optsForFile(inpFile));
+                if (fileOpts.back().mode != Opts::Mode::DIS) {
+                    fatalExitWithMessage(
+                        inpFile, ": -Xjobs requires disassembly mode (-d)");
+                }
+            }
+            hasError |= !disassembleBatch(
+                baseOpts, fileOpts, baseOpts.inputFiles);
+            return hasError ? EXIT_FAILURE : EXIT_SUCCESS;
+        }
+
         // iterate each file and process it
         for (auto &inpFile : baseOpts.inputFiles) {
             if (inpFile != IGA_STDIN_FILENAME &&
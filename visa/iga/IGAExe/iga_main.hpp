@@ -53,8 +53,9 @@ struct Opts {
     // XLST = -Xlist-ops (list ops for a given platform)
     // XIFS = -Xifs (decode fields)
     // XDCMP = -Xdcmp (debug compaction)
+    // XDBENCH = -Xdbench (benchmark decoders)
     // AUTO = operate based on input (see inferPlatformAndMode below)
-    enum class Mode {ASM, DIS, XLST, XIFS, XDCMP, XDSD, AUTO};
+    enum class Mode {ASM, DIS, XLST, XIFS, XDCMP, XDSD, XDBENCH, AUTO};
     enum class Color {NEVER, AUTO, ALWAYS};
 
     std::vector<std::string> inputFiles;             // .empty() means stdin
@@ -78,12 +79,19 @@ struct Opts {
     bool printHexFloats      = false;                // -Xprint-hex-floats
     bool printLdSt           = false;                // -Xprint-ldst
     bool printInstructionPc  = false;                // -Xprint-pc
+    bool streamed            = false;                // -Xstream
+    int jobs                 = 1;                    // -Xjobs
+    int benchIterations      = 0;                    // -Xdbench
 };
 
 bool disassemble(
     const Opts &opts,
     igax::Context &ctx,
     const std::string &inpFile); // -d: disassemble.cpp
+bool disassembleBatch(
+    const Opts &baseOpts,
+    const std::vector<Opts> &fileOpts,
+    const std::vector<std::string> &inpFiles); // -d -Xjobs: disassemble.cpp
 bool assemble(
     const Opts &opts,
     igax::Context &ctx,
@@ -98,6 +106,8 @@ bool decodeInstructionFields(
     const Opts &baseOpts); // -Xifs in decode_fields.cpp
 bool debugCompaction(
     Opts opts); // -Xdcmp in decode_fields.cpp
+bool benchmarkDecoders(
+    Opts opts); // -Xdbench in decode_fields.cpp
 bool listOps(
     const Opts &opts,
     const std::string &opmn); // -Xlist-ops: list_ops.cpp
@@ -166,16 +176,23 @@ static inline void emitWarningToStderr(
     w.emitContext(std::cerr, inp);
 }
 
-static inline void emitWarningToStderr(
+static inline void emitWarningToStream(
+    std::ostream &os,
     const igax::Diagnostic &w,
     const std::vector<unsigned char> &inp)
 {
-    w.emitLoc(std::cerr);
-    std::cerr << " warning: ";
-    emitYellowText(std::cerr, w.message);
-    std::cerr << "\n";
+    w.emitLoc(os);
+    os << " warning: ";
+    emitYellowText(os, w.message);
+    os << "\n";
 
-    w.emitContext(std::cerr, "", inp.data(), inp.size());
+    w.emitContext(os, "", inp.data(), inp.size());
+}
+static inline void emitWarningToStderr(
+    const igax::Diagnostic &w,
+    const std::vector<unsigned char> &inp)
+{
+    emitWarningToStream(std::cerr, w, inp);
 }
 
 static inline void emitErrorToStderr(
@@ -189,16 +206,23 @@ static inline void emitErrorToStderr(
 
     e.emitContext(std::cerr, inp);
 }
-static inline void emitErrorToStderr(
+static inline void emitErrorToStream(
+    std::ostream &os,
     const igax::Diagnostic &e,
     const std::vector<unsigned char> &inp)
 {
-    e.emitLoc(std::cerr);
-    std::cerr << " error: ";
-    emitRedText(std::cerr, e.message);
-    std::cerr << "\n";
+    e.emitLoc(os);
+    os << " error: ";
+    emitRedText(os, e.message);
+    os << "\n";
 
-    e.emitContext(std::cerr, "", inp.data(), inp.size());
+    e.emitContext(os, "", inp.data(), inp.size());
+}
+static inline void emitErrorToStderr(
+    const igax::Diagnostic &e,
+    const std::vector<unsigned char> &inp)
+{
+    emitErrorToStream(std::cerr, e, inp);
 }
 
 static inline std::string normalizePlatformName(std::string inp) {
@@ -266,6 +290,7 @@ static inline void ensurePlatformIsSet(const Opts &opts)
           opts.mode == Opts::Mode::XIFS ? "ifs" :
           opts.mode == Opts::Mode::XDCMP ? "dcmp" :
           opts.mode == Opts::Mode::XDSD ? "dsd" :
+          opts.mode == Opts::Mode::XDBENCH ? "dbench" :
             "???";
 
         fatalExitWithMessage(
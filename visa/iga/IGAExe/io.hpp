@@ -45,8 +45,8 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "system.hpp"
 
 
-static inline void readBinaryStream(
-    const char *streamName,
+// returns false on a read error
+static inline bool tryReadBinaryStream(
     std::istream &is,
     std::vector<unsigned char> &bin)
 {
@@ -55,21 +55,36 @@ static inline void readBinaryStream(
     while (is.good()) {
         int chr;
         if ((chr = is.get()) == EOF) {
-            return;
+            return true;
         }
         bin.push_back((char)chr);
     }
-    fatalExitWithMessage(streamName, ": error reading ");
+    return false;
+}
+
+static inline void readBinaryStream(
+    const char *streamName,
+    std::istream &is,
+    std::vector<unsigned char> &bin)
+{
+    if (!tryReadBinaryStream(is, bin)) {
+        fatalExitWithMessage(streamName, ": error reading ");
+    }
 }
 
 #define IGA_STDIN_FILENAME std::string("std::cin")
 
-static inline std::vector<unsigned char> readBinaryStreamStdin()
+static inline void setStdinBinary()
 {
 #ifdef _WIN32
     (void)_setmode(_fileno(stdin), _O_BINARY);
     // #else Linux doesn't make a distinction
 #endif
+}
+
+static inline std::vector<unsigned char> readBinaryStreamStdin()
+{
+    setStdinBinary();
     std::vector<unsigned char> bits;
     readBinaryStream("stdin", std::cin, bits);
     return bits;
@@ -85,6 +100,25 @@ static inline void readBinaryFile(
     readBinaryStream(fileName, is, bin);
 }
 
+// same as readBinaryFile, but reports failure to 'diags' instead of
+// exiting (e.g. for worker threads)
+static inline bool readBinaryFile(
+    const char *fileName,
+    std::vector<unsigned char> &bin,
+    std::ostream &diags)
+{
+    std::ifstream is(fileName, std::ios::binary);
+    if (!is.is_open()) {
+        diags << IGA_EXE << ": " << fileName << ": failed to open file\n";
+        return false;
+    }
+    if (!tryReadBinaryStream(is, bin)) {
+        diags << IGA_EXE << ": " << fileName << ": error reading\n";
+        return false;
+    }
+    return true;
+}
+
 static inline std::string readTextStream(
     const char *streamName,
     std::istream &is)
@@ -0,0 +1,58 @@
+# Checks that batch disassembly with -Xjobs=N prints the same text as the
+# sequential path (in particular symbolic labels rather than jump offsets).
+#
+#   cmake -DIGA=<iga exe> -DSRC=<kernel.asm> -DWORK=<scratch dir> -P jobs_consistency.cmake
+
+file(MAKE_DIRECTORY "${WORK}")
+set(KRN_A "${WORK}/a.krn")
+set(KRN_B "${WORK}/b.krn")
+
+execute_process(COMMAND "${IGA}" -p=9 -q -a "${SRC}" -o "${KRN_A}"
+                RESULT_VARIABLE rc)
+if(NOT rc EQUAL 0)
+  message(FATAL_ERROR "assembling ${SRC} failed (${rc})")
+endif()
+configure_file("${KRN_A}" "${KRN_B}" COPYONLY)
+
+foreach(jobs 1 2)
+  execute_process(COMMAND "${IGA}" -p=9 -d -Xjobs=${jobs} "${KRN_A}" "${KRN_B}"
+                  OUTPUT_VARIABLE out${jobs} RESULT_VARIABLE rc)
+  if(NOT rc EQUAL 0)
+    message(FATAL_ERROR "-Xjobs=${jobs} disassembly failed (${rc})")
+  endif()
+endforeach()
+
+if(NOT out1 STREQUAL out2)
+  message(FATAL_ERROR "-Xjobs=2 output differs from -Xjobs=1\n"
+                      "--- -Xjobs=1\n${out1}\n--- -Xjobs=2\n${out2}")
+endif()
+if(NOT out1 MATCHES "jmpi[^\n]*L[0-9]+")
+  message(FATAL_ERROR "expected a symbolic jump label:\n${out1}")
+endif()
+
+# a file that cannot be opened fails on its own, the other files are still
+# disassembled (the check needs a user that file permissions apply to)
+set(KRN_NOREAD "${WORK}/noread.krn")
+configure_file("${KRN_A}" "${KRN_NOREAD}" COPYONLY)
+execute_process(COMMAND chmod 000 "${KRN_NOREAD}")
+execute_process(COMMAND cat "${KRN_NOREAD}"
+                OUTPUT_QUIET ERROR_QUIET RESULT_VARIABLE readable)
+if(NOT readable EQUAL 0)
+  execute_process(COMMAND "${IGA}" -p=9 -d -Xjobs=2
+                          "${KRN_A}" "${KRN_NOREAD}" "${KRN_B}"
+                  OUTPUT_VARIABLE out_bad ERROR_VARIABLE err_bad
+                  RESULT_VARIABLE rc)
+  if(rc EQUAL 0)
+    message(FATAL_ERROR "-Xjobs=2 with an unreadable input succeeded")
+  endif()
+  if(NOT out_bad STREQUAL out1)
+    message(FATAL_ERROR "-Xjobs=2 with an unreadable input lost output\n"
+                        "--- expected\n${out1}\n--- got\n${out_bad}")
+  endif()
+  if(NOT err_bad MATCHES "noread.krn: failed to open file")
+    message(FATAL_ERROR "expected an open error for noread.krn:\n${err_bad}")
+  endif()
+else()
+  message(STATUS "noread.krn is readable anyway, skipping the read error check")
+endif()
+execute_process(COMMAND chmod 644 "${KRN_NOREAD}")
@@ -0,0 +1,6 @@
+// a backward jump so the disassembler has a label to print symbolically
+L0:
+      mov (8|M0)  r1.0<1>:ud  r2.0<8;8,1>:ud
+      jmpi  L0
+      add (8|M0)  r3.0<1>:d  r4.0<8;8,1>:d  r5.0<8;8,1>:d
+      nop
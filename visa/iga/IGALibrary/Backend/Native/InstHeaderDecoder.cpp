@@ -0,0 +1,177 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+#include "InstHeaderDecoder.hpp"
+
+#include <initializer_list>
+
+using namespace iga;
+
+struct HeaderFieldDef {
+    HeaderField id;
+    Field          field;
+};
+
+static CONSTEXPR_IF_CPP14 HeaderFormat makeFormat(
+    const char *name,
+    std::initializer_list<HeaderFieldDef> defs)
+{
+    HeaderFormat fmt {name, { }};
+    for (const HeaderFieldDef &d : defs) {
+        fmt.fields[(int)d.id] = FieldMask(d.field);
+    }
+    return fmt;
+}
+
+#define PD_FIELD(ID, OFF, LEN) \
+    HeaderFieldDef {HeaderField::ID, Field(#ID, OFF, LEN)}
+
+///////////////////////////////////////////////////////////////////////////
+// GEN8 through GEN11
+static CONSTEXPR_IF_CPP14 HeaderFormat FORMAT_GEN8_NATIVE = makeFormat(
+    "GEN8 native", {
+        PD_FIELD(OPCODE,      0, 7),
+        PD_FIELD(ACCESSMODE,  8, 1),
+        PD_FIELD(DEPCTRL,     9, 2),
+        PD_FIELD(EXECOFFSET, 11, 3), // QtrCtrl[13:12] and NibCtrl[11]
+        PD_FIELD(THREADCTRL, 14, 2),
+        PD_FIELD(PREDCTRL,   16, 4),
+        PD_FIELD(PREDINV,    20, 1),
+        PD_FIELD(EXECSIZE,   21, 3),
+        PD_FIELD(CONDMOD,    24, 4),
+        PD_FIELD(ACCWREN,    28, 1),
+        PD_FIELD(CMPTCTRL,   29, 1),
+        PD_FIELD(DEBUGCTRL,  30, 1),
+        PD_FIELD(SATURATE,   31, 1),
+        PD_FIELD(FLAGSUBREG, 32, 1),
+        PD_FIELD(FLAGREG,    33, 1),
+        PD_FIELD(MASKCTRL,   34, 1),
+    });
+static CONSTEXPR_IF_CPP14 HeaderFormat FORMAT_GEN8_COMPACT = makeFormat(
+    "GEN8 compacted", {
+        PD_FIELD(OPCODE,         0, 7),
+        PD_FIELD(DEBUGCTRL,      7, 1),
+        PD_FIELD(CONTROLINDEX,   8, 5),
+        PD_FIELD(DATATYPEINDEX, 13, 5),
+        PD_FIELD(SUBREGINDEX,   18, 5),
+        PD_FIELD(ACCWREN,       23, 1),
+        PD_FIELD(CONDMOD,       24, 4),
+        PD_FIELD(CMPTCTRL,      29, 1),
+        PD_FIELD(SRC0INDEX,     30, 5),
+        PD_FIELD(SRC1INDEX,     35, 5),
+    });
+
+///////////////////////////////////////////////////////////////////////////
+// GEN12
+static CONSTEXPR_IF_CPP14 HeaderFormat FORMAT_GEN12_NATIVE = makeFormat(
+    "GEN12 native", {
+        PD_FIELD(OPCODE,      0, 7),
+        PD_FIELD(SWSB,        8, 8),
+        PD_FIELD(EXECSIZE,   16, 3),
+        PD_FIELD(EXECOFFSET, 19, 3),
+        PD_FIELD(FLAGSUBREG, 22, 1),
+        PD_FIELD(FLAGREG,    23, 1),
+        PD_FIELD(PREDCTRL,   24, 4),
+        PD_FIELD(PREDINV,    28, 1),
+        PD_FIELD(CMPTCTRL,   29, 1),
+        PD_FIELD(DEBUGCTRL,  30, 1),
+        PD_FIELD(MASKCTRL,   31, 1),
+    });
+static CONSTEXPR_IF_CPP14 HeaderFormat FORMAT_GEN12_COMPACT = makeFormat(
+    "GEN12 compacted", {
+        PD_FIELD(OPCODE,         0, 7),
+        PD_FIELD(DEBUGCTRL,      7, 1),
+        PD_FIELD(SWSB,           8, 8),
+        PD_FIELD(CONTROLINDEX,  24, 5),
+        PD_FIELD(CMPTCTRL,      29, 1),
+        PD_FIELD(DATATYPEINDEX, 30, 5),
+        PD_FIELD(SUBREGINDEX,   35, 5),
+        PD_FIELD(SRC0INDEX,     48, 4),
+        PD_FIELD(SRC1INDEX,     52, 4),
+    });
+
+#undef PD_FIELD
+
+
+bool InstHeaderDecoder::isSupported(Platform p)
+{
+    switch (p) {
+    case Platform::GEN8:
+    case Platform::GEN8LP:
+    case Platform::GEN9:
+    case Platform::GEN9LP:
+    case Platform::GEN9P5:
+    case Platform::GEN10:
+    case Platform::GEN11:
+    case Platform::GEN12P1:
+        return true;
+    default:
+        return false;
+    }
+}
+
+
+InstHeaderDecoder::InstHeaderDecoder(const Model &m) : model(m)
+{
+    IGA_ASSERT(isSupported(m.platform),
+        "header decoder doesn't support this platform; "
+        "caller should have checked via InstHeaderDecoder::isSupported");
+    if (m.platform >= Platform::GEN12P1) {
+        nativeFormat = &FORMAT_GEN12_NATIVE;
+        compactFormat = &FORMAT_GEN12_COMPACT;
+    } else {
+        nativeFormat = &FORMAT_GEN8_NATIVE;
+        compactFormat = &FORMAT_GEN8_COMPACT;
+    }
+    for (unsigned opc = 0; opc < sizeof(opsByCode)/sizeof(opsByCode[0]); opc++) {
+        opsByCode[opc] = &model.lookupOpSpecByCode(opc);
+    }
+}
+
+
+void InstHeaderDecoder::decodeHeaders(
+    ErrorHandler &eh,
+    const void *bits,
+    size_t bitsLen,
+    std::vector<InstHeader> &insts) const
+{
+    const uint8_t *binary = (const uint8_t *)bits;
+    // an upper bound for everything compacted would over-allocate by 2x
+    // for typical kernels; native sizing is the better guess
+    insts.reserve(insts.size() + bitsLen/16 + 1);
+
+    size_t pc = 0;
+    while (pc < bitsLen) {
+        InstHeader hdr;
+        if (!decodeHeader(binary + pc, bitsLen - pc, hdr)) {
+            eh.reportWarning(Loc((uint32_t)pc),
+                "unexpected padding at end of kernel");
+            break;
+        }
+        hdr.pc = (uint32_t)pc;
+        insts.push_back(hdr);
+        pc += hdr.length();
+    }
+}
@@ -0,0 +1,216 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+#ifndef IGA_BACKEND_NATIVE_INSTHEADERDECODER_HPP
+#define IGA_BACKEND_NATIVE_INSTHEADERDECODER_HPP
+
+#include "Field.hpp"
+#include "MInst.hpp"
+#include "../../ErrorHandler.hpp"
+#include "../../Models/Models.hpp"
+
+#include <cstdint>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////
+// A fast instruction header decoder for binary analysis tools.
+//
+// The full decoders (native InstDecoder and GED) walk field descriptors
+// one at a time and build IR.  Tools that only need to classify
+// instructions (instrumentation, block counting, opcode histograms...)
+// pay for far more than they use.  This decoder looks at each instruction
+// once: the compaction control and opcode select a format and an OpSpec,
+// and then every field of that format is pulled out via a shift/mask
+// table that is computed at compile time from the same Field descriptors
+// the native encoder uses.
+//
+// It is deliberately limited to the instruction header: the fields that
+// sit at the same place for every native format on a platform family.
+// Operands (registers, regions, types, immediates, send descriptors) are
+// not decoded, and compacted instructions only yield their compaction
+// table indices; callers needing any of those must use a full decoder.
+namespace iga
+{
+    // A Field lowered to (qword, shift, mask) triples.
+    struct FieldMask
+    {
+        struct Part {
+            uint64_t mask = 0;     // unshifted mask
+            uint8_t  word = 0;     // qword index
+            uint8_t  shift = 0;    // bit offset within that qword
+            uint8_t  dstShift = 0; // where these bits land in the result
+        };
+        Part parts[Field::MAX_FRAGMENTS_PER_FIELD];
+        int  numParts = 0;
+
+        constexpr FieldMask() { }
+        CONSTEXPR_IF_CPP14 FieldMask(const Field &f) {
+            int dstOff = 0;
+            for (const Fragment &fr : f.fragments) {
+                if (fr.isInvalid())
+                    break;
+                if (fr.isEncoded()) {
+                    Part &p = parts[numParts++];
+                    p.mask = fr.getMask();
+                    p.word = (uint8_t)(fr.offset / 64);
+                    p.shift = (uint8_t)(fr.offset % 64);
+                    p.dstShift = (uint8_t)dstOff;
+                }
+                // zero-fill fragments contribute nothing but their width
+                dstOff += fr.length;
+            }
+        }
+
+        constexpr bool isPresent() const {return numParts > 0;}
+
+        uint64_t extract(const MInst &mi) const {
+            uint64_t val = 0;
+            for (int i = 0; i < numParts; i++) {
+                const Part &p = parts[i];
+                val |= ((mi.qws[p.word] >> p.shift) & p.mask) << p.dstShift;
+            }
+            return val;
+        }
+    };
+
+
+    // the fields the header decoder extracts; a given format only has a
+    // subset of these (see HeaderFormat::has)
+    enum class HeaderField {
+        OPCODE = 0,
+        CMPTCTRL,
+        DEBUGCTRL,
+        // native formats
+        ACCESSMODE,
+        DEPCTRL,
+        EXECOFFSET,
+        THREADCTRL,
+        PREDCTRL,
+        PREDINV,
+        EXECSIZE,
+        CONDMOD,
+        ACCWREN,
+        SATURATE,
+        MASKCTRL,
+        FLAGREG,
+        FLAGSUBREG,
+        SWSB,
+        // compacted formats
+        CONTROLINDEX,
+        DATATYPEINDEX,
+        SUBREGINDEX,
+        SRC0INDEX,
+        SRC1INDEX,
+        //
+        COUNT
+    };
+    static const int HEADER_FIELD_COUNT = (int)HeaderField::COUNT;
+
+    // a shift/mask table for one instruction format
+    struct HeaderFormat {
+        const char *name; // e.g. "GEN8 native"
+        FieldMask   fields[HEADER_FIELD_COUNT];
+
+        bool has(HeaderField f) const {
+            return fields[(int)f].isPresent();
+        }
+    };
+
+
+    // the header of one instruction
+    struct InstHeader {
+        uint32_t               pc = 0;
+        const OpSpec          *os = nullptr; // invalid OpSpec if unknown
+        const HeaderFormat *format = nullptr;
+        uint32_t               fields[HEADER_FIELD_COUNT] = { };
+
+        bool isCompact() const {return fields[(int)HeaderField::CMPTCTRL] != 0;}
+        int length() const {return isCompact() ? 8 : 16;}
+        bool has(HeaderField f) const {return format->has(f);}
+        uint32_t get(HeaderField f) const {return fields[(int)f];}
+
+        // the execution size in channels (native formats only)
+        int getExecSize() const {return 1 << get(HeaderField::EXECSIZE);}
+        // the channel offset (e.g. 16 for M16) (native formats only)
+        int getChannelOffset() const {return 4*get(HeaderField::EXECOFFSET);}
+    };
+
+
+    class InstHeaderDecoder
+    {
+        const Model           &model;
+        const HeaderFormat *nativeFormat = nullptr;
+        const HeaderFormat *compactFormat = nullptr;
+        // opcode to OpSpec; Model::lookupOpSpecByCode is a linear search
+        const OpSpec          *opsByCode[128];
+
+    public:
+        InstHeaderDecoder(const Model &m);
+
+        static bool isSupported(Platform p);
+
+        // the format of native or compacted instructions
+        const HeaderFormat &getFormat(bool compact) const {
+            return compact ? *compactFormat : *nativeFormat;
+        }
+
+        // decodes the header of a single instruction; bitsLen is the number of bytes
+        // available at bits; returns false if there isn't a full
+        // instruction there
+        bool decodeHeader(
+            const void *bits,
+            size_t bitsLen,
+            InstHeader &hdr) const
+        {
+            if (bitsLen < 8)
+                return false;
+            MInst mi;
+            memcpy(&mi, bits, 8);
+            const HeaderFormat *fmt =
+                mi.isCompact() ? compactFormat : nativeFormat;
+            if (!mi.isCompact()) {
+                if (bitsLen < 16)
+                    return false;
+                memcpy(&mi.qw1, (const uint8_t *)bits + 8, 8);
+            }
+            hdr.format = fmt;
+            for (int i = 0; i < HEADER_FIELD_COUNT; i++) {
+                hdr.fields[i] = (uint32_t)fmt->fields[i].extract(mi);
+            }
+            hdr.os = opsByCode[hdr.fields[(int)HeaderField::OPCODE]];
+            return true;
+        }
+
+        // decodes the headers of a whole kernel; trailing padding is
+        // reported as a warning (as the full decoders do)
+        void decodeHeaders(
+            ErrorHandler &eh,
+            const void *bits,
+            size_t bitsLen,
+            std::vector<InstHeader> &insts) const;
+    };
+} // namespace iga
+
+#endif // IGA_BACKEND_NATIVE_INSTHEADERDECODER_HPP
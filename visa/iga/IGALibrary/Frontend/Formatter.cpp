@@ -197,7 +197,7 @@ public:
         emit(ANSI_COMMENT);
         o << std::hex;
         emit("/* [");
-        o << setfill('0') << std::setw(4) << i.getPC();
+        o << setfill('0') << std::setw(4) << (opts.basePc + i.getPC());
         emit("] ");
         if (i.hasInstOpt(InstOpt::COMPACTED)) {
             emit("        ");
@@ -612,10 +612,11 @@ private:
 
         if (opts.printInstPc) {
             semiColon.insert();
-            ss << "[" << i.getPC() << "]: #" << i.getID();
+            ss << "[" << (opts.basePc + i.getPC()) << "]: #" <<
+                (opts.baseId + i.getID());
         } else if (opts.liveAnalysis) {
             semiColon.insert();
-            ss << "#" << i.getID();
+            ss << "#" << (opts.baseId + i.getID());
         }
 
         if (opts.liveAnalysis) {
@@ -631,7 +632,7 @@ private:
                     } else {
                         ss << "WAW";
                     }
-                    ss << " from #" << d.def->getID() << " ";
+                    ss << " from #" << (opts.baseId + d.def->getID()) << " ";
                     d.live.str(ss);
                     ss << " @" << d.minInOrderDist;
                 });
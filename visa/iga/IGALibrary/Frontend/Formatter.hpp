@@ -61,6 +61,10 @@ namespace iga {
         bool              printLdSt = false;
         bool              printAnsi = false;
         DepAnalysis      *liveAnalysis = nullptr;
+        // added to instruction PCs and IDs when printing them; used when a
+        // kernel is decoded and formatted in pieces (streamed disassembly)
+        uint32_t          basePc = 0;
+        uint32_t          baseId = 0;
 
         // format with default labels
         FormatOpts(Platform _platform)
@@ -24,7 +24,11 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 ======================= end_copyright_notice ==================================*/
 
+#include "Backend/GED/GEDToIGATranslation.hpp"
+#include "Backend/GED/IGAToGEDTranslation.hpp"
+#include "Backend/GED/Interface.hpp"
 #include "Backend/Native/InstEncoder.hpp"
+#include "Backend/Native/InstHeaderDecoder.hpp"
 #include "Backend/Native/Interface.hpp"
 #include "ColoredIO.hpp"
 #include "Frontend/Formatter.hpp"
@@ -34,6 +38,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include <algorithm>
 #include <bitset>
+#include <chrono>
 #include <iostream>
 #include <iomanip>
 #include <map>
@@ -900,4 +905,224 @@ iga_status_t iga::DebugCompaction(
     }
 
     return IGA_SUCCESS;
-}
\ No newline at end of file
+}
+
+///////////////////////////////////////////////////////////////////////////
+// decoder benchmarking (-Xdbench)
+template <typename F>
+static double timeIterationsMs(int iterations, F func)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        func();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double,std::milli>(end - start).count();
+}
+
+static void emitBenchmarkRow(
+    std::ostream &os,
+    const char *name,
+    double totalMs,
+    int iterations,
+    size_t bitsLen,
+    size_t totalInsts,
+    double baselineMs)
+{
+    double perIterMs = totalMs/iterations;
+    os << "  " << std::setw(12) << std::left << name << std::right;
+    os << std::fixed << std::setprecision(3);
+    os << std::setw(12) << perIterMs << " ms/iter";
+    os << std::setw(12) << (1000000.0*perIterMs/(double)totalInsts) <<
+        " ns/inst";
+    os << std::setw(12) << (bitsLen/(1024.0*1024.0))/(perIterMs/1000.0) <<
+        " MB/s";
+    os << std::setw(10) << (baselineMs/totalMs) << "x";
+    os << "\n";
+    os << std::defaultfloat;
+}
+
+// reads one header field through GED's getters
+static uint32_t getGEDHeaderField(ged_ins_t &gi, HeaderField f)
+{
+    GED_RETURN_VALUE st = GED_RETURN_VALUE_SUCCESS;
+    switch (f) {
+    case HeaderField::OPCODE:        return (uint32_t)GED_GetOpcode(&gi);
+    case HeaderField::CMPTCTRL:      return GED_IsCompact(&gi) ? 1 : 0;
+    case HeaderField::DEBUGCTRL:     return (uint32_t)GED_GetDebugCtrl(&gi, &st);
+    case HeaderField::ACCESSMODE:    return (uint32_t)GED_GetAccessMode(&gi, &st);
+    case HeaderField::DEPCTRL:       return (uint32_t)GED_GetDepCtrl(&gi, &st);
+    case HeaderField::EXECOFFSET:    return (uint32_t)GED_GetChannelOffset(&gi, &st);
+    case HeaderField::THREADCTRL:    return (uint32_t)GED_GetThreadCtrl(&gi, &st);
+    case HeaderField::PREDCTRL:      return (uint32_t)GED_GetPredCtrl(&gi, &st);
+    case HeaderField::PREDINV:       return (uint32_t)GED_GetPredInv(&gi, &st);
+    case HeaderField::EXECSIZE:      return GED_GetExecSize(&gi, &st);
+    case HeaderField::CONDMOD:       return (uint32_t)GED_GetCondModifier(&gi, &st);
+    case HeaderField::ACCWREN:       return (uint32_t)GED_GetAccWrCtrl(&gi, &st);
+    case HeaderField::SATURATE:      return (uint32_t)GED_GetSaturate(&gi, &st);
+    case HeaderField::MASKCTRL:      return (uint32_t)GED_GetMaskCtrl(&gi, &st);
+    case HeaderField::FLAGREG:       return GED_GetFlagRegNum(&gi, &st);
+    case HeaderField::FLAGSUBREG:    return GED_GetFlagSubRegNum(&gi, &st);
+    case HeaderField::SWSB:          return GED_GetSWSB(&gi, &st);
+    case HeaderField::CONTROLINDEX:  return GED_GetControlIndex(&gi, &st);
+    case HeaderField::DATATYPEINDEX: return GED_GetDataTypeIndex(&gi, &st);
+    case HeaderField::SUBREGINDEX:   return GED_GetSubRegIndex(&gi, &st);
+    case HeaderField::SRC0INDEX:     return GED_GetSrc0Index(&gi, &st);
+    case HeaderField::SRC1INDEX:     return GED_GetSrc1Index(&gi, &st);
+    default:                         return 0;
+    }
+}
+
+// the GED equivalent of InstHeaderDecoder::decodeHeaders: the same fields
+// of each instruction read with GED's getters and no IR built; this is the
+// baseline the header decoder should be measured against (values are
+// GED's enumerations, not raw bits)
+static void decodeHeadersWithGED(
+    const Model &model,
+    const InstHeaderDecoder &hd,
+    const uint8_t *bits,
+    size_t bitsLen,
+    std::vector<InstHeader> &insts)
+{
+    const GED_MODEL gedModel = lowerPlatform(model.platform);
+    insts.reserve(insts.size() + bitsLen/16 + 1);
+
+    size_t pc = 0;
+    while (pc < bitsLen) {
+        ged_ins_t gi;
+        GED_RETURN_VALUE st = GED_DecodeIns(
+            gedModel, bits + pc, (uint32_t)(bitsLen - pc), &gi);
+        if (st != GED_RETURN_VALUE_SUCCESS &&
+            st != GED_RETURN_VALUE_NO_COMPACT_FORM)
+        {
+            break;
+        }
+        InstHeader hdr;
+        hdr.pc = (uint32_t)pc;
+        hdr.format = &hd.getFormat(GED_IsCompact(&gi));
+        for (int i = 0; i < HEADER_FIELD_COUNT; i++) {
+            if (hdr.format->fields[i].isPresent())
+                hdr.fields[i] = getGEDHeaderField(gi, (HeaderField)i);
+        }
+        hdr.os = &model.lookupOpSpec(translate(GED_GetOpcode(&gi)));
+        insts.push_back(hdr);
+        pc += hdr.length();
+    }
+}
+
+iga_status_t iga::BenchmarkDecoders(
+    Platform p,
+    int iterations,
+    std::ostream &os,
+    const uint8_t *bits,
+    size_t bitsLen)
+{
+    const Model *model = Model::LookupModel(p);
+    if (model == nullptr) {
+        return IGA_UNSUPPORTED_PLATFORM;
+    } else if (!iga::ged::IsDecodeSupported(*model, DecoderOpts())) {
+        return IGA_UNSUPPORTED_PLATFORM;
+    } else if (!InstHeaderDecoder::isSupported(p)) {
+        return IGA_UNSUPPORTED_PLATFORM;
+    }
+    if (iterations <= 0) {
+        iterations = 1;
+    }
+
+    // numeric labels: we're timing decode, not block inference
+    DecoderOpts dopts(true);
+
+    // GED decoder (baseline); this also gives us the reference IR
+    // for checking the header decoder's classification
+    ErrorHandler gedEh;
+    Kernel *refKernel =
+        iga::ged::Decode(*model, dopts, gedEh, bits, bitsLen);
+    if (refKernel == nullptr || gedEh.hasErrors()) {
+        emitRedText(os, "GED failed to decode kernel\n");
+        delete refKernel;
+        return IGA_DECODE_ERROR;
+    }
+    std::vector<const Instruction *> refInsts;
+    for (const Block *b : refKernel->getBlockList()) {
+        for (const Instruction *inst : b->getInstList()) {
+            refInsts.push_back(inst);
+        }
+    }
+    size_t totalInsts = std::max<size_t>(refInsts.size(), 1);
+
+    double gedMs = timeIterationsMs(iterations, [&] () {
+        ErrorHandler eh;
+        delete iga::ged::Decode(*model, dopts, eh, bits, bitsLen);
+    });
+
+    bool nativeSupported = iga::native::IsDecodeSupported(*model, dopts);
+    double nativeMs = 0.0;
+    if (nativeSupported) {
+        nativeMs = timeIterationsMs(iterations, [&] () {
+            ErrorHandler eh;
+            delete iga::native::Decode(*model, dopts, eh, bits, bitsLen);
+        });
+    }
+
+    // header fields only: GED's getters versus the header decoder
+    InstHeaderDecoder hd(*model);
+    std::vector<InstHeader> hdrs;
+    double gedHeaderMs = timeIterationsMs(iterations, [&] () {
+        hdrs.clear();
+        decodeHeadersWithGED(*model, hd, bits, bitsLen, hdrs);
+    });
+    double headerMs = timeIterationsMs(iterations, [&] () {
+        ErrorHandler eh;
+        hdrs.clear();
+        hd.decodeHeaders(eh, bits, bitsLen, hdrs);
+    });
+
+    // cross check the header decoder's classification against GED
+    size_t mismatches = 0;
+    if (hdrs.size() != refInsts.size()) {
+        os << Color::RED << "header decoder found " << hdrs.size() <<
+            " instructions; GED found " << refInsts.size() <<
+            Reset::RESET << "\n";
+        mismatches++;
+    }
+    for (size_t i = 0; i < std::min(hdrs.size(), refInsts.size()); i++) {
+        const InstHeader &hdr = hdrs[i];
+        const Instruction *ref = refInsts[i];
+        if (hdr.pc != (uint32_t)ref->getPC() ||
+            hdr.os->op != ref->getOp())
+        {
+            if (mismatches++ < 8) {
+                os << Color::RED << fmtPc((const MInst *)&bits[hdr.pc], hdr.pc) <<
+                    "header decoder classified as " << hdr.os->mnemonic.str() <<
+                    "; GED decoded " << ref->getOpSpec().mnemonic.str() <<
+                    Reset::RESET << "\n";
+            }
+        }
+    }
+    delete refKernel;
+
+    os << "decoding " << refInsts.size() << " instructions (" <<
+        bitsLen << " bytes) " << iterations << " times\n";
+    os << "full decode (IR):\n";
+    emitBenchmarkRow(os, "GED", gedMs,
+        iterations, bitsLen, totalInsts, gedMs);
+    if (nativeSupported) {
+        emitBenchmarkRow(os, "native", nativeMs,
+            iterations, bitsLen, totalInsts, gedMs);
+    } else {
+        os << "  " << std::setw(12) << std::left << "native" <<
+            std::right << "   (unsupported on this platform)\n";
+    }
+    os << "header fields only:\n";
+    emitBenchmarkRow(os, "GED", gedHeaderMs,
+        iterations, bitsLen, totalInsts, gedHeaderMs);
+    emitBenchmarkRow(os, "header", headerMs,
+        iterations, bitsLen, totalInsts, gedHeaderMs);
+    if (mismatches) {
+        os << Color::RED << mismatches <<
+            " header classification mismatch(es)" <<
+            Reset::RESET << "\n";
+        return IGA_ERROR;
+    }
+    return IGA_SUCCESS;
+}
@@ -83,6 +83,18 @@ namespace iga
         std::ostream &os,
         const uint8_t *bits,
         size_t bitsLen);
+
+    // times the GED decoder and the native decoder (where supported)
+    // building IR for the given kernel, then GED's field getters against
+    // the header decoder (Backend/Native/InstHeaderDecoder.hpp) reading
+    // only the instruction headers; the header decoder's opcode and
+    // instruction size classification is checked against GED's
+    iga_status_t BenchmarkDecoders(
+        Platform p,
+        int iterations,
+        std::ostream &os,
+        const uint8_t *bits,
+        size_t bitsLen);
 }
 
 #endif // IGA_INSTDIFF_HPP
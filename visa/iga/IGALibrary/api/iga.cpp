@@ -566,6 +566,97 @@ public:
     }
 
 
+    iga_status_t disassembleStreamed(
+        iga_disassemble_options_t &dopts,
+        const void *bits,
+        uint32_t bitsLen,
+        uint32_t chunkSize,
+        iga_disassemble_sink_t sink,
+        void *sinkCtx)
+    {
+        if (chunkSize == 0)
+            chunkSize = IGA_DISASSEMBLE_CHUNK_SIZE_DEFAULT;
+
+        // branch targets may be in a different chunk
+        dopts.formatting_opts |= IGA_FORMATTING_OPT_NUMERIC_LABELS;
+
+        // diagnostics from all chunks (offsets relative to the input start)
+        iga::ErrorHandler errHandler;
+        iga_status_t st = IGA_SUCCESS;
+
+        const uint8_t *bytes = (const uint8_t *)bits;
+        std::stringstream ss;
+        uint32_t chunkStart = 0, chunkFirstId = 0;
+        while (chunkStart < bitsLen && st == IGA_SUCCESS) {
+            // extend the chunk by whole instructions
+            uint32_t chunkEnd = chunkStart;
+            while (chunkEnd < bitsLen && chunkEnd - chunkStart < chunkSize) {
+                if (bitsLen - chunkEnd < 8) {
+                    // trailing garbage; let the decoder report it
+                    chunkEnd = bitsLen;
+                    break;
+                }
+                const MInst *mi = (const MInst *)(bytes + chunkEnd);
+                chunkEnd += mi->isCompact() ? 8 : 16;
+            }
+            if (chunkEnd > bitsLen)
+                chunkEnd = bitsLen;
+
+            iga::Kernel *k = nullptr;
+            iga::ErrorHandler chunkErrHandler;
+            st = disassembleKernel(
+                chunkErrHandler,
+                dopts,
+                bytes + chunkStart,
+                chunkEnd - chunkStart,
+                k);
+            if (k != nullptr) {
+                ss.str(std::string());
+                ss.clear();
+                FormatOpts fopts = formatterOpts(dopts, nullptr, nullptr);
+                fopts.basePc = chunkStart;
+                fopts.baseId = chunkFirstId;
+                DepAnalysis la;
+                if (dopts.formatting_opts & IGA_FORMATTING_OPT_PRINT_DEPS) {
+                    la = ComputeDepAnalysis(k);
+                    fopts.liveAnalysis = &la;
+                }
+                FormatKernel(
+                    chunkErrHandler, ss, fopts, *k, bytes + chunkStart);
+                for (const Block *b : k->getBlockList())
+                    chunkFirstId += (uint32_t)b->getInstList().size();
+                delete k;
+
+                const std::string text = ss.str();
+                if ((*sink)(text.c_str(), text.size(), sinkCtx) != 0) {
+                    st = IGA_ERROR;
+                }
+            }
+
+            // rebase the chunk's diagnostics to the input start
+            for (const auto &d : chunkErrHandler.getWarnings()) {
+                Loc at = d.at;
+                at.offset += chunkStart;
+                errHandler.reportWarning(at, d.message);
+            }
+            for (const auto &d : chunkErrHandler.getErrors()) {
+                Loc at = d.at;
+                at.offset += chunkStart;
+                errHandler.reportError(at, d.message);
+            }
+            if (chunkErrHandler.hasErrors() && st == IGA_SUCCESS)
+                st = IGA_DECODE_ERROR;
+
+            chunkStart = chunkEnd;
+        }
+
+        iga_status_t dst = translateDiagnostics(errHandler);
+        if (st != IGA_SUCCESS)
+            return st;
+        return dst;
+    }
+
+
     iga_status_t disassembleInstruction(
         iga_disassemble_options_t &dopts,
         const void *bits,
@@ -851,6 +942,38 @@ iga_status_t  iga_context_disassemble_instruction(
 }
 
 
+iga_status_t  iga_context_disassemble_streamed(
+    iga_context_t ctx,
+    const iga_disassemble_options_t *dopts,
+    const void *input,
+    uint32_t input_size,
+    uint32_t chunk_size,
+    iga_disassemble_sink_t sink,
+    void *sink_ctx)
+{
+    RETURN_INVALID_ARG_ON_NULL(ctx);
+    RETURN_INVALID_ARG_ON_NULL(dopts);
+    if (input == nullptr && input_size != 0)
+        return IGA_INVALID_ARG;
+    RETURN_INVALID_ARG_ON_NULL(sink);
+    if (dopts->cb > sizeof(*dopts)) {
+        return IGA_VERSION_ERROR;
+    }
+    iga_disassemble_options_t doptsInternal =
+        IGA_DISASSEMBLE_OPTIONS_INIT_NUMERIC_LABELS();
+    memcpy_s(&doptsInternal, dopts->cb, dopts, dopts->cb);
+
+    CAST_CONTEXT(ctx_obj, ctx);
+    return ctx_obj->disassembleStreamed(
+        doptsInternal,
+        input,
+        input_size,
+        chunk_size,
+        sink,
+        sink_ctx);
+}
+
+
 iga_status_t iga_context_get_errors(
     iga_context_t ctx,
     const iga_diagnostic_t **ds,
@@ -554,6 +554,73 @@ IGA_API  iga_status_t  iga_disassemble_instruction(
     char **kernel_text);
 
 
+/*
+ * A callback receiving a piece of disassembly text from
+ * iga_context_disassemble_streamed.
+ *
+ * PARAMETERS:
+ *  text            NUL-terminated disassembly text for a contiguous group
+ *                  of instructions; the memory is owned by IGA and is only
+ *                  valid until the callback returns
+ *  text_len        the length of 'text' in characters (excluding the NUL)
+ *  sink_ctx        the 'sink_ctx' argument of the disassembly call
+ *
+ * RETURNS:
+ *  0 to continue disassembly; any other value stops the disassembly and
+ *  makes iga_context_disassemble_streamed return IGA_ERROR
+ */
+typedef int (*iga_disassemble_sink_t)(
+    const char *text,
+    size_t text_len,
+    void *sink_ctx);
+
+/* the default chunk size (in bytes of input) for streamed disassembly */
+#define IGA_DISASSEMBLE_CHUNK_SIZE_DEFAULT (64u*1024u)
+
+/*
+ * Disassembles kernel bits in fixed-size chunks, passing the text of each
+ * chunk to a callback.  Only one chunk is decoded and formatted at a time
+ * so memory use is bounded by the chunk size rather than the kernel size.
+ *
+ * Chunks always end on an instruction boundary (compacted instructions are
+ * respected).  Since a branch target may be in a different chunk, labels
+ * are always numeric (as if IGA_FORMATTING_OPT_NUMERIC_LABELS was given).
+ * PCs printed with IGA_FORMATTING_OPT_PRINT_PC or IGA_FORMATTING_OPT_PRINT_BITS
+ * and diagnostic offsets are relative to the start of 'input'.  Dependency
+ * information (IGA_FORMATTING_OPT_PRINT_DEPS) is computed per chunk.
+ *
+ * PARAMETERS:
+ *  ctx             an iga context
+ *  dopts           the disassemble options
+ *  input           the instructions to disassemble
+ *  input_size      the size of the 'input' in bytes
+ *  chunk_size      the (approximate) number of input bytes decoded at a time;
+ *                  0 means IGA_DISASSEMBLE_CHUNK_SIZE_DEFAULT
+ *  sink            the callback receiving the disassembly text
+ *  sink_ctx        A callback context (environment) forwarded to 'sink'
+ *
+ * RETURNS:
+ *  IGA_SUCCESS         upon successful disassembly; 'iga_get_warnings' may
+ *                      contain warning diagnostics even upon success
+ *  IGA_INVALID_ARG     if an argument is NULL; 'input' may be NULL only
+ *                      if 'input_size' is also 0
+ *  IGA_INVALID_OBJECT  if ctx has already been destroyed
+ *  IGA_DECODE_ERROR    upon failure to decode error; the chunks preceding
+ *                      the error have already been passed to 'sink';
+ *                      specific error messages may be retrieved via
+ *                      'iga_context_get_errors'
+ *  IGA_ERROR           if 'sink' requested to stop the disassembly
+ */
+IGA_API  iga_status_t  iga_context_disassemble_streamed(
+    iga_context_t ctx,
+    const iga_disassemble_options_t *dopts,
+    const void *input,
+    uint32_t input_size,
+    uint32_t chunk_size,
+    iga_disassemble_sink_t sink,
+    void *sink_ctx);
+
+
 /*****************************************************************************/
 /*             Diagnostic Processing Functions                               */
 /*****************************************************************************/
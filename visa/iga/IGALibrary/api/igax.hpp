@@ -113,6 +113,7 @@ struct Result {
 typedef std::vector<unsigned char> Bits;
 struct AsmResult : Result<Bits> { };
 struct DisResult : Result<std::string> { };
+struct StreamResult : Result<size_t> { }; // value is the characters written
 
 // a context manages memory and state across the module boundary
 class Context {
@@ -138,6 +139,14 @@ class Context {
         const void *bits,
         const size_t bitsLen,
         const iga_disassemble_options_t &opts = IGA_DISASSEMBLE_OPTIONS_INIT());
+    // Disassembles a sequence of bits to an output stream a chunk at a time
+    // (see iga_context_disassemble_streamed); labels are always numeric
+    StreamResult disassembleToStream(
+        std::ostream &os,
+        const void *bits,
+        const size_t bitsLen,
+        const iga_disassemble_options_t &opts = IGA_DISASSEMBLE_OPTIONS_INIT(),
+        uint32_t chunkSize = IGA_DISASSEMBLE_CHUNK_SIZE_DEFAULT);
 };
 
 // parent class for all IGA API errors
@@ -413,6 +422,51 @@ inline DisResult Context::disassembleToString(
     return result;
 }
 
+inline StreamResult Context::disassembleToStream(
+    std::ostream &os,
+    const void *bits,
+    const size_t bitsLen,
+    const iga_disassemble_options_t &opts,
+    uint32_t chunkSize)
+{
+    struct Sink {
+        std::ostream &os;
+        size_t written;
+        static int emit(const char *text, size_t textLen, void *ctx) {
+            Sink *s = (Sink *)ctx;
+            s->os.write(text, (std::streamsize)textLen);
+            s->written += textLen;
+            return s->os.good() ? 0 : 1;
+        }
+    } sink {os, 0};
+
+    iga_status_t st = iga_context_disassemble_streamed(
+        context,
+        &opts,
+        bits,
+        (uint32_t)bitsLen,
+        chunkSize,
+        &Sink::emit,
+        &sink);
+    if (st != IGA_SUCCESS) {
+        std::vector<Diagnostic> errs;
+        if (st != IGA_UNSUPPORTED_PLATFORM)
+            errs = igax::getErrors(context);
+        if (st == IGA_DECODE_ERROR) {
+            throw DecodeError(
+                "iga_context_disassemble_streamed", errs, bits, bitsLen);
+        } else {
+            throw DisassembleError(
+                st, "iga_context_disassemble_streamed", errs, bits, bitsLen);
+        }
+    }
+
+    StreamResult result;
+    result.value = sink.written;
+    result.warnings = getWarnings(context);
+    return result;
+}
+
 inline void Error::emit(std::ostream &os) const {
     os << api << ": " << iga_status_to_string(status);
 }
@@ -774,6 +774,12 @@ public:
     /// This requires reRA pass to be executed, otherwise it returs nullptr
     VISA_BUILDER_API virtual int GetFreeGRFInfo(void *& buffer, unsigned int& size) = 0;
 
+    /// SetBlockProfile -- pass the execution count, measured in an instrumented
+    /// run, of the block starting at <label> (nullptr for the entry block).
+    /// With a profile, RA weighs spill candidates by how often their blocks
+    /// actually run instead of by loop nesting
+    VISA_BUILDER_API virtual int SetBlockProfile(VISA_LabelOpnd *label, uint64_t count) = 0;
+
     ///Gets declaration id GenVar
     VISA_BUILDER_API virtual int getDeclarationID(VISA_GenVar *decl) const = 0;
 